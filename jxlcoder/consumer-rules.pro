@@ -0,0 +1,13 @@
+# Created from native code
+-keep class com.awxkee.jxlcoder.JxlRateControlResult {
+    <init>(byte[], float, int, int, boolean);
+}
+-keep class com.awxkee.jxlcoder.JxlRenditions {
+    <init>(byte[], int[], int[], int[], int[]);
+}
+-keep class com.awxkee.jxlcoder.JxlRecompressionReport {
+    <init>(int[], long[], long, long, long);
+}
+-keep class com.awxkee.jxlcoder.JxlInstrumentation {
+    private void update(long[], long, int, long[]);
+}
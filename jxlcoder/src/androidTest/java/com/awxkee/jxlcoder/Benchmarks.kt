@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.util.Log
+import java.io.File
+import java.util.concurrent.atomic.AtomicBoolean
+import kotlin.concurrent.thread
+
+/**
+ * Measurements for the instrumented benchmarks, results go to logcat under [TAG]
+ */
+internal object Benchmarks {
+
+    const val TAG = "JxlBenchmark"
+
+    fun report(name: String, message: String) {
+        Log.i(TAG, "$name: $message")
+    }
+
+    /**
+     * Best of [runs] wall clock times of [block] in nanoseconds, after one warm up run
+     */
+    fun bestNanos(runs: Int = 5, block: () -> Unit): Long {
+        block()
+        var best = Long.MAX_VALUE
+        repeat(runs) {
+            val start = System.nanoTime()
+            block()
+            best = minOf(best, System.nanoTime() - start)
+        }
+        return best
+    }
+
+    /**
+     * Resident set size of the process in kilobytes
+     */
+    fun residentKb(): Long {
+        val line = File("/proc/self/status").useLines { lines ->
+            lines.first { it.startsWith("VmRSS:") }
+        }
+        return line.substringAfter(':').trim().substringBefore(' ').toLong()
+    }
+
+    /**
+     * Runs [block] while RSS is sampled every millisecond, returns the peak growth over RSS before the call in
+     * kilobytes. Garbage is collected first so Java heap leftovers of earlier runs do not count.
+     */
+    fun peakResidentGrowthKb(block: () -> Unit): Long {
+        Runtime.getRuntime().gc()
+        val baseline = residentKb()
+        val running = AtomicBoolean(true)
+        var peak = baseline
+        val sampler = thread(name = "rss-sampler") {
+            while (running.get()) {
+                peak = maxOf(peak, residentKb())
+                Thread.sleep(1)
+            }
+        }
+        try {
+            block()
+        } finally {
+            running.set(false)
+            sampler.join()
+        }
+        return maxOf(peak, residentKb()) - baseline
+    }
+}
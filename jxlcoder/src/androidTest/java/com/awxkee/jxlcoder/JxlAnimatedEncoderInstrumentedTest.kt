@@ -0,0 +1,195 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.graphics.Bitmap
+import android.graphics.Color
+import android.os.ParcelFileDescriptor
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertThrows
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.ByteArrayOutputStream
+import java.io.File
+
+@RunWith(AndroidJUnit4::class)
+class JxlAnimatedEncoderInstrumentedTest {
+
+    @Test
+    fun bitmapAnimationEndsWithLastFrame() {
+        val data = JxlAnimatedEncoder(64, 48, effort = 3, quality = 90).use { encoder ->
+            repeat(3) {
+                encoder.addFrame(TestImages.gradient(64, 48, seed = it * 40), 40)
+            }
+            encoder.encode()
+        }
+        assertStrictlyDecodable(data, frames = 3)
+    }
+
+    @Test
+    fun heldFrameIsEncodedAsTheLastOne() {
+        val first = TestImages.gradient(64, 48)
+        val second = TestImages.gradient(64, 48, seed = 40)
+        val data = JxlAnimatedEncoder(64, 48, effort = 3, quality = 90).use { encoder ->
+            encoder.addFrame(first, 40)
+            encoder.addFrame(second, 40)
+            // Equal frames only extend the held one, which is encoded by finish
+            encoder.addFrame(second, 40)
+            encoder.addFrame(second, 40)
+            encoder.encode()
+        }
+        assertStrictlyDecodable(data, frames = 2)
+        JxlAnimatedImage(data).use { image ->
+            assertEquals(40, image.getFrameDuration(0))
+            assertEquals(120, image.getFrameDuration(1))
+        }
+    }
+
+    @Test
+    fun changedPartOfFrameIsEncodedAsTheLastOne() {
+        val first = TestImages.gradient(64, 48)
+        val second = first.copy(Bitmap.Config.ARGB_8888, true)
+        for (y in 10 until 20) {
+            for (x in 30 until 42) {
+                second.setPixel(x, y, Color.MAGENTA)
+            }
+        }
+        val data = JxlAnimatedEncoder(
+            64, 48,
+            compressionOption = JxlCompressionOption.LOSSLESS,
+            effort = 3
+        ).use { encoder ->
+            encoder.addFrame(first, 40)
+            encoder.addFrame(second, 40)
+            encoder.encode()
+        }
+        assertStrictlyDecodable(data, frames = 2)
+        JxlAnimatedImage(data, preferredColorConfig = PreferredColorConfig.RGBA_8888).use { image ->
+            val expected = IntArray(64 * 48)
+            second.getPixels(expected, 0, 64, 0, 0, 64, 48)
+            val actual = IntArray(64 * 48)
+            image.getFrame(1).getPixels(actual, 0, 64, 0, 0, 64, 48)
+            assertArrayEquals(expected, actual)
+        }
+    }
+
+    @Test
+    fun animationWrittenIntoFileEndsWithLastFrame() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        val file = File.createTempFile("animation", ".jxl", context.cacheDir)
+        try {
+            ParcelFileDescriptor.open(
+                file,
+                ParcelFileDescriptor.MODE_READ_WRITE or ParcelFileDescriptor.MODE_TRUNCATE
+            ).use { pfd ->
+                JxlAnimatedEncoder(64, 48, effort = 3, quality = 90, output = pfd).use { encoder ->
+                    repeat(3) {
+                        encoder.addFrame(TestImages.gradient(64, 48, seed = it * 40), 40)
+                    }
+                    assertEquals(file.length(), encoder.finish())
+                }
+            }
+            assertStrictlyDecodable(file.readBytes(), frames = 3)
+        } finally {
+            file.delete()
+        }
+    }
+
+    @Test
+    fun convertedPngEndsWithLastFrame() {
+        val stream = ByteArrayOutputStream()
+        TestImages.gradient(64, 48).compress(Bitmap.CompressFormat.PNG, 100, stream)
+        assertStrictlyDecodable(JxlCoder.Convenience.apng2JXL(stream.toByteArray()), frames = 1)
+    }
+
+    @Test
+    fun wrongFrameSizeFailsAndEncoderStaysUsable() {
+        JxlAnimatedEncoder(64, 48, effort = 3, quality = 90).use { encoder ->
+            assertThrows(Exception::class.java) {
+                encoder.addFrame(TestImages.gradient(32, 32), 40)
+            }
+            encoder.addFrame(TestImages.gradient(64, 48), 40)
+            val data = encoder.encode()
+            JxlAnimatedImage(data).use { image ->
+                assertEquals(1, image.numberOfFrames)
+            }
+        }
+    }
+
+    @Test
+    fun emptyAnimationFails() {
+        JxlAnimatedEncoder(64, 48, effort = 3, quality = 90).use { encoder ->
+            assertThrows(Exception::class.java) {
+                encoder.encode()
+            }
+        }
+    }
+
+    /**
+     * Conversion of a 500 frame GIF, where decoding and composing frames overlaps encoding of the previous ones
+     */
+    @Test
+    fun gifConversionThroughputBenchmark() {
+        val width = 160
+        val height = 120
+        val frames = 500
+        val palette = IntArray(256) { Color.rgb(it, (it * 3) and 0xFF, 255 - it) and 0xFFFFFF }
+        val gif = TestGif(width, height, palette)
+        repeat(frames) { frame ->
+            gif.addFrame(ByteArray(width * height) { ((it % width + it / width + frame * 3) and 0xFF).toByte() })
+        }
+        val data = gif.toByteArray()
+        var encoded = ByteArray(0)
+        val nanos = Benchmarks.bestNanos(runs = 2) {
+            encoded = JxlCoder.Convenience.gif2JXL(data, quality = 90, effort = JxlEffort.FALCON)
+        }
+        Benchmarks.report(
+            "GIF conversion, $frames frames ${width}x$height",
+            "${nanos / 1_000_000} ms, ${frames * 1_000_000_000L / nanos} frames/s, " +
+                    "${data.size} bytes into ${encoded.size}",
+        )
+        assertStrictlyDecodable(encoded, frames = frames)
+    }
+
+    /**
+     * Fails when the stream breaks off before a frame marked as the last one,
+     * lenient playback would still show all the frames of such stream
+     */
+    private fun assertStrictlyDecodable(data: ByteArray, frames: Int) {
+        JxlAnimatedImage(data).use { image ->
+            assertTrue("last frame is not marked", image.isComplete)
+            assertEquals(frames, image.numberOfFrames)
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.graphics.Bitmap
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertSame
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class JxlAnimatedFrameReuseInstrumentedTest {
+
+    @Test
+    fun framesDecodedIntoReusedBitmapAllocateNothing() {
+        assertSteadyPlaybackAllocatesNothing(scaleWidth = 0, scaleHeight = 0)
+    }
+
+    @Test
+    fun scaledFramesDecodedIntoReusedBitmapAllocateNothing() {
+        assertSteadyPlaybackAllocatesNothing(scaleWidth = 32, scaleHeight = 24)
+    }
+
+    private fun assertSteadyPlaybackAllocatesNothing(scaleWidth: Int, scaleHeight: Int) {
+        val data = encodeAnimation(FRAMES)
+        val expected = JxlAnimatedImage(data, PreferredColorConfig.RGBA_8888).use { image ->
+            (0 until FRAMES).map { TestImages.pixels(image.getFrame(it, scaleWidth, scaleHeight)) }
+        }
+
+        JxlAnimatedImage(data, PreferredColorConfig.RGBA_8888).use { image ->
+            val first = JxlInstrumentation()
+            val bitmap = image.getFrame(0, scaleWidth, scaleHeight, instrumentation = first)
+            assertEquals(Bitmap.Config.ARGB_8888, bitmap.config)
+            assertTrue("first frame allocated ${first.allocatedBytes}", first.allocatedBytes > 0)
+
+            // Two loops, the second one rewinds the decoder
+            for (i in 1 until FRAMES * 2) {
+                val frame = i % FRAMES
+                val instrumentation = JxlInstrumentation()
+                val reused = image.getFrame(frame, scaleWidth, scaleHeight, bitmap, instrumentation)
+                assertSame("frame $frame", bitmap, reused)
+                assertEquals("frame $frame", 0L, instrumentation.allocatedBytes)
+                assertTrue(instrumentation.stageNanos(JxlPipelineStage.DECODE) > 0)
+                assertArrayEquals("frame $frame", expected[frame], TestImages.pixels(reused))
+            }
+        }
+    }
+
+    private fun encodeAnimation(frames: Int): ByteArray {
+        return JxlAnimatedEncoder(64, 48, effort = 3, quality = 90).use { encoder ->
+            repeat(frames) {
+                encoder.addFrame(TestImages.gradient(64, 48, seed = it * 40), 40)
+            }
+            encoder.encode()
+        }
+    }
+
+    companion object {
+        private const val FRAMES = 6
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import com.awxkee.jxlcoder.animation.JxlAnimatedStore
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class JxlAnimatedFrameTableInstrumentedTest {
+
+    @Test
+    fun frameCountIsKnownProgressively() {
+        val data = encodeAnimation(64, 48, frames = 6, duration = 40)
+        JxlAnimatedImage(data).use { image ->
+            val known = image.knownNumberOfFrames
+            assertTrue("known $known", known in 0..6)
+            assertEquals(6, image.numberOfFrames)
+            assertTrue(image.isNumberOfFramesFinal)
+            assertEquals(6, image.knownNumberOfFrames)
+            for (i in 0 until 6) {
+                assertEquals(40, image.getFrameDuration(i))
+            }
+        }
+    }
+
+    @Test
+    fun storeReportsFramesWithoutDecodingAll() {
+        val data = encodeAnimation(64, 48, frames = 4, duration = 30)
+        JxlAnimatedImage(data).use { image ->
+            val store = JxlAnimatedStore(image)
+            assertTrue(store.hasFrame(0))
+            assertTrue(store.hasFrame(3))
+            assertFalse(store.hasFrame(4))
+            assertEquals(4, store.framesCount)
+        }
+    }
+
+    /**
+     * Time from opening a long animation to its first frame, against the time until the whole frame table is known
+     */
+    @Test
+    fun timeToFirstFrameBenchmark() {
+        val frames = 200
+        val data = encodeAnimation(256, 192, frames = frames, duration = 20)
+        var knownAtFirstFrame = 0
+        val firstFrame = Benchmarks.bestNanos {
+            JxlAnimatedImage(data).use { image ->
+                image.getFrame(0)
+                knownAtFirstFrame = image.knownNumberOfFrames
+            }
+        }
+        val frameTable = Benchmarks.bestNanos {
+            JxlAnimatedImage(data).use { image ->
+                assertEquals(frames, image.numberOfFrames)
+            }
+        }
+        Benchmarks.report(
+            "time to first frame, $frames frames 256x192",
+            "first frame ${firstFrame / 1000} us with $knownAtFirstFrame frames known, " +
+                    "whole frame table ${frameTable / 1000} us",
+        )
+        assertTrue(knownAtFirstFrame <= frames)
+    }
+
+    private fun encodeAnimation(width: Int, height: Int, frames: Int, duration: Int): ByteArray {
+        return JxlAnimatedEncoder(width, height, effort = 1, quality = 90).use { encoder ->
+            repeat(frames) {
+                encoder.addFrame(TestImages.gradient(width, height, seed = it * 40), duration)
+            }
+            encoder.encode()
+        }
+    }
+}
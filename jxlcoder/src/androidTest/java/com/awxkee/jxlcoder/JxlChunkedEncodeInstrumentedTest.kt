@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class JxlChunkedEncodeInstrumentedTest {
+
+    @Test
+    fun chunkedAndWholeLosslessDecodeToSamePixels() {
+        // Larger than one 256x256 group so chunked input is asked for several rects
+        val source = TestImages.gradient(300, 280)
+        val whole = JxlCoder.encode(
+            source,
+            compressionOption = JxlCompressionOption.LOSSLESS,
+            effort = JxlEffort.HARE,
+        )
+        val chunked = JxlCoder.encode(
+            source,
+            compressionOption = JxlCompressionOption.LOSSLESS,
+            effort = JxlEffort.HARE,
+            chunked = true,
+        )
+        val expected = TestImages.pixels(source)
+        assertArrayEquals(expected, decodePixels(whole))
+        assertArrayEquals(expected, decodePixels(chunked))
+    }
+
+    @Test
+    fun chunkedAndWholeLosslessWithAlphaDecodeToSamePixels() {
+        val source = TestImages.gradient(300, 280, translucent = true)
+        val whole = JxlCoder.encode(
+            source,
+            channelsConfiguration = JxlChannelsConfiguration.RGBA,
+            compressionOption = JxlCompressionOption.LOSSLESS,
+            effort = JxlEffort.HARE,
+        )
+        val chunked = JxlCoder.encode(
+            source,
+            channelsConfiguration = JxlChannelsConfiguration.RGBA,
+            compressionOption = JxlCompressionOption.LOSSLESS,
+            effort = JxlEffort.HARE,
+            chunked = true,
+        )
+        assertArrayEquals(decodePixels(whole), decodePixels(chunked))
+    }
+
+    /**
+     * Peak RSS growth of whole and chunked encoding against image size, the bitmap itself is allocated before
+     */
+    @Test
+    fun peakMemoryBenchmark() {
+        var largest = 0L to 0L
+        for (side in listOf(1024, 2048, 3072)) {
+            val source = TestImages.gradient(side, side)
+            val whole = Benchmarks.peakResidentGrowthKb {
+                JxlCoder.encode(source, effort = JxlEffort.FALCON, quality = 80)
+            }
+            val chunked = Benchmarks.peakResidentGrowthKb {
+                JxlCoder.encode(source, effort = JxlEffort.FALCON, quality = 80, chunked = true)
+            }
+            Benchmarks.report(
+                "chunked encode ${side}x$side",
+                "bitmap ${source.byteCount / 1024} KB, peak RSS growth whole $whole KB, chunked $chunked KB",
+            )
+            source.recycle()
+            largest = whole to chunked
+        }
+        assertTrue("whole ${largest.first} KB, chunked ${largest.second} KB", largest.second < largest.first)
+    }
+
+    private fun decodePixels(data: ByteArray): IntArray =
+        TestImages.pixels(JxlCoder.decode(data, preferredColorConfig = PreferredColorConfig.RGBA_8888))
+}
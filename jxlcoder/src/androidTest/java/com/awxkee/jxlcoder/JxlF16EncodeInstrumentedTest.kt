@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.graphics.Bitmap
+import android.os.Build
+import android.util.Half
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.filters.SdkSuppress
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+import kotlin.math.abs
+
+@RunWith(AndroidJUnit4::class)
+@SdkSuppress(minSdkVersion = Build.VERSION_CODES.O)
+class JxlF16EncodeInstrumentedTest {
+
+    @Test
+    fun f16LosslessRoundTripKeepsHalfFloats() {
+        val source = TestImages.gradient(96, 64, config = Bitmap.Config.RGBA_F16)
+        for (chunked in listOf(false, true)) {
+            val encoded = JxlCoder.encode(
+                source,
+                compressionOption = JxlCompressionOption.LOSSLESS,
+                effort = JxlEffort.HARE,
+                chunked = chunked,
+            )
+            val decoded = JxlCoder.decode(encoded, preferredColorConfig = PreferredColorConfig.RGBA_F16)
+            assertEquals(Bitmap.Config.RGBA_F16, decoded.config)
+            val error = maxError(source, decoded)
+            assertTrue("chunked=$chunked, error $error", error <= 0.01f)
+        }
+    }
+
+    /**
+     * Conversion and encode time of the same picture as RGBA_8888 and RGBA_F16, and the largest
+     * round trip error of F16 lossless and lossy encoding
+     */
+    @Test
+    fun conversionCostBenchmark() {
+        val rgba = TestImages.gradient(2048, 1536)
+        val f16 = rgba.copy(Bitmap.Config.RGBA_F16, false)
+        for ((name, bitmap) in listOf("RGBA_8888" to rgba, "RGBA_F16" to f16)) {
+            val instrumentation = JxlInstrumentation()
+            val total = Benchmarks.bestNanos {
+                JxlCoder.encode(bitmap, effort = JxlEffort.FALCON, quality = 90, instrumentation = instrumentation)
+            }
+            Benchmarks.report(
+                "F16 encode $name 2048x1536",
+                "conversion ${instrumentation.stageNanos(JxlPipelineStage.CONVERSION) / 1000} us, " +
+                        "input ${instrumentation.stageNanos(JxlPipelineStage.INPUT) / 1000} us, " +
+                        "encode ${total / 1000} us",
+            )
+        }
+
+        val source = TestImages.gradient(512, 384, config = Bitmap.Config.RGBA_F16)
+        for (option in JxlCompressionOption.entries) {
+            val encoded = JxlCoder.encode(source, compressionOption = option, effort = JxlEffort.FALCON, quality = 90)
+            val decoded = JxlCoder.decode(encoded, preferredColorConfig = PreferredColorConfig.RGBA_F16)
+            Benchmarks.report("F16 fidelity $option", "max error ${maxError(source, decoded)}")
+        }
+    }
+
+    private fun maxError(expected: Bitmap, actual: Bitmap): Float {
+        val expectedHalves = TestImages.halves(expected)
+        val actualHalves = TestImages.halves(actual)
+        assertEquals(expectedHalves.size, actualHalves.size)
+        var error = 0f
+        for (i in expectedHalves.indices) {
+            error = maxOf(error, abs(Half.toFloat(expectedHalves[i]) - Half.toFloat(actualHalves[i])))
+        }
+        return error
+    }
+}
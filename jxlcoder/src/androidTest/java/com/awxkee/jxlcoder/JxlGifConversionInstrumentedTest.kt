@@ -0,0 +1,134 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.graphics.Color
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Test
+import org.junit.runner.RunWith
+
+/**
+ * GIF conversion composes frames with its own reader, lossless results are compared with the composition
+ * rules of the reader used before: transparent background, disposal clearing or restoring the frame rect,
+ * transparent index leaving the canvas as it is and frame parts outside the canvas dropped
+ */
+@RunWith(AndroidJUnit4::class)
+class JxlGifConversionInstrumentedTest {
+
+    private class Frame(
+        val left: Int,
+        val top: Int,
+        val width: Int,
+        val height: Int,
+        val disposal: Int = 1,
+        val transparentIndex: Int = -1,
+        val interlaced: Boolean = false,
+        val localPalette: IntArray? = null,
+    ) {
+        val indices = ByteArray(width * height) { ((it * 7 + left * 3 + top * 5 + it / width) % 8).toByte() }
+    }
+
+    @Test
+    fun losslessConversionMatchesComposedFrames() {
+        val width = 40
+        val height = 30
+        val palette = IntArray(8) { Color.rgb(it * 31, 255 - it * 29, (it * 67) and 0xFF) and 0xFFFFFF }
+        val localPalette = IntArray(8) { Color.rgb(255 - it * 13, it * 41, 128 + it * 9) and 0xFFFFFF }
+        val frames = listOf(
+            Frame(0, 0, width, height),
+            Frame(4, 4, 16, 12, disposal = 2, transparentIndex = 3),
+            Frame(10, 8, 20, 10, disposal = 3, interlaced = true, localPalette = localPalette),
+            // Partly outside on the right and the bottom
+            Frame(32, 25, 12, 9, transparentIndex = 5),
+            // Starts past the right edge, nothing is drawn
+            Frame(50, 2, 6, 5),
+            Frame(0, 0, 30, 20, disposal = 3, transparentIndex = 0, localPalette = localPalette),
+            Frame(2, 20, 8, 13, disposal = 2, transparentIndex = 1, interlaced = true),
+            Frame(0, 0, width, height, transparentIndex = 2),
+        )
+        val gif = TestGif(width, height, palette)
+        frames.forEach {
+            gif.addFrame(
+                it.indices, it.left, it.top, it.width, it.height, disposal = it.disposal,
+                transparentIndex = it.transparentIndex, interlaced = it.interlaced, localPalette = it.localPalette,
+            )
+        }
+
+        val encoded = JxlCoder.Convenience.gif2JXL(
+            gif.toByteArray(),
+            effort = JxlEffort.HARE,
+            compressionOption = JxlCompressionOption.LOSSLESS,
+        )
+        val expected = compose(width, height, palette, frames)
+        JxlAnimatedImage(encoded, PreferredColorConfig.RGBA_8888).use { image ->
+            assertEquals(frames.size, image.numberOfFrames)
+            expected.forEachIndexed { index, pixels ->
+                assertEquals(40, image.getFrameDuration(index))
+                assertArrayEquals("frame $index", pixels, TestImages.pixels(image.getFrame(index)))
+            }
+        }
+    }
+
+    private fun compose(width: Int, height: Int, palette: IntArray, frames: List<Frame>): List<IntArray> {
+        val canvas = IntArray(width * height)
+        var saved = IntArray(0)
+        var previous: Frame? = null
+        return frames.map { frame ->
+            previous?.let { last ->
+                when (last.disposal) {
+                    2 -> forEachVisible(last, width, height) { _, canvasIndex -> canvas[canvasIndex] = 0 }
+                    3 -> saved.copyInto(canvas)
+                }
+            }
+            if (frame.disposal == 3) {
+                saved = canvas.copyOf()
+            }
+            val colors = frame.localPalette ?: palette
+            forEachVisible(frame, width, height) { frameIndex, canvasIndex ->
+                val index = frame.indices[frameIndex].toInt() and 0xFF
+                if (index != frame.transparentIndex) {
+                    canvas[canvasIndex] = colors[index] or 0xFF000000.toInt()
+                }
+            }
+            previous = frame
+            canvas.copyOf()
+        }
+    }
+
+    private inline fun forEachVisible(frame: Frame, width: Int, height: Int, block: (Int, Int) -> Unit) {
+        for (y in frame.top until minOf(frame.top + frame.height, height)) {
+            for (x in frame.left until minOf(frame.left + frame.width, width)) {
+                block((y - frame.top) * frame.width + x - frame.left, y * width + x)
+            }
+        }
+    }
+}
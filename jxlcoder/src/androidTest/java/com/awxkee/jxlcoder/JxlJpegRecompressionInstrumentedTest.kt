@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.graphics.Bitmap
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+
+@RunWith(AndroidJUnit4::class)
+class JxlJpegRecompressionInstrumentedTest {
+
+    private val directory = File(
+        InstrumentationRegistry.getInstrumentation().targetContext.cacheDir,
+        "recompression",
+    ).apply { mkdirs() }
+
+    @After
+    fun cleanUp() {
+        directory.deleteRecursively()
+    }
+
+    @Test
+    fun batchReconstructsEveryJpegAndSkipsBroken() {
+        val jpegs = writeJpegs(count = 4, width = 320, height = 240)
+        val broken = File(directory, "broken.jpg").apply { writeBytes(ByteArray(1024) { it.toByte() }) }
+        val inputs = jpegs + broken
+        val outputs = inputs.map { File(directory, it.nameWithoutExtension + ".jxl") }
+        val report = JxlCoder.Convenience.recompressJpegs(
+            inputs.map { it.absolutePath },
+            outputs.map { it.absolutePath },
+            effort = JxlEffort.FALCON,
+        )
+        assertEquals(5, report.count)
+        assertEquals(1, report.failedCount)
+        jpegs.forEachIndexed { i, jpeg ->
+            assertEquals(JxlRecompressionStatus.OK, report.status(i))
+            assertEquals(outputs[i].length(), report.outputSize(i))
+            assertArrayEquals(jpeg.readBytes(), JxlCoder.Convenience.reconstructJPEG(outputs[i].readBytes()))
+        }
+        assertEquals(JxlRecompressionStatus.ENCODE_FAILED, report.status(4))
+        assertFalse(outputs[4].exists())
+    }
+
+    /**
+     * Throughput of small JPEGs converted one by one with threads inside every image,
+     * against whole files spread over one worker and over every core
+     */
+    @Test
+    fun batchThroughputBenchmark() {
+        val jpegs = writeJpegs(count = 48, width = 800, height = 600)
+        val inputBytes = jpegs.sumOf { it.length() }
+        val outputs = jpegs.map { File(directory, it.nameWithoutExtension + ".jxl").absolutePath }
+
+        val oneByOne = Benchmarks.bestNanos(runs = 2) {
+            jpegs.forEach { JxlCoder.Convenience.construct(it.readBytes(), effort = JxlEffort.SQUIRREL) }
+        }
+        Benchmarks.report(
+            "JPEG recompression one by one",
+            "${jpegs.size} files, ${inputBytes / 1024} KB, ${"%.2f".format(inputBytes / 1e6 / (oneByOne / 1e9))} MB/s",
+        )
+        for (parallelFiles in listOf(1, 0)) {
+            val report = JxlCoder.Convenience.recompressJpegs(
+                jpegs.map { it.absolutePath },
+                outputs,
+                effort = JxlEffort.SQUIRREL,
+                parallelFiles = parallelFiles,
+            )
+            assertEquals(0, report.failedCount)
+            Benchmarks.report(
+                "JPEG recompression batch, parallel files $parallelFiles",
+                "${report.count} files, ${report.inputBytes / 1024} KB into ${report.outputBytes / 1024} KB, " +
+                        "${"%.2f".format(report.megabytesPerSecond)} MB/s",
+            )
+        }
+    }
+
+    private fun writeJpegs(count: Int, width: Int, height: Int): List<File> {
+        return (0 until count).map { i ->
+            val bitmap = TestImages.noisy(TestImages.gradient(width, height, seed = i * 17), amplitude = 6, seed = i)
+            File(directory, "image$i.jpg").apply {
+                outputStream().use { bitmap.compress(Bitmap.CompressFormat.JPEG, 90, it) }
+                bitmap.recycle()
+            }
+        }
+    }
+}
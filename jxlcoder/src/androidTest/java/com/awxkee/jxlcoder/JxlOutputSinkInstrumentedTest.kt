@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.os.ParcelFileDescriptor
+import android.system.Os
+import android.system.OsConstants
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertThrows
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+import java.nio.ByteBuffer
+
+@RunWith(AndroidJUnit4::class)
+class JxlOutputSinkInstrumentedTest {
+
+    @Test
+    fun everyOutputReceivesTheSameBytes() {
+        val source = TestImages.gradient(128, 96)
+        val expected = JxlCoder.encode(source, effort = JxlEffort.HARE, quality = 80)
+
+        val buffer = ByteBuffer.allocateDirect(expected.size + 16)
+        buffer.position(8)
+        val bufferWritten = JxlCoder.encode(source, buffer, effort = JxlEffort.HARE, quality = 80)
+        assertEquals(expected.size, bufferWritten)
+        assertEquals(8 + expected.size, buffer.position())
+        val fromBuffer = ByteArray(expected.size)
+        buffer.position(8)
+        buffer.get(fromBuffer)
+        assertArrayEquals(expected, fromBuffer)
+
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        val file = File.createTempFile("sink", ".jxl", context.cacheDir)
+        try {
+            val prefix = byteArrayOf(1, 2, 3, 4, 5)
+            ParcelFileDescriptor.open(
+                file,
+                ParcelFileDescriptor.MODE_READ_WRITE or ParcelFileDescriptor.MODE_TRUNCATE
+            ).use { pfd ->
+                Os.write(pfd.fileDescriptor, prefix, 0, prefix.size)
+                val fdWritten = JxlCoder.encode(source, pfd, effort = JxlEffort.HARE, quality = 80)
+                assertEquals(expected.size.toLong(), fdWritten)
+                // Offset is left right after the image, as a sequential write would leave it
+                assertEquals(
+                    prefix.size + fdWritten,
+                    Os.lseek(pfd.fileDescriptor, 0, OsConstants.SEEK_CUR)
+                )
+            }
+            assertArrayEquals(prefix + expected, file.readBytes())
+        } finally {
+            file.delete()
+        }
+    }
+
+    @Test
+    fun tooSmallBufferFails() {
+        val source = TestImages.gradient(128, 96)
+        val buffer = ByteBuffer.allocateDirect(16)
+        assertThrows(Exception::class.java) {
+            JxlCoder.encode(source, buffer, effort = JxlEffort.HARE, quality = 80)
+        }
+        assertEquals(0, buffer.position())
+    }
+
+    /**
+     * Bytes the coder allocated, time of handing the output over and the whole encode for every kind of output,
+     * a byte array costs one more copy of the encoded image than writing into a buffer or a file
+     */
+    @Test
+    fun outputCopyBenchmark() {
+        val source = TestImages.gradient(2048, 1536)
+        val expected = JxlCoder.encode(source, effort = JxlEffort.FALCON, quality = 90)
+        val buffer = ByteBuffer.allocateDirect(expected.size)
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        val file = File.createTempFile("sink", ".jxl", context.cacheDir)
+        try {
+            val outputs = listOf<Pair<String, (JxlInstrumentation) -> Unit>>(
+                "ByteArray" to { stats ->
+                    JxlCoder.encode(source, effort = JxlEffort.FALCON, quality = 90, instrumentation = stats)
+                },
+                "ByteBuffer" to { stats ->
+                    buffer.clear()
+                    JxlCoder.encode(source, buffer, effort = JxlEffort.FALCON, quality = 90, instrumentation = stats)
+                },
+                "file" to { stats ->
+                    ParcelFileDescriptor.open(
+                        file,
+                        ParcelFileDescriptor.MODE_READ_WRITE or ParcelFileDescriptor.MODE_TRUNCATE
+                    ).use { pfd ->
+                        JxlCoder.encode(source, pfd, effort = JxlEffort.FALCON, quality = 90, instrumentation = stats)
+                    }
+                },
+            )
+            val allocated = outputs.associate { (name, encode) ->
+                val stats = JxlInstrumentation()
+                val nanos = Benchmarks.bestNanos { encode(stats) }
+                Benchmarks.report(
+                    "output $name",
+                    "${expected.size} bytes encoded, allocated ${stats.allocatedBytes} bytes, " +
+                            "output ${stats.stageNanos(JxlPipelineStage.OUTPUT) / 1000} us, encode ${nanos / 1000} us",
+                )
+                name to stats.allocatedBytes
+            }
+            assertTrue("$allocated", allocated.getValue("ByteBuffer") <= allocated.getValue("ByteArray"))
+            assertTrue("$allocated", allocated.getValue("file") <= allocated.getValue("ByteArray"))
+        } finally {
+            file.delete()
+        }
+    }
+}
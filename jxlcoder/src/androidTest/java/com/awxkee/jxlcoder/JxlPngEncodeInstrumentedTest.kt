@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.graphics.Bitmap
+import android.graphics.BitmapFactory
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertArrayEquals
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.ByteArrayOutputStream
+
+@RunWith(AndroidJUnit4::class)
+class JxlPngEncodeInstrumentedTest {
+
+    @Test
+    fun losslessPngDecodesToSamePixels() {
+        val source = TestImages.gradient(300, 200)
+        val encoded = JxlCoder.Convenience.png2JXL(png(source), effort = JxlEffort.HARE)
+        val decoded = JxlCoder.decode(encoded, preferredColorConfig = PreferredColorConfig.RGBA_8888)
+        assertArrayEquals(TestImages.pixels(source), TestImages.pixels(decoded))
+    }
+
+    /**
+     * Lossless encoding of PNG data straight from the PNG against decoding it into a bitmap first
+     */
+    @Test
+    fun pngRouteBenchmark() {
+        val data = png(TestImages.gradient(2048, 1536))
+        val stats = JxlInstrumentation()
+        val direct = Benchmarks.bestNanos(runs = 3) {
+            JxlCoder.Convenience.png2JXL(data, effort = JxlEffort.FALCON, instrumentation = stats)
+        }
+        val directResident = Benchmarks.peakResidentGrowthKb {
+            JxlCoder.Convenience.png2JXL(data, effort = JxlEffort.FALCON)
+        }
+        val throughBitmap = Benchmarks.bestNanos(runs = 3) {
+            val bitmap = BitmapFactory.decodeByteArray(data, 0, data.size)
+            JxlCoder.encode(bitmap, compressionOption = JxlCompressionOption.LOSSLESS, effort = JxlEffort.FALCON)
+            bitmap.recycle()
+        }
+        val bitmapResident = Benchmarks.peakResidentGrowthKb {
+            val bitmap = BitmapFactory.decodeByteArray(data, 0, data.size)
+            JxlCoder.encode(bitmap, compressionOption = JxlCompressionOption.LOSSLESS, effort = JxlEffort.FALCON)
+            bitmap.recycle()
+        }
+        val megapixels = 2048.0 * 1536.0 / 1_000_000.0
+        Benchmarks.report(
+            "PNG route 2048x1536",
+            "png2JXL ${direct / 1000} us (${"%.1f".format(megapixels * 1e9 / direct)} MP/s, " +
+                    "allocated ${stats.allocatedBytes} bytes, peak RSS growth $directResident KB), " +
+                    "bitmap ${throughBitmap / 1000} us (${"%.1f".format(megapixels * 1e9 / throughBitmap)} MP/s, " +
+                    "peak RSS growth $bitmapResident KB)",
+        )
+    }
+
+    private fun png(bitmap: Bitmap): ByteArray {
+        val stream = ByteArrayOutputStream()
+        bitmap.compress(Bitmap.CompressFormat.PNG, 100, stream)
+        return stream.toByteArray()
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.graphics.Bitmap
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertThrows
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.ByteArrayOutputStream
+import java.util.zip.CRC32
+
+@RunWith(AndroidJUnit4::class)
+class JxlPngReaderInstrumentedTest {
+
+    @Test
+    fun truncatedPngFailsConversion() {
+        val stream = ByteArrayOutputStream()
+        TestImages.gradient(64, 48).compress(Bitmap.CompressFormat.PNG, 100, stream)
+        val png = stream.toByteArray()
+        assertThrows(Exception::class.java) {
+            JxlCoder.Convenience.apng2JXL(png.copyOf(png.size / 2))
+        }
+        assertTrue(JxlCoder.isJXL(JxlCoder.Convenience.apng2JXL(png)))
+    }
+
+    /**
+     * Conversion time of the same small picture padded by private chunks from 100KB to 50MB,
+     * libpng reads through all of them, so only the reader depends on the file size
+     */
+    @Test
+    fun readerScalingBenchmark() {
+        val stream = ByteArrayOutputStream()
+        TestImages.gradient(64, 48).compress(Bitmap.CompressFormat.PNG, 100, stream)
+        val png = stream.toByteArray()
+        val nanos = listOf(100 shl 10, 1 shl 20, 10 shl 20, 50 shl 20).associateWith { size ->
+            val padded = withPadding(png, size)
+            Benchmarks.bestNanos(runs = 2) {
+                JxlCoder.Convenience.apng2JXL(padded, effort = JxlEffort.LIGHTNING)
+            }
+        }
+        for ((size, time) in nanos) {
+            Benchmarks.report(
+                "PNG reader, ${size shr 10} KB",
+                "${time / 1000} us, ${time * (1 shl 20) / size / 1000} us per MB",
+            )
+        }
+        // Linear reading grows 50 times from 1MB to 50MB, erasing the consumed front would grow 2500 times
+        val perMegabyte = nanos.getValue(1 shl 20)
+        assertTrue("$nanos", nanos.getValue(50 shl 20) < perMegabyte * 100)
+    }
+
+    /**
+     * Inserts private ancillary chunks of zeros after IHDR until the file has [size] bytes
+     */
+    private fun withPadding(png: ByteArray, size: Int): ByteArray {
+        val headerEnd = 8 + 25
+        val chunkOverhead = 12
+        val maxChunk = 1 shl 20
+        val padding = maxOf(size - png.size, chunkOverhead)
+        // The last chunk may overshoot the padding by its overhead
+        val result = ByteArray(png.size + padding + chunkOverhead)
+        System.arraycopy(png, 0, result, 0, headerEnd)
+        var offset = headerEnd
+        var remaining = padding
+        val type = "jxPd".toByteArray(Charsets.US_ASCII)
+        while (remaining > 0) {
+            val length = minOf(maxChunk, maxOf(remaining - chunkOverhead, 0))
+            writeInt(result, offset, length)
+            System.arraycopy(type, 0, result, offset + 4, 4)
+            val crc = CRC32()
+            crc.update(result, offset + 4, 4 + length)
+            writeInt(result, offset + 8 + length, crc.value.toInt())
+            offset += chunkOverhead + length
+            remaining -= chunkOverhead + length
+        }
+        System.arraycopy(png, headerEnd, result, offset, png.size - headerEnd)
+        return result.copyOf(offset + png.size - headerEnd)
+    }
+
+    private fun writeInt(target: ByteArray, offset: Int, value: Int) {
+        target[offset] = (value ushr 24).toByte()
+        target[offset + 1] = (value ushr 16).toByte()
+        target[offset + 2] = (value ushr 8).toByte()
+        target[offset + 3] = value.toByte()
+    }
+}
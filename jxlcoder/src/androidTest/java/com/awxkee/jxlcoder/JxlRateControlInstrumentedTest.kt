@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertThrows
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class JxlRateControlInstrumentedTest {
+
+    @Test
+    fun sizeTargetIsNotExceeded() {
+        val source = TestImages.gradient(256, 192)
+        val result = JxlCoder.encodeToSize(source, targetSize = 6000, effort = JxlEffort.HARE)
+        assertTrue(result.targetReached)
+        assertTrue("size ${result.data.size}", result.data.size <= 6000)
+        assertTrue(result.score.isNaN())
+    }
+
+    @Test
+    fun scoreTargetIsReachedAndMatchesDecodedImage() {
+        val source = TestImages.gradient(256, 192)
+        val result = JxlCoder.encodeToScore(source, targetScore = 80.0, effort = JxlEffort.HARE, tolerance = 3.0)
+        assertTrue(result.targetReached)
+        assertTrue("score ${result.score}", result.score >= 80.0)
+        val decoded = JxlCoder.decode(result.data, preferredColorConfig = PreferredColorConfig.RGBA_8888)
+        assertEquals(result.score, JxlCoder.ssimulacra2(source, decoded), 0.5)
+    }
+
+    @Test
+    fun higherScoreTargetKeepsMoreBytes() {
+        val source = TestImages.gradient(256, 192)
+        val medium = JxlCoder.encodeToScore(source, targetScore = 60.0, effort = JxlEffort.HARE)
+        val high = JxlCoder.encodeToScore(source, targetScore = 85.0, effort = JxlEffort.HARE)
+        assertTrue(high.distance < medium.distance)
+        assertTrue(high.data.size > medium.data.size)
+    }
+
+    @Test
+    fun scoreTargetOutOfRangeFails() {
+        val source = TestImages.gradient(64, 48)
+        assertThrows(Exception::class.java) {
+            JxlCoder.encodeToScore(source, targetScore = 120.0)
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class Ssimulacra2InstrumentedTest {
+
+    @Test
+    fun identicalImageScoresHundred() {
+        val reference = TestImages.gradient(128, 96)
+        assertEquals(100.0, JxlCoder.ssimulacra2(reference, reference), 0.5)
+    }
+
+    /**
+     * Scores of the scalar libjxl transcription in tools/Ssimulacra2Reference.cpp for the same pairs,
+     * the host ctest keeps the library within the same tolerances
+     */
+    @Test
+    fun scoresMatchReference() {
+        val reference = TestImages.gradient(96, 80)
+        val expected = listOf(
+            Triple(TestImages.Distortion.POSTERIZE, 29.9758, 0.05),
+            Triple(TestImages.Distortion.RED_SHIFT, 88.8175, 0.25),
+            Triple(TestImages.Distortion.BOX_BLUR, 62.1891, 0.05),
+            Triple(TestImages.Distortion.XOR_PATTERN, 48.7162, 0.05),
+        )
+        for ((distortion, score, tolerance) in expected) {
+            val actual = JxlCoder.ssimulacra2(reference, TestImages.distorted(reference, distortion))
+            assertEquals("$distortion", score, actual, tolerance)
+        }
+    }
+
+    @Test
+    fun scoreDecreasesWithStrongerNoise() {
+        val reference = TestImages.gradient(128, 96)
+        val scores = listOf(2, 8, 24, 64).map {
+            JxlCoder.ssimulacra2(reference, TestImages.noisy(reference, it))
+        }
+        assertDescending(scores)
+    }
+
+    @Test
+    fun scoreDecreasesWithLowerQuality() {
+        val reference = TestImages.gradient(128, 96)
+        val scores = listOf(95, 70, 30, 5).map {
+            val encoded = JxlCoder.encode(reference, effort = JxlEffort.HARE, quality = it)
+            val decoded = JxlCoder.decode(encoded, preferredColorConfig = PreferredColorConfig.RGBA_8888)
+            JxlCoder.ssimulacra2(reference, decoded)
+        }
+        assertDescending(scores)
+    }
+
+    private fun assertDescending(scores: List<Double>) {
+        for (i in 1 until scores.size) {
+            assertTrue("scores $scores", scores[i] < scores[i - 1])
+        }
+    }
+}
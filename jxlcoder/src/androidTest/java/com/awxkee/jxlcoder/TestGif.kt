@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import java.io.ByteArrayOutputStream
+
+/**
+ * Writes GIF89a files for the tests. LZW data is stored without compression: every index is a literal
+ * code of 9 bits and the dictionary is cleared before it could grow, which any decoder has to accept.
+ * @param palette global color table of up to 256 colors as 0xRRGGBB
+ */
+internal class TestGif(
+    private val width: Int,
+    private val height: Int,
+    palette: IntArray,
+    loops: Int = 0,
+) {
+    private val out = ByteArrayOutputStream()
+
+    init {
+        out.write("GIF89a".toByteArray(Charsets.US_ASCII))
+        writeShort(width)
+        writeShort(height)
+        out.write(0xF7) // global color table of 256 entries, 8 bit color resolution
+        out.write(0) // background index
+        out.write(0) // aspect ratio
+        writePalette(palette)
+        out.write(byteArrayOf(0x21, 0xFF.toByte(), 11))
+        out.write("NETSCAPE2.0".toByteArray(Charsets.US_ASCII))
+        out.write(byteArrayOf(3, 1))
+        writeShort(loops)
+        out.write(0)
+    }
+
+    /**
+     * @param indices color indices of the frame rect row by row, always in natural order,
+     * rows are reordered when [interlaced]
+     * @param disposal GIF disposal method: 0 or 1 keeps the frame, 2 restores the background, 3 the previous canvas
+     * @param transparentIndex index which leaves canvas pixels as they are, -1 when there is none
+     * @param localPalette color table of this frame only
+     */
+    fun addFrame(
+        indices: ByteArray,
+        left: Int = 0,
+        top: Int = 0,
+        frameWidth: Int = width,
+        frameHeight: Int = height,
+        delayCentiseconds: Int = 4,
+        disposal: Int = 0,
+        transparentIndex: Int = -1,
+        interlaced: Boolean = false,
+        localPalette: IntArray? = null,
+    ): TestGif {
+        require(indices.size == frameWidth * frameHeight)
+        out.write(byteArrayOf(0x21, 0xF9.toByte(), 4))
+        out.write((disposal shl 2) or (if (transparentIndex >= 0) 1 else 0))
+        writeShort(delayCentiseconds)
+        out.write(maxOf(transparentIndex, 0))
+        out.write(0)
+
+        out.write(0x2C)
+        writeShort(left)
+        writeShort(top)
+        writeShort(frameWidth)
+        writeShort(frameHeight)
+        out.write((if (localPalette != null) 0x87 else 0) or (if (interlaced) 0x40 else 0))
+        localPalette?.let { writePalette(it) }
+
+        val rows = if (interlaced) interlacedRows(frameHeight) else (0 until frameHeight).toList()
+        val ordered = ByteArray(indices.size)
+        rows.forEachIndexed { i, row ->
+            System.arraycopy(indices, row * frameWidth, ordered, i * frameWidth, frameWidth)
+        }
+        writeImageData(ordered)
+        return this
+    }
+
+    fun toByteArray(): ByteArray {
+        return out.toByteArray() + byteArrayOf(0x3B)
+    }
+
+    private fun writeImageData(indices: ByteArray) {
+        val bits = BitWriter()
+        bits.write(CLEAR_CODE)
+        indices.forEachIndexed { i, index ->
+            if (i > 0 && i % LITERALS_PER_CLEAR == 0) {
+                bits.write(CLEAR_CODE)
+            }
+            bits.write(index.toInt() and 0xFF)
+        }
+        bits.write(END_CODE)
+        val data = bits.toByteArray()
+
+        out.write(MIN_CODE_SIZE)
+        var offset = 0
+        while (offset < data.size) {
+            val length = minOf(255, data.size - offset)
+            out.write(length)
+            out.write(data, offset, length)
+            offset += length
+        }
+        out.write(0)
+    }
+
+    private fun writePalette(palette: IntArray) {
+        require(palette.size <= 256)
+        for (i in 0 until 256) {
+            val color = palette.getOrElse(i) { 0 }
+            out.write((color shr 16) and 0xFF)
+            out.write((color shr 8) and 0xFF)
+            out.write(color and 0xFF)
+        }
+    }
+
+    private fun writeShort(value: Int) {
+        out.write(value and 0xFF)
+        out.write((value shr 8) and 0xFF)
+    }
+
+    /**
+     * Codes of 9 bits packed from the least significant bit
+     */
+    private class BitWriter {
+        private val out = ByteArrayOutputStream()
+        private var accumulator = 0
+        private var count = 0
+
+        fun write(code: Int) {
+            accumulator = accumulator or (code shl count)
+            count += CODE_BITS
+            while (count >= 8) {
+                out.write(accumulator and 0xFF)
+                accumulator = accumulator ushr 8
+                count -= 8
+            }
+        }
+
+        fun toByteArray(): ByteArray {
+            if (count > 0) {
+                out.write(accumulator and 0xFF)
+            }
+            return out.toByteArray()
+        }
+    }
+
+    companion object {
+        private const val MIN_CODE_SIZE = 8
+        private const val CODE_BITS = 9
+        private const val CLEAR_CODE = 256
+        private const val END_CODE = 257
+
+        // Every literal after the first adds a dictionary entry, codes grow to 10 bits at 512 entries
+        private const val LITERALS_PER_CLEAR = 250
+
+        /**
+         * Row order of an interlaced image: every 8th from 0, every 8th from 4, every 4th from 2, every 2nd from 1
+         */
+        fun interlacedRows(height: Int): List<Int> {
+            return (0 until height step 8) + (4 until height step 8) + (2 until height step 4) +
+                    (1 until height step 2)
+        }
+    }
+}
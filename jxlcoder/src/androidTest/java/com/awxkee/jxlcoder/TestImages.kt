@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.graphics.Bitmap
+import android.graphics.Color
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import kotlin.random.Random
+
+/**
+ * Deterministic pictures for the instrumented tests: smooth gradients with hard edges,
+ * optional translucency and seeded noise, so results never depend on assets
+ */
+internal object TestImages {
+
+    fun gradient(
+        width: Int,
+        height: Int,
+        config: Bitmap.Config = Bitmap.Config.ARGB_8888,
+        seed: Int = 0,
+        translucent: Boolean = false,
+    ): Bitmap {
+        val pixels = IntArray(width * height)
+        for (y in 0 until height) {
+            for (x in 0 until width) {
+                val r = (x * 255 / (width - 1) + seed) and 0xFF
+                val g = (y * 255 / (height - 1) + seed * 3) and 0xFF
+                val b = if ((x / 16 + y / 16) % 5 == 0) 255 - r else (r + g) / 2
+                val a = if (translucent) 64 + (x + y) % 192 else 255
+                pixels[y * width + x] = Color.argb(a, r, g, b)
+            }
+        }
+        val bitmap = Bitmap.createBitmap(width, height, config)
+        bitmap.setPixels(pixels, 0, width, 0, 0, width, height)
+        return bitmap
+    }
+
+    /**
+     * Copy of [source] with every channel moved by up to +-[amplitude], alpha is kept
+     */
+    fun noisy(source: Bitmap, amplitude: Int, seed: Int = 1): Bitmap {
+        val random = Random(seed)
+        val pixels = pixels(source)
+        for (i in pixels.indices) {
+            val c = pixels[i]
+            fun jitter(v: Int) = (v + random.nextInt(-amplitude, amplitude + 1)).coerceIn(0, 255)
+            pixels[i] = Color.argb(
+                Color.alpha(c),
+                jitter(Color.red(c)),
+                jitter(Color.green(c)),
+                jitter(Color.blue(c)),
+            )
+        }
+        val bitmap = Bitmap.createBitmap(source.width, source.height, source.config)
+        bitmap.setPixels(pixels, 0, source.width, 0, 0, source.width, source.height)
+        return bitmap
+    }
+
+    enum class Distortion {
+        POSTERIZE,
+        RED_SHIFT,
+        BOX_BLUR,
+        XOR_PATTERN,
+    }
+
+    /**
+     * Copy of [source] with color channels distorted, alpha is kept.
+     * Same formulas as tools/Ssimulacra2Patterns.h, so scores of the host reference apply
+     */
+    fun distorted(source: Bitmap, distortion: Distortion): Bitmap {
+        val width = source.width
+        val height = source.height
+        val input = pixels(source)
+        val output = IntArray(input.size)
+        val shifts = intArrayOf(16, 8, 0)
+        for (y in 0 until height) {
+            for (x in 0 until width) {
+                val channels = IntArray(3) { c ->
+                    val value = (input[y * width + x] shr shifts[c]) and 0xFF
+                    when (distortion) {
+                        Distortion.POSTERIZE -> (value and 0xE0) or 0x10
+                        Distortion.RED_SHIFT -> if (c == 0) minOf(value + 12, 255) else value
+                        Distortion.BOX_BLUR -> {
+                            var sum = 0
+                            for (dy in -1..1) {
+                                for (dx in -1..1) {
+                                    val sx = (x + dx).coerceIn(0, width - 1)
+                                    val sy = (y + dy).coerceIn(0, height - 1)
+                                    sum += (input[sy * width + sx] shr shifts[c]) and 0xFF
+                                }
+                            }
+                            (sum + 4) / 9
+                        }
+                        Distortion.XOR_PATTERN -> value xor ((x * 7 + y * 13) and 15)
+                    }
+                }
+                output[y * width + x] =
+                    Color.argb(Color.alpha(input[y * width + x]), channels[0], channels[1], channels[2])
+            }
+        }
+        val bitmap = Bitmap.createBitmap(width, height, source.config)
+        bitmap.setPixels(output, 0, width, 0, 0, width, height)
+        return bitmap
+    }
+
+    fun pixels(bitmap: Bitmap): IntArray {
+        val pixels = IntArray(bitmap.width * bitmap.height)
+        bitmap.getPixels(pixels, 0, bitmap.width, 0, 0, bitmap.width, bitmap.height)
+        return pixels
+    }
+
+    /**
+     * Raw half floats of RGBA_F16 bitmap, rows are packed by rowBytes
+     */
+    fun halves(bitmap: Bitmap): ShortArray {
+        val buffer = ByteBuffer.allocate(bitmap.rowBytes * bitmap.height).order(ByteOrder.nativeOrder())
+        bitmap.copyPixelsToBuffer(buffer)
+        buffer.rewind()
+        val shorts = buffer.asShortBuffer()
+        return ShortArray(shorts.remaining()).also { shorts.get(it) }
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "ByteSources.h"
+#include "interop/ByteInput.h"
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::shared_ptr<coder::ByteSource> borrowDirectByteBuffer(JNIEnv *env, jobject byteBuffer) {
+  auto bufferAddress = reinterpret_cast<const uint8_t *>(env->GetDirectBufferAddress(byteBuffer));
+  jlong length = env->GetDirectBufferCapacity(byteBuffer);
+  if (!bufferAddress || length <= 0) {
+    return nullptr;
+  }
+  JavaVM *vm = nullptr;
+  if (env->GetJavaVM(&vm) != JNI_OK) {
+    return nullptr;
+  }
+  jobject bufferRef = env->NewGlobalRef(byteBuffer);
+  std::shared_ptr<void> owner(bufferRef, [vm](void *ref) {
+    JNIEnv *releaseEnv = nullptr;
+    bool attached = false;
+    if (vm->GetEnv(reinterpret_cast<void **>(&releaseEnv), JNI_VERSION_1_6) == JNI_EDETACHED) {
+      if (vm->AttachCurrentThread(&releaseEnv, nullptr) != JNI_OK) {
+        return;
+      }
+      attached = true;
+    }
+    releaseEnv->DeleteGlobalRef(reinterpret_cast<jobject>(ref));
+    if (attached) {
+      vm->DetachCurrentThread();
+    }
+  });
+  return std::make_shared<coder::ByteSource>(bufferAddress, static_cast<size_t>(length), std::move(owner));
+}
+
+std::shared_ptr<coder::ByteSource> copyByteArray(JNIEnv *env, jbyteArray byteArray) {
+  auto length = env->GetArrayLength(byteArray);
+  std::vector<uint8_t> srcBuffer(length);
+  env->GetByteArrayRegion(byteArray, 0, length,
+                          reinterpret_cast<jbyte *>(srcBuffer.data()));
+  return std::make_shared<coder::ByteSource>(std::move(srcBuffer));
+}
+
+std::shared_ptr<coder::ByteSource> mapFileDescriptor(int fd) {
+  struct stat fileStat = {};
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+    std::string str = "Cannot retrieve file size from the file descriptor";
+    throw std::runtime_error(str);
+  }
+  // Data starts at the descriptor offset, the same place a read would start from
+  off_t offset = lseek(fd, 0, SEEK_CUR);
+  if (offset < 0) {
+    offset = 0;
+  }
+  if (offset >= fileStat.st_size) {
+    std::string str = "File descriptor has no data left after its current offset";
+    throw std::runtime_error(str);
+  }
+  const auto pageSize = static_cast<off_t>(sysconf(_SC_PAGESIZE));
+  const off_t mapOffset = offset - offset % pageSize;
+  const auto mapLength = static_cast<size_t>(fileStat.st_size - mapOffset);
+  void *mapped = mmap(nullptr, mapLength, PROT_READ, MAP_PRIVATE, fd, mapOffset);
+  if (mapped == MAP_FAILED) {
+    std::string str = "Cannot map the file into memory";
+    throw std::runtime_error(str);
+  }
+  std::shared_ptr<void> owner(mapped, [mapLength](void *region) {
+    munmap(region, mapLength);
+  });
+  return std::make_shared<coder::ByteSource>(reinterpret_cast<const uint8_t *>(mapped) + (offset - mapOffset),
+                                             static_cast<size_t>(fileStat.st_size - offset), std::move(owner));
+}
+
+std::unique_ptr<coder::ByteInput> openFileDescriptorInput(int fd) {
+  struct stat fileStat = {};
+  if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > 0) {
+    return std::make_unique<coder::MemoryByteInput>(mapFileDescriptor(fd));
+  }
+  return std::make_unique<coder::StreamByteInput>(fd);
+}
+
+std::unique_ptr<coder::JxlBufferSink> directByteBufferSink(JNIEnv *env, jobject byteBuffer) {
+  auto bufferAddress = reinterpret_cast<uint8_t *>(env->GetDirectBufferAddress(byteBuffer));
+  jlong length = env->GetDirectBufferCapacity(byteBuffer);
+  if (!bufferAddress || length < 0) {
+    return nullptr;
+  }
+  return std::make_unique<coder::JxlBufferSink>(bufferAddress, static_cast<size_t>(length));
+}
+
+jbyteArray chunkListToByteArray(JNIEnv *env, const coder::JxlChunkListSink &output) {
+  if (output.getSize() > static_cast<uint64_t>(std::numeric_limits<jsize>::max())) {
+    throw std::bad_alloc();
+  }
+  const auto length = static_cast<jsize>(output.getSize());
+  jbyteArray byteArray = env->NewByteArray(length);
+  if (!byteArray) {
+    env->ExceptionClear();
+    throw std::bad_alloc();
+  }
+  jsize offset = 0;
+  output.forEachChunk([&](const uint8_t *data, size_t size) {
+    env->SetByteArrayRegion(byteArray, offset, static_cast<jsize>(size),
+                            reinterpret_cast<const jbyte *>(data));
+    offset += static_cast<jsize>(size);
+  });
+  return byteArray;
+}
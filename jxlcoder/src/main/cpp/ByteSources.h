@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_BYTESOURCES_H
+#define JXLCODER_BYTESOURCES_H
+
+#include <jni.h>
+#include <memory>
+#include "interop/ByteSource.hpp"
+#include "interop/JxlOutputSink.h"
+
+namespace coder {
+class ByteInput;
+}
+
+/**
+ * Borrows direct byte buffer memory without copying, buffer is pinned with a global reference
+ * until the last holder of the source is gone. Returns nullptr if the buffer is not direct.
+ */
+std::shared_ptr<coder::ByteSource> borrowDirectByteBuffer(JNIEnv *env, jobject byteBuffer);
+
+/**
+ * Copies java byte array into the source, the only copy which is made.
+ */
+std::shared_ptr<coder::ByteSource> copyByteArray(JNIEnv *env, jbyteArray byteArray);
+
+/**
+ * Maps the file from the descriptor's current offset to its end into memory read only, the mapping
+ * is released with the last holder of the source. The offset is not moved and the file descriptor
+ * may be closed right after the call.
+ */
+std::shared_ptr<coder::ByteSource> mapFileDescriptor(int fd);
+
+/**
+ * Decoder input over the descriptor, regular files are mapped and anything else like a pipe is read as a stream
+ */
+std::unique_ptr<coder::ByteInput> openFileDescriptorInput(int fd);
+
+/**
+ * Sink writing straight into direct byte buffer memory, nullptr if the buffer is not direct.
+ * Buffer must be kept reachable by the caller while encoding.
+ */
+std::unique_ptr<coder::JxlBufferSink> directByteBufferSink(JNIEnv *env, jobject byteBuffer);
+
+/**
+ * The only copy of the encoded chunks into a java array, throws std::bad_alloc if the array cannot be allocated.
+ */
+jbyteArray chunkListToByteArray(JNIEnv *env, const coder::JxlChunkListSink &output);
+
+#endif //JXLCODER_BYTESOURCES_H
@@ -0,0 +1,205 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "GifFrameReader.h"
+#include "imagebit/BlendRgba.h"
+#include <algorithm>
+#include <cstring>
+
+static coder::FrameRect unionRect(const coder::FrameRect &a, const coder::FrameRect &b) {
+  if (a.width == 0 || a.height == 0) {
+    return b;
+  }
+  if (b.width == 0 || b.height == 0) {
+    return a;
+  }
+  const uint32_t x0 = std::min(a.x, b.x);
+  const uint32_t y0 = std::min(a.y, b.y);
+  const uint32_t x1 = std::max(a.x + a.width, b.x + b.width);
+  const uint32_t y1 = std::max(a.y + a.height, b.y + b.height);
+  return coder::FrameRect{x0, y0, x1 - x0, y1 - y0};
+}
+
+GifFrameReader::GifFrameReader(coder::ByteInput &input) : input(input) {
+  int error = D_GIF_SUCCEEDED;
+  gif = DGifOpen(this, &GifFrameReader::read, &error);
+  if (!gif) {
+    throw GifReadError("GIF cannot be read with error: " + std::string(GifErrorString(error)));
+  }
+  if (gif->SWidth <= 0 || gif->SHeight <= 0) {
+    DGifCloseFile(gif, nullptr);
+    gif = nullptr;
+    throw GifReadError("GIF has invalid dimensions");
+  }
+  width = static_cast<uint32_t>(gif->SWidth);
+  height = static_cast<uint32_t>(gif->SHeight);
+  canvas.resize(static_cast<size_t>(width) * height * 4, 0);
+}
+
+GifFrameReader::~GifFrameReader() {
+  if (gif) {
+    DGifCloseFile(gif, nullptr);
+  }
+}
+
+int GifFrameReader::read(GifFileType *gifFile, GifByteType *data, int length) {
+  auto reader = reinterpret_cast<GifFrameReader *>(gifFile->UserData);
+  // dgif_lib takes a short count as the end of the data, streams may return less than asked
+  int count = 0;
+  while (count < length) {
+    const size_t chunk = reader->input.read(data + count, static_cast<size_t>(length - count));
+    if (chunk == 0) {
+      break;
+    }
+    count += static_cast<int>(chunk);
+  }
+  return count;
+}
+
+void GifFrameReader::throwGifError() {
+  throw GifReadError("GIF cannot be read with error: " + std::string(GifErrorString(gif->Error)));
+}
+
+bool GifFrameReader::nextFrame() {
+  GraphicsControlBlock gcb = {DISPOSAL_UNSPECIFIED, false, 0, NO_TRANSPARENT_COLOR};
+  GifRecordType recordType;
+  do {
+    if (DGifGetRecordType(gif, &recordType) != GIF_OK) {
+      throwGifError();
+    }
+    if (recordType == EXTENSION_RECORD_TYPE) {
+      readExtension(gcb);
+    } else if (recordType == IMAGE_DESC_RECORD_TYPE) {
+      readImage(gcb);
+      return true;
+    }
+  } while (recordType != TERMINATE_RECORD_TYPE);
+  return false;
+}
+
+void GifFrameReader::readExtension(GraphicsControlBlock &gcb) {
+  int extensionCode = 0;
+  GifByteType *extension = nullptr;
+  if (DGifGetExtension(gif, &extensionCode, &extension) != GIF_OK) {
+    throwGifError();
+  }
+  if (extensionCode == GRAPHICS_EXT_FUNC_CODE && extension) {
+    DGifExtensionToGCB(extension[0], extension + 1, &gcb);
+  }
+  const bool isLoop = extensionCode == APPLICATION_EXT_FUNC_CODE && extension && extension[0] == 11 &&
+      (!std::memcmp(extension + 1, "NETSCAPE2.0", 11) || !std::memcmp(extension + 1, "ANIMEXTS1.0", 11));
+  while (extension) {
+    if (DGifGetExtensionNext(gif, &extension) != GIF_OK) {
+      throwGifError();
+    }
+    if (isLoop && extension && extension[0] == 3 && extension[1] == 1) {
+      loopCount = static_cast<int>(extension[2] | (extension[3] << 8));
+    }
+  }
+}
+
+coder::FrameRect GifFrameReader::disposePrevious() {
+  const coder::FrameRect &rect = frameRect;
+  if (rect.width == 0 || rect.height == 0 || (disposal != DISPOSE_BACKGROUND && disposal != DISPOSE_PREVIOUS)) {
+    return coder::FrameRect{};
+  }
+  const uint32_t stride = width * 4;
+  uint8_t *canvasRect = canvas.data() + static_cast<size_t>(rect.y) * stride + rect.x * 4;
+  if (disposal == DISPOSE_PREVIOUS) {
+    coder::ReplaceRgba8(savedRect.data(), rect.width * 4, canvasRect, stride, rect.width, rect.height);
+  } else {
+    // Background is transparent, as every browser does
+    coder::ClearRgba8(canvasRect, stride, rect.width, rect.height);
+  }
+  return rect;
+}
+
+void GifFrameReader::readImage(const GraphicsControlBlock &gcb) {
+  if (DGifGetImageDesc(gif) != GIF_OK) {
+    throwGifError();
+  }
+  const GifImageDesc &desc = gif->Image;
+  const ColorMapObject *colorMap = desc.ColorMap ? desc.ColorMap : gif->SColorMap;
+  if (!colorMap || desc.Width < 0 || desc.Height < 0) {
+    throw GifReadError("GIF frame has no color map");
+  }
+
+  const coder::FrameRect disposed = disposePrevious();
+
+  const uint32_t x0 = std::min(static_cast<uint32_t>(desc.Left), width);
+  const uint32_t y0 = std::min(static_cast<uint32_t>(desc.Top), height);
+  const uint32_t x1 = std::min(static_cast<uint32_t>(desc.Left + desc.Width), width);
+  const uint32_t y1 = std::min(static_cast<uint32_t>(desc.Top + desc.Height), height);
+  frameRect = coder::FrameRect{x0, y0, x1 - x0, y1 - y0};
+  changedRect = unionRect(disposed, frameRect);
+  disposal = gcb.DisposalMode;
+  duration = gcb.DelayTime * 10;
+
+  if (disposal == DISPOSE_PREVIOUS && frameRect.width && frameRect.height) {
+    const uint32_t stride = width * 4;
+    savedRect.resize(static_cast<size_t>(frameRect.width) * frameRect.height * 4);
+    coder::ReplaceRgba8(canvas.data() + static_cast<size_t>(frameRect.y) * stride + frameRect.x * 4, stride,
+                        savedRect.data(), frameRect.width * 4, frameRect.width, frameRect.height);
+  }
+
+  static constexpr int kInterlacedOffsets[] = {0, 4, 2, 1};
+  static constexpr int kInterlacedJumps[] = {8, 8, 4, 2};
+  const int passes = desc.Interlace ? 4 : 1;
+  line.resize(static_cast<size_t>(desc.Width));
+
+  for (int pass = 0; pass < passes; ++pass) {
+    const int start = desc.Interlace ? kInterlacedOffsets[pass] : 0;
+    const int step = desc.Interlace ? kInterlacedJumps[pass] : 1;
+    for (int row = start; row < desc.Height; row += step) {
+      if (DGifGetLine(gif, line.data(), desc.Width) != GIF_OK) {
+        throwGifError();
+      }
+      const auto y = static_cast<uint32_t>(desc.Top + row);
+      // Lines are still read to consume the data, a frame starting past the canvas has nothing to copy
+      if (y >= y1 || x0 >= x1) {
+        continue;
+      }
+      uint8_t *dst = canvas.data() + (static_cast<size_t>(y) * width + x0) * 4;
+      const GifByteType *src = line.data() + (x0 - desc.Left);
+      for (uint32_t x = x0; x < x1; ++x, ++src, dst += 4) {
+        int index = *src;
+        if (index == gcb.TransparentColor) {
+          continue;
+        }
+        if (index >= colorMap->ColorCount) {
+          index = 0;
+        }
+        const GifColorType &color = colorMap->Colors[index];
+        dst[0] = color.Red;
+        dst[1] = color.Green;
+        dst[2] = color.Blue;
+        dst[3] = 255;
+      }
+    }
+  }
+}
@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_GIFFRAMEREADER_H
+#define JXLCODER_GIFFRAMEREADER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "gif_lib.h"
+#include "imagebit/FrameDiff.h"
+#include "interop/ByteInput.h"
+
+class GifReadError : public std::exception {
+ public:
+  explicit GifReadError(const std::string &message) : errorMessage(message) {}
+
+  const char *what() const noexcept override {
+    return errorMessage.c_str();
+  }
+
+ private:
+  std::string errorMessage;
+};
+
+/**
+ * Reads GIF records one by one through dgif_lib and composes each frame on the RGBA8 canvas,
+ * so only the current frame is decoded at a time and the input is pulled only as far as that frame.
+ * Reports the area which the frame and the disposal of the previous one touched, nothing else on the canvas changes.
+ */
+class GifFrameReader {
+ public:
+  /**
+   * Input must outlive the reader
+   */
+  explicit GifFrameReader(coder::ByteInput &input);
+
+  GifFrameReader(const GifFrameReader &) = delete;
+
+  GifFrameReader &operator=(const GifFrameReader &) = delete;
+
+  ~GifFrameReader();
+
+  /**
+   * Composes the next frame on the canvas, returns false when there are no more frames
+   */
+  bool nextFrame();
+
+  [[nodiscard]] uint32_t getWidth() const {
+    return width;
+  }
+
+  [[nodiscard]] uint32_t getHeight() const {
+    return height;
+  }
+
+  /**
+   * Count from the NETSCAPE extension, 0 is infinite and 1 when there is no extension.
+   * Final after the first frame since the extension precedes it.
+   */
+  [[nodiscard]] int getLoopCount() const {
+    return loopCount;
+  }
+
+  [[nodiscard]] const std::vector<uint8_t> &getCanvas() const {
+    return canvas;
+  }
+
+  [[nodiscard]] const coder::FrameRect &getChangedRect() const {
+    return changedRect;
+  }
+
+  /**
+   * Duration of the last read frame in milliseconds
+   */
+  [[nodiscard]] int getDuration() const {
+    return duration;
+  }
+
+ private:
+  GifFileType *gif = nullptr;
+  coder::ByteInput &input;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  int loopCount = 1;
+  int duration = 0;
+  int disposal = DISPOSAL_UNSPECIFIED;
+  coder::FrameRect frameRect = {};
+  coder::FrameRect changedRect = {};
+  std::vector<uint8_t> canvas;
+  std::vector<uint8_t> savedRect;
+  std::vector<GifByteType> line;
+
+  static int read(GifFileType *gifFile, GifByteType *data, int length);
+
+  void readExtension(GraphicsControlBlock &gcb);
+
+  void readImage(const GraphicsControlBlock &gcb);
+
+  /**
+   * Disposes the previous frame, returns the area it restored
+   */
+  coder::FrameRect disposePrevious();
+
+  [[noreturn]] void throwGifError();
+};
+
+#endif //JXLCODER_GIFFRAMEREADER_H
@@ -32,199 +32,211 @@
 #include <string>
 #include <vector>
 #include "JniExceptions.h"
-#include "EasyGifReader.h"
+#include "ByteSources.h"
+#include "GifFrameReader.h"
+#include "interop/PngInput.h"
+#include "interop/JxlPngChunkedInput.h"
+#include "interop/JxlEncoding.h"
+#include "JniInstrumentation.h"
+#include "imagebit/BlendRgba.h"
+#include "imagebit/RgbaToRgb.h"
 #include "interop/JxlAnimatedEncoder.hpp"
 #include "pnglibconf.h"
 #include "png.h"
 #include <memory>
 #include <setjmp.h>
 
-std::string getGifError(EasyGifReader::Error gifError) {
-  std::string errorString = "GIF cannot be read with error: ";
+/**
+ * Frames are decoded one at a time while the encoder works on the previous ones, so memory stays at a few canvases
+ * whatever the size of the GIF. Lossless keeps pixels exact and both encode only the area each frame
+ * and the previous disposal touched.
+ */
+static void gifToJxl(coder::ByteInput &input, JxlCompressionOption compressionOption, int quality, int effort,
+                     int decodingSpeed, coder::JxlOutputSink &output) {
+  GifFrameReader reader(input);
+  std::unique_ptr<JxlAnimatedEncoder> encoder;
+  while (reader.nextFrame()) {
+    if (!encoder) {
+      const bool lossless = compressionOption == loseless;
+      encoder = std::make_unique<JxlAnimatedEncoder>(reader.getWidth(), reader.getHeight(), rgba,
+                                                     UNSIGNED_8,
+                                                     compressionOption,
+                                                     reader.getLoopCount(),
+                                                     lossless ? 100 : quality,
+                                                     effort, decodingSpeed);
+      if (lossless) {
+        encoder->setPaletteColors(256);
+      }
+    }
+    std::vector<uint8_t> frame = encoder->acquireFrameBuffer();
+    std::copy(reader.getCanvas().begin(), reader.getCanvas().end(), frame.begin());
+    encoder->addFrame(std::move(frame), reader.getDuration(), reader.getChangedRect());
+  }
+  if (!encoder) {
+    throw GifReadError("GIF has no frames");
+  }
+  encoder->encode(output);
+}
 
-  switch (gifError) {
+static jbyteArray gifToJxl(JNIEnv *env, coder::ByteInput &input, jint quality, jint effort, jint decodingSpeed,
+                           jint javaCompressionOption) {
+  try {
+    coder::JxlChunkListSink output;
+    gifToJxl(input, static_cast<JxlCompressionOption>(javaCompressionOption), quality, effort, decodingSpeed, output);
+    return chunkListToByteArray(env, output);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  } catch (GifReadError &err) {
+    std::string errorString = err.what();
+    throwException(env, errorString);
+    return nullptr;
+  } catch (AnimatedEncoderError &err) {
+    std::string errorString = err.what();
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
 
-    case EasyGifReader::Error::UNKNOWN: {
-      errorString += "Error is unknown";
-    }
-      break;
-    case EasyGifReader::Error::INVALID_OPERATION: {
-      errorString += "Invalid operation has occur while reading";
-    }
-      break;
-    case EasyGifReader::Error::OPEN_FAILED: {
-      errorString += "Open GIF has failed";
-    }
-      break;
-    case EasyGifReader::Error::READ_FAILED: {
-      errorString += "Read GIF has failed";
-    }
-      break;
-    case EasyGifReader::Error::INVALID_FILENAME: {
-      errorString += "Invalid GIF filename";
-    }
-      break;
-    case EasyGifReader::Error::NOT_A_GIF_FILE: {
-      errorString += "Not a GIF";
-    }
-      break;
-    case EasyGifReader::Error::INVALID_GIF_FILE: {
-      errorString += "Invalid GIF";
-    }
-      break;
-    case EasyGifReader::Error::OUT_OF_MEMORY: {
-      errorString += "Out of memory while reading GIF";
-    }
-      break;
-    case EasyGifReader::Error::CLOSE_FAILED: {
-      errorString += "GIF closing failed";
-    }
-      break;
-    case EasyGifReader::Error::NOT_READABLE: {
-      errorString += "GIF not readable";
-    }
-      break;
-    case EasyGifReader::Error::IMAGE_DEFECT: {
-      errorString += "GIF image defected";
-    }
-      break;
-    case EasyGifReader::Error::UNEXPECTED_EOF: {
-      errorString += "Unexpected EOF";
-    }
-      break;
+static bool checkGifOptions(JNIEnv *env, jint quality, jint effort, jint javaCompressionOption) {
+  auto compressionOption = static_cast<JxlCompressionOption>(javaCompressionOption);
+  if (compressionOption != lossy && compressionOption != loseless) {
+    throwInvalidCompressionOptionException(env);
+    return false;
+  }
+  if (effort < 0 || effort > 10) {
+    throwInvalidCompressionOptionException(env);
+    return false;
   }
-  return errorString;
+  if (quality < 0 || quality > 100) {
+    std::string exc = "Quality must be in 0...100";
+    throwException(env, exc);
+    return false;
+  }
+  return true;
 }
 
 extern "C"
 JNIEXPORT jbyteArray JNICALL
 Java_com_awxkee_jxlcoder_JxlCoder_gif2JXLImpl(JNIEnv *env, jobject thiz, jbyteArray gifData,
-                                              jint quality, jint effort, jint decodingSpeed) {
+                                              jint quality, jint effort, jint decodingSpeed,
+                                              jint javaCompressionOption) {
+  if (!checkGifOptions(env, quality, effort, javaCompressionOption)) {
+    return nullptr;
+  }
+  if (env->GetArrayLength(gifData) <= 0) {
+    std::string errorString = "Invalid input array length";
+    throwException(env, errorString);
+    return nullptr;
+  }
   try {
-    if (effort < 0 || effort > 10) {
-      throwInvalidCompressionOptionException(env);
-      return 0;
-    }
-
-    if (quality < 0 || quality > 100) {
-      std::string exc = "Quality must be in 0...100";
-      throwException(env, exc);
-      return 0;
-    }
-    auto totalLength = env->GetArrayLength(gifData);
-    if (totalLength <= 0) {
-      std::string errorString = "Invalid input array length";
-      throwException(env, errorString);
-      return nullptr;
-    }
-    std::vector<uint8_t> srcBuffer(totalLength);
-    env->GetByteArrayRegion(gifData, 0, totalLength, reinterpret_cast<jbyte *>(srcBuffer.data()));
-    EasyGifReader gifReader = EasyGifReader::openMemory(srcBuffer.data(), srcBuffer.size());
-    const int frameCount = gifReader.frameCount(); // TODO: Do something with frame count
-    if (frameCount <= 0) {
-      std::string detail = "Image contains negative count of frames";
-      std::string errorString = "GIF cannot be read with error: " + detail;
-      throwException(env, errorString);
-      return nullptr;
-    }
-    const int width = gifReader.width();
-    const int height = gifReader.height();
-    const int repeatCount = gifReader.repeatCount();
-
-    JxlAnimatedEncoder encoder(width, height, rgba,
-                               UNSIGNED_8,
-                               lossy,
-                               repeatCount,
-                               quality,
-                               effort, decodingSpeed);
-
-    const size_t frameSize = width * height * sizeof(uint8_t) * 4;
-    std::vector<uint8_t> mPixelStore(frameSize);
-
-    for (const EasyGifReader::Frame &frame : gifReader) {
-      const std::uint32_t *framePixels = frame.pixels();
-      int frameDuration = frame.duration().milliseconds();
-      const auto *mSource = reinterpret_cast<const uint8_t *>(framePixels);
-      std::copy(mSource, mSource + frameSize, mPixelStore.begin());
-      encoder.addFrame(mPixelStore, frameDuration);
-    }
-
-    mPixelStore.resize(0);
-
-    std::vector<uint8_t> buffer;
-    encoder.encode(buffer);
-    jbyteArray byteArray = env->NewByteArray((jsize) buffer.size());
-    char *memBuf = reinterpret_cast<char *>(buffer.data());
-    env->SetByteArrayRegion(byteArray, 0, (jint) buffer.size(),
-                            reinterpret_cast<const jbyte *>(memBuf));
-    buffer.clear();
-    return byteArray;
+    coder::MemoryByteInput input(copyByteArray(env, gifData));
+    return gifToJxl(env, input, quality, effort, decodingSpeed, javaCompressionOption);
   } catch (std::bad_alloc &err) {
     std::string errorString = "Not enough memory to encode this image";
     throwException(env, errorString);
     return nullptr;
-  } catch (EasyGifReader::Error gifError) {
-    std::string errorString = getGifError(gifError);
-    throwException(env, errorString);
-    return nullptr;
   }
 }
 
-void BlendOverAPNG(unsigned char **rows_dst, unsigned char **rows_src, unsigned int x, unsigned int y, unsigned int w, unsigned int h) {
-  unsigned int i, j;
-  int u, v, al;
-
-  for (j = 0; j < h; j++) {
-    unsigned char *sp = rows_src[j];
-    unsigned char *dp = rows_dst[j + y] + x * 4;
-
-    for (i = 0; i < w; i++, sp += 4, dp += 4) {
-      if (sp[3] == 255)
-        memcpy(dp, sp, 4);
-      else if (sp[3] != 0) {
-        if (dp[3] != 0) {
-          u = sp[3] * 255;
-          v = (255 - sp[3]) * dp[3];
-          al = u + v;
-          dp[0] = (sp[0] * u + dp[0] * v) / al;
-          dp[1] = (sp[1] * u + dp[1] * v) / al;
-          dp[2] = (sp[2] * u + dp[2] * v) / al;
-          dp[3] = al / 255;
-        } else
-          memcpy(dp, sp, 4);
-      }
-    }
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_gif2JXLBufferImpl(JNIEnv *env, jobject thiz, jobject gifBuffer,
+                                                    jint quality, jint effort, jint decodingSpeed,
+                                                    jint javaCompressionOption) {
+  if (!checkGifOptions(env, quality, effort, javaCompressionOption)) {
+    return nullptr;
   }
+  auto source = borrowDirectByteBuffer(env, gifBuffer);
+  if (!source) {
+    std::string errorString = "Only direct byte buffers are supported";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  coder::MemoryByteInput input(std::move(source));
+  return gifToJxl(env, input, quality, effort, decodingSpeed, javaCompressionOption);
 }
 
 extern "C"
 JNIEXPORT jbyteArray JNICALL
-Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLImpl(JNIEnv *env,
-                                               jobject thiz,
-                                               jbyteArray apngData,
-                                               jint quality,
-                                               jint effort,
-                                               jint decodingSpeed) {
+Java_com_awxkee_jxlcoder_JxlCoder_gif2JXLFdImpl(JNIEnv *env, jobject thiz, jint fd,
+                                                jint quality, jint effort, jint decodingSpeed,
+                                                jint javaCompressionOption) {
+  if (!checkGifOptions(env, quality, effort, javaCompressionOption)) {
+    return nullptr;
+  }
   try {
-    if (effort < 0 || effort > 10) {
-      throwInvalidCompressionOptionException(env);
-      return 0;
-    }
+    auto input = openFileDescriptorInput(fd);
+    return gifToJxl(env, *input, quality, effort, decodingSpeed, javaCompressionOption);
+  } catch (std::runtime_error &err) {
+    std::string errorString = "Error: " + std::string(err.what());
+    throwException(env, errorString);
+    return nullptr;
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
 
-    if (quality < 0 || quality > 100) {
-      std::string exc = "Quality must be in 0...100";
-      throwException(env, exc);
-      return 0;
-    }
-    auto totalLength = env->GetArrayLength(apngData);
-    if (totalLength <= 0) {
-      std::string errorString = "Invalid input array length";
-      throwException(env, errorString);
-      return nullptr;
-    }
-    std::vector<uint8_t> srcBuffer(totalLength);
-    env->GetByteArrayRegion(apngData, 0, totalLength, reinterpret_cast<jbyte *>(srcBuffer.data()));
+// libpng reports errors by longjmp, so every call that may fail runs in a frame owning
+// nothing with a destructor and the caller turns the failure into a C++ error
+static bool readApngHeader(png_structp png, png_infop info, coder::ByteInput &input) {
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  coder::AttachPngInput(png, input);
+  png_read_info(png, info);
+  png_set_expand(png);
+  png_set_strip_16(png);
+  png_set_gray_to_rgb(png);
+  // Canvas is always RGBA so one compositor serves every PNG
+  png_set_add_alpha(png, 0xff, PNG_FILLER_AFTER);
+  (void) png_set_interlace_handling(png);
+  png_read_update_info(png, info);
+  return true;
+}
+
+struct ApngFrameControl {
+  png_uint_32 width;
+  png_uint_32 height;
+  png_uint_32 x;
+  png_uint_32 y;
+  unsigned short delayNum;
+  unsigned short delayDen;
+  unsigned char disposeOp;
+  unsigned char blendOp;
+};
+
+static bool readApngFrameHead(png_structp png, png_infop info, ApngFrameControl &fcTL) {
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  png_read_frame_head(png, info);
+  png_get_next_frame_fcTL(png, info, &fcTL.width, &fcTL.height, &fcTL.x, &fcTL.y,
+                          &fcTL.delayNum, &fcTL.delayDen, &fcTL.disposeOp, &fcTL.blendOp);
+  return true;
+}
+
+static bool readApngImage(png_structp png, png_bytepp rows) {
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  png_read_image(png, rows);
+  return true;
+}
+
+static bool readApngEnd(png_structp png, png_infop info) {
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  png_read_end(png, info);
+  return true;
+}
 
+static jbyteArray apngToJxl(JNIEnv *env, coder::ByteInput &input, jint quality, jint effort, jint decodingSpeed) {
+  try {
     png_structp mPngPtr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if (!mPngPtr) {
       std::string errorString = "Cannot initialize libpng";
@@ -245,33 +257,18 @@ Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLImpl(JNIEnv *env,
       return nullptr;
     }
 
-    if (setjmp(png_jmpbuf(pngPtr.get()))) {
+    if (!readApngHeader(pngPtr.get(), infoPtr, input)) {
       std::string errorString = "Reading APNG has failed";
       throwException(env, errorString);
       return nullptr;
     }
 
-    png_set_read_fn(pngPtr.get(), static_cast<png_voidp>(&srcBuffer), [](png_structp png, png_bytep data, png_size_t length) {
-      auto &buffer = *static_cast<std::vector<uint8_t> *>(png_get_io_ptr(png));
-      if (buffer.size() >= length) {
-        std::copy(buffer.begin(), buffer.begin() + length, data);
-        buffer.erase(buffer.begin(), buffer.begin() + length);
-      }
-    });
-
-//    png_set_sig_bytes(pngPtr.get(), 8);
-    png_read_info(pngPtr.get(), infoPtr);
-    png_set_expand(pngPtr.get());
-    png_set_strip_16(pngPtr.get());
-    png_set_gray_to_rgb(pngPtr.get());
-//    png_set_add_alpha(pngPtr.get(), 0xff, PNG_FILLER_AFTER);
-//    png_set_bgr(pngPtr.get());
-    (void) png_set_interlace_handling(pngPtr.get());
-    png_read_update_info(pngPtr.get(), infoPtr);
-    const int width = png_get_image_width(pngPtr.get(), infoPtr);
-    const int height = png_get_image_height(pngPtr.get(), infoPtr);
-    const int channels = png_get_channels(pngPtr.get(), infoPtr);
-    const int rowbytes = png_get_rowbytes(pngPtr.get(), infoPtr);
+    // Transforms don't touch the source color type and tRNS validity
+    const png_byte colorType = png_get_color_type(pngPtr.get(), infoPtr);
+    const bool hasAlpha = (colorType & PNG_COLOR_MASK_ALPHA) || png_get_valid(pngPtr.get(), infoPtr, PNG_INFO_tRNS);
+    const uint32_t width = png_get_image_width(pngPtr.get(), infoPtr);
+    const uint32_t height = png_get_image_height(pngPtr.get(), infoPtr);
+    const uint32_t stride = width * 4;
 
     png_bytep iccpData = nullptr;
     png_uint_32 iccpLength = 0;
@@ -286,10 +283,11 @@ Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLImpl(JNIEnv *env,
       }
     }
 
-    const size_t frameSize = rowbytes * height;
+    const size_t frameSize = static_cast<size_t>(stride) * height;
     std::vector<uint8_t> mFrame(frameSize);
     std::vector<uint8_t> mImage(frameSize);
-    std::vector<uint8_t> mTempImage(frameSize);
+    // Only the rect of a DISPOSE_OP_PREVIOUS frame is kept for restoring
+    std::vector<uint8_t> mSavedRect;
 
     png_uint_32 frames = 1;
     png_uint_32 repeatCount = 0;
@@ -297,7 +295,7 @@ Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLImpl(JNIEnv *env,
     if (png_get_valid(pngPtr.get(), infoPtr, PNG_INFO_acTL))
       png_get_acTL(pngPtr.get(), infoPtr, &frames, &repeatCount);
 
-    JxlColorPixelType colorPixelType = channels > 3 ? rgba : rgb;
+    JxlColorPixelType colorPixelType = hasAlpha ? rgba : rgb;
 
     JxlAnimatedEncoder encoder(width, height, colorPixelType,
                                UNSIGNED_8,
@@ -310,72 +308,92 @@ Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLImpl(JNIEnv *env,
       encoder.setICCProfile(iccProfile);
     }
 
-    png_uint_32 w0 = width;
-    png_uint_32 h0 = height;
-    png_uint_32 x0 = 0;
-    png_uint_32 y0 = 0;
-    unsigned short delay_num = 1;
-    unsigned short delay_den = 10;
-    unsigned char dop = 0;
-    unsigned char bop = 0;
-
-    std::vector<png_bytep> rowsFrame(height * sizeof(png_bytep));
-    std::vector<png_bytep> rowsImage(height * sizeof(png_bytep));
+    ApngFrameControl fcTL = {width, height, 0, 0, 1, 10, 0, 0};
+    coder::FrameRect disposedRect = {};
 
-    for (int j = 0; j < height; j++)
-      rowsFrame[j] = reinterpret_cast<uint8_t *>(mFrame.data()) + j * rowbytes;
+    std::vector<png_bytep> rowsFrame(height);
+    for (uint32_t j = 0; j < height; j++)
+      rowsFrame[j] = mFrame.data() + j * stride;
 
-    for (int j = 0; j < height; j++)
-      rowsImage[j] = reinterpret_cast<uint8_t *>(mImage.data()) + j * rowbytes;
-
-    for (int i = 0; i < frames; i++) {
+    for (png_uint_32 i = 0; i < frames; i++) {
       if (png_get_valid(pngPtr.get(), infoPtr, PNG_INFO_acTL)) {
-        png_read_frame_head(pngPtr.get(), infoPtr);
-        png_get_next_frame_fcTL(pngPtr.get(), infoPtr, &w0,
-                                &h0, &x0,
-                                &y0, &delay_num, &delay_den, &dop, &bop);
+        if (!readApngFrameHead(pngPtr.get(), infoPtr, fcTL)) {
+          throw AnimatedEncoderError("Reading APNG frame header has failed");
+        }
         if (i == 0) {
-          bop = PNG_BLEND_OP_SOURCE;
-          if (dop == PNG_DISPOSE_OP_PREVIOUS)
-            dop = PNG_DISPOSE_OP_BACKGROUND;
+          fcTL.blendOp = PNG_BLEND_OP_SOURCE;
+          if (fcTL.disposeOp == PNG_DISPOSE_OP_PREVIOUS)
+            fcTL.disposeOp = PNG_DISPOSE_OP_BACKGROUND;
         }
       }
-      png_read_image(pngPtr.get(), rowsFrame.data());
-
-      if (dop == PNG_DISPOSE_OP_PREVIOUS)
-        std::copy(mImage.begin(), mImage.end(), mTempImage.begin());
+      if (!readApngImage(pngPtr.get(), rowsFrame.data())) {
+        throw AnimatedEncoderError("Reading APNG frame has failed");
+      }
+      const png_uint_32 w0 = fcTL.width;
+      const png_uint_32 h0 = fcTL.height;
+      const png_uint_32 x0 = fcTL.x;
+      const png_uint_32 y0 = fcTL.y;
+      const unsigned short delay_num = fcTL.delayNum;
+      const unsigned short delay_den = fcTL.delayDen;
+      const unsigned char dop = fcTL.disposeOp;
+      const unsigned char bop = fcTL.blendOp;
+
+      uint8_t *canvasRect = mImage.data() + y0 * stride + x0 * 4;
+      if (dop == PNG_DISPOSE_OP_PREVIOUS) {
+        mSavedRect.resize(static_cast<size_t>(w0) * h0 * 4);
+        coder::ReplaceRgba8(canvasRect, stride, mSavedRect.data(), w0 * 4, w0, h0);
+      }
 
       if (bop == PNG_BLEND_OP_OVER) {
-        BlendOverAPNG(rowsImage.data(), rowsFrame.data(), x0, y0, w0, h0);
+        coder::BlendOverRgba8(mFrame.data(), stride, canvasRect, stride, w0, h0);
       } else {
-        for (int j = 0; j < h0; j++)
-          memcpy(rowsImage[j + y0] + x0 * 4, rowsFrame[j], w0 * 4);
+        coder::ReplaceRgba8(mFrame.data(), stride, canvasRect, stride, w0, h0);
       }
 
-      const int frameDuration = std::roundf(static_cast<float>(delay_num) / static_cast<float>(delay_den) * 1000.f);
-      encoder.addFrame(mImage, frameDuration);
+      const int frameDuration = delay_den == 0
+                                ? delay_num * 10
+                                : static_cast<int>(std::roundf(static_cast<float>(delay_num) / static_cast<float>(delay_den) * 1000.f));
+      // Only the frame rect and the one disposed before it may differ from the previous frame
+      const coder::FrameRect frameRect = {x0, y0, w0, h0};
+      coder::FrameRect changed = frameRect;
+      if (disposedRect.width && disposedRect.height) {
+        const uint32_t cx0 = std::min(changed.x, disposedRect.x);
+        const uint32_t cy0 = std::min(changed.y, disposedRect.y);
+        const uint32_t cx1 = std::max(changed.x + changed.width, disposedRect.x + disposedRect.width);
+        const uint32_t cy1 = std::max(changed.y + changed.height, disposedRect.y + disposedRect.height);
+        changed = {cx0, cy0, cx1 - cx0, cy1 - cy0};
+      }
 
-      if (dop == PNG_DISPOSE_OP_PREVIOUS)
-        std::copy(mTempImage.begin(), mTempImage.end(), mImage.begin());
-      else if (dop == PNG_DISPOSE_OP_BACKGROUND) {
-        for (int j = 0; j < h0; j++)
-          memset(rowsImage[j + y0] + x0 * 4, 0, w0 * 4);
+      // The canvas keeps composing the next frame, the encoder gets its own copy
+      std::vector<uint8_t> canvasCopy = encoder.acquireFrameBuffer();
+      if (hasAlpha) {
+        std::copy(mImage.begin(), mImage.end(), canvasCopy.begin());
+      } else {
+        coder::Rgba8ToRgb8(mImage.data(), stride, canvasCopy.data(), width * 3, width, height);
+      }
+      encoder.addFrame(std::move(canvasCopy), frameDuration, changed);
+
+      disposedRect = {};
+      if (dop == PNG_DISPOSE_OP_PREVIOUS) {
+        coder::ReplaceRgba8(mSavedRect.data(), w0 * 4, canvasRect, stride, w0, h0);
+        disposedRect = frameRect;
+      } else if (dop == PNG_DISPOSE_OP_BACKGROUND) {
+        coder::ClearRgba8(canvasRect, stride, w0, h0);
+        disposedRect = frameRect;
       }
     }
 
-    png_read_end(pngPtr.get(), infoPtr);
+    if (!readApngEnd(pngPtr.get(), infoPtr)) {
+      throw AnimatedEncoderError("Reading APNG has failed");
+    }
 
-    mTempImage.resize(0);
+    mSavedRect.resize(0);
     mFrame.resize(0);
     mImage.resize(0);
 
-    std::vector<uint8_t> buffer;
-    encoder.encode(buffer);
-    jbyteArray byteArray = env->NewByteArray((jsize) buffer.size());
-    char *memBuf = reinterpret_cast<char *>(buffer.data());
-    env->SetByteArrayRegion(byteArray, 0, (jint) buffer.size(), reinterpret_cast<const jbyte *>(memBuf));
-    buffer.clear();
-    return byteArray;
+    coder::JxlChunkListSink output;
+    encoder.encode(output);
+    return chunkListToByteArray(env, output);
   } catch (std::bad_alloc &err) {
     std::string errorString = "Not enough memory to encode this image";
     throwException(env, errorString);
@@ -385,4 +403,242 @@ Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLImpl(JNIEnv *env,
     throwException(env, errorString);
     return nullptr;
   }
-}
\ No newline at end of file
+}
+
+static bool checkApngOptions(JNIEnv *env, jint quality, jint effort) {
+  if (effort < 0 || effort > 10) {
+    throwInvalidCompressionOptionException(env);
+    return false;
+  }
+  if (quality < 0 || quality > 100) {
+    std::string exc = "Quality must be in 0...100";
+    throwException(env, exc);
+    return false;
+  }
+  return true;
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLImpl(JNIEnv *env,
+                                               jobject thiz,
+                                               jbyteArray apngData,
+                                               jint quality,
+                                               jint effort,
+                                               jint decodingSpeed) {
+  if (!checkApngOptions(env, quality, effort)) {
+    return nullptr;
+  }
+  if (env->GetArrayLength(apngData) <= 0) {
+    std::string errorString = "Invalid input array length";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  try {
+    coder::MemoryByteInput input(copyByteArray(env, apngData));
+    return apngToJxl(env, input, quality, effort, decodingSpeed);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLBufferImpl(JNIEnv *env,
+                                                     jobject thiz,
+                                                     jobject apngBuffer,
+                                                     jint quality,
+                                                     jint effort,
+                                                     jint decodingSpeed) {
+  if (!checkApngOptions(env, quality, effort)) {
+    return nullptr;
+  }
+  auto source = borrowDirectByteBuffer(env, apngBuffer);
+  if (!source) {
+    std::string errorString = "Only direct byte buffers are supported";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  coder::MemoryByteInput input(std::move(source));
+  return apngToJxl(env, input, quality, effort, decodingSpeed);
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_apng2JXLFdImpl(JNIEnv *env,
+                                                 jobject thiz,
+                                                 jint fd,
+                                                 jint quality,
+                                                 jint effort,
+                                                 jint decodingSpeed) {
+  if (!checkApngOptions(env, quality, effort)) {
+    return nullptr;
+  }
+  try {
+    auto input = openFileDescriptorInput(fd);
+    return apngToJxl(env, *input, quality, effort, decodingSpeed);
+  } catch (std::runtime_error &err) {
+    std::string errorString = "Error: " + std::string(err.what());
+    throwException(env, errorString);
+    return nullptr;
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+/**
+ * Still PNG straight into the encoder, rows are decoded only when the encoder pulls them
+ */
+static jbyteArray pngToJxl(JNIEnv *env, coder::ByteInput &input, JxlCompressionOption compressionOption,
+                           jint effort, jint quality, jint qualityMapping, jint decodingSpeed,
+                           jobject javaInstrumentation) {
+  coder::JxlPngChunkedInput pngInput(input);
+  if (!pngInput.readHeader()) {
+    std::string errorString = "Reading PNG has failed";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  const JxlColorPixelType colorspace = pngInput.getColorspace();
+  JxlColorEncoding colorEncoding = {};
+  // Without iCCP the PNG is taken as sRGB
+  JxlColorEncodingSetToSRGB(&colorEncoding, colorspace == mono || colorspace == monoAlpha);
+  const float distance = JxlQualityToDistance(quality, static_cast<JxlQualityMapping>(qualityMapping));
+
+  coder::JxlInstrumentation instrumentation;
+  coder::JxlInstrumentation *instrumentationPtr = javaInstrumentation ? &instrumentation : nullptr;
+  coder::JxlChunkListSink output;
+  if (!EncodeJxlChunked(pngInput, pngInput.getWidth(), pngInput.getHeight(), output, colorspace,
+                        compressionOption, pngInput.getIccProfile(), effort, distance, decodingSpeed,
+                        colorEncoding, true, 0, nullptr, instrumentationPtr)) {
+    if (pngInput.hasFailed()) {
+      std::string errorString = "Reading PNG rows has failed";
+      throwException(env, errorString);
+    } else {
+      throwCantCompressImage(env);
+    }
+    return nullptr;
+  }
+
+  coder::JxlStageTimer outputTimer(instrumentationPtr, coder::STAGE_OUTPUT);
+  jbyteArray data = chunkListToByteArray(env, output);
+  outputTimer.stop();
+  if (!data) {
+    return nullptr;
+  }
+  instrumentation.addAllocated(output.getAllocatedSize() + output.getSize());
+  publishInstrumentation(env, javaInstrumentation, instrumentation);
+  return data;
+}
+
+static bool checkPngOptions(JNIEnv *env, jint javaCompressionOption, jint quality, jint effort,
+                            jint qualityMapping) {
+  auto compressionOption = static_cast<JxlCompressionOption>(javaCompressionOption);
+  if (compressionOption != lossy && compressionOption != loseless) {
+    throwInvalidCompressionOptionException(env);
+    return false;
+  }
+  if (effort < 0 || effort > 10 || (qualityMapping != QUALITY_CODER && qualityMapping != QUALITY_LIBJXL)) {
+    throwInvalidCompressionOptionException(env);
+    return false;
+  }
+  if (quality < 0 || quality > 100) {
+    std::string exc = "Quality must be in 0...100";
+    throwException(env, exc);
+    return false;
+  }
+  return true;
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_png2JXLImpl(JNIEnv *env,
+                                              jobject thiz,
+                                              jbyteArray pngData,
+                                              jint javaCompressionOption,
+                                              jint effort,
+                                              jint quality,
+                                              jint qualityMapping,
+                                              jint decodingSpeed,
+                                              jobject javaInstrumentation) {
+  if (!checkPngOptions(env, javaCompressionOption, quality, effort, qualityMapping)) {
+    return nullptr;
+  }
+  if (env->GetArrayLength(pngData) <= 0) {
+    std::string errorString = "Invalid input array length";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  try {
+    coder::MemoryByteInput input(copyByteArray(env, pngData));
+    return pngToJxl(env, input, static_cast<JxlCompressionOption>(javaCompressionOption), effort, quality,
+                    qualityMapping, decodingSpeed, javaInstrumentation);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_png2JXLBufferImpl(JNIEnv *env,
+                                                    jobject thiz,
+                                                    jobject pngBuffer,
+                                                    jint javaCompressionOption,
+                                                    jint effort,
+                                                    jint quality,
+                                                    jint qualityMapping,
+                                                    jint decodingSpeed,
+                                                    jobject javaInstrumentation) {
+  if (!checkPngOptions(env, javaCompressionOption, quality, effort, qualityMapping)) {
+    return nullptr;
+  }
+  auto source = borrowDirectByteBuffer(env, pngBuffer);
+  if (!source) {
+    std::string errorString = "Only direct byte buffers are supported";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  try {
+    coder::MemoryByteInput input(std::move(source));
+    return pngToJxl(env, input, static_cast<JxlCompressionOption>(javaCompressionOption), effort, quality,
+                    qualityMapping, decodingSpeed, javaInstrumentation);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_png2JXLFdImpl(JNIEnv *env,
+                                                jobject thiz,
+                                                jint fd,
+                                                jint javaCompressionOption,
+                                                jint effort,
+                                                jint quality,
+                                                jint qualityMapping,
+                                                jint decodingSpeed,
+                                                jobject javaInstrumentation) {
+  if (!checkPngOptions(env, javaCompressionOption, quality, effort, qualityMapping)) {
+    return nullptr;
+  }
+  try {
+    auto input = openFileDescriptorInput(fd);
+    return pngToJxl(env, *input, static_cast<JxlCompressionOption>(javaCompressionOption), effort, quality,
+                    qualityMapping, decodingSpeed, javaInstrumentation);
+  } catch (std::runtime_error &err) {
+    std::string errorString = "Error: " + std::string(err.what());
+    throwException(env, errorString);
+    return nullptr;
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
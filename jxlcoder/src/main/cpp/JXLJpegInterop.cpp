@@ -31,33 +31,78 @@
 #include <jni.h>
 #include <vector>
 #include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include "JniExceptions.h"
 #include "interop/JxlConstruction.hpp"
 #include "interop/JxlReconstruction.hpp"
+#include "interop/JxlBatchConstruction.h"
+#include "ByteSources.h"
 
-extern "C"
-JNIEXPORT jbyteArray JNICALL
-Java_com_awxkee_jxlcoder_JxlCoder_constructImpl(JNIEnv *env, jobject thiz, jbyteArray fromJpegData) {
-  try {
-    auto totalLength = env->GetArrayLength(fromJpegData);
-    if (totalLength <= 0) {
+static bool checkConstructionOptions(JNIEnv *env, jint effort, jint decodingSpeed) {
+  if (effort < 1 || effort > 10 || decodingSpeed < 0 || decodingSpeed > 4) {
+    throwInvalidCompressionOptionException(env);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * JPEG from exactly one of the array, the direct buffer or the file descriptor, only the array is copied
+ */
+static std::shared_ptr<coder::ByteSource> openJpegSource(JNIEnv *env, jbyteArray jpegData, jobject jpegBuffer,
+                                                         jint jpegFd) {
+  if (jpegData) {
+    if (env->GetArrayLength(jpegData) <= 0) {
       std::string errorString = "Invalid input array length";
       throwException(env, errorString);
       return nullptr;
     }
-    std::vector<uint8_t> srcBuffer(totalLength);
-    env->GetByteArrayRegion(fromJpegData, 0, totalLength, reinterpret_cast<jbyte *>(srcBuffer.data()));
-    coder::JxlConstruction construction(srcBuffer);
-    if (!construction.construct()) {
-      std::string errorString = "Cannot construct JPEG XL from provided JPEG data";
+    return copyByteArray(env, jpegData);
+  }
+  if (jpegBuffer) {
+    auto source = borrowDirectByteBuffer(env, jpegBuffer);
+    if (!source) {
+      std::string errorString = "Only direct byte buffers are supported";
       throwException(env, errorString);
+    }
+    return source;
+  }
+  try {
+    return mapFileDescriptor(jpegFd);
+  } catch (std::runtime_error &err) {
+    std::string errorString = "Error: " + std::string(err.what());
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+static jbyteArray constructToArray(JNIEnv *env, coder::JxlConstruction &construction,
+                                   const coder::ByteSource &source) {
+  coder::JxlChunkListSink output;
+  if (!construction.construct(source.data(), source.size(), output)) {
+    std::string errorString = "Cannot construct JPEG XL from provided JPEG data";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  return chunkListToByteArray(env, output);
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_constructImpl(JNIEnv *env, jobject thiz, jbyteArray fromJpegData,
+                                                jint effort, jint decodingSpeed) {
+  if (!checkConstructionOptions(env, effort, decodingSpeed)) {
+    return nullptr;
+  }
+  try {
+    auto source = openJpegSource(env, fromJpegData, nullptr, -1);
+    if (!source) {
       return nullptr;
     }
-    std::vector<uint8_t> constructedJpegXL = construction.getCompressedData();
-    jbyteArray byteArray = env->NewByteArray(static_cast<jint>(constructedJpegXL.size()));
-    env->SetByteArrayRegion(byteArray, 0, static_cast<jint>(constructedJpegXL.size()),
-                            reinterpret_cast<const jbyte *>(constructedJpegXL.data()));
-    return byteArray;
+    coder::JxlConstruction construction(effort, decodingSpeed);
+    return constructToArray(env, construction, *source);
   } catch (std::bad_alloc &err) {
     std::string errorString = "Not enough memory to construct this image";
     throwException(env, errorString);
@@ -65,6 +110,196 @@ Java_com_awxkee_jxlcoder_JxlCoder_constructImpl(JNIEnv *env, jobject thiz, jbyte
   }
 }
 
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_awxkee_jxlcoder_JxlJpegRecompressor_createRecompressor(JNIEnv *env, jobject thiz,
+                                                                jint effort, jint decodingSpeed,
+                                                                jint workerThreads) {
+  if (!checkConstructionOptions(env, effort, decodingSpeed)) {
+    return -1;
+  }
+  if (workerThreads < 0) {
+    std::string errorString = "Worker threads must not be negative";
+    throwException(env, errorString);
+    return -1;
+  }
+  try {
+    auto construction = new coder::JxlConstruction(effort, decodingSpeed, static_cast<size_t>(workerThreads));
+    return reinterpret_cast<jlong>(construction);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to create the recompressor";
+    throwException(env, errorString);
+    return -1;
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_awxkee_jxlcoder_JxlJpegRecompressor_releaseRecompressor([[maybe_unused]] JNIEnv *env,
+                                                                 [[maybe_unused]] jobject thiz, jlong ptr) {
+  delete reinterpret_cast<coder::JxlConstruction *>(ptr);
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlJpegRecompressor_recompressImpl(JNIEnv *env, jobject thiz, jlong ptr,
+                                                            jbyteArray jpegData, jobject jpegBuffer,
+                                                            jint jpegFd) {
+  try {
+    auto source = openJpegSource(env, jpegData, jpegBuffer, jpegFd);
+    if (!source) {
+      return nullptr;
+    }
+    return constructToArray(env, *reinterpret_cast<coder::JxlConstruction *>(ptr), *source);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to construct this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_awxkee_jxlcoder_JxlJpegRecompressor_recompressToOutputImpl(JNIEnv *env, jobject thiz, jlong ptr,
+                                                                    jbyteArray jpegData, jobject jpegBuffer,
+                                                                    jint jpegFd, jint outputFd,
+                                                                    jobject outputBuffer) {
+  try {
+    std::unique_ptr<coder::JxlOutputSink> output;
+    if (outputBuffer) {
+      output = directByteBufferSink(env, outputBuffer);
+      if (!output) {
+        std::string errorString = "Only direct byte buffers are supported";
+        throwException(env, errorString);
+        return -1;
+      }
+    } else {
+      output = std::make_unique<coder::JxlFdSink>(outputFd);
+    }
+    auto source = openJpegSource(env, jpegData, jpegBuffer, jpegFd);
+    if (!source) {
+      return -1;
+    }
+    auto construction = reinterpret_cast<coder::JxlConstruction *>(ptr);
+    if (!construction->construct(source->data(), source->size(), *output)) {
+      std::string errorString = output->hasFailed()
+                                ? "Encoded image cannot be written into the output, it is too small or not writable"
+                                : "Cannot construct JPEG XL from provided JPEG data";
+      throwException(env, errorString);
+      return -1;
+    }
+    output->finish();
+    return static_cast<jlong>(output->getSize());
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to construct this image";
+    throwException(env, errorString);
+    return -1;
+  }
+}
+
+static std::vector<std::string> toStringVector(JNIEnv *env, jobjectArray array) {
+  std::vector<std::string> strings;
+  if (!array) {
+    return strings;
+  }
+  const jsize length = env->GetArrayLength(array);
+  strings.reserve(length);
+  for (jsize i = 0; i < length; ++i) {
+    auto string = reinterpret_cast<jstring>(env->GetObjectArrayElement(array, i));
+    const char *chars = string ? env->GetStringUTFChars(string, nullptr) : nullptr;
+    strings.emplace_back(chars ? chars : "");
+    if (chars) {
+      env->ReleaseStringUTFChars(string, chars);
+    }
+    env->DeleteLocalRef(string);
+  }
+  return strings;
+}
+
+static std::vector<jint> toIntVector(JNIEnv *env, jintArray array) {
+  std::vector<jint> values;
+  if (!array) {
+    return values;
+  }
+  values.resize(env->GetArrayLength(array));
+  env->GetIntArrayRegion(array, 0, static_cast<jsize>(values.size()), values.data());
+  return values;
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_recompressBatchImpl(JNIEnv *env, jobject thiz,
+                                                      jobjectArray inputPaths, jobjectArray outputPaths,
+                                                      jintArray inputFds, jintArray outputFds,
+                                                      jint effort, jint decodingSpeed, jint parallelFiles) {
+  if (!checkConstructionOptions(env, effort, decodingSpeed)) {
+    return nullptr;
+  }
+  try {
+    // Either paths or descriptors are given, both lists of the same size
+    std::vector<std::string> inputs = toStringVector(env, inputPaths);
+    std::vector<std::string> outputs = toStringVector(env, outputPaths);
+    std::vector<jint> inputDescriptors = toIntVector(env, inputFds);
+    std::vector<jint> outputDescriptors = toIntVector(env, outputFds);
+    const size_t count = inputPaths ? inputs.size() : inputDescriptors.size();
+    if ((inputPaths ? outputs.size() : outputDescriptors.size()) != count || parallelFiles < 0) {
+      std::string errorString = "Inputs and outputs must be of the same size";
+      throwException(env, errorString);
+      return nullptr;
+    }
+
+    std::vector<coder::JxlConstructionJob> jobs(count);
+    for (size_t i = 0; i < count; ++i) {
+      if (inputPaths) {
+        jobs[i].inputPath = std::move(inputs[i]);
+        jobs[i].outputPath = std::move(outputs[i]);
+      } else {
+        jobs[i].inputFd = inputDescriptors[i];
+        jobs[i].outputFd = outputDescriptors[i];
+      }
+    }
+
+    std::vector<coder::JxlConstructionResult> results;
+    coder::JxlBatchConstructionStats stats = coder::ConstructJxlBatch(jobs, effort, decodingSpeed,
+                                                                      static_cast<size_t>(parallelFiles),
+                                                                      results);
+
+    std::vector<jint> statuses(count);
+    std::vector<jlong> outputSizes(count);
+    for (size_t i = 0; i < count; ++i) {
+      statuses[i] = static_cast<jint>(results[i].status);
+      outputSizes[i] = static_cast<jlong>(results[i].outputSize);
+    }
+    // Failed Java allocations and lookups leave their exception pending for the caller
+    jintArray javaStatuses = env->NewIntArray(static_cast<jsize>(count));
+    if (!javaStatuses) {
+      return nullptr;
+    }
+    jlongArray javaSizes = env->NewLongArray(static_cast<jsize>(count));
+    if (!javaSizes) {
+      return nullptr;
+    }
+    env->SetIntArrayRegion(javaStatuses, 0, static_cast<jsize>(count), statuses.data());
+    env->SetLongArrayRegion(javaSizes, 0, static_cast<jsize>(count), outputSizes.data());
+
+    jclass reportClass = env->FindClass("com/awxkee/jxlcoder/JxlRecompressionReport");
+    if (!reportClass) {
+      return nullptr;
+    }
+    jmethodID methodID = env->GetMethodID(reportClass, "<init>", "([I[JJJJ)V");
+    if (!methodID) {
+      return nullptr;
+    }
+    return env->NewObject(reportClass, methodID, javaStatuses, javaSizes,
+                          static_cast<jlong>(stats.inputBytes), static_cast<jlong>(stats.outputBytes),
+                          static_cast<jlong>(stats.elapsedNanos));
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to construct these images";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
 extern "C"
 JNIEXPORT jbyteArray JNICALL
 Java_com_awxkee_jxlcoder_JxlCoder_reconstructImpl(JNIEnv *env, jobject thiz, jbyteArray fromJpegXlData) {
@@ -41,11 +41,14 @@
 #include "hwy/highway.h"
 #include "imagebit/CopyUnalignedRGBA.h"
 #include "NativeColorSpace.h"
+#include "JniInstrumentation.h"
+#include "jxl/resizable_parallel_runner.h"
 
 jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jint scaledWidth,
                                jint scaledHeight,
                                jint javaPreferredColorConfig,
-                               jint javaScaleMode, jint javaResizeFilter) {
+                               jint javaScaleMode, jint javaResizeFilter,
+                               coder::JxlInstrumentation *instrumentation) {
   ScaleMode scaleMode;
   PreferredColorConfig preferredColorConfig;
   XSampler sampler;
@@ -67,6 +70,7 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
   bool hasAlphaInOrigin = true;
   float intensityTarget = 255.f;
   try {
+    coder::JxlStageTimer decodeTimer(instrumentation, coder::STAGE_DECODE);
     if (!DecodeJpegXlOneShot(reinterpret_cast<uint8_t *>(imageData.data()), imageData.size(),
                              &rgbaPixels,
                              &xsize, &ysize,
@@ -92,6 +96,12 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
     return nullptr;
   }
 
+  if (instrumentation) {
+    // Same count the decoder gives to its runner
+    instrumentation->setThreads(static_cast<uint32_t>(JxlResizableParallelRunnerSuggestThreads(xsize, ysize)));
+    instrumentation->addAllocated(rgbaPixels.size());
+  }
+
   if (jxlOrientation == JXL_ORIENT_ROTATE_90_CW || jxlOrientation == JXL_ORIENT_ROTATE_90_CCW ||
       jxlOrientation == JXL_ORIENT_ANTI_TRANSPOSE || jxlOrientation == JXL_ORIENT_TRANSPOSE) {
     size_t xz = xsize;
@@ -102,6 +112,7 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
   imageData.clear();
 
   if (!iccProfile.empty()) {
+    coder::JxlStageTimer colorTimer(instrumentation, coder::STAGE_COLOR);
     size_t stride =
         (size_t) xsize * 4 * (size_t) (useBitmapFloats ? sizeof(uint16_t) : sizeof(uint8_t));
     convertUseDefinedColorSpace(rgbaPixels,
@@ -122,6 +133,7 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
       * static_cast<uint32_t >(useBitmapFloats ? sizeof(uint16_t) : sizeof(uint8_t));
 
   if (useSampler) {
+    coder::JxlStageTimer scaleTimer(instrumentation, coder::STAGE_SCALE);
     auto scaleResult = RescaleImage(rgbaPixels, env, &stride, useBitmapFloats,
                                     reinterpret_cast<uint32_t *>(&finalWidth),
                                     reinterpret_cast<uint32_t *>(&finalHeight),
@@ -133,6 +145,9 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
     if (!scaleResult) {
       return nullptr;
     }
+    if (instrumentation) {
+      instrumentation->addAllocated(rgbaPixels.size());
+    }
   }
 
   bool toneMap = true;
@@ -144,6 +159,7 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
       colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA ||
       colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB)
       && colorEncoding.color_space == JXL_COLOR_SPACE_RGB && osVersion < 34) {
+    coder::JxlStageTimer colorTimer(instrumentation, coder::STAGE_COLOR);
     Eigen::Matrix3f sourceProfile;
     TransferFunction transferFunction = TransferFunction::Srgb;
     if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG) {
@@ -227,6 +243,7 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
     }
   }
 
+  coder::JxlStageTimer bitmapTimer(instrumentation, coder::STAGE_BITMAP);
   std::string bitmapPixelConfig = useBitmapFloats ? "RGBA_F16" : "ARGB_8888";
   jobject hwBuffer = nullptr;
   ReformatColorConfig(env, rgbaPixels, bitmapPixelConfig, preferredColorConfig, bitDepth,
@@ -325,6 +342,10 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
     return static_cast<jobject>(nullptr);
   }
 
+  if (instrumentation) {
+    instrumentation->addAllocated(static_cast<uint64_t>(info.stride) * info.height);
+  }
+
   rgbaPixels.clear();
 
   return bitmapObj;
@@ -337,15 +358,25 @@ Java_com_awxkee_jxlcoder_JxlCoder_decodeSampledImpl(JNIEnv *env, jobject thiz,
                                                     jint scaledHeight,
                                                     jint javaPreferredColorConfig,
                                                     jint javaScaleMode,
-                                                    jint resizeSampler) {
+                                                    jint resizeSampler,
+                                                    jobject javaInstrumentation) {
   try {
+    coder::JxlInstrumentation instrumentation;
+    coder::JxlInstrumentation *instrumentationPtr = javaInstrumentation ? &instrumentation : nullptr;
+    coder::JxlStageTimer inputTimer(instrumentationPtr, coder::STAGE_INPUT);
     auto totalLength = env->GetArrayLength(byte_array);
     std::vector<uint8_t> srcBuffer(totalLength);
     env->GetByteArrayRegion(byte_array, 0, totalLength,
                             reinterpret_cast<jbyte *>(srcBuffer.data()));
-    return decodeSampledImageImpl(env, srcBuffer, scaledWidth, scaledHeight,
-                                  javaPreferredColorConfig, javaScaleMode,
-                                  resizeSampler);
+    inputTimer.stop();
+    instrumentation.addAllocated(srcBuffer.size());
+    jobject bitmap = decodeSampledImageImpl(env, srcBuffer, scaledWidth, scaledHeight,
+                                            javaPreferredColorConfig, javaScaleMode,
+                                            resizeSampler, instrumentationPtr);
+    if (bitmap) {
+      publishInstrumentation(env, javaInstrumentation, instrumentation);
+    }
+    return bitmap;
   } catch (std::bad_alloc &err) {
     std::string errorString = "Not enough memory to decode this image";
     throwException(env, errorString);
@@ -365,8 +396,11 @@ Java_com_awxkee_jxlcoder_JxlCoder_decodeByteBufferSampledImpl(JNIEnv *env, jobje
                                                               jint scaledHeight,
                                                               jint preferredColorConfig,
                                                               jint scaleMode,
-                                                              jint resizeSampler) {
+                                                              jint resizeSampler,
+                                                              jobject javaInstrumentation) {
   try {
+    coder::JxlInstrumentation instrumentation;
+    coder::JxlInstrumentation *instrumentationPtr = javaInstrumentation ? &instrumentation : nullptr;
     auto bufferAddress = reinterpret_cast<uint8_t *>(env->GetDirectBufferAddress(byteBuffer));
     int length = (int) env->GetDirectBufferCapacity(byteBuffer);
     if (!bufferAddress || length <= 0) {
@@ -374,11 +408,18 @@ Java_com_awxkee_jxlcoder_JxlCoder_decodeByteBufferSampledImpl(JNIEnv *env, jobje
       throwException(env, errorString);
       return nullptr;
     }
+    coder::JxlStageTimer inputTimer(instrumentationPtr, coder::STAGE_INPUT);
     std::vector<uint8_t> srcBuffer(length);
     std::copy(bufferAddress, bufferAddress + length, srcBuffer.begin());
-    return decodeSampledImageImpl(env, srcBuffer, scaledWidth, scaledHeight,
-                                  preferredColorConfig, scaleMode,
-                                  resizeSampler);
+    inputTimer.stop();
+    instrumentation.addAllocated(srcBuffer.size());
+    jobject bitmap = decodeSampledImageImpl(env, srcBuffer, scaledWidth, scaledHeight,
+                                            preferredColorConfig, scaleMode,
+                                            resizeSampler, instrumentationPtr);
+    if (bitmap) {
+      publishInstrumentation(env, javaInstrumentation, instrumentation);
+    }
+    return bitmap;
   } catch (std::bad_alloc &err) {
     std::string errorString = "Not enough memory to decode this image";
     throwException(env, errorString);
@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JniInstrumentation.h"
+#include <array>
+
+void publishInstrumentation(JNIEnv *env, jobject target, const coder::JxlInstrumentation &instrumentation) {
+  if (!target) {
+    return;
+  }
+  std::array<jlong, coder::STAGE_COUNT> stageNanos = {};
+  for (int i = 0; i < coder::STAGE_COUNT; ++i) {
+    stageNanos[i] = static_cast<jlong>(instrumentation.getStageNanos(static_cast<coder::JxlPipelineStage>(i)));
+  }
+  jlongArray stages = env->NewLongArray(coder::STAGE_COUNT);
+  if (!stages) {
+    return;
+  }
+  env->SetLongArrayRegion(stages, 0, coder::STAGE_COUNT, stageNanos.data());
+
+  jlongArray encoderStats = nullptr;
+  if (instrumentation.hasEncoderStats()) {
+    std::array<jlong, JXL_ENC_NUM_STATS> stats = {};
+    for (int i = 0; i < JXL_ENC_NUM_STATS; ++i) {
+      stats[i] = static_cast<jlong>(instrumentation.getEncoderStat(static_cast<JxlEncoderStatsKey>(i)));
+    }
+    encoderStats = env->NewLongArray(JXL_ENC_NUM_STATS);
+    if (!encoderStats) {
+      return;
+    }
+    env->SetLongArrayRegion(encoderStats, 0, JXL_ENC_NUM_STATS, stats.data());
+  }
+
+  jclass targetClass = env->GetObjectClass(target);
+  jmethodID methodID = env->GetMethodID(targetClass, "update", "([JJI[J)V");
+  env->CallVoidMethod(target, methodID, stages, static_cast<jlong>(instrumentation.getAllocatedBytes()),
+                      static_cast<jint>(instrumentation.getThreads()), encoderStats);
+}
@@ -38,10 +38,69 @@
 #include "hwy/highway.h"
 #include "colorspaces/ColorSpaceProfile.h"
 #include "imagebit/CopyUnalignedRGBA.h"
+#include "imagebit/RGBAlpha.h"
 #include "NativeColorSpace.h"
+#include "ByteSources.h"
+#include "JniInstrumentation.h"
 
 using namespace std;
 
+/**
+ * HDR frames are kept in 16 bits only when they may be presented as F16 or 1010102 bitmaps
+ */
+static bool allowsHighBitDepth(PreferredColorConfig preferredColorConfig) {
+  return androidOSVersion() >= 26 && preferredColorConfig != Rgba_8888 && preferredColorConfig != Rgb_565;
+}
+
+coder::JxlLayerCompositor &JxlAnimatedDecoderCoordinator::composeFrame(uint32_t at, coder::JxlDirtyRect &dirty) {
+  if (!compositor) {
+    compositor = std::make_unique<coder::JxlLayerCompositor>(decoder->getWidth(), decoder->getHeight(),
+                                                             decoder->isAlphaAttenuated());
+  }
+  if (at < nextComposedFrame) {
+    decoder->rewindLayers();
+    compositor->reset();
+    nextComposedFrame = 0;
+  }
+  const bool isSequential = at == nextComposedFrame;
+  while (nextComposedFrame <= at) {
+    for (;;) {
+      if (!decoder->nextLayer(layer)) {
+        decoder->rewindLayers();
+        compositor->reset();
+        nextComposedFrame = 0;
+        std::string str = "Requested frame index more than frames in the container";
+        throw AnimatedDecoderError(str);
+      }
+      compositor->compose(layer, dirty);
+      if (layer.durationTicks != 0 || layer.isLast) {
+        break;
+      }
+    }
+    nextComposedFrame += 1;
+  }
+  if (!isSequential) {
+    dirty.add(0, 0, compositor->getWidth(), compositor->getHeight());
+  }
+  return *compositor;
+}
+
+bool JxlAnimatedDecoderCoordinator::swapRenderTarget(JNIEnv *env, jobject target) {
+  if (renderTarget && env->IsSameObject(renderTarget, target)) {
+    return true;
+  }
+  releaseRenderTarget(env);
+  renderTarget = env->NewWeakGlobalRef(target);
+  return false;
+}
+
+void JxlAnimatedDecoderCoordinator::releaseRenderTarget(JNIEnv *env) {
+  if (renderTarget) {
+    env->DeleteWeakGlobalRef(renderTarget);
+    renderTarget = nullptr;
+  }
+}
+
 extern "C"
 JNIEXPORT jlong JNICALL
 Java_com_awxkee_jxlcoder_JxlAnimatedImage_createCoordinator(JNIEnv *env, jobject thiz,
@@ -65,16 +124,14 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_createCoordinator(JNIEnv *env, jobject
 //        return 0;
 //    }
   try {
-    auto bufferAddress = reinterpret_cast<uint8_t *>(env->GetDirectBufferAddress(byteBuffer));
-    int length = (int) env->GetDirectBufferCapacity(byteBuffer);
-    if (!bufferAddress || length <= 0) {
+    // Buffer is borrowed for the whole life of the decoder instead of being copied
+    auto source = borrowDirectByteBuffer(env, byteBuffer);
+    if (!source) {
       std::string errorString = "Only direct byte buffers are supported";
       throwException(env, errorString);
       return 0;
     }
-    vector<uint8_t> srcBuffer(length);
-    copy(bufferAddress, bufferAddress + length, srcBuffer.begin());
-    auto decoder = new JxlAnimatedDecoder(srcBuffer);
+    auto decoder = new JxlAnimatedDecoder(source, allowsHighBitDepth(preferredColorConfig));
     auto coordinator = new JxlAnimatedDecoderCoordinator(
         decoder, scaleMode, preferredColorConfig, sampler
     );
@@ -106,11 +163,7 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_createCoordinatorByteArray(JNIEnv *env
   }
 
   try {
-    auto length = env->GetArrayLength(byteArray);
-    vector<uint8_t> srcBuffer(length);
-    env->GetByteArrayRegion(byteArray, 0, length,
-                            reinterpret_cast<jbyte *>(srcBuffer.data()));
-    auto decoder = new JxlAnimatedDecoder(srcBuffer);
+    auto decoder = new JxlAnimatedDecoder(copyByteArray(env, byteArray), allowsHighBitDepth(preferredColorConfig));
     auto coordinator = new JxlAnimatedDecoderCoordinator(
         decoder, scaleMode, preferredColorConfig, sampler
     );
@@ -126,11 +179,48 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_createCoordinatorByteArray(JNIEnv *env
   }
 }
 
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_awxkee_jxlcoder_JxlAnimatedImage_createCoordinatorFd(JNIEnv *env, jobject thiz,
+                                                              jint fd,
+                                                              jint javaPreferredColorConfig,
+                                                              jint javaScaleMode,
+                                                              jint javaJxlResizeSampler) {
+  ScaleMode scaleMode;
+  PreferredColorConfig preferredColorConfig;
+  XSampler sampler;
+  if (!checkDecodePreconditions(env, javaPreferredColorConfig, &preferredColorConfig,
+                                javaScaleMode, &scaleMode, javaJxlResizeSampler, &sampler)) {
+    return 0;
+  }
+
+  try {
+    auto decoder = new JxlAnimatedDecoder(mapFileDescriptor(fd), allowsHighBitDepth(preferredColorConfig));
+    auto coordinator = new JxlAnimatedDecoderCoordinator(
+        decoder, scaleMode, preferredColorConfig, sampler
+    );
+    return reinterpret_cast<jlong >(coordinator);
+  } catch (AnimatedDecoderError &err) {
+    std::string errorString = err.what();
+    throwException(env, errorString);
+    return 0;
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "OOM: " + string(err.what());
+    throwException(env, errorString);
+    return 0;
+  } catch (std::runtime_error &err) {
+    std::string errorString = "Error: " + string(err.what());
+    throwException(env, errorString);
+    return 0;
+  }
+}
+
 extern "C"
 JNIEXPORT void JNICALL
 Java_com_awxkee_jxlcoder_JxlAnimatedImage_closeAndReleaseAnimatedImage(JNIEnv *env, jobject thiz,
                                                                        jlong coordinatorPtr) {
   auto coordinator = reinterpret_cast<JxlAnimatedDecoderCoordinator *>(coordinatorPtr);
+  coordinator->releaseRenderTarget(env);
   delete coordinator;
 }
 
@@ -142,6 +232,30 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getNumberOfFrames(JNIEnv *env, jobject
   return coordinator->numberOfFrames();
 }
 
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_awxkee_jxlcoder_JxlAnimatedImage_getKnownNumberOfFrames(JNIEnv *env, jobject thiz,
+                                                                 jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlAnimatedDecoderCoordinator *>(coordinatorPtr);
+  return coordinator->knownNumberOfFrames();
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_awxkee_jxlcoder_JxlAnimatedImage_isNumberOfFramesFinalImpl(JNIEnv *env, jobject thiz,
+                                                                    jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlAnimatedDecoderCoordinator *>(coordinatorPtr);
+  return coordinator->isNumberOfFramesFinal() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_awxkee_jxlcoder_JxlAnimatedImage_isStreamCompleteImpl(JNIEnv *env, jobject thiz,
+                                                               jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlAnimatedDecoderCoordinator *>(coordinatorPtr);
+  return coordinator->isStreamComplete() ? JNI_TRUE : JNI_FALSE;
+}
+
 extern "C"
 JNIEXPORT jint JNICALL
 Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameDurationImpl(JNIEnv *env, jobject thiz,
@@ -157,20 +271,192 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getLoopsCount(JNIEnv *env, jobject thi
   auto coordinator = reinterpret_cast<JxlAnimatedDecoderCoordinator *>(coordinatorPtr);
   return coordinator->loopsCount();
 }
+/**
+ * Converts HDR and non sRGB transfer functions into sRGB when the OS cannot present them itself
+ */
+static void applyFrameColorMatrix(uint8_t *data, uint32_t stride, uint32_t width, uint32_t height,
+                                  uint32_t bitDepth, float intensityTarget,
+                                  const JxlColorEncoding &colorEncoding) {
+  if ((colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709 ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB)
+      && colorEncoding.color_space == JXL_COLOR_SPACE_RGB) {
+    Eigen::Matrix3f sourceProfile;
+    TransferFunction transferFunction = TransferFunction::Srgb;
+    bool tonemap = true;
+    bool useChromaticAdaptation = false;
+    float gamma = 2.2f;
+    if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG) {
+      transferFunction = TransferFunction::Hlg;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI) {
+      tonemap = false;
+      transferFunction = TransferFunction::Smpte428;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ) {
+      transferFunction = TransferFunction::Pq;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA) {
+      tonemap = false;
+      // Make real gamma
+      transferFunction = TransferFunction::Gamma2p2;
+      gamma = 1.f / colorEncoding.gamma;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709) {
+      tonemap = false;
+      transferFunction = TransferFunction::Itur709;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB) {
+      tonemap = false;
+      transferFunction = TransferFunction::Srgb;
+    }
+
+    Eigen::Matrix<float, 3, 2> primaries;
+    Eigen::Vector2f whitePoint;
+
+    if (colorEncoding.primaries == JXL_PRIMARIES_2100) {
+      sourceProfile = GamutRgbToXYZ(getRec2020Primaries(), getIlluminantD65());
+      primaries << getRec2020Primaries();
+      whitePoint << getIlluminantD65();
+    } else if (colorEncoding.primaries == JXL_PRIMARIES_P3) {
+      sourceProfile = GamutRgbToXYZ(getDisplayP3Primaries(), getIlluminantD65());
+      primaries << getDisplayP3Primaries();
+      whitePoint << getIlluminantD65();
+    } else if (colorEncoding.primaries == JXL_PRIMARIES_SRGB) {
+      sourceProfile = GamutRgbToXYZ(getSRGBPrimaries(), getIlluminantD65());
+      primaries << getSRGBPrimaries();
+      whitePoint << getIlluminantD65();
+    } else {
+      primaries << static_cast<float>(colorEncoding.primaries_red_xy[0]),
+          static_cast<float>(colorEncoding.primaries_red_xy[1]),
+          static_cast<float>(colorEncoding.primaries_green_xy[0]),
+          static_cast<float>(colorEncoding.primaries_green_xy[1]),
+          static_cast<float>(colorEncoding.primaries_blue_xy[0]),
+          static_cast<float>(colorEncoding.primaries_blue_xy[1]);
+      whitePoint << static_cast<float>(colorEncoding.white_point_xy[0]),
+          static_cast<float>(colorEncoding.white_point_xy[1]);
+      if (whitePoint != getIlluminantD65()) {
+        useChromaticAdaptation = true;
+      }
+      sourceProfile = GamutRgbToXYZ(primaries, whitePoint);
+    }
+
+    Eigen::Matrix3f dstProfile = GamutRgbToXYZ(getRec709Primaries(), getIlluminantD65());
+    Eigen::Matrix3f conversion = dstProfile.inverse() * sourceProfile;
+
+    ITURColorCoefficients coeffs = colorPrimariesComputeYCoeffs(primaries, whitePoint);
+
+    const float matrix[9] = {
+        conversion(0, 0), conversion(0, 1), conversion(0, 2),
+        conversion(1, 0), conversion(1, 1), conversion(1, 2),
+        conversion(2, 0), conversion(2, 1), conversion(2, 2),
+    };
+
+    if (bitDepth > 8) {
+      applyColorMatrix16Bit(reinterpret_cast<uint16_t *>(data),
+                            stride,
+                            width, height,
+                            bitDepth,
+                            matrix,
+                            transferFunction,
+                            TransferFunction::Srgb,
+                            tonemap,
+                            coeffs,
+                            intensityTarget);
+    } else {
+      applyColorMatrix(data,
+                       stride,
+                       width,
+                       height,
+                       matrix,
+                       transferFunction,
+                       TransferFunction::Srgb,
+                       tonemap,
+                       coeffs, intensityTarget);
+    }
+  }
+}
+
+static jobject getFrameColorSpace(JNIEnv *env, const JxlColorEncoding &colorEncoding) {
+  if (colorEncoding.primaries == JXL_PRIMARIES_2100 && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ) {
+    return colorspace::getJNIColorSpace(env, NativeColorSpace::Pq2100);
+  } else if (colorEncoding.primaries == JXL_PRIMARIES_2100 && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG) {
+    return colorspace::getJNIColorSpace(env, NativeColorSpace::Hlg2100);
+  } else if (colorEncoding.primaries == JXL_PRIMARIES_P3 && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB) {
+    return colorspace::getJNIColorSpace(env, NativeColorSpace::DisplayP3);
+  } else if (colorEncoding.primaries == JXL_PRIMARIES_SRGB && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_LINEAR) {
+    return colorspace::getJNIColorSpace(env, NativeColorSpace::LinearSrgb);
+  } else if (colorEncoding.primaries == JXL_PRIMARIES_P3 && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI) {
+    return colorspace::getJNIColorSpace(env, NativeColorSpace::DciP3);
+  } else if (colorEncoding.primaries == JXL_PRIMARIES_SRGB && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709) {
+    return colorspace::getJNIColorSpace(env, NativeColorSpace::Hlg2100);
+  } else {
+    return colorspace::getJNIColorSpace(env, NativeColorSpace::DefaultSrgb);
+  }
+}
+
+/**
+ * Caller supplied bitmap is reused only when it is mutable and exactly matches the frame, otherwise a new one is created
+ */
+static bool canReuseBitmap(JNIEnv *env, jobject bitmap, const std::string &bitmapPixelConfig,
+                           uint32_t width, uint32_t height) {
+  if (!bitmap || bitmapPixelConfig == "HARDWARE") {
+    return false;
+  }
+  AndroidBitmapInfo info;
+  if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
+    return false;
+  }
+  if (info.width != width || info.height != height) {
+    return false;
+  }
+  int32_t requiredFormat;
+  if (bitmapPixelConfig == "RGBA_F16") {
+    requiredFormat = ANDROID_BITMAP_FORMAT_RGBA_F16;
+  } else if (bitmapPixelConfig == "RGB_565") {
+    requiredFormat = ANDROID_BITMAP_FORMAT_RGB_565;
+  } else if (bitmapPixelConfig == "RGBA_1010102") {
+    requiredFormat = ANDROID_BITMAP_FORMAT_RGBA_1010102;
+  } else {
+    requiredFormat = ANDROID_BITMAP_FORMAT_RGBA_8888;
+  }
+  if (info.format != requiredFormat) {
+    return false;
+  }
+  jclass bitmapClass = env->GetObjectClass(bitmap);
+  jmethodID isMutableMethodID = env->GetMethodID(bitmapClass, "isMutable", "()Z");
+  return env->CallBooleanMethod(bitmap, isMutableMethodID);
+}
+
 extern "C"
 JNIEXPORT jobject JNICALL
 Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz,
                                                        jlong coordinatorPtr, jint frameIndex,
-                                                       jint scaleWidth, jint scaleHeight) {
+                                                       jint scaleWidth, jint scaleHeight,
+                                                       jobject reuseBitmap, jobject javaInstrumentation) {
   try {
     auto coordinator = reinterpret_cast<JxlAnimatedDecoderCoordinator *>(coordinatorPtr);
 
-    JxlFrame frame = coordinator->getFrame(frameIndex);
-    vector<uint8_t> iccProfile = frame.iccProfile;
-    vector<uint8_t> rgbaPixels = frame.pixels;
-    // Currently always in 8bpp;
-    bool useFloat16 = false;
-    const uint32_t bitDepth = 8;
+    std::lock_guard guard(coordinator->getFrameLock());
+
+    coder::JxlInstrumentation instrumentation;
+    coder::JxlInstrumentation *instrumentationPtr = javaInstrumentation ? &instrumentation : nullptr;
+    const size_t buffersCapacity = coordinator->getBuffersCapacity();
+    // Frame buffers are owned by the coordinator, only their growth counts as allocated by this call
+    const auto countBuffersGrowth = [&]() {
+      const size_t capacity = coordinator->getBuffersCapacity();
+      if (capacity > buffersCapacity) {
+        instrumentation.addAllocated(capacity - buffersCapacity);
+      }
+    };
+
+    coder::JxlStageTimer decodeTimer(instrumentationPtr, coder::STAGE_DECODE);
+    JxlFrame &frame = coordinator->decodeFrame(frameIndex);
+    decodeTimer.stop();
+    const vector<uint8_t> &iccProfile = frame.iccProfile;
+    // Points to the buffer currently holding the frame, all of them are owned by coordinator and reused
+    vector<uint8_t> *workingBuffer = &frame.pixels;
+    // HDR frames are decoded into 16 bits and kept there until the final bitmap config is chosen
+    const uint32_t bitDepth = frame.bitDepth;
+    bool useFloat16 = bitDepth > 8;
     const bool alphaPremultiplied = coordinator->isAlphaAttenuated();
 
     auto preferEncoding = frame.preferColorEncoding;
@@ -180,98 +466,23 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz
 
     uint32_t stride = coordinator->getWidth() * 4 * static_cast<uint32_t>(useFloat16 ? sizeof(uint16_t) : sizeof(uint8_t));
 
-    if (preferEncoding && (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ ||
-        colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG ||
-        colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI ||
-        colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709 ||
-        colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA ||
-        colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB)
-        && colorEncoding.color_space == JXL_COLOR_SPACE_RGB && osVersion < 34) {
-      Eigen::Matrix3f sourceProfile;
-      TransferFunction transferFunction = TransferFunction::Srgb;
-      bool tonemap = true;
-      bool useChromaticAdaptation = false;
-      float gamma = 2.2f;
-      if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG) {
-        transferFunction = TransferFunction::Hlg;
-      } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI) {
-        tonemap = false;
-        transferFunction = TransferFunction::Smpte428;
-      } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ) {
-        transferFunction = TransferFunction::Pq;
-      } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA) {
-        tonemap = false;
-        // Make real gamma
-        transferFunction = TransferFunction::Gamma2p2;
-        gamma = 1.f / colorEncoding.gamma;
-      } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709) {
-        tonemap = false;
-        transferFunction = TransferFunction::Itur709;
-      } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB) {
-        tonemap = false;
-        transferFunction = TransferFunction::Srgb;
-      }
-
-      Eigen::Matrix<float, 3, 2> primaries;
-      Eigen::Vector2f whitePoint;
-
-      if (colorEncoding.primaries == JXL_PRIMARIES_2100) {
-        sourceProfile = GamutRgbToXYZ(getRec2020Primaries(), getIlluminantD65());
-        primaries << getRec2020Primaries();
-        whitePoint << getIlluminantD65();
-      } else if (colorEncoding.primaries == JXL_PRIMARIES_P3) {
-        sourceProfile = GamutRgbToXYZ(getDisplayP3Primaries(), getIlluminantD65());
-        primaries << getDisplayP3Primaries();
-        whitePoint << getIlluminantD65();
-      } else if (colorEncoding.primaries == JXL_PRIMARIES_SRGB) {
-        sourceProfile = GamutRgbToXYZ(getSRGBPrimaries(), getIlluminantD65());
-        primaries << getSRGBPrimaries();
-        whitePoint << getIlluminantD65();
-      } else {
-        primaries << static_cast<float>(colorEncoding.primaries_red_xy[0]),
-            static_cast<float>(colorEncoding.primaries_red_xy[1]),
-            static_cast<float>(colorEncoding.primaries_green_xy[0]),
-            static_cast<float>(colorEncoding.primaries_green_xy[1]),
-            static_cast<float>(colorEncoding.primaries_blue_xy[0]),
-            static_cast<float>(colorEncoding.primaries_blue_xy[1]);
-        whitePoint << static_cast<float>(colorEncoding.white_point_xy[0]),
-            static_cast<float>(colorEncoding.white_point_xy[1]);
-        if (whitePoint != getIlluminantD65()) {
-          useChromaticAdaptation = true;
-        }
-        sourceProfile = GamutRgbToXYZ(primaries, whitePoint);
-      }
-
-      Eigen::Matrix3f dstProfile = GamutRgbToXYZ(getRec709Primaries(), getIlluminantD65());
-      Eigen::Matrix3f conversion = dstProfile.inverse() * sourceProfile;
-
-      ITURColorCoefficients coeffs = colorPrimariesComputeYCoeffs(primaries, whitePoint);
-
-      const float matrix[9] = {
-          conversion(0, 0), conversion(0, 1), conversion(0, 2),
-          conversion(1, 0), conversion(1, 1), conversion(1, 2),
-          conversion(2, 0), conversion(2, 1), conversion(2, 2),
-      };
-
-      applyColorMatrix(reinterpret_cast<uint8_t *>(rgbaPixels.data()),
-                       stride,
-                       (uint32_t) coordinator->getWidth(),
-                       (uint32_t) coordinator->getHeight(),
-                       matrix,
-                       transferFunction,
-                       TransferFunction::Srgb,
-                       tonemap,
-                       coeffs, 255.);
+    coder::JxlStageTimer colorTimer(instrumentationPtr, coder::STAGE_COLOR);
+    if (preferEncoding && osVersion < 34) {
+      applyFrameColorMatrix(workingBuffer->data(), stride,
+                            (uint32_t) coordinator->getWidth(),
+                            (uint32_t) coordinator->getHeight(),
+                            bitDepth, frame.intensityTarget,
+                            colorEncoding);
     }
 
     if (!iccProfile.empty() && !frame.preferColorEncoding) {
-      convertUseDefinedColorSpace(rgbaPixels,
-                                  stride,
-                                  (uint32_t) coordinator->getWidth(),
-                                  (uint32_t) coordinator->getHeight(), iccProfile.data(),
-                                  iccProfile.size(),
-                                  useFloat16);
+      coordinator->getColorSpaceTransform(iccProfile, useFloat16)->transformInPlace(workingBuffer->data(),
+                                                                                  stride,
+                                                                                  (uint32_t) coordinator->getWidth(),
+                                                                                  (uint32_t) coordinator->getHeight());
     }
+    colorTimer.stop();
+
     uint32_t scaledWidth = scaleWidth;
     uint32_t scaledHeight = scaleHeight;
     bool useSampler = (scaledWidth > 0 || scaledHeight > 0) && (scaledWidth != 0 && scaledHeight != 0);
@@ -280,42 +491,33 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz
     uint32_t finalHeight = coordinator->getHeight();
 
     if (useSampler && scaledHeight > 0 && scaledWidth > 0) {
-      auto scaleResult = RescaleImage(rgbaPixels, env, &stride, useFloat16,
+      coder::JxlStageTimer scaleTimer(instrumentationPtr, coder::STAGE_SCALE);
+      auto scaleResult = RescaleImage(*workingBuffer, coordinator->getScaleBuffer(), env, &stride, useFloat16,
                                       reinterpret_cast<uint32_t *>(&finalWidth),
                                       reinterpret_cast<uint32_t *>(&finalHeight),
-                                      scaledWidth, scaledHeight, alphaPremultiplied,
-                                      bitDepth,
+                                      scaledWidth, scaledHeight,
+                                      bitDepth, alphaPremultiplied,
                                       coordinator->getScaleMode(),
                                       coordinator->getSampler(), frame.hasAlphaInOrigin);
       if (!scaleResult) {
         return nullptr;
       }
+      workingBuffer = &coordinator->getScaleBuffer();
     }
 
+    coder::JxlStageTimer bitmapTimer(instrumentationPtr, coder::STAGE_BITMAP);
     std::string bitmapPixelConfig = useFloat16 ? "RGBA_F16" : "ARGB_8888";
     jobject hwBuffer = nullptr;
-    ReformatColorConfig(env, rgbaPixels, bitmapPixelConfig,
-                        coordinator->getPreferredColorConfig(), 8,
+    ReformatColorConfig(env, *workingBuffer, bitmapPixelConfig,
+                        coordinator->getPreferredColorConfig(), bitDepth,
                         finalWidth, finalHeight, &stride, &useFloat16,
-                        &hwBuffer, alphaPremultiplied, frame.hasAlphaInOrigin);
+                        &hwBuffer, alphaPremultiplied, frame.hasAlphaInOrigin,
+                        coordinator->getReformatBuffer());
+    const vector<uint8_t> &rgbaPixels = *workingBuffer;
 
     jobject colorSpace = nullptr;
     if (androidOSVersion() >= 34) {
-      if (colorEncoding.primaries == JXL_PRIMARIES_2100 && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ) {
-        colorSpace = colorspace::getJNIColorSpace(env, NativeColorSpace::Pq2100);
-      } else if (colorEncoding.primaries == JXL_PRIMARIES_2100 && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG) {
-        colorSpace = colorspace::getJNIColorSpace(env, NativeColorSpace::Hlg2100);
-      } else if (colorEncoding.primaries == JXL_PRIMARIES_P3 && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB) {
-        colorSpace = colorspace::getJNIColorSpace(env, NativeColorSpace::DisplayP3);
-      } else if (colorEncoding.primaries == JXL_PRIMARIES_SRGB && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_LINEAR) {
-        colorSpace = colorspace::getJNIColorSpace(env, NativeColorSpace::LinearSrgb);
-      } else if (colorEncoding.primaries == JXL_PRIMARIES_P3 && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI) {
-        colorSpace = colorspace::getJNIColorSpace(env, NativeColorSpace::DciP3);
-      } else if (colorEncoding.primaries == JXL_PRIMARIES_SRGB && colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709) {
-        colorSpace = colorspace::getJNIColorSpace(env, NativeColorSpace::Hlg2100);
-      } else {
-        colorSpace = colorspace::getJNIColorSpace(env, NativeColorSpace::DefaultSrgb);
-      }
+      colorSpace = getFrameColorSpace(env, colorEncoding);
     }
 
     if (bitmapPixelConfig == "HARDWARE") {
@@ -326,18 +528,29 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz
       jobject bitmapObj = env->CallStaticObjectMethod(bitmapClass,
                                                       createBitmapMethodID,
                                                       hwBuffer, colorSpace);
+      bitmapTimer.stop();
+      countBuffersGrowth();
+      publishInstrumentation(env, javaInstrumentation, instrumentation);
       return bitmapObj;
     }
 
-    jclass bitmapConfig = env->FindClass("android/graphics/Bitmap$Config");
-    jfieldID rgba8888FieldID = env->GetStaticFieldID(bitmapConfig,
-                                                     bitmapPixelConfig.c_str(),
-                                                     "Landroid/graphics/Bitmap$Config;");
-    jobject rgba8888Obj = env->GetStaticObjectField(bitmapConfig, rgba8888FieldID);
-
-    jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
     jobject bitmapObj;
-    if (androidOSVersion() >= 34 && colorSpace) {
+    const bool reusesBitmap = canReuseBitmap(env, reuseBitmap, bitmapPixelConfig, finalWidth, finalHeight);
+    if (reusesBitmap) {
+      bitmapObj = reuseBitmap;
+      if (colorSpace) {
+        jclass bitmapClass = env->GetObjectClass(reuseBitmap);
+        jmethodID setColorSpaceMethodID = env->GetMethodID(bitmapClass, "setColorSpace",
+                                                           "(Landroid/graphics/ColorSpace;)V");
+        env->CallVoidMethod(reuseBitmap, setColorSpaceMethodID, colorSpace);
+      }
+    } else if (androidOSVersion() >= 34 && colorSpace) {
+      jclass bitmapConfig = env->FindClass("android/graphics/Bitmap$Config");
+      jfieldID rgba8888FieldID = env->GetStaticFieldID(bitmapConfig,
+                                                       bitmapPixelConfig.c_str(),
+                                                       "Landroid/graphics/Bitmap$Config;");
+      jobject rgba8888Obj = env->GetStaticObjectField(bitmapConfig, rgba8888FieldID);
+      jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
       jmethodID createBitmapMethodID = env->GetStaticMethodID(bitmapClass,
                                                               "createBitmap",
                                                               "(IILandroid/graphics/Bitmap$Config;ZLandroid/graphics/ColorSpace;)Landroid/graphics/Bitmap;");
@@ -346,6 +559,12 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz
                                               static_cast<jint>(finalHeight),
                                               rgba8888Obj, true, colorSpace);
     } else {
+      jclass bitmapConfig = env->FindClass("android/graphics/Bitmap$Config");
+      jfieldID rgba8888FieldID = env->GetStaticFieldID(bitmapConfig,
+                                                       bitmapPixelConfig.c_str(),
+                                                       "Landroid/graphics/Bitmap$Config;");
+      jobject rgba8888Obj = env->GetStaticObjectField(bitmapConfig, rgba8888FieldID);
+      jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
       jmethodID createBitmapMethodID = env->GetStaticMethodID(bitmapClass,
                                                               "createBitmap",
                                                               "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;");
@@ -391,8 +610,12 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz
       return static_cast<jobject>(nullptr);
     }
 
-    rgbaPixels.clear();
-
+    bitmapTimer.stop();
+    countBuffersGrowth();
+    if (!reusesBitmap) {
+      instrumentation.addAllocated(static_cast<uint64_t>(info.stride) * info.height);
+    }
+    publishInstrumentation(env, javaInstrumentation, instrumentation);
     return bitmapObj;
   } catch (std::bad_alloc &err) {
     std::string errorString = "OOM: " + string(err.what());
@@ -409,6 +632,99 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz
   }
 }
 
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_awxkee_jxlcoder_JxlAnimatedImage_renderFrameImpl(JNIEnv *env, jobject thiz,
+                                                          jlong coordinatorPtr, jint frameIndex,
+                                                          jobject target, jobject dirtyRect) {
+  try {
+    auto coordinator = reinterpret_cast<JxlAnimatedDecoderCoordinator *>(coordinatorPtr);
+
+    std::lock_guard guard(coordinator->getFrameLock());
+
+    AndroidBitmapInfo info;
+    if (AndroidBitmap_getInfo(env, target, &info) < 0) {
+      throwPixelsException(env);
+      return;
+    }
+
+    if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888
+        || info.width != coordinator->getWidth() || info.height != coordinator->getHeight()) {
+      std::string errorString = "Render target must be ARGB_8888 bitmap with the size of the animation";
+      throwException(env, errorString);
+      return;
+    }
+
+    coder::JxlDirtyRect dirty;
+    const bool isSameTarget = coordinator->swapRenderTarget(env, target);
+    coder::JxlLayerCompositor &compositor = coordinator->composeFrame(frameIndex, dirty);
+    if (!isSameTarget) {
+      dirty.add(0, 0, compositor.getWidth(), compositor.getHeight());
+    }
+
+    const JxlLayer &layer = coordinator->getLastLayer();
+    const bool needsPremultiplication = coordinator->hasAlpha() && !coordinator->isAlphaAttenuated();
+    const vector<uint8_t> &iccProfile = coordinator->getIccProfile();
+
+    if (!dirty.isEmpty()) {
+      void *addr;
+      if (AndroidBitmap_lockPixels(env, target, &addr) != 0) {
+        throwPixelsException(env);
+        return;
+      }
+
+      const uint32_t dstStride = info.stride;
+      auto dst = reinterpret_cast<uint8_t *>(addr) + dirty.y * dstStride + dirty.x * 4;
+      auto src = compositor.getCanvas() + dirty.y * compositor.getStride() + dirty.x * 4;
+
+      coder::CopyUnaligned(src, compositor.getStride(), dst, dstStride, dirty.width * 4, dirty.height);
+
+      // Canvas keeps decoded values as references, so color management goes on the target region only
+      if (layer.preferColorEncoding && androidOSVersion() < 34) {
+        applyFrameColorMatrix(dst, dstStride, dirty.width, dirty.height, 8, layer.intensityTarget,
+                              layer.colorEncoding);
+      }
+
+      if (!iccProfile.empty() && !layer.preferColorEncoding) {
+        coordinator->getColorSpaceTransform(iccProfile, false)->transformInPlace(dst, dstStride,
+                                                                                 dirty.width, dirty.height);
+      }
+
+      if (needsPremultiplication) {
+        coder::AssociateAlphaRgba8(dst, dstStride, dst, dstStride, dirty.width, dirty.height);
+      }
+
+      if (AndroidBitmap_unlockPixels(env, target) != 0) {
+        throwPixelsException(env);
+        return;
+      }
+    }
+
+    if (androidOSVersion() >= 34) {
+      jobject colorSpace = getFrameColorSpace(env, layer.colorEncoding);
+      jclass bitmapClass = env->GetObjectClass(target);
+      jmethodID setColorSpaceMethodID = env->GetMethodID(bitmapClass, "setColorSpace",
+                                                         "(Landroid/graphics/ColorSpace;)V");
+      env->CallVoidMethod(target, setColorSpaceMethodID, colorSpace);
+    }
+
+    jclass rectClass = env->GetObjectClass(dirtyRect);
+    env->SetIntField(dirtyRect, env->GetFieldID(rectClass, "left", "I"), static_cast<jint>(dirty.x));
+    env->SetIntField(dirtyRect, env->GetFieldID(rectClass, "top", "I"), static_cast<jint>(dirty.y));
+    env->SetIntField(dirtyRect, env->GetFieldID(rectClass, "right", "I"), static_cast<jint>(dirty.x + dirty.width));
+    env->SetIntField(dirtyRect, env->GetFieldID(rectClass, "bottom", "I"), static_cast<jint>(dirty.y + dirty.height));
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "OOM: " + string(err.what());
+    throwException(env, errorString);
+  } catch (AnimatedDecoderError &err) {
+    std::string errorString = err.what();
+    throwException(env, errorString);
+  } catch (std::runtime_error &err) {
+    std::string errorString = "Error: " + string(err.what());
+    throwException(env, errorString);
+  }
+}
+
 extern "C"
 JNIEXPORT jint JNICALL
 Java_com_awxkee_jxlcoder_JxlAnimatedImage_getHeightImpl(JNIEnv *env, jobject thiz,
@@ -30,9 +30,13 @@
 #define JXLCODER_JXLANIMATEDDECODERCOORDINATOR_H
 
 #include "interop/JxlAnimatedDecoder.hpp"
+#include "interop/JxlLayerCompositor.hpp"
 #include "SizeScaler.h"
 #include "Support.h"
+#include "colorspaces/colorspace.h"
 #include <vector>
+#include <mutex>
+#include <memory>
 
 using namespace std;
 
@@ -53,6 +57,18 @@ class JxlAnimatedDecoderCoordinator {
     return decoder->getNumberOfFrames();
   }
 
+  int knownNumberOfFrames() {
+    return decoder->getKnownNumberOfFrames();
+  }
+
+  bool isNumberOfFramesFinal() {
+    return decoder->isNumberOfFramesFinal();
+  }
+
+  bool isStreamComplete() {
+    return decoder->isStreamComplete();
+  }
+
   uint32_t frameDuration(int frame) {
     return decoder->getFrameDuration(frame);
   }
@@ -61,12 +77,72 @@ class JxlAnimatedDecoderCoordinator {
     return decoder->getLoopCount();
   }
 
-  JxlFrame getFrame(uint32_t at) {
-    return decoder->getFrame(at);
+  /**
+   * Decodes the frame into the coordinator owned frame, its buffers are allocated once and reused by every next frame.
+   * Caller must hold `getFrameLock()` while working with the returned frame and the working buffers.
+   */
+  JxlFrame &decodeFrame(uint32_t at) {
+    decoder->getFrame(static_cast<int>(at), frame);
+    return frame;
+  }
+
+  JxlFrame &decodeNextFrame() {
+    decoder->nextFrame(frame);
+    return frame;
   }
 
-  JxlFrame nextFrame() {
-    return decoder->nextFrame();
+  /**
+   * Non-coalesced playback, composites layers of the frame into the persistent canvas and extends dirty
+   * by the changed region. Sequential frames decode only their own layers, any other frame replays from the start.
+   * Caller must hold `getFrameLock()`.
+   */
+  coder::JxlLayerCompositor &composeFrame(uint32_t at, coder::JxlDirtyRect &dirty);
+
+  const JxlLayer &getLastLayer() {
+    return layer;
+  }
+
+  /**
+   * Returns true if the target is the same bitmap which received the previous composed frame,
+   * only then its content may be updated partially.
+   */
+  bool swapRenderTarget(JNIEnv *env, jobject target);
+
+  void releaseRenderTarget(JNIEnv *env);
+
+  std::mutex &getFrameLock() {
+    return frameLock;
+  }
+
+  std::vector<uint8_t> &getScaleBuffer() {
+    return scaleBuffer;
+  }
+
+  std::vector<uint8_t> &getReformatBuffer() {
+    return reformatBuffer;
+  }
+
+  /**
+   * Bytes reserved by the reusable frame buffers, buffers are swapped between each other so only the total
+   * is meaningful, its growth over a call is what the call allocated
+   */
+  size_t getBuffersCapacity() {
+    return frame.pixels.capacity() + frame.iccProfile.capacity() + scaleBuffer.capacity()
+        + reformatBuffer.capacity();
+  }
+
+  /**
+   * Transform is cached on both the profile and the sample size it was made for
+   */
+  ColorSpaceTransform *getColorSpaceTransform(const std::vector<uint8_t> &iccProfile, bool image16Bits) {
+    if (!colorSpaceTransform || colorSpaceTransform->is16Bits() != image16Bits
+        || colorSpaceTransformProfile != iccProfile) {
+      colorSpaceTransform = std::make_unique<ColorSpaceTransform>(iccProfile.data(),
+                                                                  iccProfile.size(),
+                                                                  image16Bits);
+      colorSpaceTransformProfile = iccProfile;
+    }
+    return colorSpaceTransform.get();
   }
 
   ~JxlAnimatedDecoderCoordinator() {
@@ -100,11 +176,31 @@ class JxlAnimatedDecoderCoordinator {
     return decoder->isAlphaAttenuated();
   }
 
+  bool hasAlpha() {
+    return decoder->hasAlpha();
+  }
+
+  const std::vector<uint8_t> &getIccProfile() {
+    return decoder->getIccProfile();
+  }
+
  private:
   JxlAnimatedDecoder *decoder;
   ScaleMode scaleMode;
   PreferredColorConfig preferredColorConfig;
   XSampler sampler;
+
+  std::mutex frameLock;
+  JxlFrame frame = {};
+  std::vector<uint8_t> scaleBuffer;
+  std::vector<uint8_t> reformatBuffer;
+  std::unique_ptr<ColorSpaceTransform> colorSpaceTransform;
+  std::vector<uint8_t> colorSpaceTransformProfile;
+
+  std::unique_ptr<coder::JxlLayerCompositor> compositor;
+  JxlLayer layer = {};
+  uint32_t nextComposedFrame = 0;
+  jweak renderTarget = nullptr;
 };
 
 #endif //JXLCODER_JXLANIMATEDDECODERCOORDINATOR_H
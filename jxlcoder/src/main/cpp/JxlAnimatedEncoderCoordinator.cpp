@@ -32,7 +32,9 @@
 #include "Support.h"
 #include <string>
 #include <vector>
+#include <algorithm>
 #include "JniExceptions.h"
+#include "ByteSources.h"
 #include <android/data_space.h>
 #include <android/bitmap.h>
 #include "conversion/RgbChannels.h"
@@ -66,7 +68,8 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_createEncodeCoordinator(JNIEnv *env,
                                                                     jint javaDataSpaceValue,
                                                                     jint effort,
                                                                     jint decodingSpeed,
-                                                                    jint javaDataPixelFormat) {
+                                                                    jint javaDataPixelFormat,
+                                                                    jint fd) {
   auto colorspace = static_cast<JxlColorPixelType>(javaColorSpace);
   if (!colorspace) {
     throwInvalidColorSpaceException(env);
@@ -126,6 +129,9 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_createEncodeCoordinator(JNIEnv *env,
                                                          jQuality,
                                                          colorSpaceMatrix,
                                                          dataPixelFormat);
+    if (fd >= 0) {
+      coordinator->setOutput(std::make_unique<coder::JxlFdSink>(fd));
+    }
     return reinterpret_cast<jlong >(coordinator);
   } catch (std::bad_alloc &err) {
     std::string errorString = "OOM: " + string(err.what());
@@ -183,12 +189,41 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_addFrameImpl(JNIEnv *env, jobject th
       return;
     }
 
+    JxlAnimatedEncoder *encoder = coordinator->getEncoder();
+    JxlEncodingPixelDataFormat dataPixelFormat = coordinator->getDataPixelFormat();
+    JxlColorPixelType colorPixelType = coordinator->getColorPixelType();
+    std::vector<uint8_t> rgbPixels = encoder->acquireFrameBuffer();
+
     void *addr;
     if (AndroidBitmap_lockPixels(env, bitmap, &addr) != 0) {
       throwPixelsException(env);
       return;
     }
 
+    // Bitmap layout is what the encoder takes, pixels are written straight into the recycled buffer
+    if (colorPixelType == rgba &&
+        ((info.format == ANDROID_BITMAP_FORMAT_RGBA_8888 && dataPixelFormat == UNSIGNED_8) ||
+            (info.format == ANDROID_BITMAP_FORMAT_RGBA_F16 && dataPixelFormat == BINARY_16))) {
+      if (info.format == ANDROID_BITMAP_FORMAT_RGBA_8888) {
+        const uint32_t requiredStride = info.width * 4 * sizeof(uint8_t);
+        coder::UnassociateRgba8(reinterpret_cast<const uint8_t *>(addr), info.stride,
+                                rgbPixels.data(), requiredStride,
+                                info.width, info.height);
+      } else {
+        const uint32_t requiredStride = info.width * 4 * sizeof(uint16_t);
+        coder::CopyUnaligned(reinterpret_cast<const uint16_t *>(addr), info.stride,
+                             reinterpret_cast<uint16_t *>(rgbPixels.data()), requiredStride,
+                             info.width * 4, info.height);
+      }
+      if (AndroidBitmap_unlockPixels(env, bitmap) != 0) {
+        string exc = "Unlocking pixels has failed";
+        throwException(env, exc);
+        return;
+      }
+      encoder->addFrame(std::move(rgbPixels), duration);
+      return;
+    }
+
     vector<uint8_t> rgbaPixels(info.stride * info.height);
     memcpy(rgbaPixels.data(), addr, info.stride * info.height);
 
@@ -198,7 +233,6 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_addFrameImpl(JNIEnv *env, jobject th
       return;
     }
 
-    JxlEncodingPixelDataFormat dataPixelFormat = coordinator->getDataPixelFormat();
     uint32_t imageStride = info.stride;
     if (info.format == ANDROID_BITMAP_FORMAT_RGBA_1010102) {
       if (dataPixelFormat == BINARY_16) {
@@ -271,25 +305,44 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_addFrameImpl(JNIEnv *env, jobject th
       }
     }
 
-    std::vector<uint8_t> rgbPixels;
-    JxlColorPixelType colorPixelType = coordinator->getColorPixelType();
     switch (colorPixelType) {
       case mono: {
         size_t requiredStride = (size_t) info.width * 1 *
             (size_t)(dataPixelFormat == BINARY_16 ? sizeof(uint16_t) : sizeof(uint8_t));
         rgbPixels.resize(info.height * requiredStride);
         if (dataPixelFormat == BINARY_16) {
-          coder::RGBAPickChannel(reinterpret_cast<const uint16_t *>(rgbaPixels.data()),
+          coder::RGBAToGray(reinterpret_cast<const uint16_t *>(rgbaPixels.data()),
+                            (uint32_t) imageStride,
+                            reinterpret_cast<uint16_t *>(rgbPixels.data()),
+                            (uint32_t) requiredStride,
+                            (uint32_t) info.width, (uint32_t) info.height);
+        } else {
+          coder::RGBAToGray(reinterpret_cast<const uint8_t *>(rgbaPixels.data()), static_cast<uint32_t>(imageStride),
+                            reinterpret_cast<uint8_t *>(rgbPixels.data()),
+                            static_cast<uint32_t>(requiredStride),
+                            static_cast<uint32_t>(info.width),
+                            static_cast<uint32_t>(info.height));
+        }
+        imageStride = requiredStride;
+      }
+        break;
+      case monoAlpha: {
+        size_t requiredStride = (size_t) info.width * 2 *
+            (size_t)(dataPixelFormat == BINARY_16 ? sizeof(uint16_t) : sizeof(uint8_t));
+        rgbPixels.resize(info.height * requiredStride);
+        if (dataPixelFormat == BINARY_16) {
+          coder::RGBAToGrayAlpha(reinterpret_cast<const uint16_t *>(rgbaPixels.data()),
                                  (uint32_t) imageStride,
                                  reinterpret_cast<uint16_t *>(rgbPixels.data()),
                                  (uint32_t) requiredStride,
-                                 (uint32_t) info.width, (uint32_t) info.height, 0);
+                                 (uint32_t) info.width, (uint32_t) info.height);
         } else {
-          coder::RGBAPickChannel(reinterpret_cast<const uint8_t *>(rgbaPixels.data()), static_cast<uint32_t>(imageStride),
+          coder::RGBAToGrayAlpha(reinterpret_cast<const uint8_t *>(rgbaPixels.data()),
+                                 static_cast<uint32_t>(imageStride),
                                  reinterpret_cast<uint8_t *>(rgbPixels.data()),
                                  static_cast<uint32_t>(requiredStride),
                                  static_cast<uint32_t>(info.width),
-                                 static_cast<uint32_t>(info.height), 0);
+                                 static_cast<uint32_t>(info.height));
         }
         imageStride = requiredStride;
       }
@@ -319,10 +372,10 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_addFrameImpl(JNIEnv *env, jobject th
         int requiredStride = (int) info.width * 4 *
             (int) (dataPixelFormat == BINARY_16 ? sizeof(uint16_t)
                                                 : sizeof(uint8_t));
+        rgbPixels.resize(requiredStride * (int) info.height);
         if (requiredStride == imageStride) {
-          rgbPixels = rgbaPixels;
+          std::copy_n(rgbaPixels.data(), rgbPixels.size(), rgbPixels.data());
         } else {
-          rgbPixels.resize(requiredStride * (int) info.height);
           if (dataPixelFormat == BINARY_16) {
             coder::CopyUnaligned(reinterpret_cast<uint16_t *>(rgbaPixels.data()), imageStride,
                                  reinterpret_cast<uint16_t *>(rgbPixels.data()), requiredStride,
@@ -340,8 +393,7 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_addFrameImpl(JNIEnv *env, jobject th
 
     rgbaPixels.clear();
 
-    JxlAnimatedEncoder *encoder = coordinator->getEncoder();
-    encoder->addFrame(rgbPixels, duration);
+    encoder->addFrame(std::move(rgbPixels), duration);
   } catch (std::bad_alloc &err) {
     std::string errorString = "OOM: " + string(err.what());
     throwException(env, errorString);
@@ -359,14 +411,9 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_encodeAnimatedImpl(JNIEnv *env, jobj
                                                                jlong coordinatorPtr) {
   try {
     auto coordinator = reinterpret_cast<JxlAnimatedEncoderCoordinator *>(coordinatorPtr);
-    vector<uint8_t> buffer;
-    coordinator->finish(ref(buffer));
-    jbyteArray byteArray = env->NewByteArray((jsize) buffer.size());
-    char *memBuf = (char *) ((void *) buffer.data());
-    env->SetByteArrayRegion(byteArray, 0, (jint) buffer.size(),
-                            reinterpret_cast<const jbyte *>(memBuf));
-    buffer.clear();
-    return byteArray;
+    coder::JxlChunkListSink output;
+    coordinator->finish(output);
+    return chunkListToByteArray(env, output);
   } catch (std::bad_alloc &err) {
     std::string errorString = "OOM: " + string(err.what());
     throwException(env, errorString);
@@ -376,4 +423,27 @@ Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_encodeAnimatedImpl(JNIEnv *env, jobj
     throwException(env, errorString);
     return static_cast<jbyteArray >(nullptr);
   }
-}
\ No newline at end of file
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_awxkee_jxlcoder_JxlAnimatedEncoder_finishAnimatedImpl(JNIEnv *env, jobject thiz,
+                                                               jlong coordinatorPtr) {
+  try {
+    auto coordinator = reinterpret_cast<JxlAnimatedEncoderCoordinator *>(coordinatorPtr);
+    if (!coordinator->hasOutput()) {
+      std::string errorString = "Encoder has no output to finish into";
+      throwException(env, errorString);
+      return 0;
+    }
+    return static_cast<jlong>(coordinator->finishOutput());
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "OOM: " + string(err.what());
+    throwException(env, errorString);
+    return 0;
+  } catch (AnimatedEncoderError &err) {
+    std::string errorString = err.what();
+    throwException(env, errorString);
+    return 0;
+  }
+}
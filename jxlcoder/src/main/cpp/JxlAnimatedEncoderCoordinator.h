@@ -31,6 +31,7 @@
 
 #include "interop/JxlAnimatedEncoder.hpp"
 #include <string>
+#include <memory>
 
 using namespace std;
 
@@ -73,8 +74,26 @@ class JxlAnimatedEncoderCoordinator {
     return encoder;
   }
 
-  void finish(vector<uint8_t> &dst) {
-    return encoder->encode(dst);
+  void finish(coder::JxlOutputSink &output) {
+    return encoder->encode(output);
+  }
+
+  /**
+   * Frames are streamed into the sink while they are added, the coordinator keeps it alive
+   */
+  void setOutput(std::unique_ptr<coder::JxlOutputSink> sink) {
+    encoder->setOutput(sink.get());
+    output = std::move(sink);
+  }
+
+  bool hasOutput() {
+    return output != nullptr;
+  }
+
+  uint64_t finishOutput() {
+    const uint64_t size = encoder->finish();
+    output->finish();
+    return size;
   }
 
   ~JxlAnimatedEncoderCoordinator() {
@@ -92,6 +111,7 @@ class JxlAnimatedEncoderCoordinator {
   int quality;
   JxlColorMatrix colorSpaceMatrix;
   JxlEncodingPixelDataFormat pixelDataFormat;
+  std::unique_ptr<coder::JxlOutputSink> output;
 };
 
 #endif //JXLCODER_JXLANIMATEDENCODERCOORDINATOR_H
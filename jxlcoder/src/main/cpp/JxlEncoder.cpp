@@ -30,63 +30,313 @@
 #include <string>
 #include <vector>
 #include <cinttypes>
+#include <limits>
+#include <cmath>
 #include "android/bitmap.h"
 #include <android/log.h>
 #include "JniExceptions.h"
+#include "JniInstrumentation.h"
 #include "interop/JxlEncoding.h"
+#include "interop/JxlOutputSink.h"
+#include "interop/JxlRateControl.h"
+#include "interop/JxlBatchEncoder.h"
+#include "interop/JxlYuvChunkedInput.h"
+#include "ByteSources.h"
 #include <android/data_space.h>
 #include "interop/JxlDefinitions.h"
 #include <jxl/encode.h>
 #include "colorspaces/ColorSpaceProfile.h"
 #include "conversion/RgbChannels.h"
 #include "imagebit/RGBAlpha.h"
+#include "imagebit/ScanAlpha.h"
 #include "imagebit/CopyUnalignedRGBA.h"
 #include "imagebit/Rgb565.h"
 #include "imagebit/RgbaToRgb.h"
 #include "imagebit/Rgb1010102.h"
 #include "imagebit/RgbaF16bitToNBitU16.h"
+#include "metrics/Ssimulacra2.h"
+#include "SizeScaler.h"
 
 using namespace std;
 
-extern "C"
-JNIEXPORT jbyteArray JNICALL
-Java_com_awxkee_jxlcoder_JxlCoder_encodeImpl(JNIEnv *env, jobject thiz, jobject bitmap,
-                                             jint javaColorSpace, jint javaCompressionOption,
-                                             jint effort, jstring bitmapColorProfile,
-                                             jint dataSpace, jint jQuality, jint decodingSpeed) {
+/**
+ * Resolves bitmap color space into the JXL color encoding
+ */
+static JxlColorEncoding getBitmapColorEncoding(JNIEnv *env, jstring bitmapColorProfile, jint dataSpace,
+                                               bool isImageMono) {
+  JxlColorEncoding colorEncoding = {};
+
+  if (bitmapColorProfile || dataSpace != -1) {
+    std::string stdString;
+    if (bitmapColorProfile) {
+      const char *utf8String = env->GetStringUTFChars(bitmapColorProfile, nullptr);
+      stdString = utf8String;
+      env->ReleaseStringUTFChars(bitmapColorProfile, utf8String);
+    }
+
+    if (stdString == "Rec. ITU-R BT.709-5" || dataSpace == ADataSpace::ADATASPACE_BT709) {
+      auto matrix = getRec709Primaries();
+      auto illuminant = getIlluminantD65();
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_D65,
+          .white_point_xy = {illuminant.x(), illuminant.y()},
+          .primaries = JXL_PRIMARIES_SRGB,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = JXL_TRANSFER_FUNCTION_709,
+      };
+    } else if (stdString == "Rec. ITU-R BT.2020-1" ||
+        dataSpace == ADataSpace::ADATASPACE_BT2020) {
+      auto matrix = getRec2020Primaries();
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_D65,
+          .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
+          .primaries = JXL_PRIMARIES_2100,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = JXL_TRANSFER_FUNCTION_709,
+      };
+    } else if (stdString == "Display P3" ||
+        dataSpace == ADataSpace::ADATASPACE_DISPLAY_P3) {
+      auto matrix = getDisplayP3Primaries();
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_D65,
+          .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
+          .primaries = JXL_PRIMARIES_CUSTOM,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = JXL_TRANSFER_FUNCTION_SRGB,
+          .gamma = 1 / 2.2
+      };
+    } else if (stdString == "sRGB IEC61966-2.1 (Linear)" ||
+        dataSpace == ADataSpace::ADATASPACE_SCRGB_LINEAR) {
+      auto matrix = getRec709Primaries();
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_D65,
+          .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
+          .primaries = JXL_PRIMARIES_SRGB,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = JXL_TRANSFER_FUNCTION_LINEAR
+      };
+    } else if (stdString == "Perceptual Quantizer encoding" ||
+        (dataSpace == ADataSpace::ADATASPACE_BT2020_ITU_PQ ||
+            dataSpace == ADataSpace::ADATASPACE_BT2020_HLG ||
+            dataSpace == ADataSpace::ADATASPACE_BT2020_ITU_HLG)) {
+      auto matrix = getRec2020Primaries();
+      JxlTransferFunction function = JXL_TRANSFER_FUNCTION_PQ;
+      if (dataSpace == ADataSpace::ADATASPACE_BT2020_HLG ||
+          dataSpace == ADataSpace::ADATASPACE_BT2020_ITU_HLG) {
+        function = JXL_TRANSFER_FUNCTION_HLG;
+      }
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_D65,
+          .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
+          .primaries = JXL_PRIMARIES_2100,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = function,
+      };
+    } else if (stdString == "Adobe RGB (1998)" ||
+        dataSpace == ADataSpace::ADATASPACE_ADOBE_RGB) {
+      auto matrix = getAdobeRGBPrimaries();
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_D65,
+          .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
+          .primaries = JXL_PRIMARIES_CUSTOM,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = JXL_TRANSFER_FUNCTION_GAMMA,
+          .gamma = 256.0 / 563.0
+      };
+    } else if (stdString == "SMPTE RP 431-2-2007 DCI (P3)" ||
+        dataSpace == ADataSpace::ADATASPACE_DCI_P3) {
+      auto matrix = getDCIP3Primaries();
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_D65,
+          .white_point_xy = {getIlluminantDCI().x(), getIlluminantDCI().y()},
+          .primaries = JXL_PRIMARIES_CUSTOM,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = JXL_TRANSFER_FUNCTION_SRGB,
+      };
+    } else if (dataSpace == ADataSpace::ADATASPACE_BT601_525 ||
+        dataSpace == ADataSpace::ADATASPACE_BT601_625 ||
+        dataSpace == ADataSpace::ADATASPACE_JFIF) {
+      auto matrix = getBT601_525Primaries();
+      if (dataSpace == ADataSpace::ADATASPACE_BT601_625 ||
+          dataSpace == ADataSpace::ADATASPACE_JFIF) {
+        matrix = getBT601_625Primaries();
+      }
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_D65,
+          .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
+          .primaries = JXL_PRIMARIES_CUSTOM,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = JXL_TRANSFER_FUNCTION_709
+      };
+    } else if (dataSpace == ADataSpace::STANDARD_BT470M) {
+      auto matrix = getBT470MPrimaries();
+      colorEncoding = {
+          .color_space = JXL_COLOR_SPACE_RGB,
+          .white_point = JXL_WHITE_POINT_CUSTOM,
+          .white_point_xy = {getIlluminantC().x(), getIlluminantC().y()},
+          .primaries = JXL_PRIMARIES_CUSTOM,
+          .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
+          .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
+          .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
+          .transfer_function = JXL_TRANSFER_FUNCTION_GAMMA,
+          .gamma = 0.45f
+      };
+    } else {
+      JxlColorEncodingSetToSRGB(&colorEncoding, isImageMono);
+    }
+  } else {
+    JxlColorEncodingSetToSRGB(&colorEncoding, isImageMono);
+  }
+  if (isImageMono) {
+    // Single channel images must be described as gray, primaries are ignored then
+    colorEncoding.color_space = JXL_COLOR_SPACE_GRAY;
+  }
+  return colorEncoding;
+}
+
+/**
+ * Keeps bitmap pixels locked while the encoder reads them
+ */
+class BitmapPixelsLock {
+ public:
+  BitmapPixelsLock(JNIEnv *env, jobject bitmap) : env(env), bitmap(bitmap) {
+    locked = AndroidBitmap_lockPixels(env, bitmap, &addr) == 0;
+  }
+
+  ~BitmapPixelsLock() {
+    unlock();
+  }
+
+  bool unlock() {
+    if (!locked) {
+      return true;
+    }
+    locked = false;
+    return AndroidBitmap_unlockPixels(env, bitmap) == 0;
+  }
+
+  [[nodiscard]] bool isLocked() const {
+    return locked;
+  }
+
+  [[nodiscard]] const uint8_t *data() const {
+    return reinterpret_cast<const uint8_t *>(addr);
+  }
+
+ private:
+  JNIEnv *env;
+  jobject bitmap;
+  void *addr = nullptr;
+  bool locked = false;
+};
+
+static coder::JxlChunkedSourceFormat getChunkedSourceFormat(int32_t format) {
+  switch (format) {
+    case ANDROID_BITMAP_FORMAT_RGBA_F16:
+      return coder::SOURCE_RGBA_F16;
+    case ANDROID_BITMAP_FORMAT_RGBA_1010102:
+      return coder::SOURCE_RGBA_1010102;
+    case ANDROID_BITMAP_FORMAT_RGB_565:
+      return coder::SOURCE_RGB_565;
+    default:
+      return coder::SOURCE_RGBA_8888;
+  }
+}
+
+static void throwEncodingFailed(JNIEnv *env, const coder::JxlOutputSink &output) {
+  if (output.hasFailed()) {
+    std::string errorString = "Encoded image cannot be written into the output, it is too small or not writable";
+    throwException(env, errorString);
+  } else {
+    throwCantCompressImage(env);
+  }
+}
+
+/**
+ * Encodes the bitmap into the output, java exception is already thrown when false is returned.
+ * With rate control the distance is searched for the target size and quality is only the first guess.
+ * With auto grayscale RGBA_8888 bitmaps which have R, G, B within the tolerance are encoded as a single channel,
+ * tolerance applies only to lossy encoding.
+ * Instrumentation is optional and is not used with rate control.
+ */
+static bool encodeBitmap(JNIEnv *env, jobject bitmap,
+                         jint javaColorSpace, jint javaCompressionOption,
+                         jint effort, jstring bitmapColorProfile,
+                         jint dataSpace, jint jQuality, jint qualityMapping, jint decodingSpeed,
+                         jboolean chunked, jboolean autoGrayscale, jint grayscaleTolerance,
+                         coder::JxlOutputSink &output,
+                         coder::JxlRateControlOptions *rateControl = nullptr,
+                         coder::JxlRateControlResult *rateResult = nullptr,
+                         coder::JxlInstrumentation *instrumentation = nullptr) {
   try {
     auto colorspace = static_cast<JxlColorPixelType>(javaColorSpace);
     if (!colorspace) {
       throwInvalidColorSpaceException(env);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
     }
     auto compressionOption = static_cast<JxlCompressionOption>(javaCompressionOption);
     if (!compressionOption) {
       throwInvalidCompressionOptionException(env);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
     }
 
     if (effort < 0 || effort > 10) {
       throwInvalidCompressionOptionException(env);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
     }
 
     if (jQuality < 0 || jQuality > 100) {
       std::string exc = "Quality must be in 0...100";
       throwException(env, exc);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
     }
 
+    if (qualityMapping != QUALITY_CODER && qualityMapping != QUALITY_LIBJXL) {
+      throwInvalidCompressionOptionException(env);
+      return false;
+    }
+
+    if (grayscaleTolerance < 0 || grayscaleTolerance > 8) {
+      std::string exc = "Grayscale tolerance must be in 0...8";
+      throwException(env, exc);
+      return false;
+    }
+    const float distance = JxlQualityToDistance(jQuality, static_cast<JxlQualityMapping>(qualityMapping));
+
     AndroidBitmapInfo info;
     if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
       throwPixelsException(env);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
     }
 
     if (info.flags & ANDROID_BITMAP_FLAGS_IS_HARDWARE) {
       std::string exc = "Hardware bitmap is not supported by JXL Coder";
       throwException(env, exc);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
     }
 
     if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 &&
@@ -95,32 +345,132 @@ Java_com_awxkee_jxlcoder_JxlCoder_encodeImpl(JNIEnv *env, jobject thiz, jobject
         info.format != ANDROID_BITMAP_FORMAT_RGB_565) {
       string msg("Currently support encoding only RGBA_8888, RGBA_F16, RGBA_1010102, RGB_565 images pixel format");
       throwException(env, msg);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
     }
 
-    void *addr;
-    if (AndroidBitmap_lockPixels(env, bitmap, &addr) != 0) {
+    coder::JxlStageTimer inputTimer(instrumentation, coder::STAGE_INPUT);
+    BitmapPixelsLock pixelsLock(env, bitmap);
+    if (!pixelsLock.isLocked()) {
       throwPixelsException(env);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
+    }
+    inputTimer.stop();
+
+    bool opaque = false;
+    if (info.format == ANDROID_BITMAP_FORMAT_RGBA_8888) {
+      // Opacity and grayscale are found in the same pass over the pixels
+      const bool knownOpaque =
+          (info.flags & ANDROID_BITMAP_FLAGS_ALPHA_MASK) == ANDROID_BITMAP_FLAGS_ALPHA_OPAQUE;
+      const bool detectGray = autoGrayscale && colorspace != mono;
+      // Tolerance is applied only to opaque pixels, premultiplied R, G, B of translucent ones
+      // are equal only when unpremultiplied are, but their difference is scaled down by alpha
+      const auto tolerance = static_cast<uint8_t>(compressionOption == lossy ? grayscaleTolerance : 0);
+      coder::JxlStageTimer scanTimer(instrumentation, coder::STAGE_SCAN);
+      coder::RgbaScanResult scan = coder::ScanRgba8(pixelsLock.data(), info.stride, info.width, info.height,
+                                                    !knownOpaque, detectGray, tolerance);
+      scanTimer.stop();
+      opaque = knownOpaque || scan.opaque;
+      if (scan.gray) {
+        colorspace = colorspace == rgba && !opaque ? monoAlpha : mono;
+      }
     }
 
+    const bool isImageMono = colorspace == mono || colorspace == monoAlpha;
+    JxlColorEncoding colorEncoding = getBitmapColorEncoding(env, bitmapColorProfile, dataSpace, isImageMono);
+
+    std::vector<uint8_t> iccProfile;
+
+    if (rateControl) {
+      coder::JxlBitmapChunkedInput rateInput(pixelsLock.data(), info.stride, info.width, info.height,
+                                             getChunkedSourceFormat(info.format), colorspace, opaque);
+      rateControl->initialDistance = distance;
+      bool encoded;
+      if (rateControl->targetScore > 0) {
+        if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+          std::string exc = "Score target supports only RGBA_8888 bitmaps";
+          throwException(env, exc);
+          return false;
+        }
+        if (info.width < 8 || info.height < 8) {
+          std::string exc = "Score target needs an image of at least 8x8";
+          throwException(env, exc);
+          return false;
+        }
+        // Probes are decoded unassociated, so they are scored against unassociated pixels
+        const uint8_t *reference = pixelsLock.data();
+        uint32_t referenceStride = info.stride;
+        std::vector<uint8_t> unassociated;
+        if (!opaque) {
+          referenceStride = info.width * 4;
+          unassociated.resize(static_cast<size_t>(referenceStride) * info.height);
+          coder::UnassociateRgba8(pixelsLock.data(), info.stride, unassociated.data(), referenceStride,
+                                  info.width, info.height);
+          reference = unassociated.data();
+        }
+        encoded = coder::EncodeJxlToTargetScore(rateInput, info.width, info.height, output, colorspace,
+                                                iccProfile, effort, (int) decodingSpeed, colorEncoding,
+                                                reference, referenceStride, *rateControl, *rateResult);
+      } else {
+        encoded = coder::EncodeJxlToTargetSize(rateInput, info.width, info.height, output, colorspace,
+                                               iccProfile, effort, (int) decodingSpeed, colorEncoding,
+                                               *rateControl, *rateResult);
+      }
+      if (!pixelsLock.unlock()) {
+        string exc = "Unlocking pixels has failed";
+        throwException(env, exc);
+        return false;
+      }
+      if (!encoded) {
+        throwEncodingFailed(env, output);
+        return false;
+      }
+      return true;
+    }
+
+    // RGBA_8888 and RGBA_F16 never need a full size copy, only unpremultiplying and repacking which both are done per tile
+    if (chunked || info.format == ANDROID_BITMAP_FORMAT_RGBA_8888 || info.format == ANDROID_BITMAP_FORMAT_RGBA_F16) {
+      // Tiles are converted straight from the locked pixels while encoder pulls them
+      coder::JxlBitmapChunkedInput chunkedInput(pixelsLock.data(), info.stride, info.width, info.height,
+                                                getChunkedSourceFormat(info.format), colorspace, opaque);
+      bool encoded = EncodeJxlChunked(chunkedInput, info.width, info.height,
+                                      output, colorspace,
+                                      compressionOption, ref(iccProfile),
+                                      effort, distance, (int) decodingSpeed,
+                                      colorEncoding, chunked, 0, nullptr, instrumentation);
+      if (!pixelsLock.unlock()) {
+        string exc = "Unlocking pixels has failed";
+        throwException(env, exc);
+        return false;
+      }
+      if (!encoded) {
+        throwEncodingFailed(env, output);
+        return false;
+      }
+      return true;
+    }
+
+    coder::JxlStageTimer copyTimer(instrumentation, coder::STAGE_INPUT);
     vector<uint8_t> rgbaPixels(info.stride * info.height);
-    memcpy(rgbaPixels.data(), addr, info.stride * info.height);
+    memcpy(rgbaPixels.data(), pixelsLock.data(), info.stride * info.height);
+    copyTimer.stop();
 
-    if (AndroidBitmap_unlockPixels(env, bitmap) != 0) {
+    if (!pixelsLock.unlock()) {
       string exc = "Unlocking pixels has failed";
       throwException(env, exc);
-      return static_cast<jbyteArray>(nullptr);
+      return false;
     }
 
     uint32_t imageStride = info.stride;
+    size_t allocatedPixels = rgbaPixels.size();
 
+    coder::JxlStageTimer conversionTimer(instrumentation, coder::STAGE_CONVERSION);
     if (info.format == ANDROID_BITMAP_FORMAT_RGBA_1010102) {
       imageStride = info.width * 4 * sizeof(uint16_t);
       vector<uint8_t> halfFloatPixels(imageStride * info.height);
       coder::RGBA1010102ToUnsigned(reinterpret_cast<const uint8_t *>(rgbaPixels.data()), info.stride,
                                    reinterpret_cast<uint16_t *>(halfFloatPixels.data()), imageStride,
                                    info.width, info.height, 16);
+      allocatedPixels += halfFloatPixels.size();
       rgbaPixels = halfFloatPixels;
     } else if (info.format == ANDROID_BITMAP_FORMAT_RGB_565) {
       uint32_t
@@ -132,29 +482,11 @@ Java_com_awxkee_jxlcoder_JxlCoder_encodeImpl(JNIEnv *env, jobject thiz, jobject
                                rgba8888Pixels.data(), newStride,
                                (uint32_t) info.width, (uint32_t) info.height, 255);
       imageStride = newStride;
+      allocatedPixels += rgba8888Pixels.size();
       rgbaPixels = rgba8888Pixels;
-    } else if (info.format == ANDROID_BITMAP_FORMAT_RGBA_8888) {
-      coder::UnassociateRgba8(rgbaPixels.data(), imageStride,
-                              rgbaPixels.data(), imageStride,
-                              (uint32_t) info.width,
-                              (uint32_t) info.height);
-    } else if (info.format == ANDROID_BITMAP_FORMAT_RGBA_F16) {
-      uint32_t
-          newStride = info.width * 4 * (uint32_t)
-      sizeof(uint16_t);
-      std::vector<uint8_t> rgbau16Pixels(newStride * info.height);
-      coder::RGBAF16BitToNBitU16(reinterpret_cast<uint16_t *>(rgbaPixels.data()),
-                                 (uint32_t) info.stride,
-                                 reinterpret_cast<uint16_t *>(rgbau16Pixels.data()), newStride,
-                                 (uint32_t) info.width, (uint32_t) info.height, 16);
-      imageStride = newStride;
-      rgbaPixels = rgbau16Pixels;
     }
 
-    bool useFloat16 = info.format == ANDROID_BITMAP_FORMAT_RGBA_F16 ||
-        info.format == ANDROID_BITMAP_FORMAT_RGBA_1010102;
-
-    const bool isImageMono = colorspace == mono;
+    bool useFloat16 = info.format == ANDROID_BITMAP_FORMAT_RGBA_1010102;
 
     std::vector<uint8_t> rgbPixels;
     switch (colorspace) {
@@ -163,17 +495,17 @@ Java_com_awxkee_jxlcoder_JxlCoder_encodeImpl(JNIEnv *env, jobject thiz, jobject
             (int) (useFloat16 ? sizeof(uint16_t) : sizeof(uint8_t));
         rgbPixels.resize(info.height * requiredStride);
         if (useFloat16) {
-          coder::RGBAPickChannel(reinterpret_cast<const uint16_t *>(rgbaPixels.data()),
-                                 (int) imageStride,
-                                 reinterpret_cast<uint16_t *>(rgbPixels.data()),
-                                 (int) requiredStride,
-                                 (int) info.width, (int) info.height, 0);
+          coder::RGBAToGray(reinterpret_cast<const uint16_t *>(rgbaPixels.data()),
+                            (int) imageStride,
+                            reinterpret_cast<uint16_t *>(rgbPixels.data()),
+                            (int) requiredStride,
+                            (int) info.width, (int) info.height);
         } else {
-          coder::RGBAPickChannel(reinterpret_cast<const uint8_t *>(rgbaPixels.data()), static_cast<int>(imageStride),
-                                 reinterpret_cast<uint8_t *>(rgbPixels.data()),
-                                 static_cast<int>(requiredStride),
-                                 static_cast<int>(info.width),
-                                 static_cast<int>(info.height), 0);
+          coder::RGBAToGray(reinterpret_cast<const uint8_t *>(rgbaPixels.data()), static_cast<int>(imageStride),
+                            reinterpret_cast<uint8_t *>(rgbPixels.data()),
+                            static_cast<int>(requiredStride),
+                            static_cast<int>(info.width),
+                            static_cast<int>(info.height));
         }
         imageStride = requiredStride;
       }
@@ -197,6 +529,20 @@ Java_com_awxkee_jxlcoder_JxlCoder_encodeImpl(JNIEnv *env, jobject thiz, jobject
         imageStride = requiredStride;
       }
         break;
+      case monoAlpha: {
+        uint32_t requiredStride = (uint32_t) info.width * 2 * (uint32_t)(useFloat16 ? sizeof(uint16_t) : sizeof(uint8_t));
+        rgbPixels.resize(info.height * requiredStride);
+        if (useFloat16) {
+          coder::RGBAToGrayAlpha(reinterpret_cast<const uint16_t *>(rgbaPixels.data()), imageStride,
+                                 reinterpret_cast<uint16_t *>(rgbPixels.data()), requiredStride,
+                                 info.width, info.height);
+        } else {
+          coder::RGBAToGrayAlpha(rgbaPixels.data(), imageStride, rgbPixels.data(), requiredStride,
+                                 info.width, info.height);
+        }
+        imageStride = requiredStride;
+      }
+        break;
       case rgba: {
         int requiredStride = (int) info.width * 4 *
             (int) (useFloat16 ? sizeof(uint16_t) : sizeof(uint8_t));
@@ -222,181 +568,588 @@ Java_com_awxkee_jxlcoder_JxlCoder_encodeImpl(JNIEnv *env, jobject thiz, jobject
     }
 
     rgbaPixels.clear();
+    conversionTimer.stop();
+    if (instrumentation) {
+      instrumentation->addAllocated(allocatedPixels + rgbPixels.size());
+    }
 
-    std::vector<uint8_t> compressedVector;
+    JxlEncodingPixelDataFormat dataPixelFormat = useFloat16 ? BINARY_16 : UNSIGNED_8;
 
-    JxlColorEncoding colorEncoding = {};
+    if (!EncodeJxlOneshot(rgbPixels, info.width, info.height,
+                          output, colorspace,
+                          compressionOption, dataPixelFormat,
+                          ref(iccProfile),
+                          effort, distance, (int) decodingSpeed,
+                          colorEncoding, instrumentation)) {
+      throwEncodingFailed(env, output);
+      return false;
+    }
+    return true;
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return false;
+  } catch (std::runtime_error &err) {
+    std::string m1 = err.what();
+    std::string errorString = "Error: " + m1;
+    throwException(env, errorString);
+    return false;
+  }
+}
 
-    if (bitmapColorProfile || dataSpace != -1) {
-      const char *utf8String = env->GetStringUTFChars(bitmapColorProfile, nullptr);
-      std::string stdString(utf8String);
-      env->ReleaseStringUTFChars(bitmapColorProfile, utf8String);
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_encodeImpl(JNIEnv *env, jobject thiz, jobject bitmap,
+                                             jint javaColorSpace, jint javaCompressionOption,
+                                             jint effort, jstring bitmapColorProfile,
+                                             jint dataSpace, jint jQuality, jint qualityMapping,
+                                             jint decodingSpeed, jboolean chunked,
+                                             jboolean autoGrayscale, jint grayscaleTolerance,
+                                             jobject javaInstrumentation) {
+  try {
+    coder::JxlInstrumentation instrumentation;
+    coder::JxlInstrumentation *instrumentationPtr = javaInstrumentation ? &instrumentation : nullptr;
+    coder::JxlChunkListSink output;
+    if (!encodeBitmap(env, bitmap, javaColorSpace, javaCompressionOption, effort, bitmapColorProfile,
+                      dataSpace, jQuality, qualityMapping, decodingSpeed, chunked,
+                      autoGrayscale, grayscaleTolerance, output, nullptr, nullptr, instrumentationPtr)) {
+      return nullptr;
+    }
+    coder::JxlStageTimer outputTimer(instrumentationPtr, coder::STAGE_OUTPUT);
+    jbyteArray data = chunkListToByteArray(env, output);
+    outputTimer.stop();
+    if (!data) {
+      return nullptr;
+    }
+    instrumentation.addAllocated(output.getAllocatedSize() + output.getSize());
+    publishInstrumentation(env, javaInstrumentation, instrumentation);
+    return data;
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
 
-      if (stdString == "Rec. ITU-R BT.709-5" || dataSpace == ADataSpace::ADATASPACE_BT709) {
-        auto matrix = getRec709Primaries();
-        auto illuminant = getIlluminantD65();
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_D65,
-            .white_point_xy = {illuminant.x(), illuminant.y()},
-            .primaries = JXL_PRIMARIES_SRGB,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = JXL_TRANSFER_FUNCTION_709,
-        };
-      } else if (stdString == "Rec. ITU-R BT.2020-1" ||
-          dataSpace == ADataSpace::ADATASPACE_BT2020) {
-        auto matrix = getRec2020Primaries();
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_D65,
-            .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
-            .primaries = JXL_PRIMARIES_2100,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = JXL_TRANSFER_FUNCTION_709,
-        };
-      } else if (stdString == "Display P3" ||
-          dataSpace == ADataSpace::ADATASPACE_DISPLAY_P3) {
-        auto matrix = getDisplayP3Primaries();
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_D65,
-            .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
-            .primaries = JXL_PRIMARIES_CUSTOM,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = JXL_TRANSFER_FUNCTION_SRGB,
-            .gamma = 1 / 2.2
-        };
-      } else if (stdString == "sRGB IEC61966-2.1 (Linear)" ||
-          dataSpace == ADataSpace::ADATASPACE_SCRGB_LINEAR) {
-        auto matrix = getRec709Primaries();
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_D65,
-            .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
-            .primaries = JXL_PRIMARIES_SRGB,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = JXL_TRANSFER_FUNCTION_LINEAR
-        };
-      } else if (stdString == "Perceptual Quantizer encoding" ||
-          (dataSpace == ADataSpace::ADATASPACE_BT2020_ITU_PQ ||
-              dataSpace == ADataSpace::ADATASPACE_BT2020_HLG ||
-              dataSpace == ADataSpace::ADATASPACE_BT2020_ITU_HLG)) {
-        auto matrix = getRec2020Primaries();
-        JxlTransferFunction function = JXL_TRANSFER_FUNCTION_PQ;
-        if (dataSpace == ADataSpace::ADATASPACE_BT2020_HLG ||
-            dataSpace == ADataSpace::ADATASPACE_BT2020_ITU_HLG) {
-          function = JXL_TRANSFER_FUNCTION_HLG;
-        }
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_D65,
-            .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
-            .primaries = JXL_PRIMARIES_2100,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = function,
-        };
-      } else if (stdString == "Adobe RGB (1998)" ||
-          dataSpace == ADataSpace::ADATASPACE_ADOBE_RGB) {
-        auto matrix = getAdobeRGBPrimaries();
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_D65,
-            .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
-            .primaries = JXL_PRIMARIES_CUSTOM,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = JXL_TRANSFER_FUNCTION_GAMMA,
-            .gamma = 256.0 / 563.0
-        };
-      } else if (stdString == "SMPTE RP 431-2-2007 DCI (P3)" ||
-          dataSpace == ADataSpace::ADATASPACE_DCI_P3) {
-        auto matrix = getDCIP3Primaries();
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_D65,
-            .white_point_xy = {getIlluminantDCI().x(), getIlluminantDCI().y()},
-            .primaries = JXL_PRIMARIES_CUSTOM,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = JXL_TRANSFER_FUNCTION_SRGB,
-        };
-      } else if (dataSpace == ADataSpace::ADATASPACE_BT601_525 ||
-          dataSpace == ADataSpace::ADATASPACE_BT601_625 ||
-          dataSpace == ADataSpace::ADATASPACE_JFIF) {
-        auto matrix = getBT601_525Primaries();
-        if (dataSpace == ADataSpace::ADATASPACE_BT601_625 ||
-            dataSpace == ADataSpace::ADATASPACE_JFIF) {
-          matrix = getBT601_625Primaries();
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_encodeToOutputImpl(JNIEnv *env, jobject thiz, jobject bitmap,
+                                                     jint javaColorSpace, jint javaCompressionOption,
+                                                     jint effort, jstring bitmapColorProfile,
+                                                     jint dataSpace, jint jQuality, jint qualityMapping,
+                                                     jint decodingSpeed, jboolean chunked,
+                                                     jboolean autoGrayscale, jint grayscaleTolerance,
+                                                     jint fd, jobject byteBuffer, jobject javaInstrumentation) {
+  std::unique_ptr<coder::JxlOutputSink> output;
+  if (byteBuffer) {
+    output = directByteBufferSink(env, byteBuffer);
+    if (!output) {
+      std::string errorString = "Only direct byte buffers are supported";
+      throwException(env, errorString);
+      return -1;
+    }
+  } else {
+    output = std::make_unique<coder::JxlFdSink>(fd);
+  }
+  // Output is written while encoding, so its time is a part of the encode stage
+  coder::JxlInstrumentation instrumentation;
+  if (!encodeBitmap(env, bitmap, javaColorSpace, javaCompressionOption, effort, bitmapColorProfile,
+                    dataSpace, jQuality, qualityMapping, decodingSpeed, chunked,
+                    autoGrayscale, grayscaleTolerance, *output, nullptr, nullptr,
+                    javaInstrumentation ? &instrumentation : nullptr)) {
+    return -1;
+  }
+  output->finish();
+  publishInstrumentation(env, javaInstrumentation, instrumentation);
+  return static_cast<jlong>(output->getSize());
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_encodeToTargetImpl(JNIEnv *env, jobject thiz, jobject bitmap,
+                                                     jint javaColorSpace, jint effort,
+                                                     jstring bitmapColorProfile, jint dataSpace,
+                                                     jint jQuality, jint qualityMapping, jint decodingSpeed,
+                                                     jboolean autoGrayscale, jint grayscaleTolerance,
+                                                     jlong targetSize, jfloat tolerance,
+                                                     jdouble targetScore, jdouble scoreTolerance,
+                                                     jint maxIterations, jint parallelProbes) {
+  // Exactly one of the targets is set
+  const bool sizeTarget = targetSize > 0 && tolerance >= 0 && tolerance < 1 && targetScore == 0;
+  const bool scoreTarget = targetSize == 0 && targetScore > 0 && targetScore <= 100 && scoreTolerance > 0;
+  if ((!sizeTarget && !scoreTarget) || maxIterations <= 0 || parallelProbes <= 0) {
+    std::string errorString = "Invalid rate control parameters";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  try {
+    coder::JxlRateControlOptions rateControl;
+    rateControl.targetSize = static_cast<uint64_t>(targetSize);
+    rateControl.tolerance = tolerance;
+    rateControl.targetScore = targetScore;
+    rateControl.scoreTolerance = scoreTolerance;
+    rateControl.maxIterations = maxIterations;
+    rateControl.parallelProbes = parallelProbes;
+    coder::JxlRateControlResult rateResult;
+    coder::JxlChunkListSink output;
+    if (!encodeBitmap(env, bitmap, javaColorSpace, lossy, effort, bitmapColorProfile,
+                      dataSpace, jQuality, qualityMapping, decodingSpeed, false,
+                      autoGrayscale, grayscaleTolerance, output, &rateControl, &rateResult)) {
+      return nullptr;
+    }
+    jbyteArray data = chunkListToByteArray(env, output);
+    if (!data) {
+      return nullptr;
+    }
+    jclass resultClass = env->FindClass("com/awxkee/jxlcoder/JxlRateControlResult");
+    if (!resultClass) {
+      return nullptr;
+    }
+    jmethodID methodID = env->GetMethodID(resultClass, "<init>", "([BFIIZD)V");
+    if (!methodID) {
+      return nullptr;
+    }
+    return env->NewObject(resultClass, methodID, data, static_cast<jfloat>(rateResult.distance),
+                          static_cast<jint>(rateResult.iterations), static_cast<jint>(rateResult.encodes),
+                          static_cast<jboolean>(rateResult.targetReached),
+                          static_cast<jdouble>(scoreTarget ? rateResult.score : NAN));
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_encodeRenditionsImpl(JNIEnv *env, jobject thiz, jobject bitmap,
+                                                       jint javaColorSpace, jstring bitmapColorProfile,
+                                                       jint dataSpace, jintArray maxWidths, jintArray maxHeights,
+                                                       jintArray compressionOptions, jfloatArray distances,
+                                                       jintArray efforts, jint decodingSpeed, jint resizeFilter,
+                                                       jint parallelEncodes) {
+  try {
+    auto colorspace = static_cast<JxlColorPixelType>(javaColorSpace);
+    if (!colorspace) {
+      throwInvalidColorSpaceException(env);
+      return nullptr;
+    }
+
+    const jsize count = env->GetArrayLength(maxWidths);
+    if (count == 0 || env->GetArrayLength(maxHeights) != count || env->GetArrayLength(compressionOptions) != count ||
+        env->GetArrayLength(distances) != count || env->GetArrayLength(efforts) != count || parallelEncodes <= 0) {
+      std::string exc = "Invalid renditions parameters";
+      throwException(env, exc);
+      return nullptr;
+    }
+
+    std::vector<jint> widthsValues(count), heightsValues(count), compressionValues(count), effortsValues(count);
+    std::vector<jfloat> distancesValues(count);
+    env->GetIntArrayRegion(maxWidths, 0, count, widthsValues.data());
+    env->GetIntArrayRegion(maxHeights, 0, count, heightsValues.data());
+    env->GetIntArrayRegion(compressionOptions, 0, count, compressionValues.data());
+    env->GetFloatArrayRegion(distances, 0, count, distancesValues.data());
+    env->GetIntArrayRegion(efforts, 0, count, effortsValues.data());
+
+    std::vector<coder::JxlRenditionSpec> specs(count);
+    for (jsize i = 0; i < count; ++i) {
+      if (widthsValues[i] < 0 || heightsValues[i] < 0) {
+        std::string exc = "Rendition size must not be negative";
+        throwException(env, exc);
+        return nullptr;
+      }
+      if (compressionValues[i] != lossy && compressionValues[i] != loseless) {
+        throwInvalidCompressionOptionException(env);
+        return nullptr;
+      }
+      if (effortsValues[i] < 0 || effortsValues[i] > 10) {
+        throwInvalidCompressionOptionException(env);
+        return nullptr;
+      }
+      if (distancesValues[i] < 0 || distancesValues[i] > 25) {
+        std::string exc = "Distance must be in 0...25";
+        throwException(env, exc);
+        return nullptr;
+      }
+      specs[i].maxWidth = static_cast<uint32_t>(widthsValues[i]);
+      specs[i].maxHeight = static_cast<uint32_t>(heightsValues[i]);
+      specs[i].compressionOption = static_cast<JxlCompressionOption>(compressionValues[i]);
+      specs[i].distance = distancesValues[i];
+      specs[i].effort = effortsValues[i];
+    }
+
+    AndroidBitmapInfo info;
+    if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
+      throwPixelsException(env);
+      return nullptr;
+    }
+
+    if (info.flags & ANDROID_BITMAP_FLAGS_IS_HARDWARE) {
+      std::string exc = "Hardware bitmap is not supported by JXL Coder";
+      throwException(env, exc);
+      return nullptr;
+    }
+
+    if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 &&
+        info.format != ANDROID_BITMAP_FORMAT_RGBA_F16 &&
+        info.format != ANDROID_BITMAP_FORMAT_RGBA_1010102 &&
+        info.format != ANDROID_BITMAP_FORMAT_RGB_565) {
+      string msg("Currently support encoding only RGBA_8888, RGBA_F16, RGBA_1010102, RGB_565 images pixel format");
+      throwException(env, msg);
+      return nullptr;
+    }
+
+    JxlColorEncoding colorEncoding = getBitmapColorEncoding(env, bitmapColorProfile, dataSpace, colorspace == mono);
+
+    BitmapPixelsLock pixelsLock(env, bitmap);
+    if (!pixelsLock.isLocked()) {
+      throwPixelsException(env);
+      return nullptr;
+    }
+
+    // Source is converted once and every rendition is scaled and encoded from it. Only RGBA_8888 is unpremultiplied,
+    // F16 and 1010102 are taken as they are like the single encode does. Weaver scales only integer samples,
+    // so F16 is clipped to 0..1 in 16 bits here, unlike the single encode which keeps half floats.
+    const uint8_t *source = pixelsLock.data();
+    uint32_t sourceStride = info.stride;
+    bool highBitDepth = false;
+    bool hasAlpha = true;
+    std::vector<uint8_t> sourcePixels;
+
+    switch (info.format) {
+      case ANDROID_BITMAP_FORMAT_RGBA_8888: {
+        hasAlpha = (info.flags & ANDROID_BITMAP_FLAGS_ALPHA_MASK) != ANDROID_BITMAP_FLAGS_ALPHA_OPAQUE &&
+            !coder::IsRgba8Opaque(pixelsLock.data(), info.stride, info.width, info.height);
+        if (hasAlpha) {
+          sourceStride = info.width * 4 * sizeof(uint8_t);
+          sourcePixels.resize(static_cast<size_t>(sourceStride) * info.height);
+          coder::UnassociateRgba8(pixelsLock.data(), info.stride, sourcePixels.data(), sourceStride,
+                                  info.width, info.height);
         }
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_D65,
-            .white_point_xy = {getIlluminantD65().x(), getIlluminantD65().y()},
-            .primaries = JXL_PRIMARIES_CUSTOM,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = JXL_TRANSFER_FUNCTION_709
-        };
-      } else if (dataSpace == ADataSpace::STANDARD_BT470M) {
-        auto matrix = getBT470MPrimaries();
-        colorEncoding = {
-            .color_space = JXL_COLOR_SPACE_RGB,
-            .white_point = JXL_WHITE_POINT_CUSTOM,
-            .white_point_xy = {getIlluminantC().x(), getIlluminantC().y()},
-            .primaries = JXL_PRIMARIES_CUSTOM,
-            .primaries_red_xy = {matrix(0, 0), matrix(0, 1)},
-            .primaries_green_xy = {matrix(1, 0), matrix(1, 1)},
-            .primaries_blue_xy = {matrix(2, 0), matrix(2, 1)},
-            .transfer_function = JXL_TRANSFER_FUNCTION_GAMMA,
-            .gamma = 0.45f
-        };
-      } else {
-        JxlColorEncodingSetToSRGB(&colorEncoding, isImageMono);
       }
-    } else {
-      JxlColorEncodingSetToSRGB(&colorEncoding, isImageMono);
+        break;
+      case ANDROID_BITMAP_FORMAT_RGBA_F16: {
+        highBitDepth = true;
+        sourceStride = info.width * 4 * sizeof(uint16_t);
+        sourcePixels.resize(static_cast<size_t>(sourceStride) * info.height);
+        coder::RGBAF16BitToNBitU16(reinterpret_cast<const uint16_t *>(pixelsLock.data()), info.stride,
+                                   reinterpret_cast<uint16_t *>(sourcePixels.data()), sourceStride,
+                                   info.width, info.height, 16);
+      }
+        break;
+      case ANDROID_BITMAP_FORMAT_RGBA_1010102: {
+        highBitDepth = true;
+        sourceStride = info.width * 4 * sizeof(uint16_t);
+        sourcePixels.resize(static_cast<size_t>(sourceStride) * info.height);
+        coder::RGBA1010102ToUnsigned(pixelsLock.data(), info.stride,
+                                     reinterpret_cast<uint16_t *>(sourcePixels.data()), sourceStride,
+                                     info.width, info.height, 16);
+      }
+        break;
+      default: {
+        hasAlpha = false;
+        sourceStride = info.width * 4 * sizeof(uint8_t);
+        sourcePixels.resize(static_cast<size_t>(sourceStride) * info.height);
+        coder::Rgb565ToUnsigned8(reinterpret_cast<const uint16_t *>(pixelsLock.data()), info.stride,
+                                 sourcePixels.data(), sourceStride, info.width, info.height, 255);
+      }
+        break;
     }
 
-    JxlEncodingPixelDataFormat dataPixelFormat = useFloat16 ? BINARY_16 : UNSIGNED_8;
-    std::vector<uint8_t> iccProfile;
+    if (!sourcePixels.empty()) {
+      source = sourcePixels.data();
+      if (!pixelsLock.unlock()) {
+        string exc = "Unlocking pixels has failed";
+        throwException(env, exc);
+        return nullptr;
+      }
+    }
 
-    if (!EncodeJxlOneshot(rgbPixels, info.width, info.height,
-                          &compressedVector, colorspace,
-                          compressionOption, dataPixelFormat,
-                          ref(iccProfile),
-                          effort, (int) jQuality, (int) decodingSpeed,
-                          colorEncoding)) {
+    std::vector<uint8_t> iccProfile;
+    std::vector<coder::JxlRendition> renditions;
+    bool encoded = coder::EncodeJxlRenditions(source, sourceStride, info.width, info.height,
+                                              highBitDepth, hasAlpha,
+                                              XSamplerToScalingFunction(static_cast<XSampler>(resizeFilter)),
+                                              colorspace, iccProfile, (int) decodingSpeed, colorEncoding,
+                                              specs, (int) parallelEncodes, renditions);
+    if (!pixelsLock.unlock()) {
+      string exc = "Unlocking pixels has failed";
+      throwException(env, exc);
+      return nullptr;
+    }
+    if (!encoded) {
       throwCantCompressImage(env);
-      return static_cast<jbyteArray>(nullptr);
+      return nullptr;
+    }
+
+    // All renditions share one java array
+    uint64_t totalSize = 0;
+    for (const coder::JxlRendition &rendition : renditions) {
+      totalSize += rendition.output->getSize();
+    }
+    if (totalSize > static_cast<uint64_t>(std::numeric_limits<jsize>::max())) {
+      throw std::bad_alloc();
+    }
+    jbyteArray data = env->NewByteArray(static_cast<jsize>(totalSize));
+    if (!data) {
+      env->ExceptionClear();
+      throw std::bad_alloc();
+    }
+
+    std::vector<jint> offsets(count), sizes(count), widths(count), heights(count);
+    jsize offset = 0;
+    for (jsize i = 0; i < count; ++i) {
+      const coder::JxlRendition &rendition = renditions[i];
+      offsets[i] = offset;
+      sizes[i] = static_cast<jint>(rendition.output->getSize());
+      widths[i] = static_cast<jint>(rendition.width);
+      heights[i] = static_cast<jint>(rendition.height);
+      rendition.output->forEachChunk([&](const uint8_t *chunk, size_t size) {
+        env->SetByteArrayRegion(data, offset, static_cast<jsize>(size), reinterpret_cast<const jbyte *>(chunk));
+        offset += static_cast<jsize>(size);
+      });
+    }
+
+    const auto toIntArray = [&](const std::vector<jint> &values) {
+      jintArray array = env->NewIntArray(count);
+      if (array) {
+        env->SetIntArrayRegion(array, 0, count, values.data());
+      }
+      return array;
+    };
+
+    // Failed allocations and lookups leave their java exception pending
+    jintArray javaOffsets = toIntArray(offsets);
+    jintArray javaSizes = javaOffsets ? toIntArray(sizes) : nullptr;
+    jintArray javaWidths = javaSizes ? toIntArray(widths) : nullptr;
+    jintArray javaHeights = javaWidths ? toIntArray(heights) : nullptr;
+    if (!javaHeights) {
+      return nullptr;
     }
+    jclass resultClass = env->FindClass("com/awxkee/jxlcoder/JxlRenditions");
+    if (!resultClass) {
+      return nullptr;
+    }
+    jmethodID methodID = env->GetMethodID(resultClass, "<init>", "([B[I[I[I[I)V");
+    if (!methodID) {
+      return nullptr;
+    }
+    return env->NewObject(resultClass, methodID, data, javaOffsets, javaSizes, javaWidths, javaHeights);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to encode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+/**
+ * Matrix and range of the frame from its data space, unspecified range is full for 8 bit frames
+ * as camera frames are, and limited for P010 which comes from video
+ */
+static void getYuvMatrix(jint dataSpace, coder::JxlYuvSampleFormat sampleFormat,
+                         coder::YuvMatrix *matrix, bool *fullRange) {
+  const int32_t standard = dataSpace == -1 ? 0 : (dataSpace & ADataSpace::STANDARD_MASK);
+  const int32_t range = dataSpace == -1 ? 0 : (dataSpace & ADataSpace::RANGE_MASK);
+  if (standard == ADataSpace::STANDARD_BT709) {
+    *matrix = coder::YUV_MATRIX_BT709;
+  } else if (standard == ADataSpace::STANDARD_BT2020) {
+    *matrix = coder::YUV_MATRIX_BT2020;
+  } else {
+    *matrix = coder::YUV_MATRIX_BT601;
+  }
+  if (range == ADataSpace::RANGE_FULL) {
+    *fullRange = true;
+  } else if (range == ADataSpace::RANGE_LIMITED) {
+    *fullRange = false;
+  } else {
+    *fullRange = sampleFormat == coder::YUV_SAMPLES_8;
+  }
+}
+
+/**
+ * Direct buffer address if it holds `rows` rows of `rowBytes` placed `rowStride` apart, nullptr otherwise
+ */
+static const uint8_t *getPlaneAddress(JNIEnv *env, jobject plane, uint64_t rowStride, uint64_t rows, uint64_t rowBytes) {
+  if (!plane) {
+    return nullptr;
+  }
+  auto address = reinterpret_cast<const uint8_t *>(env->GetDirectBufferAddress(plane));
+  jlong capacity = env->GetDirectBufferCapacity(plane);
+  if (!address || capacity < 0 || rowStride * (rows - 1) + rowBytes > static_cast<uint64_t>(capacity)) {
+    return nullptr;
+  }
+  return address;
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_encodeYuvImpl(JNIEnv *env, jobject thiz,
+                                                jobject yPlane, jint yRowStride,
+                                                jobject uPlane, jobject vPlane,
+                                                jint uvRowStride, jint uvPixelStride,
+                                                jint width, jint height,
+                                                jint javaSampleFormat, jint dataSpace,
+                                                jint javaCompressionOption, jint effort,
+                                                jint jQuality, jint qualityMapping, jint decodingSpeed,
+                                                jobject javaInstrumentation) {
+  try {
+    auto sampleFormat = static_cast<coder::JxlYuvSampleFormat>(javaSampleFormat);
+    if (sampleFormat != coder::YUV_SAMPLES_8 && sampleFormat != coder::YUV_SAMPLES_P010) {
+      std::string exc = "Unsupported YUV sample format";
+      throwException(env, exc);
+      return nullptr;
+    }
+    auto compressionOption = static_cast<JxlCompressionOption>(javaCompressionOption);
+    if (compressionOption != lossy && compressionOption != loseless) {
+      throwInvalidCompressionOptionException(env);
+      return nullptr;
+    }
+    if (effort < 0 || effort > 10 || (qualityMapping != QUALITY_CODER && qualityMapping != QUALITY_LIBJXL)) {
+      throwInvalidCompressionOptionException(env);
+      return nullptr;
+    }
+    if (jQuality < 0 || jQuality > 100) {
+      std::string exc = "Quality must be in 0...100";
+      throwException(env, exc);
+      return nullptr;
+    }
+
+    const uint32_t sampleSize = sampleFormat == coder::YUV_SAMPLES_P010 ? sizeof(uint16_t) : sizeof(uint8_t);
+    if (width <= 0 || height <= 0 || yRowStride < width * static_cast<jint>(sampleSize) ||
+        uvPixelStride < static_cast<jint>(sampleSize) || uvRowStride <= 0 || yRowStride % sampleSize != 0) {
+      std::string exc = "Invalid YUV frame size or strides";
+      throwException(env, exc);
+      return nullptr;
+    }
+    const uint64_t chromaWidth = (static_cast<uint64_t>(width) + 1) / 2;
+    const uint64_t chromaHeight = (static_cast<uint64_t>(height) + 1) / 2;
+    const uint64_t chromaRowBytes = (chromaWidth - 1) * uvPixelStride + sampleSize;
+    coder::JxlYuvPlanes planes = {
+        .y = getPlaneAddress(env, yPlane, yRowStride, height, static_cast<uint64_t>(width) * sampleSize),
+        .yRowStride = static_cast<uint32_t>(yRowStride),
+        .u = getPlaneAddress(env, uPlane, uvRowStride, chromaHeight, chromaRowBytes),
+        .v = getPlaneAddress(env, vPlane, uvRowStride, chromaHeight, chromaRowBytes),
+        .uvRowStride = static_cast<uint32_t>(uvRowStride),
+        .uvPixelStride = static_cast<uint32_t>(uvPixelStride),
+    };
+    if (!planes.y || !planes.u || !planes.v) {
+      std::string exc = "YUV planes must be direct byte buffers large enough for the frame";
+      throwException(env, exc);
+      return nullptr;
+    }
+
+    coder::YuvMatrix matrix;
+    bool fullRange;
+    getYuvMatrix(dataSpace, sampleFormat, &matrix, &fullRange);
+    JxlColorEncoding colorEncoding = getBitmapColorEncoding(env, nullptr, dataSpace, false);
+    const float distance = JxlQualityToDistance(jQuality, static_cast<JxlQualityMapping>(qualityMapping));
 
-    jbyteArray byteArray = env->NewByteArray((jsize) compressedVector.size());
-    char *memBuf = (char *) ((void *) compressedVector.data());
-    env->SetByteArrayRegion(byteArray, 0, (jint) compressedVector.size(),
-                            reinterpret_cast<const jbyte *>(memBuf));
-    compressedVector.clear();
-    return byteArray;
+    coder::JxlInstrumentation instrumentation;
+    coder::JxlInstrumentation *instrumentationPtr = javaInstrumentation ? &instrumentation : nullptr;
+    coder::JxlYuvChunkedInput input(planes, sampleFormat, matrix, fullRange);
+    coder::JxlChunkListSink output;
+    std::vector<uint8_t> iccProfile;
+    if (!EncodeJxlChunked(input, width, height, output, rgb, compressionOption, iccProfile,
+                          effort, distance, decodingSpeed, colorEncoding, false, 0, nullptr,
+                          instrumentationPtr)) {
+      throwEncodingFailed(env, output);
+      return nullptr;
+    }
+
+    coder::JxlStageTimer outputTimer(instrumentationPtr, coder::STAGE_OUTPUT);
+    jbyteArray data = chunkListToByteArray(env, output);
+    outputTimer.stop();
+    if (!data) {
+      return nullptr;
+    }
+    instrumentation.addAllocated(output.getAllocatedSize() + output.getSize());
+    publishInstrumentation(env, javaInstrumentation, instrumentation);
+    return data;
   } catch (std::bad_alloc &err) {
     std::string errorString = "Not enough memory to encode this image";
     throwException(env, errorString);
     return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT jdouble JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_ssimulacra2Impl(JNIEnv *env, jobject thiz, jobject reference, jobject distorted) {
+  AndroidBitmapInfo referenceInfo, distortedInfo;
+  if (AndroidBitmap_getInfo(env, reference, &referenceInfo) < 0 ||
+      AndroidBitmap_getInfo(env, distorted, &distortedInfo) < 0) {
+    throwPixelsException(env);
+    return 0;
+  }
+
+  if ((referenceInfo.flags & ANDROID_BITMAP_FLAGS_IS_HARDWARE) ||
+      (distortedInfo.flags & ANDROID_BITMAP_FLAGS_IS_HARDWARE)) {
+    std::string exc = "Hardware bitmap is not supported by JXL Coder";
+    throwException(env, exc);
+    return 0;
+  }
+
+  if (referenceInfo.width != distortedInfo.width || referenceInfo.height != distortedInfo.height ||
+      referenceInfo.format != distortedInfo.format) {
+    std::string exc = "Reference and distorted bitmaps must have the same size and pixel format";
+    throwException(env, exc);
+    return 0;
+  }
+
+  if (referenceInfo.format != ANDROID_BITMAP_FORMAT_RGBA_8888 &&
+      referenceInfo.format != ANDROID_BITMAP_FORMAT_RGBA_F16) {
+    std::string exc = "Currently support scoring only RGBA_8888, RGBA_F16 images pixel format";
+    throwException(env, exc);
+    return 0;
+  }
+
+  const auto isPremultiplied = [](const AndroidBitmapInfo &info) {
+    return (info.flags & ANDROID_BITMAP_FLAGS_ALPHA_MASK) != ANDROID_BITMAP_FLAGS_ALPHA_UNPREMUL;
+  };
+  if (isPremultiplied(referenceInfo) != isPremultiplied(distortedInfo)) {
+    std::string exc = "Reference and distorted bitmaps must be both premultiplied or both not";
+    throwException(env, exc);
+    return 0;
+  }
+  // Opaque bitmaps are the same in both forms
+  const bool premultiplied = isPremultiplied(referenceInfo);
+  const uint32_t width = referenceInfo.width;
+  const uint32_t height = referenceInfo.height;
+
+  try {
+    BitmapPixelsLock referenceLock(env, reference);
+    BitmapPixelsLock distortedLock(env, distorted);
+    if (!referenceLock.isLocked() || !distortedLock.isLocked()) {
+      throwPixelsException(env);
+      return 0;
+    }
+
+    double score;
+    if (referenceInfo.format == ANDROID_BITMAP_FORMAT_RGBA_8888) {
+      score = coder::Ssimulacra2Rgba8(referenceLock.data(), referenceInfo.stride,
+                                      distortedLock.data(), distortedInfo.stride,
+                                      width, height, premultiplied);
+    } else {
+      const uint32_t stride = width * 4 * sizeof(uint16_t);
+      std::vector<uint16_t> referencePixels(static_cast<size_t>(width) * 4 * height);
+      std::vector<uint16_t> distortedPixels(static_cast<size_t>(width) * 4 * height);
+      coder::RGBAF16BitToNBitU16(reinterpret_cast<const uint16_t *>(referenceLock.data()), referenceInfo.stride,
+                                 referencePixels.data(), stride, width, height, 16);
+      coder::RGBAF16BitToNBitU16(reinterpret_cast<const uint16_t *>(distortedLock.data()), distortedInfo.stride,
+                                 distortedPixels.data(), stride, width, height, 16);
+      referenceLock.unlock();
+      distortedLock.unlock();
+      score = coder::Ssimulacra2Rgba16(referencePixels.data(), stride, distortedPixels.data(), stride,
+                                       width, height, 16, premultiplied);
+    }
+    return static_cast<jdouble>(score);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to compute the score";
+    throwException(env, errorString);
+    return 0;
   } catch (std::runtime_error &err) {
-    std::string m1 = err.what();
-    std::string errorString = "Error: " + m1;
+    std::string errorString = err.what();
     throwException(env, errorString);
-    return nullptr;
+    return 0;
   }
-}
\ No newline at end of file
+}
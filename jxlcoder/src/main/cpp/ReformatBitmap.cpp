@@ -48,6 +48,18 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
                     PreferredColorConfig preferredColorConfig, uint32_t depth,
                     uint32_t imageWidth, uint32_t imageHeight, uint32_t *stride, bool *useFloats,
                     jobject *hwBuffer, bool alphaPremultiplied, const bool hasAlphaInOrigin) {
+  std::vector<uint8_t> reformatBuffer;
+  ReformatColorConfig(env, imageData, imageConfig, preferredColorConfig, depth,
+                      imageWidth, imageHeight, stride, useFloats,
+                      hwBuffer, alphaPremultiplied, hasAlphaInOrigin, reformatBuffer);
+}
+
+void
+ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &imageConfig,
+                    PreferredColorConfig preferredColorConfig, uint32_t depth,
+                    uint32_t imageWidth, uint32_t imageHeight, uint32_t *stride, bool *useFloats,
+                    jobject *hwBuffer, bool alphaPremultiplied, const bool hasAlphaInOrigin,
+                    std::vector<uint8_t> &reformatBuffer) {
   *hwBuffer = nullptr;
   if (preferredColorConfig == Default) {
     int osVersion = androidOSVersion();
@@ -80,14 +92,14 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
     case Rgba_8888:
       if (*useFloats) {
         uint32_t lineWidth = imageWidth * 4 * (uint32_t)sizeof(uint8_t);
-        std::vector<uint8_t> rgba8888Data(lineWidth * imageHeight);
+        reformatBuffer.resize(lineWidth * imageHeight);
         coder::Rgba16ToRgba8(reinterpret_cast<const uint16_t *>(imageData.data()),
-                             *stride, rgba8888Data.data(), lineWidth, imageWidth,
+                             *stride, reformatBuffer.data(), lineWidth, imageWidth,
                              imageHeight, depth);
         *stride = lineWidth;
         *useFloats = false;
         imageConfig = "ARGB_8888";
-        imageData = rgba8888Data;
+        imageData.swap(reformatBuffer);
       }
       break;
     case Rgba_F16:
@@ -105,14 +117,14 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
         uint32_t alignment = 64;
         uint32_t padding = (alignment - (lineWidth % alignment)) % alignment;
         uint32_t dstStride = lineWidth + padding;
-        std::vector<uint8_t> rgbaF16Data(dstStride * imageHeight);
+        reformatBuffer.resize(dstStride * imageHeight);
         coder::Rgba8ToF16(imageData.data(), *stride,
-                          reinterpret_cast<uint16_t *>(rgbaF16Data.data()), dstStride,
+                          reinterpret_cast<uint16_t *>(reformatBuffer.data()), dstStride,
                           imageWidth, imageHeight, !alphaPremultiplied);
         *stride = dstStride;
         *useFloats = true;
         imageConfig = "RGBA_F16";
-        imageData = rgbaF16Data;
+        imageData.swap(reformatBuffer);
       }
       break;
     case Rgb_565:
@@ -123,15 +135,15 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
         uint32_t alignment = 64;
         uint32_t padding = (alignment - (lineWidth % alignment)) % alignment;
         uint32_t dstStride = lineWidth + padding;
-        std::vector<uint8_t> rgb565Data(dstStride * imageHeight);
+        reformatBuffer.resize(dstStride * imageHeight);
         coder::Rgba16To565(reinterpret_cast<const uint16_t *>(imageData.data()),
                            *stride,
-                           reinterpret_cast<uint16_t *>(rgb565Data.data()), dstStride,
+                           reinterpret_cast<uint16_t *>(reformatBuffer.data()), dstStride,
                            imageWidth, imageHeight, depth);
         *stride = dstStride;
         *useFloats = false;
         imageConfig = "RGB_565";
-        imageData = rgb565Data;
+        imageData.swap(reformatBuffer);
         break;
       } else {
         uint32_t
@@ -140,15 +152,15 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
         uint32_t alignment = 64;
         uint32_t padding = (alignment - (lineWidth % alignment)) % alignment;
         uint32_t dstStride = lineWidth + padding;
-        std::vector<uint8_t> rgb565Data(dstStride * imageHeight);
+        reformatBuffer.resize(dstStride * imageHeight);
         coder::Rgba8To565(imageData.data(), *stride,
-                          reinterpret_cast<uint16_t *>(rgb565Data.data()), dstStride,
+                          reinterpret_cast<uint16_t *>(reformatBuffer.data()), dstStride,
                           imageWidth, imageHeight,
                           !alphaPremultiplied);
         *stride = dstStride;
         *useFloats = false;
         imageConfig = "RGB_565";
-        imageData = rgb565Data;
+        imageData.swap(reformatBuffer);
       }
       break;
     case Rgba_1010102:
@@ -159,16 +171,16 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
         uint32_t alignment = 64;
         uint32_t padding = (alignment - (lineWidth % alignment)) % alignment;
         uint32_t dstStride = lineWidth + padding;
-        std::vector<uint8_t> rgba1010102Data(dstStride * imageHeight);
+        reformatBuffer.resize(dstStride * imageHeight);
         coder::Rgba16ToRGBA1010102(reinterpret_cast<const uint16_t *>(imageData.data()),
                                    *stride,
-                                   reinterpret_cast<uint8_t *>(rgba1010102Data.data()),
+                                   reinterpret_cast<uint8_t *>(reformatBuffer.data()),
                                    dstStride,
                                    imageWidth, imageHeight, depth);
         *stride = dstStride;
         *useFloats = false;
         imageConfig = "RGBA_1010102";
-        imageData = rgba1010102Data;
+        imageData.swap(reformatBuffer);
         break;
       } else {
         uint32_t
@@ -177,17 +189,17 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
         uint32_t alignment = 64;
         uint32_t padding = (alignment - (lineWidth % alignment)) % alignment;
         uint32_t dstStride = lineWidth + padding;
-        std::vector<uint8_t> rgba1010102Data(dstStride * imageHeight);
+        reformatBuffer.resize(dstStride * imageHeight);
         coder::Rgba8ToRGBA1010102(reinterpret_cast<const uint8_t *>(imageData.data()),
                                   *stride,
-                                  reinterpret_cast<uint8_t *>(rgba1010102Data.data()),
+                                  reinterpret_cast<uint8_t *>(reformatBuffer.data()),
                                   dstStride,
                                   imageWidth, imageHeight,
                                   !alphaPremultiplied);
         *stride = dstStride;
         *useFloats = false;
         imageConfig = "RGBA_1010102";
-        imageData = rgba1010102Data;
+        imageData.swap(reformatBuffer);
         break;
       }
       break;
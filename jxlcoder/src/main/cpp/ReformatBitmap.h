@@ -38,4 +38,15 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
                     uint32_t imageWidth, uint32_t imageHeight, uint32_t *stride, bool *useFloats,
                     jobject *hwBuffer, bool alphaPremultiplied, const bool hasAlphaInOrigin);
 
+/**
+ * Same as above, but conversions are written into reformatBuffer which then is swapped with imageData,
+ * so callers keeping both buffers alive between calls do not reallocate.
+ */
+void
+ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &imageConfig,
+                    PreferredColorConfig preferredColorConfig, uint32_t depth,
+                    uint32_t imageWidth, uint32_t imageHeight, uint32_t *stride, bool *useFloats,
+                    jobject *hwBuffer, bool alphaPremultiplied, const bool hasAlphaInOrigin,
+                    std::vector<uint8_t> &reformatBuffer);
+
 #endif //AVIF_REFORMATBITMAP_H
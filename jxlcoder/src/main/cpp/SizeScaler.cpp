@@ -35,6 +35,53 @@
 #include "Eigen/Eigen"
 #include "weaver.h"
 
+ScalingFunction XSamplerToScalingFunction(XSampler sampler) {
+  ScalingFunction sparkSampler = ScalingFunction::Bilinear;
+  switch (sampler) {
+    case bilinear: {
+      sparkSampler = ScalingFunction::Bilinear;
+    }
+      break;
+    case nearest: {
+      sparkSampler = ScalingFunction::Nearest;
+    }
+      break;
+    case cubic: {
+      sparkSampler = ScalingFunction::Cubic;
+    }
+      break;
+    case mitchell: {
+      sparkSampler = ScalingFunction::Mitchell;
+    }
+      break;
+    case lanczos: {
+      sparkSampler = ScalingFunction::Lanczos;
+    }
+      break;
+    case catmullRom: {
+      sparkSampler = ScalingFunction::CatmullRom;
+    }
+      break;
+    case hermite: {
+      sparkSampler = ScalingFunction::Hermite;
+    }
+      break;
+    case bSpline: {
+      sparkSampler = ScalingFunction::BSpline;
+    }
+      break;
+    case hann: {
+      sparkSampler = ScalingFunction::Lanczos;
+    }
+      break;
+    case bicubic: {
+      sparkSampler = ScalingFunction::Bicubic;
+    }
+      break;
+  }
+  return sparkSampler;
+}
+
 bool RescaleImage(std::vector<uint8_t> &rgbaData,
                   JNIEnv *env,
                   uint32_t *stride,
@@ -46,52 +93,29 @@ bool RescaleImage(std::vector<uint8_t> &rgbaData,
                   ScaleMode scaleMode,
                   XSampler sampler,
                   bool doesOriginHasAlpha) {
+  return RescaleImage(rgbaData, rgbaData, env, stride, useFloats,
+                      imageWidthPtr, imageHeightPtr,
+                      scaledWidth, scaledHeight,
+                      bitDepth, alphaPremultiplied,
+                      scaleMode, sampler, doesOriginHasAlpha);
+}
+
+bool RescaleImage(const std::vector<uint8_t> &source,
+                  std::vector<uint8_t> &destination,
+                  [[maybe_unused]] JNIEnv *env,
+                  uint32_t *stride,
+                  bool useFloats,
+                  uint32_t *imageWidthPtr, uint32_t *imageHeightPtr,
+                  int scaledWidth, int scaledHeight,
+                  uint32_t bitDepth,
+                  [[maybe_unused]] bool alphaPremultiplied,
+                  ScaleMode scaleMode,
+                  XSampler sampler,
+                  bool doesOriginHasAlpha) {
   uint32_t imageWidth = *imageWidthPtr;
   uint32_t imageHeight = *imageHeightPtr;
   if ((scaledHeight != 0 || scaledWidth != 0) && (scaledWidth != 0 && scaledHeight != 0)) {
-    ScalingFunction sparkSampler = ScalingFunction::Bilinear;
-    switch (sampler) {
-      case bilinear: {
-        sparkSampler = ScalingFunction::Bilinear;
-      }
-        break;
-      case nearest: {
-        sparkSampler = ScalingFunction::Nearest;
-      }
-        break;
-      case cubic: {
-        sparkSampler = ScalingFunction::Cubic;
-      }
-        break;
-      case mitchell: {
-        sparkSampler = ScalingFunction::Mitchell;
-      }
-        break;
-      case lanczos: {
-        sparkSampler = ScalingFunction::Lanczos;
-      }
-        break;
-      case catmullRom: {
-        sparkSampler = ScalingFunction::CatmullRom;
-      }
-        break;
-      case hermite: {
-        sparkSampler = ScalingFunction::Hermite;
-      }
-        break;
-      case bSpline: {
-        sparkSampler = ScalingFunction::BSpline;
-      }
-        break;
-      case hann: {
-        sparkSampler = ScalingFunction::Lanczos;
-      }
-        break;
-      case bicubic: {
-        sparkSampler = ScalingFunction::Bicubic;
-      }
-        break;
-    }
+    ScalingFunction sparkSampler = XSamplerToScalingFunction(sampler);
 
     WeaveScaleMode mScaleMode = WeaveScaleMode::JustResize;
     switch (scaleMode) {
@@ -104,8 +128,8 @@ bool RescaleImage(std::vector<uint8_t> &rgbaData,
     }
 
     if (useFloats) {
-      auto scalingResult = weave_scale_u16(reinterpret_cast<const uint16_t *>(rgbaData.data()),
-                                           (int) imageWidth * 4 * (int) sizeof(uint16_t),
+      auto scalingResult = weave_scale_u16(reinterpret_cast<const uint16_t *>(source.data()),
+                                           (int) *stride,
                                            imageWidth, imageHeight,
                                            scaledWidth, scaledHeight,
                                            bitDepth,
@@ -117,13 +141,13 @@ bool RescaleImage(std::vector<uint8_t> &rgbaData,
       *imageHeightPtr = scalingResult.height;
       *imageWidthPtr = scalingResult.width;
       *stride = scalingResult.stride * 2;
-      rgbaData.resize(scalingResult.length * 2);
-      memcpy(rgbaData.data(), scalingResult.data, scalingResult.length * 2);
+      destination.resize(scalingResult.length * 2);
+      memcpy(destination.data(), scalingResult.data, scalingResult.length * 2);
       weave_scaling_result16_free(scalingResult);
       return true;
     } else {
-      auto scalingResult = weave_scale_u8(reinterpret_cast<const uint8_t *>(rgbaData.data()),
-                                          (int) imageWidth * 4 * (int) sizeof(uint8_t),
+      auto scalingResult = weave_scale_u8(reinterpret_cast<const uint8_t *>(source.data()),
+                                          (int) *stride,
                                           imageWidth, imageHeight,
                                           scaledWidth, scaledHeight,
                                           static_cast<ScalingFunction>(sparkSampler),
@@ -134,8 +158,8 @@ bool RescaleImage(std::vector<uint8_t> &rgbaData,
       *imageHeightPtr = scalingResult.height;
       *imageWidthPtr = scalingResult.width;
       *stride = scalingResult.stride;
-      rgbaData.resize(scalingResult.length);
-      memcpy(rgbaData.data(), scalingResult.data, scalingResult.length);
+      destination.resize(scalingResult.length);
+      memcpy(destination.data(), scalingResult.data, scalingResult.length);
       weave_scaling_result_free(scalingResult);
       return true;
     }
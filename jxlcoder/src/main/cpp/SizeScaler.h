@@ -32,6 +32,7 @@
 #include <vector>
 #include <jni.h>
 #include "XScaler.h"
+#include "weaver.h"
 
 enum ScaleMode {
   Fit = 1,
@@ -51,4 +52,23 @@ bool RescaleImage(std::vector<uint8_t> &rgbaData,
                   XSampler sampler,
                   bool doesOriginHasAlpha);
 
+/**
+ * Scales source into destination, destination only grows when the scaled image does not fit into its capacity,
+ * so it may be kept alive between calls.
+ */
+bool RescaleImage(const std::vector<uint8_t> &source,
+                  std::vector<uint8_t> &destination,
+                  JNIEnv *env,
+                  uint32_t *stride,
+                  bool useFloats,
+                  uint32_t *imageWidthPtr, uint32_t *imageHeightPtr,
+                  int scaledWidth, int scaledHeight,
+                  uint32_t bit_depth,
+                  bool alphaPremultiplied,
+                  ScaleMode scaleMode,
+                  XSampler sampler,
+                  bool doesOriginHasAlpha);
+
+ScalingFunction XSamplerToScalingFunction(XSampler sampler);
+
 #endif //AVIF_SIZESCALER_H
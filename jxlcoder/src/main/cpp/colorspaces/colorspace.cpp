@@ -35,11 +35,10 @@
 
 using namespace std;
 
-void convertUseDefinedColorSpace(std::vector<uint8_t> &vector, uint32_t stride, uint32_t width, uint32_t height,
-                                 const unsigned char *colorSpace, size_t colorSpaceSize,
-                                 bool image16Bits) {
-  cmsContext context = cmsCreateContext(nullptr, nullptr);
-  std::shared_ptr<void> contextPtr(context, [](void *profile) {
+ColorSpaceTransform::ColorSpaceTransform(const unsigned char *colorSpace, size_t colorSpaceSize,
+                                         bool image16Bits) : image16Bits(image16Bits) {
+  cmsContext cmsCtx = cmsCreateContext(nullptr, nullptr);
+  context = std::shared_ptr<void>(cmsCtx, [](void *profile) {
     cmsDeleteContext(reinterpret_cast<cmsContext>(profile));
   });
   cmsHPROFILE srcProfile = cmsOpenProfileFromMem(colorSpace, colorSpaceSize);
@@ -52,35 +51,45 @@ void convertUseDefinedColorSpace(std::vector<uint8_t> &vector, uint32_t stride,
     cmsCloseProfile(reinterpret_cast<cmsHPROFILE>(profile));
   });
   cmsHPROFILE dstProfile = cmsCreate_sRGBProfileTHR(
-      reinterpret_cast<cmsContext>(contextPtr.get()));
+      reinterpret_cast<cmsContext>(context.get()));
   std::shared_ptr<void> ptrDstProfile(dstProfile, [](void *profile) {
     cmsCloseProfile(reinterpret_cast<cmsHPROFILE>(profile));
   });
-  cmsHTRANSFORM transform = cmsCreateTransform(ptrSrcProfile.get(),
-                                               image16Bits ? TYPE_RGBA_16_PREMUL : TYPE_RGBA_8,
-                                               ptrDstProfile.get(),
-                                               image16Bits ? TYPE_RGBA_16_PREMUL : TYPE_RGBA_8,
-                                               INTENT_PERCEPTUAL,
-                                               cmsFLAGS_BLACKPOINTCOMPENSATION |
-                                                   cmsFLAGS_NOWHITEONWHITEFIXUP |
-                                                   cmsFLAGS_COPY_ALPHA);
-  if (!transform) {
+  cmsHTRANSFORM cmsTransform = cmsCreateTransform(ptrSrcProfile.get(),
+                                                  image16Bits ? TYPE_RGBA_16_PREMUL : TYPE_RGBA_8,
+                                                  ptrDstProfile.get(),
+                                                  image16Bits ? TYPE_RGBA_16_PREMUL : TYPE_RGBA_8,
+                                                  INTENT_PERCEPTUAL,
+                                                  cmsFLAGS_BLACKPOINTCOMPENSATION |
+                                                      cmsFLAGS_NOWHITEONWHITEFIXUP |
+                                                      cmsFLAGS_COPY_ALPHA);
+  if (!cmsTransform) {
     // JUST RETURN without signalling error, better proceed with invalid photo than crash
     __android_log_print(ANDROID_LOG_ERROR, "AVIFCoder", "ColorProfile Creation has hailed");
     return;
   }
-  std::shared_ptr<void> ptrTransform(transform, [](void *transform) {
+  transform = std::shared_ptr<void>(cmsTransform, [](void *transform) {
     cmsDeleteTransform(reinterpret_cast<cmsHTRANSFORM>(transform));
   });
+}
 
-  auto mSrcInput = vector.data();
-
+void ColorSpaceTransform::transformInPlace(uint8_t *data, uint32_t stride, uint32_t width, uint32_t height) {
+  if (!transform) {
+    return;
+  }
   concurrency::parallel_for(6, height, [&](int y) {
     cmsDoTransformLineStride(
-        reinterpret_cast<void *>(ptrTransform.get()),
-        reinterpret_cast<const void *>(mSrcInput + stride * y),
-        reinterpret_cast<void *>(mSrcInput + stride * y),
+        reinterpret_cast<void *>(transform.get()),
+        reinterpret_cast<const void *>(data + stride * y),
+        reinterpret_cast<void *>(data + stride * y),
         width, 1,
         stride, stride, 0, 0);
   });
 }
+
+void convertUseDefinedColorSpace(std::vector<uint8_t> &vector, uint32_t stride, uint32_t width, uint32_t height,
+                                 const unsigned char *colorSpace, size_t colorSpaceSize,
+                                 bool image16Bits) {
+  ColorSpaceTransform transform(colorSpace, colorSpaceSize, image16Bits);
+  transform.transformInPlace(vector.data(), stride, width, height);
+}
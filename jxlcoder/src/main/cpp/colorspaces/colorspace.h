@@ -30,9 +30,35 @@
 #define JXLCODER_COLORSPACE_H
 
 #include <vector>
+#include <memory>
+#include <cstdint>
 
 void convertUseDefinedColorSpace(std::vector<uint8_t> &vector, uint32_t stride, uint32_t width, uint32_t height,
                                  const unsigned char *colorSpace, size_t colorSpaceSize,
                                  bool image16Bits);
 
+/**
+ * ICC profile -> sRGB transform which may be kept alive between frames of the same image,
+ * animations share one profile for all frames so building it once per frame is a waste.
+ */
+class ColorSpaceTransform {
+ public:
+  ColorSpaceTransform(const unsigned char *colorSpace, size_t colorSpaceSize, bool image16Bits);
+
+  [[nodiscard]] bool isValid() const {
+    return transform != nullptr;
+  }
+
+  [[nodiscard]] bool is16Bits() const {
+    return image16Bits;
+  }
+
+  void transformInPlace(uint8_t *data, uint32_t stride, uint32_t width, uint32_t height);
+
+ private:
+  std::shared_ptr<void> context;
+  std::shared_ptr<void> transform;
+  bool image16Bits;
+};
+
 #endif //JXLCODER_COLORSPACE_H
\ No newline at end of file
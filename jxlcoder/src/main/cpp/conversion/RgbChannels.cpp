@@ -95,6 +95,142 @@ void RGBAPickChannelFloat32HWY(const hwy::float32_t *JXL_RESTRICT src,
   RGBAPickChannelHWY(t, src, srcStride, dst, dstStride, height, width, channel);
 }
 
+// Rec. 709 luma weights, the integer ones are scaled by 2^16 and sum up to exactly 2^16
+constexpr uint32_t kLumaR = 13933;
+constexpr uint32_t kLumaG = 46871;
+constexpr uint32_t kLumaB = 4732;
+constexpr float kLumaRf = 0.2126f;
+constexpr float kLumaGf = 0.7152f;
+constexpr float kLumaBf = 0.0722f;
+
+template<bool keepAlpha, typename T>
+void RgbaToLumaRowHWY(const T *JXL_RESTRICT src, T *JXL_RESTRICT dst, const uint32_t width) {
+  const ScalableTag<uint32_t> du32;
+  const Rebind<T, decltype(du32)> d;
+  using V32 = Vec<decltype(du32)>;
+  using V = Vec<decltype(d)>;
+  const V32 vLumaR = Set(du32, kLumaR);
+  const V32 vLumaG = Set(du32, kLumaG);
+  const V32 vLumaB = Set(du32, kLumaB);
+  const V32 rounding = Set(du32, 1u << 15);
+
+  uint32_t x = 0;
+  const uint32_t pixels = Lanes(du32);
+  for (; x + pixels <= width; x += pixels) {
+    V r, g, b, a;
+    LoadInterleaved4(d, src, r, g, b, a);
+    const V32 luma = Add(Add(Mul(PromoteTo(du32, r), vLumaR), Mul(PromoteTo(du32, g), vLumaG)),
+                         Add(Mul(PromoteTo(du32, b), vLumaB), rounding));
+    const V gray = DemoteTo(d, ShiftRight<16>(luma));
+    if constexpr (keepAlpha) {
+      StoreInterleaved2(gray, a, d, dst);
+    } else {
+      StoreU(gray, d, dst);
+    }
+    src += 4 * pixels;
+    dst += (keepAlpha ? 2 : 1) * pixels;
+  }
+
+  for (; x < width; ++x) {
+    dst[0] = static_cast<T>((src[0] * kLumaR + src[1] * kLumaG + src[2] * kLumaB + (1u << 15)) >> 16);
+    if constexpr (keepAlpha) {
+      dst[1] = src[3];
+    }
+    src += 4;
+    dst += keepAlpha ? 2 : 1;
+  }
+}
+
+template<bool keepAlpha>
+void RgbaF16ToLumaRowHWY(const uint16_t *JXL_RESTRICT src, uint16_t *JXL_RESTRICT dst, const uint32_t width) {
+  const ScalableTag<float> df32;
+  const Rebind<hwy::float16_t, decltype(df32)> df16;
+  const Rebind<uint16_t, decltype(df32)> du16;
+  using VF32 = Vec<decltype(df32)>;
+  using VU16 = Vec<decltype(du16)>;
+  const VF32 vLumaR = Set(df32, kLumaRf);
+  const VF32 vLumaG = Set(df32, kLumaGf);
+  const VF32 vLumaB = Set(df32, kLumaBf);
+
+  uint32_t x = 0;
+  const uint32_t pixels = Lanes(df32);
+  for (; x + pixels <= width; x += pixels) {
+    VU16 r, g, b, a;
+    LoadInterleaved4(du16, src, r, g, b, a);
+    const VF32 luma = MulAdd(PromoteTo(df32, BitCast(df16, r)), vLumaR,
+                             MulAdd(PromoteTo(df32, BitCast(df16, g)), vLumaG,
+                                    Mul(PromoteTo(df32, BitCast(df16, b)), vLumaB)));
+    const VU16 gray = BitCast(du16, DemoteTo(df16, luma));
+    if constexpr (keepAlpha) {
+      StoreInterleaved2(gray, a, du16, dst);
+    } else {
+      StoreU(gray, du16, dst);
+    }
+    src += 4 * pixels;
+    dst += (keepAlpha ? 2 : 1) * pixels;
+  }
+
+  for (; x < width; ++x) {
+    const float luma = hwy::F32FromF16(hwy::BitCastScalar<hwy::float16_t>(src[0])) * kLumaRf +
+        hwy::F32FromF16(hwy::BitCastScalar<hwy::float16_t>(src[1])) * kLumaGf +
+        hwy::F32FromF16(hwy::BitCastScalar<hwy::float16_t>(src[2])) * kLumaBf;
+    dst[0] = hwy::BitCastScalar<uint16_t>(hwy::F16FromF32(luma));
+    if constexpr (keepAlpha) {
+      dst[1] = src[3];
+    }
+    src += 4;
+    dst += keepAlpha ? 2 : 1;
+  }
+}
+
+template<typename T, typename Row>
+void RgbaToLumaHWY(Row row, const T *JXL_RESTRICT src, const uint32_t srcStride,
+                   T *JXL_RESTRICT dst, const uint32_t dstStride,
+                   const uint32_t width, const uint32_t height) {
+  auto rgbaData = reinterpret_cast<const uint8_t *>(src);
+  auto grayData = reinterpret_cast<uint8_t *>(dst);
+
+  for (uint32_t y = 0; y < height; ++y) {
+    row(reinterpret_cast<const T *>(rgbaData + srcStride * y),
+        reinterpret_cast<T *>(grayData + dstStride * y), width);
+  }
+}
+
+void RGBAToGrayUnsigned8HWY(const uint8_t *JXL_RESTRICT src, const uint32_t srcStride,
+                            uint8_t *JXL_RESTRICT dst, const uint32_t dstStride,
+                            const uint32_t width, const uint32_t height) {
+  RgbaToLumaHWY(RgbaToLumaRowHWY<false, uint8_t>, src, srcStride, dst, dstStride, width, height);
+}
+
+void RGBAToGrayUnsigned16HWY(const uint16_t *JXL_RESTRICT src, const uint32_t srcStride,
+                             uint16_t *JXL_RESTRICT dst, const uint32_t dstStride,
+                             const uint32_t width, const uint32_t height) {
+  RgbaToLumaHWY(RgbaToLumaRowHWY<false, uint16_t>, src, srcStride, dst, dstStride, width, height);
+}
+
+void RGBAToGrayFloat16HWY(const uint16_t *JXL_RESTRICT src, const uint32_t srcStride,
+                          uint16_t *JXL_RESTRICT dst, const uint32_t dstStride,
+                          const uint32_t width, const uint32_t height) {
+  RgbaToLumaHWY(RgbaF16ToLumaRowHWY<false>, src, srcStride, dst, dstStride, width, height);
+}
+
+void RGBAToGrayAlphaUnsigned8HWY(const uint8_t *JXL_RESTRICT src, const uint32_t srcStride,
+                                 uint8_t *JXL_RESTRICT dst, const uint32_t dstStride,
+                                 const uint32_t width, const uint32_t height) {
+  RgbaToLumaHWY(RgbaToLumaRowHWY<true, uint8_t>, src, srcStride, dst, dstStride, width, height);
+}
+
+void RGBAToGrayAlphaUnsigned16HWY(const uint16_t *JXL_RESTRICT src, const uint32_t srcStride,
+                                  uint16_t *JXL_RESTRICT dst, const uint32_t dstStride,
+                                  const uint32_t width, const uint32_t height) {
+  RgbaToLumaHWY(RgbaToLumaRowHWY<true, uint16_t>, src, srcStride, dst, dstStride, width, height);
+}
+
+void RGBAToGrayAlphaFloat16HWY(const uint16_t *JXL_RESTRICT src, const uint32_t srcStride,
+                               uint16_t *JXL_RESTRICT dst, const uint32_t dstStride,
+                               const uint32_t width, const uint32_t height) {
+  RgbaToLumaHWY(RgbaF16ToLumaRowHWY<true>, src, srcStride, dst, dstStride, width, height);
+}
 }
 HWY_AFTER_NAMESPACE();
 
@@ -103,6 +239,12 @@ namespace coder {
 HWY_EXPORT(RGBAPickChannelUnsigned8HWY);
 HWY_EXPORT(RGBAPickChannelUnsigned16HWY);
 HWY_EXPORT(RGBAPickChannelFloat32HWY);
+HWY_EXPORT(RGBAToGrayUnsigned8HWY);
+HWY_EXPORT(RGBAToGrayUnsigned16HWY);
+HWY_EXPORT(RGBAToGrayFloat16HWY);
+HWY_EXPORT(RGBAToGrayAlphaUnsigned8HWY);
+HWY_EXPORT(RGBAToGrayAlphaUnsigned16HWY);
+HWY_EXPORT(RGBAToGrayAlphaFloat16HWY);
 template<class T>
 void RGBAPickChannel(const T *JXL_RESTRICT src,
                      const uint32_t srcStride,
@@ -162,6 +304,105 @@ void RGBAPickChannel(const hwy::float32_t *JXL_RESTRICT src,
                      const uint32_t height,
                      const uint32_t channel);
 
+template<class T>
+static void RGBAToLuma(const T *JXL_RESTRICT src, const uint32_t srcStride,
+                       T *JXL_RESTRICT dst, const uint32_t dstStride,
+                       const uint32_t width, const uint32_t height, const bool keepAlpha) {
+  if (std::is_same<T, uint8_t>::value) {
+    auto s = reinterpret_cast<const uint8_t *>(src);
+    auto d = reinterpret_cast<uint8_t *>(dst);
+    if (keepAlpha) {
+      HWY_DYNAMIC_DISPATCH(RGBAToGrayAlphaUnsigned8HWY)(s, srcStride, d, dstStride, width, height);
+    } else {
+      HWY_DYNAMIC_DISPATCH(RGBAToGrayUnsigned8HWY)(s, srcStride, d, dstStride, width, height);
+    }
+  } else if (std::is_same<T, uint16_t>::value) {
+    auto s = reinterpret_cast<const uint16_t *>(src);
+    auto d = reinterpret_cast<uint16_t *>(dst);
+    if (keepAlpha) {
+      HWY_DYNAMIC_DISPATCH(RGBAToGrayAlphaUnsigned16HWY)(s, srcStride, d, dstStride, width, height);
+    } else {
+      HWY_DYNAMIC_DISPATCH(RGBAToGrayUnsigned16HWY)(s, srcStride, d, dstStride, width, height);
+    }
+  } else if (std::is_same<T, hwy::float16_t>::value) {
+    auto s = reinterpret_cast<const uint16_t *>(src);
+    auto d = reinterpret_cast<uint16_t *>(dst);
+    if (keepAlpha) {
+      HWY_DYNAMIC_DISPATCH(RGBAToGrayAlphaFloat16HWY)(s, srcStride, d, dstStride, width, height);
+    } else {
+      HWY_DYNAMIC_DISPATCH(RGBAToGrayFloat16HWY)(s, srcStride, d, dstStride, width, height);
+    }
+  }
+}
+
+template<class T>
+void RGBAToGray(const T *JXL_RESTRICT src,
+                const uint32_t srcStride,
+                T *JXL_RESTRICT dst,
+                const uint32_t dstStride,
+                const uint32_t width,
+                const uint32_t height) {
+  RGBAToLuma(src, srcStride, dst, dstStride, width, height, false);
+}
+
+template<class T>
+void RGBAToGrayAlpha(const T *JXL_RESTRICT src,
+                     const uint32_t srcStride,
+                     T *JXL_RESTRICT dst,
+                     const uint32_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height) {
+  RGBAToLuma(src, srcStride, dst, dstStride, width, height, true);
+}
+
+template
+void RGBAToGray(const uint8_t *JXL_RESTRICT src,
+                const uint32_t srcStride,
+                uint8_t *JXL_RESTRICT dst,
+                const uint32_t dstStride,
+                const uint32_t width,
+                const uint32_t height);
+
+template
+void RGBAToGray(const uint16_t *JXL_RESTRICT src,
+                const uint32_t srcStride,
+                uint16_t *JXL_RESTRICT dst,
+                const uint32_t dstStride,
+                const uint32_t width,
+                const uint32_t height);
+
+template
+void RGBAToGray(const hwy::float16_t *JXL_RESTRICT src,
+                const uint32_t srcStride,
+                hwy::float16_t *JXL_RESTRICT dst,
+                const uint32_t dstStride,
+                const uint32_t width,
+                const uint32_t height);
+
+template
+void RGBAToGrayAlpha(const uint8_t *JXL_RESTRICT src,
+                     const uint32_t srcStride,
+                     uint8_t *JXL_RESTRICT dst,
+                     const uint32_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height);
+
+template
+void RGBAToGrayAlpha(const uint16_t *JXL_RESTRICT src,
+                     const uint32_t srcStride,
+                     uint16_t *JXL_RESTRICT dst,
+                     const uint32_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height);
+
+template
+void RGBAToGrayAlpha(const hwy::float16_t *JXL_RESTRICT src,
+                     const uint32_t srcStride,
+                     hwy::float16_t *JXL_RESTRICT dst,
+                     const uint32_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height);
+
 }
 
-#endif
\ No newline at end of file
+#endif
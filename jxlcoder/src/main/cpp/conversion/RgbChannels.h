@@ -16,4 +16,26 @@ void RGBAPickChannel(const T *JXL_RESTRICT src,
                      const uint32_t width,
                      const uint32_t height,
                      const uint32_t channel);
+
+/**
+ * Rec. 709 luma of R, G, B, `T` is uint8_t, uint16_t or hwy::float16_t
+ */
+template<class T>
+void RGBAToGray(const T *JXL_RESTRICT src,
+                const uint32_t srcStride,
+                T *JXL_RESTRICT dst,
+                const uint32_t dstStride,
+                const uint32_t width,
+                const uint32_t height);
+
+/**
+ * Rec. 709 luma of R, G, B and alpha, interleaved, `T` is uint8_t, uint16_t or hwy::float16_t
+ */
+template<class T>
+void RGBAToGrayAlpha(const T *JXL_RESTRICT src,
+                     const uint32_t srcStride,
+                     T *JXL_RESTRICT dst,
+                     const uint32_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height);
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "BlendRgba.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "conversion/ConversionUtils.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "imagebit/BlendRgba.cpp"
+
+#include "hwy/foreach_target.h"  // IWYU pragma: keep
+#include "hwy/highway.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace coder::HWY_NAMESPACE {
+
+using namespace hwy::HWY_NAMESPACE;
+
+template<bool premultiplied>
+void BlendOverRowHWY(const uint8_t *JXL_RESTRICT src, uint8_t *JXL_RESTRICT dst, const uint32_t width) {
+  const ScalableTag<float> df;
+  const Rebind<int32_t, decltype(df)> di32;
+  const Rebind<uint8_t, decltype(df)> du8;
+  using VF = Vec<decltype(df)>;
+  using VU8 = Vec<decltype(du8)>;
+
+  const VF ones = Set(df, 1.f);
+  const VF maxColors = Set(df, 255.f);
+  const VF zeros = Zero(df);
+
+  const auto toFloat = [&](VU8 v) -> VF {
+    return ConvertTo(df, PromoteTo(di32, v));
+  };
+
+  const auto toU8 = [&](VF v) -> VU8 {
+    return DemoteTo(du8, NearestInt(Min(Max(v, zeros), maxColors)));
+  };
+
+  const uint32_t pixels = Lanes(df);
+  const VU8 opaque = Set(du8, 255);
+  const VU8 transparent = Zero(du8);
+  uint32_t x = 0;
+
+  for (; x + pixels <= width; x += pixels) {
+    VU8 sr8, sg8, sb8, sa8;
+    VU8 dr8, dg8, db8, da8;
+    LoadInterleaved4(du8, src, sr8, sg8, sb8, sa8);
+
+    // Animation frames are mostly opaque or fully transparent, both skip the arithmetic
+    if (AllTrue(du8, Eq(sa8, opaque))) {
+      StoreInterleaved4(sr8, sg8, sb8, sa8, du8, dst);
+      src += 4 * pixels;
+      dst += 4 * pixels;
+      continue;
+    }
+    if (!premultiplied && AllTrue(du8, Eq(sa8, transparent))) {
+      src += 4 * pixels;
+      dst += 4 * pixels;
+      continue;
+    }
+
+    LoadInterleaved4(du8, dst, dr8, dg8, db8, da8);
+
+    const VF sa = Div(toFloat(sa8), maxColors);
+    const VF da = Div(toFloat(da8), maxColors);
+    const VF invSa = Sub(ones, sa);
+
+    VF r, g, b, a;
+    if (premultiplied) {
+      r = MulAdd(toFloat(dr8), invSa, toFloat(sr8));
+      g = MulAdd(toFloat(dg8), invSa, toFloat(sg8));
+      b = MulAdd(toFloat(db8), invSa, toFloat(sb8));
+      a = MulAdd(da, invSa, sa);
+    } else {
+      // a = sa + da * (1 - sa); c = (cs * sa + cd * da * (1 - sa)) / a
+      const VF dw = Mul(da, invSa);
+      a = Add(sa, dw);
+      const auto hasAlpha = Gt(a, zeros);
+      const VF scale = Div(ones, IfThenElse(hasAlpha, a, ones));
+      // Fully transparent result keeps destination colors untouched
+      const VF dr = toFloat(dr8);
+      const VF dg = toFloat(dg8);
+      const VF db = toFloat(db8);
+      r = IfThenElse(hasAlpha, Mul(MulAdd(toFloat(sr8), sa, Mul(dr, dw)), scale), dr);
+      g = IfThenElse(hasAlpha, Mul(MulAdd(toFloat(sg8), sa, Mul(dg, dw)), scale), dg);
+      b = IfThenElse(hasAlpha, Mul(MulAdd(toFloat(sb8), sa, Mul(db, dw)), scale), db);
+    }
+
+    StoreInterleaved4(toU8(r), toU8(g), toU8(b), toU8(Mul(a, maxColors)), du8, dst);
+
+    src += 4 * pixels;
+    dst += 4 * pixels;
+  }
+
+  for (; x < width; ++x) {
+    const float sa = static_cast<float>(src[3]) / 255.f;
+    const float da = static_cast<float>(dst[3]) / 255.f;
+    const float invSa = 1.f - sa;
+    float a;
+    if (premultiplied) {
+      a = sa + da * invSa;
+      for (int c = 0; c < 3; ++c) {
+        dst[c] = static_cast<uint8_t>(std::clamp(std::roundf(src[c] + dst[c] * invSa), 0.f, 255.f));
+      }
+    } else {
+      const float dw = da * invSa;
+      a = sa + dw;
+      if (a > 0.f) {
+        const float scale = 1.f / a;
+        for (int c = 0; c < 3; ++c) {
+          dst[c] = static_cast<uint8_t>(std::clamp(std::roundf((src[c] * sa + dst[c] * dw) * scale), 0.f, 255.f));
+        }
+      }
+    }
+    dst[3] = static_cast<uint8_t>(std::clamp(std::roundf(a * 255.f), 0.f, 255.f));
+    src += 4;
+    dst += 4;
+  }
+}
+
+void BlendOverRgba8HWY(const uint8_t *src, const uint32_t srcStride,
+                       uint8_t *dst, const uint32_t dstStride,
+                       const uint32_t width, const uint32_t height) {
+  for (uint32_t y = 0; y < height; ++y) {
+    BlendOverRowHWY<false>(src + y * srcStride, dst + y * dstStride, width);
+  }
+}
+
+void BlendOverPremultipliedRgba8HWY(const uint8_t *src, const uint32_t srcStride,
+                                    uint8_t *dst, const uint32_t dstStride,
+                                    const uint32_t width, const uint32_t height) {
+  for (uint32_t y = 0; y < height; ++y) {
+    BlendOverRowHWY<true>(src + y * srcStride, dst + y * dstStride, width);
+  }
+}
+
+}
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace coder {
+HWY_EXPORT(BlendOverRgba8HWY);
+HWY_EXPORT(BlendOverPremultipliedRgba8HWY);
+
+void BlendOverRgba8(const uint8_t *src, uint32_t srcStride,
+                    uint8_t *dst, uint32_t dstStride,
+                    uint32_t width, uint32_t height) {
+  HWY_DYNAMIC_DISPATCH(BlendOverRgba8HWY)(src, srcStride, dst, dstStride, width, height);
+}
+
+void BlendOverPremultipliedRgba8(const uint8_t *src, uint32_t srcStride,
+                                 uint8_t *dst, uint32_t dstStride,
+                                 uint32_t width, uint32_t height) {
+  HWY_DYNAMIC_DISPATCH(BlendOverPremultipliedRgba8HWY)(src, srcStride, dst, dstStride, width, height);
+}
+
+void ReplaceRgba8(const uint8_t *src, uint32_t srcStride,
+                  uint8_t *dst, uint32_t dstStride,
+                  uint32_t width, uint32_t height) {
+  for (uint32_t y = 0; y < height; ++y) {
+    std::memcpy(dst + y * dstStride, src + y * srcStride, width * 4 * sizeof(uint8_t));
+  }
+}
+
+void ClearRgba8(uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height) {
+  for (uint32_t y = 0; y < height; ++y) {
+    std::memset(dst + y * dstStride, 0, width * 4 * sizeof(uint8_t));
+  }
+}
+}
+#endif
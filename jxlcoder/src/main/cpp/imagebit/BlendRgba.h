@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_BLENDRGBA_H
+#define JXLCODER_BLENDRGBA_H
+
+#include <cstdint>
+
+namespace coder {
+/**
+ * Composites src over dst in place, straight ( unassociated ) alpha RGBA8.
+ * This is JXL kBlend and APNG OP_OVER.
+ */
+void BlendOverRgba8(const uint8_t *src, uint32_t srcStride,
+                    uint8_t *dst, uint32_t dstStride,
+                    uint32_t width, uint32_t height);
+
+/**
+ * Composites src over dst in place, both are premultiplied RGBA8.
+ */
+void BlendOverPremultipliedRgba8(const uint8_t *src, uint32_t srcStride,
+                                 uint8_t *dst, uint32_t dstStride,
+                                 uint32_t width, uint32_t height);
+
+/**
+ * Replaces dst rect with src, JXL kReplace and APNG OP_SOURCE.
+ */
+void ReplaceRgba8(const uint8_t *src, uint32_t srcStride,
+                  uint8_t *dst, uint32_t dstStride,
+                  uint32_t width, uint32_t height);
+
+/**
+ * Fills dst rect with transparent black, APNG DISPOSE_OP_BACKGROUND and cleared JXL references.
+ */
+void ClearRgba8(uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height);
+}
+
+#endif //JXLCODER_BLENDRGBA_H
@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "FrameDiff.h"
+#include <algorithm>
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "imagebit/FrameDiff.cpp"
+
+#include "hwy/foreach_target.h"  // IWYU pragma: keep
+#include "hwy/highway.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace coder::HWY_NAMESPACE {
+
+using namespace hwy::HWY_NAMESPACE;
+
+/**
+ * Index of the first differing byte or -1
+ */
+intptr_t FirstDifferenceHWY(const uint8_t *first, const uint8_t *second, const size_t length) {
+  const ScalableTag<uint8_t> du8;
+  const size_t lanes = Lanes(du8);
+  size_t x = 0;
+  for (; x + lanes <= length; x += lanes) {
+    const intptr_t found = FindFirstTrue(du8, Ne(LoadU(du8, first + x), LoadU(du8, second + x)));
+    if (found >= 0) {
+      return static_cast<intptr_t>(x) + found;
+    }
+  }
+  for (; x < length; ++x) {
+    if (first[x] != second[x]) {
+      return static_cast<intptr_t>(x);
+    }
+  }
+  return -1;
+}
+
+/**
+ * Index of the last differing byte or -1
+ */
+intptr_t LastDifferenceHWY(const uint8_t *first, const uint8_t *second, const size_t length) {
+  const ScalableTag<uint8_t> du8;
+  const size_t lanes = Lanes(du8);
+  size_t x = length;
+  while (x >= lanes) {
+    x -= lanes;
+    const intptr_t found = FindLastTrue(du8, Ne(LoadU(du8, first + x), LoadU(du8, second + x)));
+    if (found >= 0) {
+      return static_cast<intptr_t>(x) + found;
+    }
+  }
+  while (x > 0) {
+    --x;
+    if (first[x] != second[x]) {
+      return static_cast<intptr_t>(x);
+    }
+  }
+  return -1;
+}
+
+}
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace coder {
+HWY_EXPORT(FirstDifferenceHWY);
+HWY_EXPORT(LastDifferenceHWY);
+
+bool FindChangedRect(const uint8_t *previous, const uint8_t *current, size_t stride,
+                     uint32_t width, uint32_t height, uint32_t pixelSize, FrameRect &rect) {
+  if (width == 0 || height == 0) {
+    return false;
+  }
+  const size_t rowBytes = static_cast<size_t>(width) * pixelSize;
+  auto firstDifference = HWY_DYNAMIC_DISPATCH(FirstDifferenceHWY);
+  auto lastDifference = HWY_DYNAMIC_DISPATCH(LastDifferenceHWY);
+
+  uint32_t top = 0;
+  intptr_t left = -1;
+  for (; top < height; ++top) {
+    left = firstDifference(previous + top * stride, current + top * stride, rowBytes);
+    if (left >= 0) {
+      break;
+    }
+  }
+  if (top == height) {
+    return false;
+  }
+  intptr_t right = lastDifference(previous + top * stride, current + top * stride, rowBytes);
+
+  uint32_t bottom = height - 1;
+  for (; bottom > top; --bottom) {
+    const intptr_t last = lastDifference(previous + bottom * stride, current + bottom * stride, rowBytes);
+    if (last >= 0) {
+      right = std::max(right, last);
+      left = std::min(left, firstDifference(previous + bottom * stride, current + bottom * stride, rowBytes));
+      break;
+    }
+  }
+
+  // Rows in between only have to be searched outside of the columns already known to change
+  const auto lastByte = static_cast<intptr_t>(rowBytes) - 1;
+  for (uint32_t y = top + 1; y < bottom && (left > 0 || right < lastByte); ++y) {
+    const uint8_t *previousRow = previous + y * stride;
+    const uint8_t *currentRow = current + y * stride;
+    if (left > 0) {
+      const intptr_t first = firstDifference(previousRow, currentRow, static_cast<size_t>(left));
+      if (first >= 0) {
+        left = first;
+      }
+    }
+    if (right < lastByte) {
+      const intptr_t last = lastDifference(previousRow + right + 1, currentRow + right + 1,
+                                           static_cast<size_t>(lastByte - right));
+      if (last >= 0) {
+        right += 1 + last;
+      }
+    }
+  }
+
+  rect.x = static_cast<uint32_t>(left) / pixelSize;
+  rect.y = top;
+  rect.width = static_cast<uint32_t>(right) / pixelSize - rect.x + 1;
+  rect.height = bottom - top + 1;
+  return true;
+}
+
+}
+#endif
@@ -64,6 +64,21 @@ void UnassociateRgba8(const uint8_t *src, uint32_t srcStride,
   }
 }
 
+bool IsRgba8Opaque(const uint8_t *src, uint32_t srcStride, uint32_t width, uint32_t height) {
+  for (uint32_t y = 0; y < height; ++y) {
+    auto mSrc = reinterpret_cast<const uint8_t *>(src) + y * srcStride;
+    // Branchless over the row so compiler may vectorize it
+    uint8_t rowAlpha = 255;
+    for (uint32_t x = 0; x < width; ++x) {
+      rowAlpha &= mSrc[x * 4 + 3];
+    }
+    if (rowAlpha != 255) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void AssociateAlphaRgba8(const uint8_t *src, uint32_t srcStride,
                          uint8_t *dst, uint32_t dstStride, uint32_t width,
                          uint32_t height) {
@@ -40,6 +40,11 @@ void AssociateAlphaRgba8(const uint8_t *src, uint32_t srcStride,
                          uint8_t *dst, uint32_t dstStride, uint32_t width,
                          uint32_t height);
 
+/**
+ * True when every pixel alpha is 255, stops on the first row which is not
+ */
+bool IsRgba8Opaque(const uint8_t *src, uint32_t srcStride, uint32_t width, uint32_t height);
+
 void AssociateAlphaRgba16(const uint16_t *src, uint32_t srcStride,
                           uint16_t *dst, uint32_t dstStride, uint32_t width,
                           uint32_t height, uint32_t bitDepth);
@@ -27,8 +27,82 @@
  */
 
 #include "ScanAlpha.h"
+#include <algorithm>
 #include <limits>
 
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "imagebit/ScanAlpha.cpp"
+
+#include "hwy/foreach_target.h"  // IWYU pragma: keep
+#include "hwy/highway.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace coder::HWY_NAMESPACE {
+
+using namespace hwy::HWY_NAMESPACE;
+
+/**
+ * Lowest alpha and widest R, G, B spread of the row, spread of translucent pixels is either 0 or 255
+ */
+void ScanRgba8RowHWY(const uint8_t *src, const uint32_t width, uint8_t *minAlpha, uint8_t *maxSpread) {
+  const ScalableTag<uint8_t> du8;
+  using VU8 = Vec<decltype(du8)>;
+
+  const VU8 opaque = Set(du8, 255);
+  VU8 alphas = opaque;
+  VU8 spreads = Zero(du8);
+
+  const uint32_t pixels = Lanes(du8);
+  uint32_t x = 0;
+
+  for (; x + pixels <= width; x += pixels) {
+    VU8 r, g, b, a;
+    LoadInterleaved4(du8, src, r, g, b, a);
+    alphas = Min(alphas, a);
+    const VU8 spread = Sub(Max(Max(r, g), b), Min(Min(r, g), b));
+    // Any difference of a translucent pixel is widest so tolerance never covers it
+    spreads = Max(spreads, IfThenElse(Eq(a, opaque), spread, VecFromMask(du8, Gt(spread, Zero(du8)))));
+    src += 4 * pixels;
+  }
+
+  uint8_t alpha = ReduceMin(du8, alphas);
+  uint8_t spread = ReduceMax(du8, spreads);
+
+  for (; x < width; ++x) {
+    alpha = std::min(alpha, src[3]);
+    uint8_t pixelSpread = std::max({src[0], src[1], src[2]}) - std::min({src[0], src[1], src[2]});
+    if (src[3] != 255 && pixelSpread != 0) {
+      pixelSpread = 255;
+    }
+    spread = std::max(spread, pixelSpread);
+    src += 4;
+  }
+
+  *minAlpha = alpha;
+  *maxSpread = spread;
+}
+
+}
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace coder {
+HWY_EXPORT(ScanRgba8RowHWY);
+
+RgbaScanResult ScanRgba8(const uint8_t *src, uint32_t stride, uint32_t width, uint32_t height,
+                         bool checkOpaque, bool checkGray, uint8_t grayTolerance) {
+  RgbaScanResult result = {checkOpaque, checkGray};
+  for (uint32_t y = 0; y < height && (result.opaque || result.gray); ++y) {
+    uint8_t minAlpha, maxSpread;
+    HWY_DYNAMIC_DISPATCH(ScanRgba8RowHWY)(src + static_cast<size_t>(y) * stride, width, &minAlpha, &maxSpread);
+    result.opaque = result.opaque && minAlpha == 255;
+    result.gray = result.gray && maxSpread <= grayTolerance;
+  }
+  return result;
+}
+
+}
+
 template<typename T>
 bool isImageHasAlpha(T *image, uint32_t stride, uint32_t width, uint32_t height) {
   T firstItem = image[3];
@@ -51,4 +125,5 @@ bool isImageHasAlpha(T *image, uint32_t stride, uint32_t width, uint32_t height)
 }
 
 template bool isImageHasAlpha(uint8_t *image, uint32_t stride, uint32_t width, uint32_t height);
-template bool isImageHasAlpha(uint16_t *image, uint32_t stride, uint32_t width, uint32_t height);
\ No newline at end of file
+template bool isImageHasAlpha(uint16_t *image, uint32_t stride, uint32_t width, uint32_t height);
+#endif
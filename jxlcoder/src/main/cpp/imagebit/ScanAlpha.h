@@ -34,4 +34,22 @@
 template<typename T>
 bool isImageHasAlpha(T* image, uint32_t stride, uint32_t width, uint32_t height);
 
+namespace coder {
+
+struct RgbaScanResult {
+  bool opaque;
+  bool gray;
+};
+
+/**
+ * Finds in one pass whether every alpha is 255 and whether every pixel has R, G, B
+ * no further apart than `grayTolerance`, stops as soon as both checked answers are false.
+ * Translucent pixels are premultiplied so their R, G, B must be equal whatever the tolerance is.
+ * Unchecked answers are reported as false.
+ */
+RgbaScanResult ScanRgba8(const uint8_t *src, uint32_t stride, uint32_t width, uint32_t height,
+                         bool checkOpaque, bool checkGray, uint8_t grayTolerance);
+
+}
+
 #endif //AVIF_AVIF_CODER_SRC_MAIN_CPP_IMAGEBITS_SCANALPHA_H_
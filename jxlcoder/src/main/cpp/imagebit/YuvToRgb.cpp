@@ -0,0 +1,181 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "YuvToRgb.h"
+#include <algorithm>
+#include <cmath>
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "imagebit/YuvToRgb.cpp"
+
+#include "hwy/foreach_target.h"  // IWYU pragma: keep
+#include "hwy/highway.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace coder::HWY_NAMESPACE {
+
+using namespace hwy::HWY_NAMESPACE;
+
+template<typename D, typename V = Vec<D>>
+HWY_INLINE void YuvToRgbVec(D df, V y, V u, V v, const YuvToRgbCoefficients &c, V &r, V &g, V &b) {
+  const V maxValue = Set(df, c.maxValue);
+  const V zeros = Zero(df);
+  const V luma = Mul(Sub(y, Set(df, c.yBias)), Set(df, c.yScale));
+  const V cb = Sub(u, Set(df, c.cBias));
+  const V cr = Sub(v, Set(df, c.cBias));
+  r = Clamp(MulAdd(cr, Set(df, c.crR), luma), zeros, maxValue);
+  g = Clamp(NegMulAdd(cr, Set(df, c.crG), NegMulAdd(cb, Set(df, c.cbG), luma)), zeros, maxValue);
+  b = Clamp(MulAdd(cb, Set(df, c.cbB), luma), zeros, maxValue);
+}
+
+template<typename T>
+HWY_INLINE void YuvPixelToRgb(float y, float u, float v, const YuvToRgbCoefficients &c, T *dst) {
+  const float luma = (y - c.yBias) * c.yScale;
+  const float cb = u - c.cBias;
+  const float cr = v - c.cBias;
+  dst[0] = static_cast<T>(std::roundf(std::clamp(luma + c.crR * cr, 0.f, c.maxValue)));
+  dst[1] = static_cast<T>(std::roundf(std::clamp(luma - c.cbG * cb - c.crG * cr, 0.f, c.maxValue)));
+  dst[2] = static_cast<T>(std::roundf(std::clamp(luma + c.cbB * cb, 0.f, c.maxValue)));
+}
+
+void YuvRowToRgb8HWY(const uint8_t *y, const uint16_t *u, const uint16_t *v,
+                     uint8_t *dst, const uint32_t width, const YuvToRgbCoefficients &c) {
+  const ScalableTag<float> df;
+  const RebindToSigned<decltype(df)> di32;
+  const Rebind<uint8_t, decltype(df)> du8;
+  const Rebind<uint16_t, decltype(df)> du16;
+  using VF = Vec<decltype(df)>;
+
+  const uint32_t pixels = Lanes(df);
+  uint32_t x = 0;
+
+  for (; x + pixels <= width; x += pixels) {
+    VF fy = ConvertTo(df, PromoteTo(di32, LoadU(du8, y + x)));
+    VF fu = ConvertTo(df, PromoteTo(di32, LoadU(du16, u + x)));
+    VF fv = ConvertTo(df, PromoteTo(di32, LoadU(du16, v + x)));
+    VF r, g, b;
+    YuvToRgbVec(df, fy, fu, fv, c, r, g, b);
+    StoreInterleaved3(DemoteTo(du8, NearestInt(r)), DemoteTo(du8, NearestInt(g)),
+                      DemoteTo(du8, NearestInt(b)), du8, dst + 3 * x);
+  }
+
+  for (; x < width; ++x) {
+    YuvPixelToRgb(static_cast<float>(y[x]), static_cast<float>(u[x]), static_cast<float>(v[x]), c, dst + 3 * x);
+  }
+}
+
+void YuvRowToRgb16HWY(const uint16_t *y, const uint32_t yShift, const uint16_t *u, const uint16_t *v,
+                      uint16_t *dst, const uint32_t width, const YuvToRgbCoefficients &c) {
+  const ScalableTag<float> df;
+  const RebindToSigned<decltype(df)> di32;
+  const Rebind<uint16_t, decltype(df)> du16;
+  using VF = Vec<decltype(df)>;
+
+  const uint32_t pixels = Lanes(df);
+  const int shift = static_cast<int>(yShift);
+  uint32_t x = 0;
+
+  for (; x + pixels <= width; x += pixels) {
+    VF fy = ConvertTo(df, PromoteTo(di32, ShiftRightSame(LoadU(du16, y + x), shift)));
+    VF fu = ConvertTo(df, PromoteTo(di32, LoadU(du16, u + x)));
+    VF fv = ConvertTo(df, PromoteTo(di32, LoadU(du16, v + x)));
+    VF r, g, b;
+    YuvToRgbVec(df, fy, fu, fv, c, r, g, b);
+    StoreInterleaved3(DemoteTo(du16, NearestInt(r)), DemoteTo(du16, NearestInt(g)),
+                      DemoteTo(du16, NearestInt(b)), du16, dst + 3 * x);
+  }
+
+  for (; x < width; ++x) {
+    YuvPixelToRgb(static_cast<float>(y[x] >> yShift), static_cast<float>(u[x]), static_cast<float>(v[x]),
+                  c, dst + 3 * x);
+  }
+}
+
+}
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+#include "colorspaces/ITUR.h"
+#include "colorspaces/ColorSpaceProfile.h"
+
+namespace coder {
+HWY_EXPORT(YuvRowToRgb8HWY);
+HWY_EXPORT(YuvRowToRgb16HWY);
+
+YuvToRgbCoefficients MakeYuvToRgbCoefficients(YuvMatrix matrix, bool fullRange,
+                                              uint32_t bitDepth, uint32_t outputBitDepth) {
+  ITURColorCoefficients coeffs;
+  switch (matrix) {
+    case YUV_MATRIX_BT709:
+      coeffs = colorPrimariesComputeYCoeffs(getRec709Primaries(), getIlluminantD65());
+      break;
+    case YUV_MATRIX_BT2020:
+      coeffs = colorPrimariesComputeYCoeffs(getRec2020Primaries(), getIlluminantD65());
+      break;
+    default:
+      // BT.601 keeps the rounded 1953 NTSC weights which are not exactly derivable from any primaries
+      coeffs = {.kr = 0.299f, .kb = 0.114f, .kg = 1.f - 0.299f - 0.114f};
+      break;
+  }
+
+  const float maxIn = static_cast<float>((1u << bitDepth) - 1);
+  const float outScale = static_cast<float>((1u << outputBitDepth) - 1) / maxIn;
+  const uint32_t rangeShift = bitDepth - 8;
+  float yBias = 0.f;
+  float yScale = outScale;
+  float cScale = outScale;
+  if (!fullRange) {
+    yBias = static_cast<float>(16u << rangeShift);
+    yScale = maxIn / static_cast<float>(219u << rangeShift) * outScale;
+    cScale = maxIn / static_cast<float>(224u << rangeShift) * outScale;
+  }
+
+  return {
+      .yBias = yBias,
+      .yScale = yScale,
+      .cBias = static_cast<float>(1u << (bitDepth - 1)),
+      .crR = 2.f * (1.f - coeffs.kr) * cScale,
+      .cbG = 2.f * coeffs.kb * (1.f - coeffs.kb) / coeffs.kg * cScale,
+      .crG = 2.f * coeffs.kr * (1.f - coeffs.kr) / coeffs.kg * cScale,
+      .cbB = 2.f * (1.f - coeffs.kb) * cScale,
+      .maxValue = static_cast<float>((1u << outputBitDepth) - 1),
+  };
+}
+
+void YuvRowToRgb8(const uint8_t *y, const uint16_t *u, const uint16_t *v,
+                  uint8_t *dst, uint32_t width, const YuvToRgbCoefficients &coefficients) {
+  HWY_DYNAMIC_DISPATCH(YuvRowToRgb8HWY)(y, u, v, dst, width, coefficients);
+}
+
+void YuvRowToRgb16(const uint16_t *y, uint32_t yShift, const uint16_t *u, const uint16_t *v,
+                   uint16_t *dst, uint32_t width, const YuvToRgbCoefficients &coefficients) {
+  HWY_DYNAMIC_DISPATCH(YuvRowToRgb16HWY)(y, yShift, u, v, dst, width, coefficients);
+}
+
+}
+#endif
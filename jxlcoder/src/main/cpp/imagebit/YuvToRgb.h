@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_YUVTORGB_H
+#define JXLCODER_YUVTORGB_H
+
+#include <cstdint>
+
+namespace coder {
+
+/**
+ * Y'CbCr matrix of the frame, BT.709 and BT.2020 Kr and Kb are derived from their primaries
+ */
+enum YuvMatrix {
+  YUV_MATRIX_BT601 = 1,
+  YUV_MATRIX_BT709 = 2,
+  YUV_MATRIX_BT2020 = 3
+};
+
+/**
+ * Ready to use factors, ranges and the output bit depth are already folded in
+ */
+struct YuvToRgbCoefficients {
+  float yBias;
+  float yScale;
+  float cBias;
+  float crR;
+  float cbG;
+  float crG;
+  float cbB;
+  float maxValue;
+};
+
+YuvToRgbCoefficients MakeYuvToRgbCoefficients(YuvMatrix matrix, bool fullRange,
+                                              uint32_t bitDepth, uint32_t outputBitDepth);
+
+/**
+ * Converts a row into interleaved RGB, chroma must be already upsampled to one sample per pixel
+ */
+void YuvRowToRgb8(const uint8_t *y, const uint16_t *u, const uint16_t *v,
+                  uint8_t *dst, uint32_t width, const YuvToRgbCoefficients &coefficients);
+
+/**
+ * Same for 16 bit samples, Y is shifted right by `yShift` first, e.g. by 6 for P010.
+ * U and V are expected to be already shifted.
+ */
+void YuvRowToRgb16(const uint16_t *y, uint32_t yShift, const uint16_t *u, const uint16_t *v,
+                   uint16_t *dst, uint32_t width, const YuvToRgbCoefficients &coefficients);
+
+}
+
+#endif //JXLCODER_YUVTORGB_H
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "ByteInput.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace coder {
+
+static constexpr size_t kStreamStagingSize = 64 * 1024;
+
+size_t MemoryByteInput::read(uint8_t *data, size_t length) {
+  const size_t count = std::min(length, source->size() - position);
+  std::memcpy(data, source->data() + position, count);
+  position += count;
+  return count;
+}
+
+size_t StreamByteInput::read(uint8_t *data, size_t length) {
+  if (offset == available) {
+    staging.resize(kStreamStagingSize);
+    ssize_t result;
+    do {
+      result = ::read(fd, staging.data(), staging.size());
+    } while (result < 0 && errno == EINTR);
+    if (result <= 0) {
+      return 0;
+    }
+    offset = 0;
+    available = static_cast<size_t>(result);
+  }
+  const size_t count = std::min(length, available - offset);
+  std::memcpy(data, staging.data() + offset, count);
+  offset += count;
+  return count;
+}
+
+}
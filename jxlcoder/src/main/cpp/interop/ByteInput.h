@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_BYTEINPUT_H
+#define JXLCODER_BYTEINPUT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ByteSource.hpp"
+
+namespace coder {
+
+/**
+ * Sequential reader of the encoded input, decoders pull bytes from it as they parse
+ * so a stream is never gathered into memory as a whole
+ */
+class ByteInput {
+ public:
+  virtual ~ByteInput() = default;
+
+  /**
+   * Copies at most length bytes, returns the count, zero at the end of the data
+   */
+  virtual size_t read(uint8_t *data, size_t length) = 0;
+};
+
+/**
+ * Cursor over bytes already in memory: a copied array, a direct buffer or a mapped file
+ */
+class MemoryByteInput : public ByteInput {
+ public:
+  explicit MemoryByteInput(std::shared_ptr<ByteSource> source) : source(std::move(source)) {}
+
+  size_t read(uint8_t *data, size_t length) override;
+
+ private:
+  std::shared_ptr<ByteSource> source;
+  size_t position = 0;
+};
+
+/**
+ * Reads a file descriptor sequentially through a staging buffer, for pipes and sockets which cannot be mapped
+ */
+class StreamByteInput : public ByteInput {
+ public:
+  explicit StreamByteInput(int fd) : fd(fd) {}
+
+  size_t read(uint8_t *data, size_t length) override;
+
+ private:
+  int fd;
+  std::vector<uint8_t> staging;
+  size_t offset = 0;
+  size_t available = 0;
+};
+
+}
+
+#endif //JXLCODER_BYTEINPUT_H
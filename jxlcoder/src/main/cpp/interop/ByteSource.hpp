@@ -0,0 +1,71 @@
+//
+//  ByteSource.hpp
+//  jxl-coder [https://github.com/awxkee/jxl-coder]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#ifndef ByteSource_hpp
+#define ByteSource_hpp
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace coder {
+
+/**
+ * Immutable encoded bytes shared between readers of the same file.
+ * Either owns a moved-in vector or borrows memory ( pinned direct buffer, mmapped file ),
+ * in the latter case the owner handle releases it when the last reference is gone.
+ */
+class ByteSource {
+ public:
+  explicit ByteSource(std::vector<uint8_t> &&bytes) : storage(std::move(bytes)),
+                                                       ptr(storage.data()),
+                                                       length(storage.size()) {}
+
+  ByteSource(const uint8_t *data, size_t size, std::shared_ptr<void> owner) : ptr(data),
+                                                                               length(size),
+                                                                               owner(std::move(owner)) {}
+
+  ByteSource(const ByteSource &) = delete;
+
+  ByteSource &operator=(const ByteSource &) = delete;
+
+  [[nodiscard]] const uint8_t *data() const {
+    return ptr;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return length;
+  }
+
+ private:
+  std::vector<uint8_t> storage;
+  const uint8_t *ptr;
+  size_t length;
+  std::shared_ptr<void> owner;
+};
+
+}
+
+#endif /* ByteSource_hpp */
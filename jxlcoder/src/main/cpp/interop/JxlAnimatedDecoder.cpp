@@ -24,17 +24,32 @@
 //
 
 #include "JxlAnimatedDecoder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
+int JxlAnimatedDecoder::durationToMillis(const JxlAnimationHeader &animation, uint32_t ticks) {
+  if (!animation.tps_numerator) {
+    return 0;
+  }
+  const double millis = std::round(1000.0 * ticks * animation.tps_denominator / animation.tps_numerator);
+  return static_cast<int>(std::min(millis, static_cast<double>(std::numeric_limits<int>::max())));
+}
+
+void JxlAnimatedDecoder::getFrame(int framePosition, JxlFrame &frame) {
   std::lock_guard guard(lock);
   if (framePosition < 0) {
     std::string str = "Frame position must be positive";
     throw AnimatedDecoderError(str);
   }
 
-  if (framePosition >= this->frameInfo.size()) {
-    std::string str = "Requested frame index more than frames in the container";
-    throw AnimatedDecoderError(str);
+  {
+    // While the scan is running the frame is searched by the decoder itself
+    std::lock_guard tableGuard(tableLock);
+    if (scanComplete && static_cast<size_t>(framePosition) >= this->frameInfo.size()) {
+      std::string str = "Requested frame index more than frames in the container";
+      throw AnimatedDecoderError(str);
+    }
   }
 
   JxlDecoderRewind(dec.get());
@@ -44,7 +59,7 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
     std::string str = "Cannot subscribe to events";
     throw AnimatedDecoderError(str);
   }
-  if (JXL_DEC_SUCCESS != JxlDecoderSetInput(dec.get(), data.data(), data.size())) {
+  if (JXL_DEC_SUCCESS != JxlDecoderSetInput(dec.get(), source->data(), source->size())) {
     std::string str = "Set input has failed";
     throw AnimatedDecoderError(str);
   }
@@ -57,10 +72,11 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
   }
 
   int frameTime = 0;
-  std::vector<uint8_t> pixels;
+  std::vector<uint8_t> &pixels = frame.pixels;
   JxlColorEncoding clr;
   bool useColorEncoding = false;
-  JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+  JxlPixelFormat format = {4, highBitDepth ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+  const size_t componentSize = highBitDepth ? sizeof(uint16_t) : sizeof(uint8_t);
   bool isFrameReceived = false;
   for (;;) {
     JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
@@ -70,11 +86,7 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
         std::string str = "Cannot retreive frame header info";
         throw AnimatedDecoderError(str);
       }
-      JxlAnimationHeader animation = info.animation;
-      if (animation.tps_numerator)
-        frameTime = (int) (1000.0 * header.duration * animation.tps_denominator / animation.tps_numerator);
-      else
-        frameTime = 0;
+      frameTime = durationToMillis(info.animation, header.duration);
     } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
       size_t bufferSize = 0;
       int components = 4;
@@ -83,11 +95,12 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
         std::string str = "Cannot retrieve buffer info size";
         throw AnimatedDecoderError(str);
       }
-      int allocationSize = info.xsize * info.ysize * (components) * sizeof(uint8_t);
+      size_t allocationSize = static_cast<size_t>(info.xsize) * info.ysize * (components) * componentSize;
       if (bufferSize != allocationSize) {
         std::string str = "Buffer size are not valid";
         throw AnimatedDecoderError(str);
       }
+      // Frame buffer is owned by the caller, after the first frame resize only reuses capacity
       pixels.resize(allocationSize);
       void *pixelsBuffer = (void *) pixels.data();
 
@@ -117,7 +130,7 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
       // We must rewind the decoder to get a new frame.
       JxlDecoderRewind(dec.get());
       JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE);
-      JxlDecoderSetInput(dec.get(), data.data(), data.size());
+      JxlDecoderSetInput(dec.get(), source->data(), source->size());
       JxlDecoderCloseInput(dec.get());
 
       if (!isFrameReceived) {
@@ -126,16 +139,16 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
         throw AnimatedDecoderError(str);
       }
 
-      std::vector<uint8_t> iccCopy;
-      iccCopy = iccProfile;
-
-      JxlFrame frame = {.pixels = pixels,
-          .iccProfile = iccCopy,
-          .colorEncoding = clr,
-          .hasAlphaInOrigin = info.num_extra_channels > 0 && info.alpha_bits > 0,
-          .preferColorEncoding = useColorEncoding,
-          .duration = frameTime};
-      return frame;
+      if (frame.iccProfile.size() != iccProfile.size()) {
+        frame.iccProfile = iccProfile;
+      }
+      frame.colorEncoding = clr;
+      frame.hasAlphaInOrigin = info.num_extra_channels > 0 && info.alpha_bits > 0;
+      frame.preferColorEncoding = useColorEncoding;
+      frame.duration = frameTime;
+      frame.bitDepth = highBitDepth ? 16 : 8;
+      frame.intensityTarget = intensityTarget;
+      return;
     } else {
       std::string str = "Error event has received";
       throw AnimatedDecoderError(str);
@@ -143,17 +156,27 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
   }
 }
 
-JxlFrame JxlAnimatedDecoder::nextFrame() {
+void JxlAnimatedDecoder::nextFrame(JxlFrame &frame) {
   std::lock_guard guard(lock);
   int frameTime = 0;
+  bool isFrameReceived = false;
   for (;;) {
     JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
-    if (status == JXL_DEC_FULL_IMAGE || status == JXL_DEC_SUCCESS) {
+    if (status == JXL_DEC_FULL_IMAGE && isFrameReceived) {
+      if (frame.iccProfile.size() != iccProfile.size()) {
+        frame.iccProfile = iccProfile;
+      }
+      frame.hasAlphaInOrigin = info.num_extra_channels > 0 && info.alpha_bits > 0;
+      frame.duration = frameTime;
+      frame.bitDepth = highBitDepth ? 16 : 8;
+      frame.intensityTarget = intensityTarget;
+      return;
+    } else if (status == JXL_DEC_FULL_IMAGE || status == JXL_DEC_SUCCESS) {
       // All decoding successfully finished, we are at the end of the file.
       // We must rewind the decoder to get a new frame.
       JxlDecoderRewind(dec.get());
       JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE);
-      JxlDecoderSetInput(dec.get(), data.data(), data.size());
+      JxlDecoderSetInput(dec.get(), source->data(), source->size());
       JxlDecoderCloseInput(dec.get());
     } else if (status == JXL_DEC_FRAME) {
       JxlFrameHeader header;
@@ -161,40 +184,171 @@ JxlFrame JxlAnimatedDecoder::nextFrame() {
         std::string str = "Cannot retreive frame header info";
         throw AnimatedDecoderError(str);
       }
-      JxlAnimationHeader animation = info.animation;
-      if (animation.tps_numerator)
-        frameTime = (int) (1000.0 * header.duration * animation.tps_denominator /
-            animation.tps_numerator);
-      else
-        frameTime = 0;
+      frameTime = durationToMillis(info.animation, header.duration);
     } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
       size_t bufferSize;
-      JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+      JxlPixelFormat format = {4, highBitDepth ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
       int components = 4;
       if (JXL_DEC_SUCCESS !=
           JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize)) {
         std::string str = "Cannot retrieve buffer info size";
         throw AnimatedDecoderError(str);
       }
-      if (bufferSize != info.xsize * info.ysize * (components) * sizeof(uint8_t)) {
+      if (bufferSize != static_cast<size_t>(info.xsize) * info.ysize * (components)
+          * (highBitDepth ? sizeof(uint16_t) : sizeof(uint8_t))) {
         std::string str = "Cannot retrieve buffer info size";
         throw AnimatedDecoderError(str);
       }
-      std::vector<uint8_t> pixels;
-      pixels.resize(info.xsize * info.ysize * (components) * sizeof(uint8_t));
-      void *pixelsBuffer = (void *) pixels.data();
+      frame.pixels.resize(bufferSize);
+      void *pixelsBuffer = (void *) frame.pixels.data();
 
       if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec.get(),
                                                          &format,
                                                          pixelsBuffer,
-                                                         pixels.size())) {
+                                                         frame.pixels.size())) {
+        std::string str = "Cannot decoder buffer info";
+        throw AnimatedDecoderError(str);
+      }
+      isFrameReceived = true;
+    } else {
+      std::string str = "Error event has received";
+      throw AnimatedDecoderError(str);
+    }
+  }
+}
+
+void JxlAnimatedDecoder::scanFrames() {
+  // Own decoder, the playback one is never touched so the first frame does not wait for the scan
+  JxlDecoderPtr scanDec = JxlDecoderMake(nullptr);
+  bool scanned = scanDec
+      && JXL_DEC_SUCCESS == JxlDecoderSubscribeEvents(scanDec.get(), JXL_DEC_FRAME)
+      && JXL_DEC_SUCCESS == JxlDecoderSetCoalescing(scanDec.get(), JXL_FALSE)
+      && JXL_DEC_SUCCESS == JxlDecoderSetInput(scanDec.get(), source->data(), source->size());
+  if (scanned) {
+    JxlDecoderCloseInput(scanDec.get());
+  }
+
+  while (scanned && !scanCancelled) {
+    // Frame data is skipped when full image is not subscribed, only the headers are parsed
+    JxlDecoderStatus status = JxlDecoderProcessInput(scanDec.get());
+    if (status == JXL_DEC_FRAME) {
+      JxlFrameHeader header;
+      if (JXL_DEC_SUCCESS != JxlDecoderGetFrameHeader(scanDec.get(), &header)) {
+        break;
+      }
+      const int frameTime = durationToMillis(info.animation, header.duration);
+      // Zero duration frames are layers of the next displayed frame, coalesced decoding never returns them
+      if (header.duration != 0 || header.is_last) {
+        JxlFrameInfo fInfo = {.duration = frameTime};
+        {
+          std::lock_guard guard(tableLock);
+          this->frameInfo.push_back(fInfo);
+        }
+        tableChanged.notify_all();
+      }
+    } else {
+      // Success or a broken tail, frames found so far is everything playback can get
+      streamComplete = status == JXL_DEC_SUCCESS;
+      break;
+    }
+  }
+
+  {
+    std::lock_guard guard(tableLock);
+    scanComplete = true;
+  }
+  tableChanged.notify_all();
+}
+
+void JxlAnimatedDecoder::startLayerDecoder() {
+  if (!layerDec) {
+    layerDec = JxlDecoderMake(nullptr);
+    if (!layerDec) {
+      std::string str = "Cannot create decoder";
+      throw AnimatedDecoderError(str);
+    }
+  } else {
+    JxlDecoderRewind(layerDec.get());
+  }
+  if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(layerDec.get(),
+                                                   JXL_DEC_COLOR_ENCODING | JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE)) {
+    std::string str = "Cannot subscribe to decoder events";
+    throw AnimatedDecoderError(str);
+  }
+  if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(layerDec.get(),
+                                                     JxlResizableParallelRunner,
+                                                     runner.get())) {
+    std::string str = "Cannot attach parallel runner to decoder";
+    throw AnimatedDecoderError(str);
+  }
+  if (JXL_DEC_SUCCESS != JxlDecoderSetCoalescing(layerDec.get(), JXL_FALSE)) {
+    std::string str = "Cannot disable frames coalescing";
+    throw AnimatedDecoderError(str);
+  }
+  if (JXL_DEC_SUCCESS != JxlDecoderSetInput(layerDec.get(), source->data(), source->size())) {
+    std::string str = "Set input has failed";
+    throw AnimatedDecoderError(str);
+  }
+  JxlDecoderCloseInput(layerDec.get());
+}
+
+void JxlAnimatedDecoder::rewindLayers() {
+  std::lock_guard guard(lock);
+  startLayerDecoder();
+}
+
+bool JxlAnimatedDecoder::nextLayer(JxlLayer &layer) {
+  std::lock_guard guard(lock);
+  if (!layerDec) {
+    startLayerDecoder();
+  }
+  JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+  for (;;) {
+    JxlDecoderStatus status = JxlDecoderProcessInput(layerDec.get());
+    if (status == JXL_DEC_COLOR_ENCODING) {
+      layerPreferColorEncoding = false;
+      if (JXL_DEC_SUCCESS ==
+          JxlDecoderGetColorAsEncodedProfile(layerDec.get(), JXL_COLOR_PROFILE_TARGET_DATA,
+                                             &layerColorEncoding)) {
+        layerPreferColorEncoding = layerColorEncoding.color_space == JXL_COLOR_SPACE_RGB
+            && layerColorEncoding.transfer_function != JXL_TRANSFER_FUNCTION_LINEAR
+            && layerColorEncoding.transfer_function != JXL_TRANSFER_FUNCTION_UNKNOWN;
+      }
+    } else if (status == JXL_DEC_FRAME) {
+      JxlFrameHeader header;
+      if (JXL_DEC_SUCCESS != JxlDecoderGetFrameHeader(layerDec.get(), &header)) {
+        std::string str = "Cannot retreive frame header info";
+        throw AnimatedDecoderError(str);
+      }
+      layer.layerInfo = header.layer_info;
+      layer.durationTicks = header.duration;
+      layer.isLast = header.is_last;
+      layer.duration = durationToMillis(info.animation, header.duration);
+      layer.colorEncoding = layerColorEncoding;
+      layer.preferColorEncoding = layerPreferColorEncoding;
+      layer.intensityTarget = intensityTarget;
+    } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+      size_t bufferSize = 0;
+      if (JXL_DEC_SUCCESS != JxlDecoderImageOutBufferSize(layerDec.get(), &format, &bufferSize)) {
+        std::string str = "Cannot retrieve buffer info size";
+        throw AnimatedDecoderError(str);
+      }
+      if (bufferSize != static_cast<size_t>(layer.layerInfo.xsize) * layer.layerInfo.ysize * 4 * sizeof(uint8_t)) {
+        std::string str = "Buffer size are not valid";
+        throw AnimatedDecoderError(str);
+      }
+      layer.pixels.resize(bufferSize);
+      if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(layerDec.get(),
+                                                         &format,
+                                                         layer.pixels.data(),
+                                                         layer.pixels.size())) {
         std::string str = "Cannot decoder buffer info";
         throw AnimatedDecoderError(str);
       }
-      std::vector<uint8_t> iccCopy;
-      iccCopy = iccProfile;
-      JxlFrame frame = {.pixels = pixels, .iccProfile = iccCopy, .duration = frameTime};
-      return frame;
+    } else if (status == JXL_DEC_FULL_IMAGE) {
+      return true;
+    } else if (status == JXL_DEC_SUCCESS) {
+      return false;
     } else {
       std::string str = "Error event has received";
       throw AnimatedDecoderError(str);
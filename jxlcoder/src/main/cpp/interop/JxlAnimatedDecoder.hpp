@@ -36,7 +36,11 @@
 #include "resizable_parallel_runner.h"
 #include "resizable_parallel_runner_cxx.h"
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include "conversion/HalfFloats.h"
+#include "ByteSource.hpp"
 
 class AnimatedDecoderError : public std::exception {
  public:
@@ -57,18 +61,40 @@ struct JxlFrame {
   bool hasAlphaInOrigin;
   bool preferColorEncoding;
   int duration;
+  // 8 for RGBA8 pixels, 16 when pixels are RGBA16
+  uint32_t bitDepth;
+  float intensityTarget;
 };
 
 struct JxlFrameInfo {
   int duration;
 };
 
+/**
+ * Single non-coalesced layer, pixels are in the layer own size as described by layerInfo.
+ */
+struct JxlLayer {
+  std::vector<uint8_t> pixels;
+  JxlLayerInfo layerInfo;
+  JxlColorEncoding colorEncoding;
+  bool preferColorEncoding;
+  float intensityTarget;
+  uint32_t durationTicks;
+  int duration;
+  bool isLast;
+};
+
 class JxlAnimatedDecoder {
  public:
-  JxlAnimatedDecoder(std::vector<uint8_t> &src) {
-    this->data = src;
-
-    if (JXL_SIG_INVALID == JxlSignatureCheck(src.data(), src.size())) {
+  /**
+   * @param src encoded file, it is shared not copied
+   * @param allowHighBitDepth frames of images with more than 8 bits per sample are decoded into 16 bits
+   *
+   * Only the basic info and the color profile are read here, so the first frame may be decoded right away.
+   * Frame table is filled by a background scan which skips frame data and only reads frame headers.
+   */
+  JxlAnimatedDecoder(std::shared_ptr<coder::ByteSource> src, bool allowHighBitDepth = false) : source(std::move(src)) {
+    if (JXL_SIG_INVALID == JxlSignatureCheck(source->data(), source->size())) {
       std::string str = "Not an JXL image";
       throw AnimatedDecoderError(str);
     }
@@ -82,9 +108,7 @@ class JxlAnimatedDecoder {
     }
     if (JXL_DEC_SUCCESS !=
         JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_BASIC_INFO |
-            JXL_DEC_COLOR_ENCODING |
-            JXL_DEC_FULL_IMAGE |
-            JXL_DEC_FRAME)) {
+            JXL_DEC_COLOR_ENCODING)) {
       std::string str = "Cannot subscribe to decoder events";
       throw AnimatedDecoderError(str);
     }
@@ -101,7 +125,7 @@ class JxlAnimatedDecoder {
       throw AnimatedDecoderError(str);
     }
 
-    JxlDecoderSetInput(dec.get(), data.data(), data.size());
+    JxlDecoderSetInput(dec.get(), source->data(), source->size());
     JxlDecoderCloseInput(dec.get());
 
     for (;;) {
@@ -118,10 +142,13 @@ class JxlAnimatedDecoder {
         denom = info.have_animation ? info.animation.tps_denominator : 1;
         numer = info.have_animation ? info.animation.tps_numerator : 1;
         alphaPremultiplied = info.alpha_premultiplied;
+        highBitDepth = allowHighBitDepth && info.bits_per_sample > 8;
+        intensityTarget = info.intensity_target <= 0. ? 255.f : info.intensity_target;
 
         uint64_t maxSize = std::numeric_limits<int32_t>::max();
         uint64_t
-            currentSize = static_cast<uint64_t >(info.xsize) * static_cast<uint64_t >(info.ysize) * 4;
+            currentSize = static_cast<uint64_t >(info.xsize) * static_cast<uint64_t >(info.ysize) * 4
+            * (highBitDepth ? sizeof(uint16_t) : sizeof(uint8_t));
         if (currentSize >= maxSize) {
           std::string errorMessage =
               "Invalid image size exceed allowance, current size w: " + std::to_string(info.xsize) + ", h: " + std::to_string(info.ysize);
@@ -131,34 +158,6 @@ class JxlAnimatedDecoder {
         JxlResizableParallelRunnerSetThreads(
             runner.get(),
             JxlResizableParallelRunnerSuggestThreads(info.xsize, info.ysize));
-      } else if (status == JXL_DEC_FULL_IMAGE) {
-        // All decoding successfully finished, we are at the end of the file.
-        // We must rewind the decoder to get a new frame.
-        JxlDecoderRewind(dec.get());
-        JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE);
-        JxlDecoderSetInput(dec.get(), data.data(), data.size());
-        JxlDecoderCloseInput(dec.get());
-        break;
-      } else if (status == JXL_DEC_FRAME) {
-        JxlFrameHeader header;
-        if (JXL_DEC_SUCCESS != JxlDecoderGetFrameHeader(dec.get(), &header)) {
-          std::string str = "Cannot retreive frame header info";
-          throw AnimatedDecoderError(str);
-        }
-        JxlAnimationHeader animation = info.animation;
-        int frameTime;
-        if (animation.tps_numerator)
-          frameTime = std::roundf(1000.0f * static_cast<float>(header.duration) * static_cast<float>(animation.tps_denominator)
-                                      / static_cast<float>(animation.tps_numerator));
-        else
-          frameTime = 0;
-        JxlFrameInfo fInfo = {.duration = frameTime};
-        this->frameInfo.push_back(fInfo);
-      } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
-        if (JXL_DEC_SUCCESS != JxlDecoderSkipCurrentFrame(dec.get())) {
-          std::string str = "Cannot properly resolve animation info";
-          throw AnimatedDecoderError(str);
-        }
       } else if (status == JXL_DEC_COLOR_ENCODING) {
         size_t iccSize;
         if (JXL_DEC_SUCCESS !=
@@ -174,19 +173,45 @@ class JxlAnimatedDecoder {
           std::string str = "Cannot retrieve color icc profile";
           throw AnimatedDecoderError(str);
         }
-      } else if (status == JXL_DEC_SUCCESS) {
         JxlDecoderRewind(dec.get());
         JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE);
-        JxlDecoderSetInput(dec.get(), data.data(), data.size());
+        JxlDecoderSetInput(dec.get(), source->data(), source->size());
         JxlDecoderCloseInput(dec.get());
         break;
+      } else if (status == JXL_DEC_SUCCESS) {
+        std::string str = "Cannot retreive color info";
+        throw AnimatedDecoderError(str);
       }
     }
+
+    scanThread = std::thread(&JxlAnimatedDecoder::scanFrames, this);
+  }
+
+  ~JxlAnimatedDecoder() {
+    scanCancelled = true;
+    if (scanThread.joinable()) {
+      scanThread.join();
+    }
   }
 
-  JxlFrame nextFrame();
+  /**
+   * Decodes the next frame into the caller owned frame.
+   * Frame buffers are reused between calls, so a frame kept alive across playback never reallocates.
+   */
+  void nextFrame(JxlFrame &frame);
+
+  /**
+   * Decodes the frame at the position into the caller owned frame, reusing its buffers.
+   */
+  void getFrame(int at, JxlFrame &frame);
+
+  /**
+   * Non-coalesced playback, decodes the next layer at its actual size without compositing it.
+   * @return false when there are no more layers, call `rewindLayers` to start over.
+   */
+  bool nextLayer(JxlLayer &layer);
 
-  JxlFrame getFrame(int at);
+  void rewindLayers();
 
   [[nodiscard]] uint32_t getLoopCount() {
     return loopCount;
@@ -200,21 +225,64 @@ class JxlAnimatedDecoder {
     return info.ysize;
   }
 
+  /**
+   * Waits until the frame table scan is finished.
+   */
   int getNumberOfFrames() {
+    std::unique_lock guard(tableLock);
+    tableChanged.wait(guard, [this] { return scanComplete; });
+    return static_cast<int>(frameInfo.size());
+  }
+
+  /**
+   * Frames found by the scan so far, there are at least this many frames until `isNumberOfFramesFinal`.
+   */
+  int getKnownNumberOfFrames() {
+    std::lock_guard guard(tableLock);
     return static_cast<int>(frameInfo.size());
   }
 
+  bool isNumberOfFramesFinal() {
+    std::lock_guard guard(tableLock);
+    return scanComplete;
+  }
+
+  /**
+   * Waits for the scan, false when the stream breaks off before a frame marked as the last one,
+   * playback still shows the frames found before the broken tail
+   */
+  bool isStreamComplete() {
+    std::unique_lock guard(tableLock);
+    tableChanged.wait(guard, [this] { return scanComplete; });
+    return streamComplete;
+  }
+
   [[nodiscard]] bool isAlphaAttenuated() const {
     return alphaPremultiplied;
   }
 
+  [[nodiscard]] bool isHighBitDepth() const {
+    return highBitDepth;
+  }
+
+  [[nodiscard]] bool hasAlpha() const {
+    return info.num_extra_channels > 0 && info.alpha_bits > 0;
+  }
+
+  [[nodiscard]] const std::vector<uint8_t> &getIccProfile() const {
+    return iccProfile;
+  }
+
+  /**
+   * Waits for the scan only as far as the requested frame.
+   */
   int getFrameDuration(int frame) {
-    std::lock_guard guard(lock);
     if (frame < 0) {
       return 0;
     }
-
-    if (frame >= this->frameInfo.size()) {
+    std::unique_lock guard(tableLock);
+    tableChanged.wait(guard, [this, frame] { return scanComplete || static_cast<size_t>(frame) < frameInfo.size(); });
+    if (static_cast<size_t>(frame) >= this->frameInfo.size()) {
       return 0;
     }
     JxlFrameInfo fInfo = this->frameInfo[frame];
@@ -222,17 +290,38 @@ class JxlAnimatedDecoder {
   }
 
  private:
-  std::vector<uint8_t> data;
+  /**
+   * Frame duration in milliseconds rounded to the nearest, the same for the scan, frames and layers
+   */
+  static int durationToMillis(const JxlAnimationHeader &animation, uint32_t ticks);
+
+  std::shared_ptr<coder::ByteSource> source;
   std::vector<uint8_t> iccProfile;
   std::vector<JxlFrameInfo> frameInfo;
   JxlDecoderPtr dec;
   JxlBasicInfo info;
   bool alphaPremultiplied;
+  bool highBitDepth = false;
+  float intensityTarget = 255.f;
   int loopCount;
   int denom;
   int numer;
   JxlResizableParallelRunnerPtr runner;
   std::mutex lock;
+
+  std::mutex tableLock;
+  std::condition_variable tableChanged;
+  bool scanComplete = false;
+  bool streamComplete = false;
+  std::atomic<bool> scanCancelled = false;
+  std::thread scanThread;
+
+  JxlDecoderPtr layerDec;
+  JxlColorEncoding layerColorEncoding = {};
+  bool layerPreferColorEncoding = false;
+
+  void startLayerDecoder();
+  void scanFrames();
 };
 
 #endif
@@ -24,70 +24,274 @@
 //
 
 #include "JxlAnimatedEncoder.hpp"
+#include <algorithm>
 
-void JxlAnimatedEncoder::addFrame(std::vector<uint8_t> &data, int frameTime) {
-  std::lock_guard guard(lock);
+void JxlAnimatedEncoder::addFrame(std::vector<uint8_t> &&data, int frameTime) {
+  addFrame(std::move(data), frameTime,
+           coder::FrameRect{0, 0, static_cast<uint32_t>(width), static_cast<uint32_t>(height)});
+}
+
+void JxlAnimatedEncoder::addFrame(std::vector<uint8_t> &&data, int frameTime, const coder::FrameRect &changed) {
+  std::unique_lock guard(lock);
 
   if (!isColorEncodingSet) {
     setColorEncoding();
   }
 
+  queueChanged.wait(guard, [this] {
+    return pendingFrames.size() < kPipelineDepth || !pipelineError.empty();
+  });
+  if (!pipelineError.empty()) {
+    throw AnimatedEncoderError(pipelineError);
+  }
+  if (stopping) {
+    std::string str = "Animation is already finished";
+    throw AnimatedEncoderError(str);
+  }
+  if (changed.x + changed.width > static_cast<uint32_t>(width) ||
+      changed.y + changed.height > static_cast<uint32_t>(height)) {
+    std::string str = "Changed area is out of the frame";
+    throw AnimatedEncoderError(str);
+  }
+
+  if (!worker.joinable()) {
+    stream->reserve(coder::EstimateJxlOutputSize(width, height, pixelFormat.num_channels,
+                                                basicInfo.bits_per_sample, compressionOption == loseless,
+                                                JXLGetDistance(quality)));
+    worker = std::thread(&JxlAnimatedEncoder::encodeQueuedFrames, this);
+  }
+
   addedFrames += 1;
+  pendingFrames.push_back(QueuedFrame{std::move(data), frameTime, changed});
+  queueChanged.notify_all();
+}
+
+void JxlAnimatedEncoder::setPaletteColors(int colors) {
+  std::lock_guard guard(lock);
+  if (addedFrames != 0) {
+    std::string str = "Palette must be set before the first frame";
+    throw AnimatedEncoderError(str);
+  }
+  if (JXL_ENC_SUCCESS != JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_MODULAR, 1) ||
+      JXL_ENC_SUCCESS != JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_PALETTE_COLORS, colors)) {
+    std::string str = "Set palette colors has failed";
+    throw AnimatedEncoderError(str);
+  }
+}
+
+std::vector<uint8_t> JxlAnimatedEncoder::acquireFrameBuffer() {
+  std::vector<uint8_t> buffer;
+  {
+    std::lock_guard guard(lock);
+    if (!spareFrames.empty()) {
+      buffer = std::move(spareFrames.back());
+      spareFrames.pop_back();
+    }
+  }
+  buffer.resize(getFrameSize());
+  return buffer;
+}
+
+void JxlAnimatedEncoder::encodeQueuedFrames() {
+  std::unique_lock guard(lock);
+  while (true) {
+    queueChanged.wait(guard, [this] {
+      return !pendingFrames.empty() || stopping;
+    });
+    if (stopping) {
+      break;
+    }
+    // The frame stays in the queue while it is encoded so the depth accounts it
+    QueuedFrame &frame = pendingFrames.front();
+    std::string error;
+    if (pipelineError.empty()) {
+      guard.unlock();
+      try {
+        submitFrame(frame);
+      } catch (AnimatedEncoderError &err) {
+        error = err.what();
+      } catch (std::bad_alloc &err) {
+        error = "Not enough memory to encode the frame";
+      }
+      guard.lock();
+    }
+    if (!error.empty()) {
+      pipelineError = error;
+    }
+    if (pipelineError.empty() && !frame.data.empty() && spareFrames.size() < kPipelineDepth) {
+      spareFrames.push_back(std::move(frame.data));
+    }
+    pendingFrames.pop_front();
+    queueChanged.notify_all();
+  }
+}
+
+void JxlAnimatedEncoder::submitFrame(QueuedFrame &frame) {
+  if (!hasHeldFrame) {
+    frame.rect = {0, 0, static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+    std::swap(heldFrame, frame);
+    hasHeldFrame = true;
+    return;
+  }
+  const coder::FrameRect &area = frame.rect;
+  const size_t pixelSize = getPixelSize();
+  const size_t stride = static_cast<size_t>(width) * pixelSize;
+  const size_t offset = area.y * stride + area.x * pixelSize;
+  coder::FrameRect rect = {};
+  if (!coder::FindChangedRect(heldFrame.data.data() + offset, frame.data.data() + offset, stride,
+                              area.width, area.height, static_cast<uint32_t>(pixelSize), rect)) {
+    heldFrame.frameTime += frame.frameTime;
+    return;
+  }
+  rect.x += area.x;
+  rect.y += area.y;
+  addImageFrame(heldFrame);
+  drainOutput();
+  frame.rect = rect;
+  std::swap(heldFrame, frame);
+}
+
+void JxlAnimatedEncoder::addImageFrame(QueuedFrame &frame) {
+  const coder::FrameRect &rect = frame.rect;
+  const bool cropped = rect.width != static_cast<uint32_t>(width) || rect.height != static_cast<uint32_t>(height);
 
   JxlEncoderInitFrameHeader(&header);
   header.timecode = 0;
-  header.duration = frameTime;
+  header.duration = frame.frameTime;
   header.is_last = false;
-  header.layer_info.crop_x0 = 0;
-  header.layer_info.crop_y0 = 0;
-  header.layer_info.xsize = width;
-  header.layer_info.ysize = height;
+  header.layer_info.have_crop = cropped ? JXL_TRUE : JXL_FALSE;
+  header.layer_info.crop_x0 = static_cast<int32_t>(rect.x);
+  header.layer_info.crop_y0 = static_cast<int32_t>(rect.y);
+  header.layer_info.xsize = rect.width;
+  header.layer_info.ysize = rect.height;
+  // Every frame is kept as the reference, the cropped next one replaces only its changed part
+  header.layer_info.blend_info.blendmode = JXL_BLEND_REPLACE;
+  header.layer_info.blend_info.source = cropped ? 1 : 0;
+  header.layer_info.save_as_reference = 1;
 
   if (JXL_ENC_SUCCESS != JxlEncoderSetFrameHeader(frameSettings, &header)) {
     std::string str = "Set frame header has failed";
     throw AnimatedEncoderError(str);
   }
 
+  if (basicInfo.num_extra_channels > 0) {
+    JxlBlendInfo blendInfo;
+    JxlEncoderInitBlendInfo(&blendInfo);
+    blendInfo.blendmode = JXL_BLEND_REPLACE;
+    blendInfo.source = header.layer_info.blend_info.source;
+    if (JXL_ENC_SUCCESS != JxlEncoderSetExtraChannelBlendInfo(frameSettings, 0, &blendInfo)) {
+      std::string str = "Set extra channel blend info has failed";
+      throw AnimatedEncoderError(str);
+    }
+  }
+
+  const uint8_t *pixels = frame.data.data();
+  size_t pixelsSize = frame.data.size();
+  if (cropped) {
+    const size_t pixelSize = getPixelSize();
+    const size_t rowBytes = static_cast<size_t>(width) * pixelSize;
+    const size_t cropRowBytes = static_cast<size_t>(rect.width) * pixelSize;
+    cropBuffer.resize(cropRowBytes * rect.height);
+    for (uint32_t y = 0; y < rect.height; ++y) {
+      std::copy_n(frame.data.data() + (rect.y + y) * rowBytes + rect.x * pixelSize, cropRowBytes,
+                  cropBuffer.data() + y * cropRowBytes);
+    }
+    pixels = cropBuffer.data();
+    pixelsSize = cropBuffer.size();
+  }
+
   if (JXL_ENC_SUCCESS !=
       JxlEncoderAddImageFrame(frameSettings, &pixelFormat,
-                              (void *) data.data(),
-                              sizeof(uint8_t) * data.size())) {
+                              (void *) pixels,
+                              sizeof(uint8_t) * pixelsSize)) {
     std::string str = "Encoding frame has failed";
     throw AnimatedEncoderError(str);
   }
 }
 
-void JxlAnimatedEncoder::encode(std::vector<uint8_t> &dst) {
-  std::lock_guard guard(lock);
-  if (!isColorEncodingSet) {
-    setColorEncoding();
+void JxlAnimatedEncoder::drainOutput() {
+  // libjxl only queues the frame, processing the output here does the actual encoding on this thread
+  // and hands the finished bytes to the sink, so neither input nor output piles up in libjxl
+  if (!coder::JxlWriteEncoderOutput(enc.get(), *stream)) {
+    std::string str = "Encoding frame has failed";
+    throw AnimatedEncoderError(str);
+  }
+}
+
+void JxlAnimatedEncoder::stopWorker() {
+  {
+    std::lock_guard guard(lock);
+    stopping = true;
+    queueChanged.notify_all();
   }
-  if (addedFrames == 0) {
-    std::string str = "Cannot compress empty animation";
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+void JxlAnimatedEncoder::setOutput(coder::JxlOutputSink *sink) {
+  std::lock_guard guard(lock);
+  if (addedFrames != 0) {
+    std::string str = "Output must be set before the first frame";
     throw AnimatedEncoderError(str);
   }
-  JxlEncoderCloseFrames(enc.get());
+  stream = sink ? sink : &encoded;
+}
 
-  dst.resize(64);
-  uint8_t *nextOut = dst.data();
-  size_t availOut = dst.size() - (nextOut - dst.data());
-  JxlEncoderStatus processResult = JXL_ENC_NEED_MORE_OUTPUT;
-  while (processResult == JXL_ENC_NEED_MORE_OUTPUT) {
-    processResult = JxlEncoderProcessOutput(enc.get(), &nextOut, &availOut);
-    if (processResult == JXL_ENC_NEED_MORE_OUTPUT) {
-      size_t offset = nextOut - dst.data();
-      dst.resize(dst.size() * 2);
-      nextOut = dst.data() + offset;
-      availOut = dst.size() - offset;
+uint64_t JxlAnimatedEncoder::finish() {
+  {
+    std::unique_lock guard(lock);
+    if (!isColorEncodingSet) {
+      setColorEncoding();
+    }
+    queueChanged.wait(guard, [this] {
+      return pendingFrames.empty();
+    });
+    if (!pipelineError.empty()) {
+      throw AnimatedEncoderError(pipelineError);
+    }
+    if (addedFrames == 0) {
+      std::string str = "Cannot compress empty animation";
+      throw AnimatedEncoderError(str);
     }
   }
-  dst.resize(nextOut - dst.data());
-  if (JXL_ENC_SUCCESS != processResult) {
+  stopWorker();
+
+  // The last frame is only queued, libjxl marks it as the last one when frames are closed
+  // before the output processing which encodes it
+  if (hasHeldFrame) {
+    hasHeldFrame = false;
+    addImageFrame(heldFrame);
+    heldFrame = {};
+  }
+
+  JxlEncoderCloseFrames(enc.get());
+
+  if (!coder::JxlWriteEncoderOutput(enc.get(), *stream)) {
     std::string str = "Encoding image has failed";
     throw AnimatedEncoderError(str);
   }
+  return stream->getSize();
 }
 
-JxlAnimatedEncoder::~JxlAnimatedEncoder() {
+void JxlAnimatedEncoder::encode(coder::JxlOutputSink &output) {
+  if (stream != &encoded) {
+    std::string str = "Animation is written into its own output";
+    throw AnimatedEncoderError(str);
+  }
+  finish();
+
+  output.reserve(encoded.getSize());
+  bool written = true;
+  encoded.forEachChunk([&](const uint8_t *data, size_t length) {
+    written = written && output.write(data, length);
+  });
+  if (!written) {
+    std::string str = "Writing encoded image has failed";
+    throw AnimatedEncoderError(str);
+  }
+}
 
+JxlAnimatedEncoder::~JxlAnimatedEncoder() {
+  stopWorker();
 }
@@ -34,8 +34,13 @@
 #include "thread_parallel_runner_cxx.h"
 #include <string>
 #include "JxlDefinitions.h"
+#include "JxlOutputSink.h"
+#include "imagebit/FrameDiff.h"
 #include <vector>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 class AnimatedEncoderError : public std::exception {
  public:
@@ -85,6 +90,11 @@ class JxlAnimatedEncoder {
         baseChannelsCount = 1;
       }
         break;
+      case monoAlpha: {
+        channelsCount = 2;
+        baseChannelsCount = 1;
+      }
+        break;
       case rgb: {
         channelsCount = 3;
         baseChannelsCount = 3;
@@ -122,7 +132,7 @@ class JxlAnimatedEncoder {
       throw AnimatedEncoderError(str);
     }
 
-    if (pixelType == rgba) {
+    if (pixelType == rgba || pixelType == monoAlpha) {
       basicInfo.num_extra_channels = 1;
       basicInfo.alpha_bits = 8;
     }
@@ -132,7 +142,7 @@ class JxlAnimatedEncoder {
       throw AnimatedEncoderError(str);
     }
 
-    if (pixelType == rgba) {
+    if (pixelType == rgba || pixelType == monoAlpha) {
       JxlExtraChannelInfo channelInfo;
       JxlEncoderInitExtraChannelInfo(JXL_CHANNEL_ALPHA, &channelInfo);
       channelInfo.bits_per_sample = 8;
@@ -180,7 +190,7 @@ class JxlAnimatedEncoder {
       throw AnimatedEncoderError(str);
     }
 
-    if (pixelType == rgba) {
+    if (pixelType == rgba || pixelType == monoAlpha) {
       if (JXL_ENC_SUCCESS !=
           JxlEncoderSetExtraChannelDistance(frameSettings, 0, JXLGetDistance(quality))) {
         std::string str = "Set extra channel distance has failed";
@@ -197,9 +207,42 @@ class JxlAnimatedEncoder {
 
   }
 
-  void addFrame(std::vector<uint8_t> &data, int frameTime);
-
-  void encode(std::vector<uint8_t> &dst);
+  /**
+   * Queues the frame and returns while libjxl still encodes the previous ones, so the caller may convert
+   * the next frame meanwhile. Blocks when `kPipelineDepth` frames are already pending.
+   */
+  void addFrame(std::vector<uint8_t> &&data, int frameTime);
+
+  /**
+   * Same as above when the caller knows that nothing outside of `changed` differs from the previous frame
+   */
+  void addFrame(std::vector<uint8_t> &&data, int frameTime, const coder::FrameRect &changed);
+
+  /**
+   * Codes lossless frames of few colors, e.g. from GIF, as modular palette indices, must be set before the first frame
+   */
+  void setPaletteColors(int colors);
+
+  /**
+   * Returns a buffer of one frame size, recycled from already encoded frames when there is one
+   */
+  std::vector<uint8_t> acquireFrameBuffer();
+
+  /**
+   * Encoded frames are written into the sink as soon as they are ready instead of being kept in memory,
+   * it must be set before the first frame and outlive the encoder
+   */
+  void setOutput(coder::JxlOutputSink *sink);
+
+  /**
+   * Waits for the queued frames and finishes the animation, returns the size of the whole stream
+   */
+  uint64_t finish();
+
+  /**
+   * Finishes the animation and copies the encoded stream into the output, only when no output was set
+   */
+  void encode(coder::JxlOutputSink &output);
 
   int getWidth() {
     return width;
@@ -227,6 +270,20 @@ class JxlAnimatedEncoder {
   ~JxlAnimatedEncoder();
 
  private:
+  /**
+   * Frames converted ahead of the encoder, one is being encoded and the rest wait for it
+   */
+  static constexpr size_t kPipelineDepth = 2;
+
+  struct QueuedFrame {
+    std::vector<uint8_t> data;
+    int frameTime;
+    /**
+     * Area where the frame may differ from the previous one, then the encoded part of it
+     */
+    coder::FrameRect rect;
+  };
+
   const int width;
   const int height;
   const int quality;
@@ -237,7 +294,7 @@ class JxlAnimatedEncoder {
   JxlPixelFormat pixelFormat;
   int addedFrames = 0;
   std::vector<uint8_t> iccProfile;
-  bool isColorEncodingSet;
+  bool isColorEncodingSet = false;
 
   void setColorEncoding() {
     if (isColorEncodingSet) {
@@ -282,6 +339,51 @@ class JxlAnimatedEncoder {
   }
 
   std::mutex lock;
+  std::condition_variable queueChanged;
+  std::deque<QueuedFrame> pendingFrames;
+  std::vector<std::vector<uint8_t>> spareFrames;
+  std::string pipelineError;
+  bool stopping = false;
+  std::thread worker;
+  coder::JxlChunkListSink encoded;
+  coder::JxlOutputSink *stream = &encoded;
+
+  size_t getFrameSize() const {
+    return static_cast<size_t>(width) * static_cast<size_t>(height) * getPixelSize();
+  }
+
+  /**
+   * Last distinct frame, it is encoded only when a different one comes, so equal frames just extend its duration.
+   * `finish` queues it without draining the output, so it is still open to be marked as the last frame.
+   */
+  QueuedFrame heldFrame = {};
+  bool hasHeldFrame = false;
+  std::vector<uint8_t> cropBuffer;
+
+  size_t getPixelSize() const {
+    return pixelFormat.num_channels * (pixelFormat.data_type == JXL_TYPE_FLOAT16 ? sizeof(uint16_t) : sizeof(uint8_t));
+  }
+
+  void encodeQueuedFrames();
+
+  /**
+   * Compares the frame with the held one, the frame becomes held when it differs and the held one is encoded.
+   * Frame keeps the buffer which is no longer needed.
+   */
+  void submitFrame(QueuedFrame &frame);
+
+  /**
+   * Queues the frame in libjxl without encoding it, the last one must be followed by JxlEncoderCloseFrames
+   * before the output is processed, otherwise it is not marked as the last frame
+   */
+  void addImageFrame(QueuedFrame &frame);
+
+  /**
+   * Encodes the queued frames and writes them into the output
+   */
+  void drainOutput();
+
+  void stopWorker();
 };
 
 #endif
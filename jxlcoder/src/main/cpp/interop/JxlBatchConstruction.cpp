@@ -0,0 +1,228 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlBatchConstruction.h"
+#include "JxlConstruction.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <new>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace coder {
+
+static constexpr size_t kReadChunkSize = 64 * 1024;
+
+/**
+ * Whole file into the buffer which is reused by the worker, for small files it is cheaper than mapping each of them
+ */
+static bool ReadWholeFile(int fd, std::vector<uint8_t> &buffer) {
+  struct stat fileStat = {};
+  size_t size = 0;
+  if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode)) {
+    buffer.resize(static_cast<size_t>(fileStat.st_size));
+  } else {
+    buffer.resize(kReadChunkSize);
+  }
+  while (true) {
+    if (size == buffer.size()) {
+      if (S_ISREG(fileStat.st_mode)) {
+        break;
+      }
+      buffer.resize(buffer.size() * 2);
+    }
+    ssize_t result = ::read(fd, buffer.data() + size, buffer.size() - size);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (result == 0) {
+      break;
+    }
+    size += static_cast<size_t>(result);
+  }
+  buffer.resize(size);
+  return size > 0;
+}
+
+/**
+ * Descriptor of a job, closed on unwind only when the job opened it itself
+ */
+class JobDescriptor {
+ public:
+  JobDescriptor(int fd, bool owned) : fd(fd), owned(owned) {}
+  JobDescriptor(const JobDescriptor &) = delete;
+  JobDescriptor &operator=(const JobDescriptor &) = delete;
+
+  ~JobDescriptor() {
+    close();
+  }
+
+  [[nodiscard]] int get() const {
+    return fd;
+  }
+
+  /**
+   * Returns false when the descriptor was opened here and closing it has failed
+   */
+  bool close() {
+    if (!owned || fd < 0) {
+      return true;
+    }
+    const bool closed = ::close(fd) == 0;
+    fd = -1;
+    return closed;
+  }
+
+ private:
+  int fd;
+  bool owned;
+};
+
+/**
+ * Removes the output file the job created unless it is committed, also when an exception leaves the job
+ */
+class PartialOutput {
+ public:
+  explicit PartialOutput(const std::string *path) : path(path) {}
+  PartialOutput(const PartialOutput &) = delete;
+  PartialOutput &operator=(const PartialOutput &) = delete;
+
+  ~PartialOutput() {
+    if (path) {
+      unlink(path->c_str());
+    }
+  }
+
+  void commit() {
+    path = nullptr;
+  }
+
+ private:
+  const std::string *path;
+};
+
+static JxlConstructionResult ConstructJob(const JxlConstructionJob &job, JxlConstruction &construction,
+                                          std::vector<uint8_t> &jpeg) {
+  JxlConstructionResult result;
+  {
+    JobDescriptor input(job.inputFd >= 0 ? job.inputFd : open(job.inputPath.c_str(), O_RDONLY | O_CLOEXEC),
+                        job.inputFd < 0);
+    if (input.get() < 0 || !ReadWholeFile(input.get(), jpeg)) {
+      result.status = CONSTRUCTION_READ_FAILED;
+      return result;
+    }
+  }
+  result.inputSize = jpeg.size();
+
+  const bool ownsOutput = job.outputFd < 0;
+  JobDescriptor output(ownsOutput ? open(job.outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)
+                                  : job.outputFd, ownsOutput);
+  if (output.get() < 0) {
+    result.status = CONSTRUCTION_WRITE_FAILED;
+    return result;
+  }
+  // Declared after the descriptor so the file is closed before it is unlinked
+  PartialOutput partialOutput(ownsOutput ? &job.outputPath : nullptr);
+
+  JxlFdSink sink(output.get());
+  if (!construction.construct(jpeg.data(), jpeg.size(), sink)) {
+    result.status = sink.hasFailed() ? CONSTRUCTION_WRITE_FAILED : CONSTRUCTION_ENCODE_FAILED;
+    return result;
+  }
+  sink.finish();
+  if (!output.close()) {
+    result.status = CONSTRUCTION_WRITE_FAILED;
+    return result;
+  }
+  partialOutput.commit();
+  result.outputSize = sink.getSize();
+  return result;
+}
+
+JxlBatchConstructionStats ConstructJxlBatch(const std::vector<JxlConstructionJob> &jobs, int effort,
+                                            int decodingSpeed, size_t parallelFiles,
+                                            std::vector<JxlConstructionResult> &results) {
+  const auto start = std::chrono::steady_clock::now();
+  results.assign(jobs.size(), JxlConstructionResult{});
+  if (parallelFiles == 0) {
+    parallelFiles = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  parallelFiles = std::min(parallelFiles, jobs.size());
+
+  // Jobs are taken one by one, so a few large files do not hold back a lane full of small ones
+  std::atomic<size_t> nextJob = 0;
+  auto worker = [&]() {
+    std::unique_ptr<JxlConstruction> construction;
+    std::vector<uint8_t> jpeg;
+    for (size_t index = nextJob++; index < jobs.size(); index = nextJob++) {
+      try {
+        if (!construction) {
+          construction = std::make_unique<JxlConstruction>(effort, decodingSpeed, 1);
+        }
+        results[index] = ConstructJob(jobs[index], *construction, jpeg);
+      } catch (std::bad_alloc &err) {
+        results[index].status = CONSTRUCTION_ENCODE_FAILED;
+        // The buffer of a huge file is not kept for the next ones
+        std::vector<uint8_t>().swap(jpeg);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < parallelFiles; ++i) {
+    workers.emplace_back(worker);
+  }
+  // Calling thread is one of the lanes
+  worker();
+  for (std::thread &thread : workers) {
+    thread.join();
+  }
+
+  JxlBatchConstructionStats stats;
+  for (const JxlConstructionResult &result : results) {
+    if (result.status != CONSTRUCTION_OK) {
+      stats.failed++;
+      continue;
+    }
+    stats.inputBytes += result.inputSize;
+    stats.outputBytes += result.outputSize;
+  }
+  stats.elapsedNanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  return stats;
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLBATCHCONSTRUCTION_H
+#define JXLCODER_JXLBATCHCONSTRUCTION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace coder {
+
+struct JxlConstructionJob {
+  // Paths are opened when descriptors are negative, given descriptors are left open
+  std::string inputPath;
+  std::string outputPath;
+  int inputFd = -1;
+  int outputFd = -1;
+};
+
+enum JxlConstructionStatus {
+  CONSTRUCTION_OK = 0,
+  CONSTRUCTION_READ_FAILED = 1,
+  CONSTRUCTION_ENCODE_FAILED = 2,
+  CONSTRUCTION_WRITE_FAILED = 3
+};
+
+struct JxlConstructionResult {
+  JxlConstructionStatus status = CONSTRUCTION_OK;
+  uint64_t inputSize = 0;
+  uint64_t outputSize = 0;
+};
+
+struct JxlBatchConstructionStats {
+  uint64_t inputBytes = 0;
+  uint64_t outputBytes = 0;
+  uint32_t failed = 0;
+  uint64_t elapsedNanos = 0;
+};
+
+/**
+ * Recompresses JPEG files losslessly, whole files are spread over `parallelFiles` workers
+ * and every worker encodes on its own thread with one encoder reset between files.
+ * For small JPEGs this keeps all cores busy where threads inside one image mostly wait for the setup.
+ * Output of a failed path job is removed. Results are in the order of jobs.
+ *
+ * @param parallelFiles files converted at the same time, 0 uses every core
+ */
+JxlBatchConstructionStats ConstructJxlBatch(const std::vector<JxlConstructionJob> &jobs, int effort,
+                                            int decodingSpeed, size_t parallelFiles,
+                                            std::vector<JxlConstructionResult> &results);
+
+}
+
+#endif //JXLCODER_JXLBATCHCONSTRUCTION_H
@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlBatchEncoder.h"
+#include "JxlChunkedInput.h"
+#include "JxlEncoding.h"
+#include "thread_parallel_runner.h"
+#include "thread_parallel_runner_cxx.h"
+#include "concurrency.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+
+namespace coder {
+
+/**
+ * Weaver output of one rendition
+ */
+class JxlScaledPixels {
+ public:
+  JxlScaledPixels() = default;
+  JxlScaledPixels(const JxlScaledPixels &) = delete;
+  JxlScaledPixels &operator=(const JxlScaledPixels &) = delete;
+
+  ~JxlScaledPixels() {
+    if (result8.data) {
+      weave_scaling_result_free(result8);
+    }
+    if (result16.data) {
+      weave_scaling_result16_free(result16);
+    }
+  }
+
+  bool scale(const uint8_t *pixels, uint32_t stride, uint32_t width, uint32_t height,
+             uint32_t scaledWidth, uint32_t scaledHeight, bool highBitDepth, bool hasAlpha,
+             ScalingFunction scalingFunction) {
+    if (highBitDepth) {
+      // Source stride is in bytes, weaver returns the scaled one in samples
+      result16 = weave_scale_u16(reinterpret_cast<const uint16_t *>(pixels), stride,
+                                 width, height,
+                                 static_cast<int32_t>(scaledWidth), static_cast<int32_t>(scaledHeight),
+                                 16, scalingFunction, hasAlpha, WeaveScaleMode::JustResize);
+      return result16.data != nullptr;
+    }
+    result8 = weave_scale_u8(pixels, stride, width, height,
+                             static_cast<int32_t>(scaledWidth), static_cast<int32_t>(scaledHeight),
+                             scalingFunction, hasAlpha, WeaveScaleMode::JustResize);
+    return result8.data != nullptr;
+  }
+
+  [[nodiscard]] const uint8_t *data() const {
+    return result16.data ? reinterpret_cast<const uint8_t *>(result16.data) : result8.data;
+  }
+
+  [[nodiscard]] uint32_t stride() const {
+    return result16.data ? static_cast<uint32_t>(result16.stride * sizeof(uint16_t))
+                         : static_cast<uint32_t>(result8.stride);
+  }
+
+ private:
+  ScalingResultU8 result8 = {};
+  ScalingResultU16 result16 = {};
+};
+
+static void FitRendition(uint32_t width, uint32_t height, const JxlRenditionSpec &spec,
+                         uint32_t &scaledWidth, uint32_t &scaledHeight) {
+  double scale = 1.0;
+  if (spec.maxWidth != 0 && spec.maxWidth < width) {
+    scale = std::min(scale, static_cast<double>(spec.maxWidth) / static_cast<double>(width));
+  }
+  if (spec.maxHeight != 0 && spec.maxHeight < height) {
+    scale = std::min(scale, static_cast<double>(spec.maxHeight) / static_cast<double>(height));
+  }
+  if (scale >= 1.0) {
+    scaledWidth = width;
+    scaledHeight = height;
+    return;
+  }
+  scaledWidth = std::max(static_cast<uint32_t>(std::lround(static_cast<double>(width) * scale)), 1u);
+  scaledHeight = std::max(static_cast<uint32_t>(std::lround(static_cast<double>(height) * scale)), 1u);
+}
+
+bool EncodeJxlRenditions(const uint8_t *pixels, uint32_t stride, uint32_t width, uint32_t height,
+                         bool highBitDepth, bool hasAlpha, ScalingFunction scalingFunction,
+                         JxlColorPixelType colorspace, std::vector<uint8_t> &iccProfile,
+                         int decodingSpeed, JxlColorEncoding &colorEncoding,
+                         const std::vector<JxlRenditionSpec> &specs, int parallelEncodes,
+                         std::vector<JxlRendition> &renditions) {
+  renditions.clear();
+  renditions.resize(specs.size());
+  if (specs.empty()) {
+    return true;
+  }
+
+  for (size_t i = 0; i < specs.size(); ++i) {
+    FitRendition(width, height, specs[i], renditions[i].width, renditions[i].height);
+  }
+
+  // Largest renditions go first so the smallest ones fill the lanes at the end
+  std::vector<size_t> order(specs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return static_cast<uint64_t>(renditions[a].width) * renditions[a].height >
+        static_cast<uint64_t>(renditions[b].width) * renditions[b].height;
+  });
+
+  const int lanesCount = std::clamp(parallelEncodes, 1, static_cast<int>(specs.size()));
+  const size_t workerThreads = std::max<size_t>(JxlThreadParallelRunnerDefaultNumWorkerThreads() / lanesCount, 1);
+  const JxlChunkedSourceFormat sourceFormat = highBitDepth ? SOURCE_RGBA_U16 : SOURCE_RGBA_U8;
+
+  std::atomic<size_t> next = 0;
+  std::atomic<bool> failed = false;
+
+  concurrency::parallel_for(lanesCount, lanesCount, [&](int) {
+    try {
+      // libjxl runner serves one encoder at a time, so it is shared only by renditions of the lane
+      auto runner = JxlThreadParallelRunnerMake(nullptr, workerThreads);
+      while (!failed) {
+        const size_t position = next.fetch_add(1);
+        if (position >= order.size()) {
+          break;
+        }
+        const size_t index = order[position];
+        const JxlRenditionSpec &spec = specs[index];
+        JxlRendition &rendition = renditions[index];
+
+        const uint8_t *renditionPixels = pixels;
+        uint32_t renditionStride = stride;
+        JxlScaledPixels scaled;
+        if (rendition.width != width || rendition.height != height) {
+          if (!scaled.scale(pixels, stride, width, height, rendition.width, rendition.height,
+                            highBitDepth, hasAlpha, scalingFunction)) {
+            failed = true;
+            break;
+          }
+          renditionPixels = scaled.data();
+          renditionStride = scaled.stride();
+        }
+
+        JxlBitmapChunkedInput input(renditionPixels, renditionStride, rendition.width, rendition.height,
+                                    sourceFormat, colorspace);
+        rendition.output = std::make_unique<JxlChunkListSink>();
+        if (!EncodeJxlChunked(input, rendition.width, rendition.height, *rendition.output, colorspace,
+                              spec.compressionOption, iccProfile, spec.effort, spec.distance, decodingSpeed,
+                              colorEncoding, false, workerThreads, runner.get())) {
+          failed = true;
+        }
+      }
+    } catch (std::bad_alloc &err) {
+      failed = true;
+    }
+  });
+
+  return !failed;
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLBATCHENCODER_H
+#define JXLCODER_JXLBATCHENCODER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "JxlDefinitions.h"
+#include "JxlOutputSink.h"
+#include "encode.h"
+#include "weaver.h"
+
+namespace coder {
+
+struct JxlRenditionSpec {
+  // Image is scaled down to fit into the box keeping its aspect ratio, 0 leaves the side unbounded.
+  // Images are never upscaled.
+  uint32_t maxWidth = 0;
+  uint32_t maxHeight = 0;
+  JxlCompressionOption compressionOption = lossy;
+  float distance = 1.0f;
+  int effort = 7;
+};
+
+struct JxlRendition {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::unique_ptr<JxlChunkListSink> output;
+};
+
+/**
+ * Encodes several renditions of one unassociated RGBA image, 8 or 16 bits per channel.
+ * Every downscale is made by weaver straight from the shared source and released once its rendition is encoded.
+ * Renditions are encoded concurrently on `parallelEncodes` lanes, largest first. Each lane keeps one runner
+ * for all its renditions, encoder threads are split between lanes.
+ * Renditions are returned in the order of specs.
+ */
+bool EncodeJxlRenditions(const uint8_t *pixels, uint32_t stride, uint32_t width, uint32_t height,
+                         bool highBitDepth, bool hasAlpha, ScalingFunction scalingFunction,
+                         JxlColorPixelType colorspace, std::vector<uint8_t> &iccProfile,
+                         int decodingSpeed, JxlColorEncoding &colorEncoding,
+                         const std::vector<JxlRenditionSpec> &specs, int parallelEncodes,
+                         std::vector<JxlRendition> &renditions);
+
+}
+
+#endif //JXLCODER_JXLBATCHENCODER_H
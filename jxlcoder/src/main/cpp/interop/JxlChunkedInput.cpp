@@ -0,0 +1,286 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlChunkedInput.h"
+#include "imagebit/RGBAlpha.h"
+#include "imagebit/Rgb565.h"
+#include "imagebit/Rgb1010102.h"
+#include "imagebit/RgbaToRgb.h"
+#include "conversion/RgbChannels.h"
+#include "hwy/base.h"
+
+namespace coder {
+
+JxlBitmapChunkedInput::JxlBitmapChunkedInput(const uint8_t *pixels, uint32_t stride,
+                                             uint32_t width, uint32_t height,
+                                             JxlChunkedSourceFormat sourceFormat,
+                                             JxlColorPixelType colorspace, bool opaque)
+    : pixels(pixels), stride(stride), width(width), height(height),
+      sourceFormat(sourceFormat), colorspace(colorspace), opaque(opaque) {
+  highBitDepth = sourceFormat == SOURCE_RGBA_F16 || sourceFormat == SOURCE_RGBA_1010102 ||
+      sourceFormat == SOURCE_RGBA_U16;
+}
+
+JxlChunkedFrameInputSource JxlChunkedInput::getInputSource() {
+  return JxlChunkedFrameInputSource{
+      .opaque = this,
+      .get_color_channels_pixel_format = getColorChannelsPixelFormat,
+      .get_color_channel_data_at = getColorChannelDataAt,
+      .get_extra_channel_pixel_format = getExtraChannelPixelFormat,
+      .get_extra_channel_data_at = getExtraChannelDataAt,
+      .release_buffer = releaseBuffer,
+  };
+}
+
+JxlPixelFormat JxlBitmapChunkedInput::pixelFormat(uint32_t channels) const {
+  JxlDataType dataType = highBitDepth ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8;
+  if (sourceFormat == SOURCE_RGBA_F16) {
+    dataType = JXL_TYPE_FLOAT16;
+  }
+  return {channels, dataType, JXL_NATIVE_ENDIAN, 0};
+}
+
+uint32_t JxlBitmapChunkedInput::colorChannels() const {
+  return JxlPixelTypeChannels(colorspace);
+}
+
+bool JxlBitmapChunkedInput::isSourceReady() const {
+  // Unpremultiplying opaque pixels changes nothing, half floats are given to the encoder as is
+  return (sourceFormat == SOURCE_RGBA_8888 && opaque) || sourceFormat == SOURCE_RGBA_F16 ||
+      sourceFormat == SOURCE_RGBA_U8 || sourceFormat == SOURCE_RGBA_U16;
+}
+
+void JxlBitmapChunkedInput::materialize() {
+  if (materialized || (isSourceReady() && colorChannels() == 4)) {
+    return;
+  }
+  size_t rowOffset = 0;
+  const void *data = convertTile(0, 0, width, height, false, &rowOffset);
+  materialized = takeLeasedTile(data);
+  materializedData = reinterpret_cast<const uint8_t *>(data);
+  materializedStride = rowOffset;
+}
+
+const void *JxlBitmapChunkedInput::convertTile(size_t xpos, size_t ypos, size_t xsize, size_t ysize,
+                                               bool alphaOnly, size_t *rowOffset) {
+  const uint32_t channels = alphaOnly ? 1 : colorChannels();
+  const bool sourceIsReady = isSourceReady();
+  const uint32_t componentSize = highBitDepth ? sizeof(uint16_t) : sizeof(uint8_t);
+  if (materialized && !alphaOnly) {
+    *rowOffset = materializedStride;
+    return materializedData + ypos * materializedStride + xpos * channels * componentSize;
+  }
+  if (sourceIsReady && channels == 4) {
+    // Released pointers which are not leased are ignored
+    *rowOffset = stride;
+    return pixels + ypos * stride + xpos * 4 * componentSize;
+  }
+
+  JxlStageTimer conversionTimer(instrumentation.load(), STAGE_CONVERSION);
+  std::unique_ptr<Tile> tile = acquireTile();
+
+  const uint32_t tileWidth = static_cast<uint32_t>(xsize);
+  const uint32_t tileHeight = static_cast<uint32_t>(ysize);
+  uint32_t rgbaStride = tileWidth * 4 * componentSize;
+  const uint8_t *rgba;
+  const size_t tileCapacity = tile->rgba.capacity() + tile->channels.capacity();
+
+  if (sourceIsReady) {
+    // Channels are picked straight from the source
+    rgbaStride = stride;
+    rgba = pixels + ypos * stride + xpos * 4 * componentSize;
+  } else {
+    tile->rgba.resize(rgbaStride * tileHeight);
+    rgba = tile->rgba.data();
+    switch (sourceFormat) {
+      case SOURCE_RGBA_8888: {
+        const uint8_t *src = pixels + ypos * stride + xpos * 4 * sizeof(uint8_t);
+        UnassociateRgba8(src, stride, tile->rgba.data(), rgbaStride, tileWidth, tileHeight);
+      }
+        break;
+      case SOURCE_RGB_565: {
+        const uint8_t *src = pixels + ypos * stride + xpos * sizeof(uint16_t);
+        Rgb565ToUnsigned8(reinterpret_cast<const uint16_t *>(src), stride,
+                          tile->rgba.data(), rgbaStride, tileWidth, tileHeight, 255);
+      }
+        break;
+      case SOURCE_RGBA_1010102: {
+        const uint8_t *src = pixels + ypos * stride + xpos * sizeof(uint32_t);
+        RGBA1010102ToUnsigned(src, stride,
+                              reinterpret_cast<uint16_t *>(tile->rgba.data()), rgbaStride,
+                              tileWidth, tileHeight, 16);
+      }
+        break;
+      case SOURCE_RGBA_F16:
+      case SOURCE_RGBA_U8:
+      case SOURCE_RGBA_U16:
+        // Always ready
+        break;
+    }
+  }
+
+  uint8_t *data = tile->rgba.data();
+  uint32_t dataStride = rgbaStride;
+
+  if (channels != 4) {
+    dataStride = tileWidth * channels * componentSize;
+    tile->channels.resize(dataStride * tileHeight);
+    if (channels == 2) {
+      if (sourceFormat == SOURCE_RGBA_F16) {
+        RGBAToGrayAlpha(reinterpret_cast<const hwy::float16_t *>(rgba), rgbaStride,
+                        reinterpret_cast<hwy::float16_t *>(tile->channels.data()), dataStride,
+                        tileWidth, tileHeight);
+      } else if (highBitDepth) {
+        RGBAToGrayAlpha(reinterpret_cast<const uint16_t *>(rgba), rgbaStride,
+                        reinterpret_cast<uint16_t *>(tile->channels.data()), dataStride,
+                        tileWidth, tileHeight);
+      } else {
+        RGBAToGrayAlpha(rgba, rgbaStride, tile->channels.data(), dataStride, tileWidth, tileHeight);
+      }
+    } else if (channels == 3) {
+      if (highBitDepth) {
+        Rgba16ToRgb16(reinterpret_cast<const uint16_t *>(rgba), rgbaStride,
+                      reinterpret_cast<uint16_t *>(tile->channels.data()), dataStride,
+                      tileWidth, tileHeight);
+      } else {
+        Rgba8ToRgb8(rgba, rgbaStride, tile->channels.data(), dataStride,
+                    tileWidth, tileHeight);
+      }
+    } else if (alphaOnly) {
+      if (highBitDepth) {
+        RGBAPickChannel(reinterpret_cast<const uint16_t *>(rgba), rgbaStride,
+                        reinterpret_cast<uint16_t *>(tile->channels.data()), dataStride,
+                        tileWidth, tileHeight, 3);
+      } else {
+        RGBAPickChannel(rgba, rgbaStride,
+                        reinterpret_cast<uint8_t *>(tile->channels.data()), dataStride,
+                        tileWidth, tileHeight, 3);
+      }
+    } else if (sourceFormat == SOURCE_RGBA_F16) {
+      RGBAToGray(reinterpret_cast<const hwy::float16_t *>(rgba), rgbaStride,
+                 reinterpret_cast<hwy::float16_t *>(tile->channels.data()), dataStride,
+                 tileWidth, tileHeight);
+    } else if (highBitDepth) {
+      RGBAToGray(reinterpret_cast<const uint16_t *>(rgba), rgbaStride,
+                 reinterpret_cast<uint16_t *>(tile->channels.data()), dataStride,
+                 tileWidth, tileHeight);
+    } else {
+      RGBAToGray(rgba, rgbaStride, tile->channels.data(), dataStride, tileWidth, tileHeight);
+    }
+    data = tile->channels.data();
+  }
+
+  if (JxlInstrumentation *stats = instrumentation.load()) {
+    const size_t grownCapacity = tile->rgba.capacity() + tile->channels.capacity();
+    stats->addAllocated(grownCapacity - tileCapacity);
+  }
+
+  *rowOffset = dataStride;
+  return leaseTile(data, std::move(tile));
+}
+
+std::unique_ptr<JxlChunkedInput::Tile> JxlChunkedInput::acquireTile() {
+  {
+    std::lock_guard guard(poolLock);
+    if (!freeTiles.empty()) {
+      std::unique_ptr<Tile> tile = std::move(freeTiles.back());
+      freeTiles.pop_back();
+      return tile;
+    }
+  }
+  return std::make_unique<Tile>();
+}
+
+const void *JxlChunkedInput::leaseTile(const void *data, std::unique_ptr<Tile> tile) {
+  std::lock_guard guard(poolLock);
+  leasedTiles[data] = std::move(tile);
+  return data;
+}
+
+std::unique_ptr<JxlChunkedInput::Tile> JxlChunkedInput::takeLeasedTile(const void *data) {
+  std::lock_guard guard(poolLock);
+  auto it = leasedTiles.find(data);
+  if (it == leasedTiles.end()) {
+    return nullptr;
+  }
+  std::unique_ptr<Tile> tile = std::move(it->second);
+  leasedTiles.erase(it);
+  return tile;
+}
+
+void JxlChunkedInput::releaseTile(const void *buf) {
+  std::lock_guard guard(poolLock);
+  auto it = leasedTiles.find(buf);
+  if (it == leasedTiles.end()) {
+    return;
+  }
+  freeTiles.push_back(std::move(it->second));
+  leasedTiles.erase(it);
+}
+
+void JxlChunkedInput::getColorChannelsPixelFormat(void *opaque, JxlPixelFormat *pixelFormat) {
+  auto input = reinterpret_cast<JxlChunkedInput *>(opaque);
+  // Alpha is always given interleaved with color, so it is never requested as an extra channel
+  *pixelFormat = input->pixelFormat(input->colorChannels());
+}
+
+const void *JxlChunkedInput::getColorChannelDataAt(void *opaque, size_t xpos, size_t ypos,
+                                                   size_t xsize, size_t ysize, size_t *rowOffset) {
+  auto input = reinterpret_cast<JxlChunkedInput *>(opaque);
+  try {
+    return input->convertTile(xpos, ypos, xsize, ysize, false, rowOffset);
+  } catch (std::bad_alloc &err) {
+    input->failed = true;
+    return nullptr;
+  }
+}
+
+void JxlChunkedInput::getExtraChannelPixelFormat(void *opaque, [[maybe_unused]] size_t ecIndex,
+                                                 JxlPixelFormat *pixelFormat) {
+  auto input = reinterpret_cast<JxlChunkedInput *>(opaque);
+  *pixelFormat = input->pixelFormat(1);
+}
+
+const void *JxlChunkedInput::getExtraChannelDataAt(void *opaque, [[maybe_unused]] size_t ecIndex,
+                                                   size_t xpos, size_t ypos, size_t xsize, size_t ysize,
+                                                   size_t *rowOffset) {
+  auto input = reinterpret_cast<JxlChunkedInput *>(opaque);
+  try {
+    return input->convertTile(xpos, ypos, xsize, ysize, true, rowOffset);
+  } catch (std::bad_alloc &err) {
+    input->failed = true;
+    return nullptr;
+  }
+}
+
+void JxlChunkedInput::releaseBuffer(void *opaque, const void *buf) {
+  auto input = reinterpret_cast<JxlChunkedInput *>(opaque);
+  input->releaseTile(buf);
+}
+
+}
@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLCHUNKEDINPUT_H
+#define JXLCODER_JXLCHUNKEDINPUT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "JxlDefinitions.h"
+#include "encode.h"
+#include "JxlInstrumentation.h"
+
+namespace coder {
+
+enum JxlChunkedSourceFormat {
+  // Android keeps RGBA_8888 alpha premultiplied
+  SOURCE_RGBA_8888 = 1,
+  SOURCE_RGBA_F16 = 2,
+  SOURCE_RGBA_1010102 = 3,
+  SOURCE_RGB_565 = 4,
+  // Already unassociated RGBA, 8 or 16 bits per channel
+  SOURCE_RGBA_U8 = 5,
+  SOURCE_RGBA_U16 = 6
+};
+
+/**
+ * Base of the sources handed to JxlEncoderAddChunkedFrame, every requested rectangle is converted
+ * into a small pooled scratch tile which is kept until libjxl releases it,
+ * so memory does not grow with the image size.
+ */
+class JxlChunkedInput {
+ public:
+  JxlChunkedInput() = default;
+  virtual ~JxlChunkedInput() = default;
+
+  JxlChunkedInput(const JxlChunkedInput &) = delete;
+  JxlChunkedInput &operator=(const JxlChunkedInput &) = delete;
+
+  JxlChunkedFrameInputSource getInputSource();
+
+  [[nodiscard]] virtual JxlEncodingPixelDataFormat getDataFormat() const = 0;
+
+  /**
+   * Tile conversion time and scratch buffer growth are added to the instrumentation, may be null
+   */
+  void setInstrumentation(JxlInstrumentation *value) {
+    instrumentation = value;
+  }
+
+  /**
+   * Tile conversion is called from libjxl without a way to report errors, it is checked after the frame is added
+   */
+  [[nodiscard]] bool hasFailed() const {
+    return failed;
+  }
+
+ protected:
+  struct Tile {
+    std::vector<uint8_t> rgba;
+    std::vector<uint8_t> channels;
+  };
+
+  // Parallel rate control probes encode one input at the same time, so both are shared between encoders
+  std::atomic<bool> failed = false;
+  std::atomic<JxlInstrumentation *> instrumentation = nullptr;
+
+  [[nodiscard]] virtual JxlPixelFormat pixelFormat(uint32_t channels) const = 0;
+  [[nodiscard]] virtual uint32_t colorChannels() const = 0;
+
+  /**
+   * Returns pixels of the rectangle, data of a pooled tile must be handed over to `leaseTile`
+   */
+  virtual const void *convertTile(size_t xpos, size_t ypos, size_t xsize, size_t ysize,
+                                  bool alphaOnly, size_t *rowOffset) = 0;
+
+  std::unique_ptr<Tile> acquireTile();
+  const void *leaseTile(const void *data, std::unique_ptr<Tile> tile);
+  std::unique_ptr<Tile> takeLeasedTile(const void *data);
+
+ private:
+  // libjxl may request several tiles at once from its worker threads
+  std::mutex poolLock;
+  std::vector<std::unique_ptr<Tile>> freeTiles;
+  std::unordered_map<const void *, std::unique_ptr<Tile>> leasedTiles;
+
+  void releaseTile(const void *buf);
+
+  static void getColorChannelsPixelFormat(void *opaque, JxlPixelFormat *pixelFormat);
+  static const void *getColorChannelDataAt(void *opaque, size_t xpos, size_t ypos,
+                                           size_t xsize, size_t ysize, size_t *rowOffset);
+  static void getExtraChannelPixelFormat(void *opaque, size_t ecIndex, JxlPixelFormat *pixelFormat);
+  static const void *getExtraChannelDataAt(void *opaque, size_t ecIndex, size_t xpos, size_t ypos,
+                                           size_t xsize, size_t ysize, size_t *rowOffset);
+  static void releaseBuffer(void *opaque, const void *buf);
+};
+
+/**
+ * Provides bitmap pixels tile by tile, source pixels must stay valid until the frame is added.
+ * Opaque RGBA_8888 and RGBA_F16 need no conversion for RGBA output, then tiles point straight into the source.
+ * RGBA_F16 is handed over as half floats, so extended range values are not clipped.
+ */
+class JxlBitmapChunkedInput : public JxlChunkedInput {
+ public:
+  JxlBitmapChunkedInput(const uint8_t *pixels, uint32_t stride, uint32_t width, uint32_t height,
+                        JxlChunkedSourceFormat sourceFormat, JxlColorPixelType colorspace,
+                        bool opaque = false);
+
+  [[nodiscard]] JxlEncodingPixelDataFormat getDataFormat() const override {
+    if (sourceFormat == SOURCE_RGBA_F16) {
+      return FLOAT_16;
+    }
+    return highBitDepth ? BINARY_16 : UNSIGNED_8;
+  }
+
+  /**
+   * Converts the whole image once and serves every next tile from it,
+   * for encoding the same pixels several times. Costs a full size buffer.
+   */
+  void materialize();
+
+ protected:
+  [[nodiscard]] JxlPixelFormat pixelFormat(uint32_t channels) const override;
+  [[nodiscard]] uint32_t colorChannels() const override;
+  const void *convertTile(size_t xpos, size_t ypos, size_t xsize, size_t ysize,
+                          bool alphaOnly, size_t *rowOffset) override;
+
+ private:
+  const uint8_t *pixels;
+  uint32_t stride;
+  uint32_t width;
+  uint32_t height;
+  JxlChunkedSourceFormat sourceFormat;
+  JxlColorPixelType colorspace;
+  bool opaque;
+  bool highBitDepth;
+
+  std::unique_ptr<Tile> materialized;
+  const uint8_t *materializedData = nullptr;
+  size_t materializedStride = 0;
+
+  bool isSourceReady() const;
+};
+
+}
+
+#endif //JXLCODER_JXLCHUNKEDINPUT_H
@@ -33,22 +33,39 @@
 #include "thread_parallel_runner.h"
 #include "thread_parallel_runner_cxx.h"
 #include <vector>
+#include "JxlOutputSink.h"
 
 namespace coder {
 
+/**
+ * Lossless JPEG recompression which keeps its encoder and runner between images,
+ * so converting many files pays the setup once. Not thread safe, one instance serves one thread at a time.
+ */
 class JxlConstruction {
  public:
-  JxlConstruction(std::vector<uint8_t> &data) : jpegData(data) {
-
+  /**
+   * @param workerThreads threads of the runner, 0 picks the libjxl default and 1 encodes on the calling thread
+   */
+  explicit JxlConstruction(int effort = 7, int decodingSpeed = 3, size_t workerThreads = 0)
+      : effort(effort), decodingSpeed(decodingSpeed), enc(JxlEncoderMake(nullptr)) {
+    const size_t threads = workerThreads ? workerThreads : JxlThreadParallelRunnerDefaultNumWorkerThreads();
+    if (threads > 1) {
+      runner = JxlThreadParallelRunnerMake(nullptr, threads);
+    }
   }
 
-  bool construct() {
-    auto enc = JxlEncoderMake(nullptr);
-    auto runner = JxlThreadParallelRunnerMake(nullptr,
-                                              JxlThreadParallelRunnerDefaultNumWorkerThreads());
-    if (JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc.get(),
-                                                       JxlThreadParallelRunner,
-                                                       runner.get())) {
+  /**
+   * JPEG is read in place and must stay valid until the call returns
+   */
+  bool construct(const uint8_t *jpegData, size_t jpegSize, JxlOutputSink &output) {
+    if (!enc) {
+      return false;
+    }
+    // Settings of the previous image are dropped, allocations of the encoder are kept
+    JxlEncoderReset(enc.get());
+    if (runner && JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc.get(),
+                                                                 JxlThreadParallelRunner,
+                                                                 runner.get())) {
       return false;
     }
 
@@ -64,50 +81,32 @@ class JxlConstruction {
     }
 
     if (JxlEncoderFrameSettingsSetOption(frameSettings,
-                                         JXL_ENC_FRAME_SETTING_EFFORT, 7) != JXL_ENC_SUCCESS) {
+                                         JXL_ENC_FRAME_SETTING_EFFORT, effort) != JXL_ENC_SUCCESS) {
       return false;
     }
 
     if (JXL_ENC_SUCCESS !=
-        JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_DECODING_SPEED, 3)) {
+        JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_DECODING_SPEED, decodingSpeed)) {
       return false;
     }
 
     if (JXL_ENC_SUCCESS !=
-        JxlEncoderAddJPEGFrame(frameSettings, jpegData.data(), jpegData.size())) {
+        JxlEncoderAddJPEGFrame(frameSettings, jpegData, jpegSize)) {
       return false;
     }
 
     JxlEncoderCloseInput(enc.get());
 
-    compressed.resize(64);
-    uint8_t *next_out = compressed.data();
-    size_t avail_out = compressed.size() - (next_out - compressed.data());
-    JxlEncoderStatus process_result = JXL_ENC_NEED_MORE_OUTPUT;
-    while (process_result == JXL_ENC_NEED_MORE_OUTPUT) {
-      process_result = JxlEncoderProcessOutput(enc.get(), &next_out, &avail_out);
-      if (process_result == JXL_ENC_NEED_MORE_OUTPUT) {
-        size_t offset = next_out - compressed.data();
-        compressed.resize(compressed.size() * 2);
-        next_out = compressed.data() + offset;
-        avail_out = compressed.size() - offset;
-      }
-    }
-    compressed.resize(next_out - compressed.data());
-    if (JXL_ENC_SUCCESS != process_result) {
-      return false;
-    }
-
-    return true;
-  }
-
-  std::vector<uint8_t> &getCompressedData() {
-    return compressed;
+    // Recompressed JPEG is usually about a fifth smaller than the original
+    output.reserve(jpegSize);
+    return JxlWriteEncoderOutput(enc.get(), output);
   }
 
  private:
-  const std::vector<uint8_t> jpegData;
-  std::vector<uint8_t> compressed;
+  int effort;
+  int decodingSpeed;
+  JxlEncoderPtr enc;
+  JxlThreadParallelRunnerPtr runner;
 };
 
 } // coder
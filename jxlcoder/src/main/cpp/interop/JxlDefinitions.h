@@ -29,6 +29,8 @@
 #ifndef JXLCODER_JXLDEFINITIONS_H
 #define JXLCODER_JXLDEFINITIONS_H
 
+#include <cstdint>
+
 enum JxlColorMatrix {
   MATRIX_ITUR_2020_PQ,
   MATRIX_ITUR_709,
@@ -43,9 +45,27 @@ enum JxlColorMatrix {
 enum JxlColorPixelType {
   rgb = 1,
   rgba = 2,
-  mono = 3
+  mono = 3,
+  // Gray with interleaved alpha, picked when gray images with transparency are detected
+  monoAlpha = 4
 };
 
+/**
+ * Channels of the interleaved pixels handed to the encoder
+ */
+static inline uint32_t JxlPixelTypeChannels(JxlColorPixelType colorspace) {
+  switch (colorspace) {
+    case mono:
+      return 1;
+    case monoAlpha:
+      return 2;
+    case rgb:
+      return 3;
+    default:
+      return 4;
+  }
+}
+
 enum JxlCompressionOption {
   loseless = 1,
   lossy = 2
@@ -53,7 +73,16 @@ enum JxlCompressionOption {
 
 enum JxlEncodingPixelDataFormat {
   UNSIGNED_8 = 1,
-  BINARY_16 = 2
+  BINARY_16 = 2,
+  // Half floats are stored as floats, so values out of 0..1 survive the encoding
+  FLOAT_16 = 3
+};
+
+enum JxlQualityMapping {
+  // Own curve of the coder, kept for compatibility of existing quality values
+  QUALITY_CODER = 0,
+  // JxlEncoderDistanceFromQuality, roughly matches libjpeg quality
+  QUALITY_LIBJXL = 1
 };
 
 #endif //JXLCODER_JXLDEFINITIONS_H
@@ -45,59 +45,61 @@ static inline float JXLGetDistance(int quality) {
                15.0f);
 }
 
-bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
-                      const uint32_t ysize, std::vector<uint8_t> *compressed,
-                      JxlColorPixelType colorspace, JxlCompressionOption compression_option,
-                      JxlEncodingPixelDataFormat encodingDataFormat,
-                      std::vector<uint8_t> &iccProfile, int effort, int quality,
-                      int decodingSpeed, JxlColorEncoding &colorEncoding) {
-  auto enc = JxlEncoderMake(nullptr);
-  auto runner = JxlThreadParallelRunnerMake(nullptr,
-                                            JxlThreadParallelRunnerDefaultNumWorkerThreads());
-  if (JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc.get(),
-                                                     JxlThreadParallelRunner,
-                                                     runner.get())) {
-    return false;
+float JxlQualityToDistance(int quality, JxlQualityMapping mapping) {
+  if (mapping == QUALITY_LIBJXL) {
+    return JxlEncoderDistanceFromQuality(static_cast<float>(quality));
   }
+  return JXLGetDistance(quality);
+}
 
-  JxlPixelFormat pixelFormat = {1, encodingDataFormat == BINARY_16 ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
-  uint32_t channelsCount = 1;
-  uint32_t baseChannelsCount = 1;
-  switch (colorspace) {
-    case mono: {
-      channelsCount = 1;
-      baseChannelsCount = 1;
-    }
-      break;
-    case rgb: {
-      channelsCount = 3;
-      baseChannelsCount = 3;
-    }
-      break;
-    case rgba: {
-      channelsCount = 4;
-      baseChannelsCount = 3;
-    }
-      break;
+static uint32_t JxlDataFormatBits(JxlEncodingPixelDataFormat encodingDataFormat) {
+  return encodingDataFormat == UNSIGNED_8 ? 8 : 16;
+}
+
+static JxlDataType JxlDataFormatType(JxlEncodingPixelDataFormat encodingDataFormat) {
+  switch (encodingDataFormat) {
+    case BINARY_16:
+      return JXL_TYPE_UINT16;
+    case FLOAT_16:
+      return JXL_TYPE_FLOAT16;
+    default:
+      return JXL_TYPE_UINT8;
+  }
+}
+
+static JxlEncoderFrameSettings *ConfigureJxlEncoder(JxlEncoder *enc, void *runner,
+                                                    const uint32_t xsize, const uint32_t ysize,
+                                                    JxlColorPixelType colorspace,
+                                                    JxlCompressionOption compression_option,
+                                                    JxlEncodingPixelDataFormat encodingDataFormat,
+                                                    std::vector<uint8_t> &iccProfile, int effort, float distance,
+                                                    int decodingSpeed, JxlColorEncoding &colorEncoding) {
+  if (JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc,
+                                                     JxlThreadParallelRunner,
+                                                     runner)) {
+    return nullptr;
   }
-  pixelFormat.num_channels = channelsCount;
 
+  uint32_t baseChannelsCount = colorspace == mono || colorspace == monoAlpha ? 1 : 3;
+  const bool hasAlpha = colorspace == rgba || colorspace == monoAlpha;
   JxlBasicInfo basicInfo;
   JxlEncoderInitBasicInfo(&basicInfo);
   basicInfo.xsize = xsize;
   basicInfo.ysize = ysize;
-  basicInfo.bits_per_sample = encodingDataFormat == BINARY_16 ? 16 : 8;
+  basicInfo.bits_per_sample = JxlDataFormatBits(encodingDataFormat);
+  basicInfo.exponent_bits_per_sample = encodingDataFormat == FLOAT_16 ? 5 : 0;
   basicInfo.uses_original_profile = compression_option == lossy ? JXL_FALSE : JXL_TRUE;
   basicInfo.num_color_channels = baseChannelsCount;
   basicInfo.alpha_premultiplied = false;
 
-  if (colorspace == rgba) {
+  if (hasAlpha) {
     basicInfo.num_extra_channels = 1;
-    basicInfo.alpha_bits = encodingDataFormat == BINARY_16 ? 16 : 8;
+    basicInfo.alpha_bits = JxlDataFormatBits(encodingDataFormat);
+    basicInfo.alpha_exponent_bits = encodingDataFormat == FLOAT_16 ? 5 : 0;
   }
 
-  if (JXL_ENC_SUCCESS != JxlEncoderSetBasicInfo(enc.get(), &basicInfo)) {
-    return false;
+  if (JXL_ENC_SUCCESS != JxlEncoderSetBasicInfo(enc, &basicInfo)) {
+    return nullptr;
   }
 
   switch (colorspace) {
@@ -109,14 +111,16 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
       basicInfo.num_color_channels = 3;
     }
       break;
-    case rgba: {
-      basicInfo.num_color_channels = 4;
+    case rgba:
+    case monoAlpha: {
+      basicInfo.num_color_channels = baseChannelsCount;
       JxlExtraChannelInfo channelInfo;
       JxlEncoderInitExtraChannelInfo(JXL_CHANNEL_ALPHA, &channelInfo);
-      channelInfo.bits_per_sample = encodingDataFormat == BINARY_16 ? 16 : 8;
+      channelInfo.bits_per_sample = JxlDataFormatBits(encodingDataFormat);
+      channelInfo.exponent_bits_per_sample = encodingDataFormat == FLOAT_16 ? 5 : 0;
       channelInfo.alpha_premultiplied = false;
-      if (JXL_ENC_SUCCESS != JxlEncoderSetExtraChannelInfo(enc.get(), 0, &channelInfo)) {
-        return false;
+      if (JXL_ENC_SUCCESS != JxlEncoderSetExtraChannelInfo(enc, 0, &channelInfo)) {
+        return nullptr;
       }
     }
       break;
@@ -124,43 +128,78 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
 
   if (!iccProfile.empty()) {
     if (JXL_ENC_SUCCESS !=
-        JxlEncoderSetICCProfile(enc.get(), iccProfile.data(), iccProfile.size())) {
-      return false;
+        JxlEncoderSetICCProfile(enc, iccProfile.data(), iccProfile.size())) {
+      return nullptr;
     }
   } else {
     JxlColorEncoding encoding;
     memcpy(&encoding, &colorEncoding, sizeof(JxlColorEncoding));
     if (JXL_ENC_SUCCESS !=
-        JxlEncoderSetColorEncoding(enc.get(), &colorEncoding)) {
-      return false;
+        JxlEncoderSetColorEncoding(enc, &colorEncoding)) {
+      return nullptr;
     }
   }
 
   JxlEncoderFrameSettings *frameSettings =
-      JxlEncoderFrameSettingsCreate(enc.get(), nullptr);
-
-  float distance = JXLGetDistance(quality);
+      JxlEncoderFrameSettingsCreate(enc, nullptr);
 
   if (compression_option == lossy &&
       JXL_ENC_SUCCESS != JxlEncoderSetFrameDistance(frameSettings, distance)) {
-    return false;
+    return nullptr;
   }
 
   if (JxlEncoderFrameSettingsSetOption(frameSettings,
                                        JXL_ENC_FRAME_SETTING_EFFORT, effort) != JXL_ENC_SUCCESS) {
-    return false;
+    return nullptr;
   }
 
   if (compression_option == loseless &&
       JXL_ENC_SUCCESS != JxlEncoderSetFrameLossless(frameSettings, JXL_TRUE)) {
-    return false;
+    return nullptr;
   }
 
   if (JXL_ENC_SUCCESS !=
       JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_DECODING_SPEED,
                                        decodingSpeed)) {
+    return nullptr;
+  }
+
+  return frameSettings;
+}
+
+bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
+                      const uint32_t ysize, coder::JxlOutputSink &output,
+                      JxlColorPixelType colorspace, JxlCompressionOption compression_option,
+                      JxlEncodingPixelDataFormat encodingDataFormat,
+                      std::vector<uint8_t> &iccProfile, int effort, float distance,
+                      int decodingSpeed, JxlColorEncoding &colorEncoding,
+                      coder::JxlInstrumentation *instrumentation) {
+  coder::JxlStageTimer encodeTimer(instrumentation, coder::STAGE_ENCODE);
+  auto enc = JxlEncoderMake(nullptr);
+  const size_t threads = JxlThreadParallelRunnerDefaultNumWorkerThreads();
+  auto runner = JxlThreadParallelRunnerMake(nullptr, threads);
+  // Encoded sections go directly into the output, libjxl does not gather the whole stream first
+  if (JXL_ENC_SUCCESS != JxlEncoderSetOutputProcessor(enc.get(), output.getOutputProcessor())) {
+    return false;
+  }
+  JxlEncoderFrameSettings *frameSettings = ConfigureJxlEncoder(enc.get(), runner.get(), xsize, ysize,
+                                                               colorspace, compression_option,
+                                                               encodingDataFormat, iccProfile,
+                                                               effort, distance, decodingSpeed,
+                                                               colorEncoding);
+  if (!frameSettings) {
     return false;
   }
+  if (instrumentation) {
+    instrumentation->setThreads(static_cast<uint32_t>(threads));
+    JxlEncoderCollectStats(frameSettings, instrumentation->encoderStats());
+  }
+
+  const uint32_t channelsCount = JxlPixelTypeChannels(colorspace);
+  output.reserve(coder::EstimateJxlOutputSize(xsize, ysize, channelsCount,
+                                              JxlDataFormatBits(encodingDataFormat),
+                                              compression_option == loseless, distance));
+  JxlPixelFormat pixelFormat = {channelsCount, JxlDataFormatType(encodingDataFormat), JXL_NATIVE_ENDIAN, 0};
 
   if (JXL_ENC_SUCCESS !=
       JxlEncoderAddImageFrame(frameSettings, &pixelFormat,
@@ -171,23 +210,62 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
 
   JxlEncoderCloseInput(enc.get());
 
-  compressed->resize(64);
-  uint8_t *next_out = compressed->data();
-  size_t avail_out = compressed->size() - (next_out - compressed->data());
-  JxlEncoderStatus process_result = JXL_ENC_NEED_MORE_OUTPUT;
-  while (process_result == JXL_ENC_NEED_MORE_OUTPUT) {
-    process_result = JxlEncoderProcessOutput(enc.get(), &next_out, &avail_out);
-    if (process_result == JXL_ENC_NEED_MORE_OUTPUT) {
-      size_t offset = next_out - compressed->data();
-      compressed->resize(compressed->size() * 2);
-      next_out = compressed->data() + offset;
-      avail_out = compressed->size() - offset;
-    }
+  if (JXL_ENC_SUCCESS != JxlEncoderFlushInput(enc.get())) {
+    return false;
   }
-  compressed->resize(next_out - compressed->data());
-  if (JXL_ENC_SUCCESS != process_result) {
+
+  return !output.hasFailed();
+}
+
+bool EncodeJxlChunked(coder::JxlChunkedInput &input, const uint32_t xsize,
+                      const uint32_t ysize, coder::JxlOutputSink &output,
+                      JxlColorPixelType colorspace, JxlCompressionOption compression_option,
+                      std::vector<uint8_t> &iccProfile, int effort, float distance,
+                      int decodingSpeed, JxlColorEncoding &colorEncoding, bool streaming,
+                      size_t workerThreads, void *runner,
+                      coder::JxlInstrumentation *instrumentation) {
+  coder::JxlStageTimer encodeTimer(instrumentation, coder::STAGE_ENCODE);
+  auto enc = JxlEncoderMake(nullptr);
+  const size_t threads = workerThreads ? workerThreads : JxlThreadParallelRunnerDefaultNumWorkerThreads();
+  JxlThreadParallelRunnerPtr ownRunner;
+  if (!runner) {
+    ownRunner = JxlThreadParallelRunnerMake(nullptr, threads);
+    runner = ownRunner.get();
+  }
+  // Encoded sections go directly into the output, libjxl does not gather the whole stream first
+  if (JXL_ENC_SUCCESS != JxlEncoderSetOutputProcessor(enc.get(), output.getOutputProcessor())) {
+    return false;
+  }
+  JxlEncoderFrameSettings *frameSettings = ConfigureJxlEncoder(enc.get(), runner, xsize, ysize,
+                                                               colorspace, compression_option,
+                                                               input.getDataFormat(), iccProfile,
+                                                               effort, distance, decodingSpeed,
+                                                               colorEncoding);
+  if (!frameSettings) {
+    return false;
+  }
+  if (instrumentation) {
+    instrumentation->setThreads(static_cast<uint32_t>(threads));
+    JxlEncoderCollectStats(frameSettings, instrumentation->encoderStats());
+  }
+
+  const uint32_t channelsCount = JxlPixelTypeChannels(colorspace);
+  output.reserve(coder::EstimateJxlOutputSize(xsize, ysize, channelsCount,
+                                              JxlDataFormatBits(input.getDataFormat()),
+                                              compression_option == loseless, distance));
+
+  // Lets the encoder work on groups as they are pulled instead of keeping the whole frame
+  if (streaming && JXL_ENC_SUCCESS !=
+      JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_BUFFERING, 2)) {
+    return false;
+  }
+
+  input.setInstrumentation(instrumentation);
+  if (JXL_ENC_SUCCESS !=
+      JxlEncoderAddChunkedFrame(frameSettings, JXL_TRUE, input.getInputSource())) {
     return false;
   }
 
-  return true;
+  // Last chunked frame closes and flushes the input by itself
+  return !input.hasFailed() && !output.hasFailed();
 }
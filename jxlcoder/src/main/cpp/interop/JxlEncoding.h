@@ -31,6 +31,9 @@
 #include <vector>
 #include "JxlDefinitions.h"
 #include "encode.h"
+#include "JxlChunkedInput.h"
+#include "JxlOutputSink.h"
+#include "JxlInstrumentation.h"
 
 /**
  * Compresses the provided pixels.
@@ -38,12 +41,37 @@
  * @param pixels input pixels
  * @param xsize width of the input image
  * @param ysize height of the input image
- * @param compressed will be populated with the compressed bytes
+ * @param output receives the compressed bytes
+ * @param instrumentation optional, receives encode time, threads and libjxl stats
  */
 bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
-                      const uint32_t ysize, std::vector<uint8_t> *compressed,
+                      const uint32_t ysize, coder::JxlOutputSink &output,
                       JxlColorPixelType colorspace, JxlCompressionOption compression_option,
                       JxlEncodingPixelDataFormat encodingPixelDataFormat,
                       std::vector<uint8_t> &iccProfile,
-                      int effort, int quality, int decodingSpeed,
-                      JxlColorEncoding &colorEncoding);
+                      int effort, float distance, int decodingSpeed,
+                      JxlColorEncoding &colorEncoding,
+                      coder::JxlInstrumentation *instrumentation = nullptr);
+
+/**
+ * Compresses pixels pulled tile by tile from the input, the whole image is never converted at once.
+ *
+ * @param streaming encoder processes groups as they are pulled instead of buffering the whole frame,
+ * keeps memory bounded for huge images at some compression cost
+ * @param workerThreads threads of the encoder runner, 0 picks the libjxl default
+ * @param runner JxlThreadParallelRunner kept by the caller between encodes, workerThreads are ignored when given
+ * @param instrumentation optional, receives encode and tile conversion time, threads and libjxl stats
+ */
+bool EncodeJxlChunked(coder::JxlChunkedInput &input, const uint32_t xsize,
+                      const uint32_t ysize, coder::JxlOutputSink &output,
+                      JxlColorPixelType colorspace, JxlCompressionOption compression_option,
+                      std::vector<uint8_t> &iccProfile,
+                      int effort, float distance, int decodingSpeed,
+                      JxlColorEncoding &colorEncoding, bool streaming,
+                      size_t workerThreads = 0, void *runner = nullptr,
+                      coder::JxlInstrumentation *instrumentation = nullptr);
+
+/**
+ * Butteraugli distance for the 0..100 quality
+ */
+float JxlQualityToDistance(int quality, JxlQualityMapping mapping);
@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLINSTRUMENTATION_H
+#define JXLCODER_JXLINSTRUMENTATION_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "encode.h"
+
+namespace coder {
+
+/**
+ * Stages of the encode and decode pipelines, order must match JxlPipelineStage on the Kotlin side
+ */
+enum JxlPipelineStage {
+  // Locking the bitmap or copying the input bytes
+  STAGE_INPUT = 0,
+  // Opacity and grayscale detection
+  STAGE_SCAN = 1,
+  // Unpremultiplying and repacking pixels for the encoder
+  STAGE_CONVERSION = 2,
+  STAGE_ENCODE = 3,
+  // Handing the encoded bytes over to Java
+  STAGE_OUTPUT = 4,
+  STAGE_DECODE = 5,
+  // ICC transform, color matrix and tone mapping
+  STAGE_COLOR = 6,
+  STAGE_SCALE = 7,
+  // Reformatting and writing pixels into the bitmap
+  STAGE_BITMAP = 8,
+  STAGE_COUNT = 9
+};
+
+/**
+ * Collects timings and counters of one encode or decode call, has no JNI dependency so host benchmarks may use it.
+ * Tiles are converted by the encoder threads while libjxl encodes, so conversion time is summed
+ * over threads and overlaps the encode stage.
+ */
+class JxlInstrumentation {
+ public:
+  JxlInstrumentation();
+
+  JxlInstrumentation(const JxlInstrumentation &) = delete;
+  JxlInstrumentation &operator=(const JxlInstrumentation &) = delete;
+
+  void addStageTime(JxlPipelineStage stage, uint64_t nanos) {
+    stages[stage].fetch_add(nanos, std::memory_order_relaxed);
+  }
+
+  /**
+   * Counts buffers the pipeline allocates for pixels and output, allocations inside libjxl are not seen
+   */
+  void addAllocated(uint64_t bytes) {
+    allocated.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  void setThreads(uint32_t count) {
+    threads = count;
+  }
+
+  /**
+   * Stats object to be given to JxlEncoderCollectStats,
+   * libjxl fills it only when built with stats enabled, otherwise every stat stays zero
+   */
+  JxlEncoderStats *encoderStats();
+
+  [[nodiscard]] uint64_t getStageNanos(JxlPipelineStage stage) const {
+    return stages[stage].load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] uint64_t getAllocatedBytes() const {
+    return allocated.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] uint32_t getThreads() const {
+    return threads;
+  }
+
+  [[nodiscard]] bool hasEncoderStats() const {
+    return stats != nullptr;
+  }
+
+  [[nodiscard]] size_t getEncoderStat(JxlEncoderStatsKey key) const;
+
+ private:
+  std::array<std::atomic<uint64_t>, STAGE_COUNT> stages;
+  std::atomic<uint64_t> allocated;
+  uint32_t threads = 0;
+  std::unique_ptr<JxlEncoderStats, void (*)(JxlEncoderStats *)> stats;
+};
+
+/**
+ * Adds the monotonic time between construction and `stop()` or destruction to the stage,
+ * does nothing when instrumentation is null
+ */
+class JxlStageTimer {
+ public:
+  JxlStageTimer(JxlInstrumentation *instrumentation, JxlPipelineStage stage)
+      : instrumentation(instrumentation), stage(stage) {
+    if (instrumentation) {
+      start = std::chrono::steady_clock::now();
+    }
+  }
+
+  JxlStageTimer(const JxlStageTimer &) = delete;
+  JxlStageTimer &operator=(const JxlStageTimer &) = delete;
+
+  void stop() {
+    if (!instrumentation) {
+      return;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    instrumentation->addStageTime(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    instrumentation = nullptr;
+  }
+
+  ~JxlStageTimer() {
+    stop();
+  }
+
+ private:
+  JxlInstrumentation *instrumentation;
+  JxlPipelineStage stage;
+  std::chrono::steady_clock::time_point start;
+};
+
+}
+
+#endif //JXLCODER_JXLINSTRUMENTATION_H
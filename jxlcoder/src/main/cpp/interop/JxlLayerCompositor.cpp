@@ -0,0 +1,147 @@
+//
+//  JxlLayerCompositor.cpp
+//  jxl-coder [https://github.com/awxkee/jxl-coder]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlLayerCompositor.hpp"
+#include <algorithm>
+#include <cmath>
+#include "imagebit/BlendRgba.h"
+
+namespace coder {
+
+JxlLayerCompositor::JxlLayerCompositor(uint32_t width, uint32_t height, bool alphaPremultiplied)
+    : width(width), height(height), alphaPremultiplied(alphaPremultiplied) {
+  canvas.resize(static_cast<size_t>(width) * height * 4, 0);
+}
+
+void JxlLayerCompositor::reset() {
+  std::fill(canvas.begin(), canvas.end(), 0);
+  referenceIsSet.fill(false);
+  referenceIsCanvas.fill(false);
+}
+
+void JxlLayerCompositor::detachReferences(int keepSlot) {
+  for (int slot = 0; slot < 4; ++slot) {
+    if (referenceIsCanvas[slot] && slot != keepSlot) {
+      references[slot].assign(canvas.begin(), canvas.end());
+      referenceIsCanvas[slot] = false;
+    }
+  }
+}
+
+static void BlendArithmeticRgba8(const uint8_t *src, uint32_t srcStride,
+                                 uint8_t *dst, uint32_t dstStride,
+                                 uint32_t width, uint32_t height,
+                                 JxlBlendMode mode) {
+  for (uint32_t y = 0; y < height; ++y) {
+    auto mSrc = src + y * srcStride;
+    auto mDst = dst + y * dstStride;
+    for (uint32_t x = 0; x < width; ++x) {
+      const float sa = static_cast<float>(mSrc[3]) / 255.f;
+      for (int c = 0; c < 4; ++c) {
+        const float s = static_cast<float>(mSrc[c]) / 255.f;
+        const float d = static_cast<float>(mDst[c]) / 255.f;
+        float v;
+        if (mode == JXL_BLEND_ADD) {
+          v = s + d;
+        } else if (mode == JXL_BLEND_MUL) {
+          v = s * d;
+        } else {
+          // JXL_BLEND_MULADD keeps background alpha
+          v = c == 3 ? d : d + s * sa;
+        }
+        mDst[c] = static_cast<uint8_t>(std::clamp(std::roundf(v * 255.f), 0.f, 255.f));
+      }
+      mSrc += 4;
+      mDst += 4;
+    }
+  }
+}
+
+void JxlLayerCompositor::compose(const JxlLayer &layer, JxlDirtyRect &dirty) {
+  const JxlLayerInfo &layerInfo = layer.layerInfo;
+  const JxlBlendInfo &blendInfo = layerInfo.blend_info;
+  const int source = std::clamp(static_cast<int>(blendInfo.source), 0, 3);
+  const bool canBeReferenced = !layer.isLast && (layer.durationTicks == 0 || layerInfo.save_as_reference != 0);
+  const int saveSlot = canBeReferenced ? std::clamp(static_cast<int>(layerInfo.save_as_reference), 0, 3) : -1;
+
+  int64_t layerX = layerInfo.have_crop ? layerInfo.crop_x0 : 0;
+  int64_t layerY = layerInfo.have_crop ? layerInfo.crop_y0 : 0;
+  const int64_t layerWidth = layerInfo.xsize;
+  const int64_t layerHeight = layerInfo.ysize;
+
+  const int64_t x0 = std::clamp<int64_t>(layerX, 0, width);
+  const int64_t y0 = std::clamp<int64_t>(layerY, 0, height);
+  const int64_t x1 = std::clamp<int64_t>(layerX + layerWidth, 0, width);
+  const int64_t y1 = std::clamp<int64_t>(layerY + layerHeight, 0, height);
+
+  const bool coversCanvas = blendInfo.blendmode == JXL_BLEND_REPLACE
+      && x0 == 0 && y0 == 0 && x1 == width && y1 == height;
+
+  const bool canvasHoldsSource = referenceIsCanvas[source];
+
+  // Slots aliasing the canvas must keep their content before it changes, the slot which will be overwritten may go
+  detachReferences(saveSlot);
+
+  if (!canvasHoldsSource && !coversCanvas) {
+    if (referenceIsSet[source]) {
+      std::copy(references[source].begin(), references[source].end(), canvas.begin());
+    } else {
+      std::fill(canvas.begin(), canvas.end(), 0);
+    }
+    dirty.add(0, 0, width, height);
+  }
+
+  if (x1 > x0 && y1 > y0) {
+    const uint32_t layerStride = static_cast<uint32_t>(layerWidth) * 4 * sizeof(uint8_t);
+    const uint8_t *src = layer.pixels.data() + (y0 - layerY) * layerStride + (x0 - layerX) * 4;
+    uint8_t *dst = canvas.data() + y0 * getStride() + x0 * 4;
+    const auto rectWidth = static_cast<uint32_t>(x1 - x0);
+    const auto rectHeight = static_cast<uint32_t>(y1 - y0);
+
+    switch (blendInfo.blendmode) {
+      case JXL_BLEND_REPLACE:
+        ReplaceRgba8(src, layerStride, dst, getStride(), rectWidth, rectHeight);
+        break;
+      case JXL_BLEND_BLEND:
+        if (alphaPremultiplied) {
+          BlendOverPremultipliedRgba8(src, layerStride, dst, getStride(), rectWidth, rectHeight);
+        } else {
+          BlendOverRgba8(src, layerStride, dst, getStride(), rectWidth, rectHeight);
+        }
+        break;
+      default:
+        BlendArithmeticRgba8(src, layerStride, dst, getStride(), rectWidth, rectHeight, blendInfo.blendmode);
+        break;
+    }
+    dirty.add(static_cast<uint32_t>(x0), static_cast<uint32_t>(y0), rectWidth, rectHeight);
+  }
+
+  if (saveSlot >= 0) {
+    referenceIsSet[saveSlot] = true;
+    referenceIsCanvas[saveSlot] = true;
+  }
+}
+
+}
@@ -0,0 +1,112 @@
+//
+//  JxlLayerCompositor.hpp
+//  jxl-coder [https://github.com/awxkee/jxl-coder]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#ifndef JxlLayerCompositor_hpp
+#define JxlLayerCompositor_hpp
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "JxlAnimatedDecoder.hpp"
+
+namespace coder {
+
+struct JxlDirtyRect {
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  [[nodiscard]] bool isEmpty() const {
+    return width == 0 || height == 0;
+  }
+
+  void add(uint32_t rx, uint32_t ry, uint32_t rWidth, uint32_t rHeight) {
+    if (rWidth == 0 || rHeight == 0) {
+      return;
+    }
+    if (isEmpty()) {
+      x = rx;
+      y = ry;
+      width = rWidth;
+      height = rHeight;
+      return;
+    }
+    uint32_t right = std::max(x + width, rx + rWidth);
+    uint32_t bottom = std::max(y + height, ry + rHeight);
+    x = std::min(x, rx);
+    y = std::min(y, ry);
+    width = right - x;
+    height = bottom - y;
+  }
+};
+
+/**
+ * Persistent canvas for non-coalesced playback.
+ * Layers are blended at their crop position onto the reference frame they name, as JXL spec says,
+ * reference slots which equal to the canvas are not copied until the canvas diverges from them.
+ */
+class JxlLayerCompositor {
+ public:
+  JxlLayerCompositor(uint32_t width, uint32_t height, bool alphaPremultiplied);
+
+  void reset();
+
+  /**
+   * Blends the layer into the canvas and extends dirty by the canvas region which has changed.
+   */
+  void compose(const JxlLayer &layer, JxlDirtyRect &dirty);
+
+  [[nodiscard]] const uint8_t *getCanvas() const {
+    return canvas.data();
+  }
+
+  [[nodiscard]] uint32_t getStride() const {
+    return width * 4 * sizeof(uint8_t);
+  }
+
+  [[nodiscard]] uint32_t getWidth() const {
+    return width;
+  }
+
+  [[nodiscard]] uint32_t getHeight() const {
+    return height;
+  }
+
+ private:
+  void detachReferences(int keepSlot);
+
+  uint32_t width;
+  uint32_t height;
+  bool alphaPremultiplied;
+  std::vector<uint8_t> canvas;
+  std::array<std::vector<uint8_t>, 4> references;
+  std::array<bool, 4> referenceIsSet = {false, false, false, false};
+  std::array<bool, 4> referenceIsCanvas = {false, false, false, false};
+};
+
+}
+
+#endif /* JxlLayerCompositor_hpp */
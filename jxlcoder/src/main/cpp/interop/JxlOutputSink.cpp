@@ -0,0 +1,280 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlOutputSink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <unistd.h>
+
+namespace coder {
+
+static constexpr size_t kMinChunkSize = 4096;
+static constexpr size_t kMaxChunkSize = 16 * 1024 * 1024;
+static constexpr size_t kFdStagingSize = 64 * 1024;
+
+JxlEncoderOutputProcessor JxlOutputSink::getOutputProcessor() {
+  return JxlEncoderOutputProcessor{
+      .opaque = this,
+      .get_buffer = getBuffer,
+      .release_buffer = releaseBuffer,
+      .seek = canSeek() ? seek : nullptr,
+      .set_finalized_position = setFinalizedPosition,
+  };
+}
+
+void *JxlOutputSink::getBuffer(void *opaque, size_t *size) {
+  auto sink = reinterpret_cast<JxlOutputSink *>(opaque);
+  uint8_t *buffer = nullptr;
+  if (!sink->failed) {
+    try {
+      buffer = sink->acquire(sink->position, size);
+    } catch (std::bad_alloc &err) {
+      buffer = nullptr;
+    }
+  }
+  if (!buffer) {
+    // Zero size with no buffer asks libjxl to stop
+    sink->failed = true;
+    *size = 0;
+  }
+  sink->activeBuffer = buffer;
+  return buffer;
+}
+
+void JxlOutputSink::releaseBuffer(void *opaque, size_t writtenBytes) {
+  auto sink = reinterpret_cast<JxlOutputSink *>(opaque);
+  if (sink->activeBuffer && writtenBytes) {
+    try {
+      sink->commit(sink->position, sink->activeBuffer, writtenBytes);
+    } catch (std::bad_alloc &err) {
+      sink->failed = true;
+    }
+  }
+  sink->activeBuffer = nullptr;
+  sink->position += writtenBytes;
+  sink->size = std::max(sink->size, sink->position);
+}
+
+void JxlOutputSink::seek(void *opaque, uint64_t position) {
+  auto sink = reinterpret_cast<JxlOutputSink *>(opaque);
+  sink->position = position;
+}
+
+void JxlOutputSink::setFinalizedPosition([[maybe_unused]] void *opaque,
+                                         [[maybe_unused]] uint64_t finalizedPosition) {
+  // Nothing is held back, every sink writes bytes as soon as they are released
+}
+
+bool JxlOutputSink::write(const uint8_t *data, size_t length) {
+  while (length) {
+    size_t available = length;
+    auto buffer = reinterpret_cast<uint8_t *>(getBuffer(this, &available));
+    if (!buffer || !available) {
+      failed = true;
+      return false;
+    }
+    const size_t written = std::min(available, length);
+    std::memcpy(buffer, data, written);
+    releaseBuffer(this, written);
+    data += written;
+    length -= written;
+  }
+  return !failed;
+}
+
+bool JxlWriteEncoderOutput(JxlEncoder *enc, JxlOutputSink &output) {
+  JxlEncoderStatus status = JXL_ENC_NEED_MORE_OUTPUT;
+  while (status == JXL_ENC_NEED_MORE_OUTPUT) {
+    size_t available = 0;
+    auto buffer = reinterpret_cast<uint8_t *>(JxlOutputSink::getBuffer(&output, &available));
+    if (!buffer) {
+      return false;
+    }
+    uint8_t *nextOut = buffer;
+    size_t availOut = available;
+    status = JxlEncoderProcessOutput(enc, &nextOut, &availOut);
+    JxlOutputSink::releaseBuffer(&output, nextOut - buffer);
+  }
+  return status == JXL_ENC_SUCCESS && !output.hasFailed();
+}
+
+size_t EstimateJxlOutputSize(uint32_t xsize, uint32_t ysize, uint32_t channels, uint32_t bitDepth,
+                             bool lossless, float distance) {
+  const double pixels = static_cast<double>(xsize) * static_cast<double>(ysize);
+  double bitsPerPixel;
+  if (lossless) {
+    // Lossless modular usually gets about a half of the raw size on photos
+    bitsPerPixel = static_cast<double>(channels * bitDepth) * 0.5;
+  } else {
+    // ~1.8 bpp at distance 1 for RGB, alpha adds a quarter and gray is cheaper
+    double channelsScale = channels >= 4 ? 1.25 : (channels < 3 ? 0.6 : 1.0);
+    bitsPerPixel = 1.8 * channelsScale / std::pow(std::max(static_cast<double>(distance), 0.05), 0.7);
+  }
+  return static_cast<size_t>(pixels * bitsPerPixel / 8.0) + kMinChunkSize;
+}
+
+void JxlChunkListSink::reserve(size_t size) {
+  if (chunks.empty()) {
+    nextChunkSize = std::clamp(size, kMinChunkSize, kMaxChunkSize);
+  }
+}
+
+size_t JxlChunkListSink::getAllocatedSize() const {
+  size_t allocated = staging.capacity();
+  for (const Chunk &chunk : chunks) {
+    allocated += chunk.data.capacity();
+  }
+  return allocated;
+}
+
+uint8_t *JxlChunkListSink::acquire(uint64_t position, size_t *size) {
+  if (position == end) {
+    stagingActive = false;
+    size_t room = chunks.empty() ? 0 : chunks.back().data.size() - chunks.back().used;
+    if (room == 0 || room < *size) {
+      // Tail of the previous chunk is left unused rather than moved anywhere
+      size_t chunkSize = std::max(nextChunkSize, *size);
+      chunks.push_back(Chunk{.data = std::vector<uint8_t>(chunkSize), .used = 0});
+      nextChunkSize = std::min(nextChunkSize * 2, kMaxChunkSize);
+    }
+    Chunk &last = chunks.back();
+    *size = last.data.size() - last.used;
+    return last.data.data() + last.used;
+  }
+  // Rewriting already produced bytes, libjxl patches section sizes this way
+  stagingActive = true;
+  staging.resize(std::max(*size, kMinChunkSize));
+  *size = staging.size();
+  return staging.data();
+}
+
+void JxlChunkListSink::commit(uint64_t position, const uint8_t *buffer, size_t written) {
+  if (stagingActive) {
+    writeAt(position, buffer, written);
+    return;
+  }
+  chunks.back().used += written;
+  end += written;
+}
+
+void JxlChunkListSink::writeAt(uint64_t position, const uint8_t *buffer, size_t length) {
+  uint64_t chunkStart = 0;
+  for (Chunk &chunk : chunks) {
+    if (length == 0) {
+      return;
+    }
+    uint64_t chunkEnd = chunkStart + chunk.used;
+    if (position < chunkEnd) {
+      size_t offset = position - chunkStart;
+      size_t toCopy = std::min(length, static_cast<size_t>(chunk.used - offset));
+      std::memcpy(chunk.data.data() + offset, buffer, toCopy);
+      buffer += toCopy;
+      length -= toCopy;
+      position += toCopy;
+    }
+    chunkStart = chunkEnd;
+  }
+  if (length) {
+    append(buffer, length);
+  }
+}
+
+void JxlChunkListSink::append(const uint8_t *buffer, size_t length) {
+  while (length) {
+    if (chunks.empty() || chunks.back().used == chunks.back().data.size()) {
+      chunks.push_back(Chunk{.data = std::vector<uint8_t>(nextChunkSize), .used = 0});
+      nextChunkSize = std::min(nextChunkSize * 2, kMaxChunkSize);
+    }
+    Chunk &last = chunks.back();
+    size_t toCopy = std::min(length, last.data.size() - last.used);
+    std::memcpy(last.data.data() + last.used, buffer, toCopy);
+    last.used += toCopy;
+    end += toCopy;
+    buffer += toCopy;
+    length -= toCopy;
+  }
+}
+
+void JxlChunkListSink::copyTo(uint8_t *dst) const {
+  forEachChunk([&dst](const uint8_t *data, size_t length) {
+    std::memcpy(dst, data, length);
+    dst += length;
+  });
+}
+
+uint8_t *JxlBufferSink::acquire(uint64_t position, size_t *size) {
+  if (position >= capacity) {
+    return nullptr;
+  }
+  *size = capacity - position;
+  return data + position;
+}
+
+JxlFdSink::JxlFdSink(int fd) : fd(fd) {
+  baseOffset = lseek(fd, 0, SEEK_CUR);
+}
+
+uint8_t *JxlFdSink::acquire([[maybe_unused]] uint64_t position, size_t *size) {
+  staging.resize(std::max(*size, kFdStagingSize));
+  *size = staging.size();
+  return staging.data();
+}
+
+void JxlFdSink::finish() {
+  // Leaves the descriptor where a sequential write of the output would
+  if (canSeek() && !failed) {
+    lseek(fd, static_cast<off_t>(baseOffset + getSize()), SEEK_SET);
+  }
+}
+
+void JxlFdSink::commit(uint64_t position, const uint8_t *buffer, size_t written) {
+  size_t offset = 0;
+  while (offset < written) {
+    ssize_t result;
+    if (canSeek()) {
+      // pwrite does not move the descriptor offset, so seeking back never races with it
+      result = pwrite(fd, buffer + offset, written - offset,
+                      static_cast<off_t>(baseOffset + position + offset));
+    } else {
+      result = ::write(fd, buffer + offset, written - offset);
+    }
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      failed = true;
+      return;
+    }
+    offset += static_cast<size_t>(result);
+  }
+}
+
+}
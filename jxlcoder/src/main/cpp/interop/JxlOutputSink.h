@@ -0,0 +1,205 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLOUTPUTSINK_H
+#define JXLCODER_JXLOUTPUTSINK_H
+
+#include <cstdint>
+#include <vector>
+#include "encode.h"
+
+namespace coder {
+
+/**
+ * Destination of the encoded stream, libjxl writes straight into the sink memory
+ * through JxlEncoderSetOutputProcessor, or through JxlEncoderProcessOutput with `JxlWriteEncoderOutput`.
+ */
+class JxlOutputSink {
+ public:
+  virtual ~JxlOutputSink() = default;
+
+  JxlEncoderOutputProcessor getOutputProcessor();
+
+  /**
+   * Hint of the expected encoded size, made once before encoding starts
+   */
+  virtual void reserve([[maybe_unused]] size_t size) {}
+
+  /**
+   * Called once after the whole output is written successfully
+   */
+  virtual void finish() {}
+
+  /**
+   * Appends already encoded bytes at the current position
+   */
+  bool write(const uint8_t *data, size_t length);
+
+  [[nodiscard]] bool hasFailed() const {
+    return failed;
+  }
+
+  /**
+   * Total bytes in the output
+   */
+  [[nodiscard]] uint64_t getSize() const {
+    return size;
+  }
+
+ protected:
+  /**
+   * Returns memory where bytes at the position go, size is a suggestion on input and the real size on output.
+   */
+  virtual uint8_t *acquire(uint64_t position, size_t *size) = 0;
+
+  /**
+   * Written bytes are in the memory returned by the last `acquire`
+   */
+  virtual void commit(uint64_t position, const uint8_t *buffer, size_t written) = 0;
+
+  [[nodiscard]] virtual bool canSeek() const {
+    return true;
+  }
+
+  bool failed = false;
+
+ private:
+  uint64_t position = 0;
+  uint64_t size = 0;
+  uint8_t *activeBuffer = nullptr;
+
+  static void *getBuffer(void *opaque, size_t *size);
+  static void releaseBuffer(void *opaque, size_t writtenBytes);
+  static void seek(void *opaque, uint64_t position);
+  static void setFinalizedPosition(void *opaque, uint64_t finalizedPosition);
+
+  friend bool JxlWriteEncoderOutput(JxlEncoder *enc, JxlOutputSink &output);
+};
+
+/**
+ * Growable list of fixed chunks, grown memory is never reallocated or copied
+ */
+class JxlChunkListSink : public JxlOutputSink {
+ public:
+  explicit JxlChunkListSink(size_t initialChunkSize = 64 * 1024) : nextChunkSize(initialChunkSize) {}
+
+  void reserve(size_t size) override;
+
+  /**
+   * Copies the whole output into dst which must hold `getSize()` bytes
+   */
+  void copyTo(uint8_t *dst) const;
+
+  /**
+   * Bytes held by the chunks and the staging buffer, may exceed `getSize()`
+   */
+  [[nodiscard]] size_t getAllocatedSize() const;
+
+  template<typename Function>
+  void forEachChunk(Function &&func) const {
+    for (const Chunk &chunk : chunks) {
+      if (chunk.used) {
+        func(chunk.data.data(), chunk.used);
+      }
+    }
+  }
+
+ protected:
+  uint8_t *acquire(uint64_t position, size_t *size) override;
+  void commit(uint64_t position, const uint8_t *buffer, size_t written) override;
+
+ private:
+  struct Chunk {
+    std::vector<uint8_t> data;
+    size_t used = 0;
+  };
+  std::vector<Chunk> chunks;
+  std::vector<uint8_t> staging;
+  size_t nextChunkSize;
+  uint64_t end = 0;
+  bool stagingActive = false;
+
+  void writeAt(uint64_t position, const uint8_t *buffer, size_t length);
+  void append(const uint8_t *buffer, size_t length);
+};
+
+/**
+ * Fixed memory, e.g. a direct byte buffer, encoding fails when it is too small
+ */
+class JxlBufferSink : public JxlOutputSink {
+ public:
+  JxlBufferSink(uint8_t *data, size_t capacity) : data(data), capacity(capacity) {}
+
+ protected:
+  uint8_t *acquire(uint64_t position, size_t *size) override;
+  void commit([[maybe_unused]] uint64_t position, [[maybe_unused]] const uint8_t *buffer,
+              [[maybe_unused]] size_t written) override {}
+
+ private:
+  uint8_t *data;
+  size_t capacity;
+};
+
+/**
+ * Writes into a file descriptor from its current offset, seekable files are written with pwrite
+ * and their descriptor offset is moved past the output only by `finish`. Pipes and sockets are
+ * written sequentially, then libjxl keeps the parts it has to patch later by itself.
+ */
+class JxlFdSink : public JxlOutputSink {
+ public:
+  explicit JxlFdSink(int fd);
+
+  void finish() override;
+
+ protected:
+  uint8_t *acquire(uint64_t position, size_t *size) override;
+  void commit(uint64_t position, const uint8_t *buffer, size_t written) override;
+  [[nodiscard]] bool canSeek() const override {
+    return baseOffset >= 0;
+  }
+
+ private:
+  int fd;
+  int64_t baseOffset;
+  std::vector<uint8_t> staging;
+};
+
+/**
+ * Drains the encoder with JxlEncoderProcessOutput into the sink, for encoders without an output processor.
+ */
+bool JxlWriteEncoderOutput(JxlEncoder *enc, JxlOutputSink &output);
+
+/**
+ * Rough encoded size from the pixel count, used to size the first output chunk
+ */
+size_t EstimateJxlOutputSize(uint32_t xsize, uint32_t ysize, uint32_t channels, uint32_t bitDepth,
+                             bool lossless, float distance);
+
+}
+
+#endif //JXLCODER_JXLOUTPUTSINK_H
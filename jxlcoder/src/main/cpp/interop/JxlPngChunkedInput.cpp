@@ -0,0 +1,215 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlPngChunkedInput.h"
+#include <cstring>
+
+namespace coder {
+
+JxlPngChunkedInput::JxlPngChunkedInput(ByteInput &input) : input(input) {}
+
+JxlPngChunkedInput::~JxlPngChunkedInput() {
+  if (png) {
+    png_destroy_read_struct(&png, info ? &info : nullptr, nullptr);
+  }
+}
+
+bool JxlPngChunkedInput::readHeader() {
+  png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  if (!png) {
+    return false;
+  }
+  info = png_create_info_struct(png);
+  if (!info) {
+    return false;
+  }
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  AttachPngInput(png, input);
+  png_read_info(png, info);
+
+  // Palette to RGB, gray of 1, 2 and 4 bits to 8 bits and tRNS to a real alpha channel,
+  // 16 bit samples and gray are kept
+  png_set_expand(png);
+  interlaced = png_get_interlace_type(png, info) != PNG_INTERLACE_NONE;
+  passes = static_cast<uint32_t>(png_set_interlace_handling(png));
+  png_read_update_info(png, info);
+
+  width = png_get_image_width(png, info);
+  height = png_get_image_height(png, info);
+  channels = png_get_channels(png, info);
+  bitDepth = png_get_bit_depth(png, info);
+  rowStride = png_get_rowbytes(png, info);
+
+  png_charp iccpName = nullptr;
+  int compressionType = 0;
+  png_bytep iccpData = nullptr;
+  png_uint_32 iccpLength = 0;
+  if (png_get_iCCP(png, info, &iccpName, &compressionType, &iccpData, &iccpLength) && iccpLength > 0) {
+    iccProfile.assign(iccpData, iccpData + iccpLength);
+  }
+  return width > 0 && height > 0 && channels >= 1 && channels <= 4;
+}
+
+JxlColorPixelType JxlPngChunkedInput::getColorspace() const {
+  switch (channels) {
+    case 1:
+      return mono;
+    case 2:
+      return monoAlpha;
+    case 3:
+      return rgb;
+    default:
+      return rgba;
+  }
+}
+
+JxlPixelFormat JxlPngChunkedInput::pixelFormat(uint32_t channelsCount) const {
+  // PNG stores 16 bit samples in network order, libjxl swaps them itself
+  return {channelsCount, bitDepth == 16 ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8, JXL_BIG_ENDIAN, 0};
+}
+
+bool JxlPngChunkedInput::readRows(uint8_t *rows, size_t count, size_t rowStep) {
+  // Nothing owning resources may live in this frame, libpng errors jump straight back here
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    png_read_row(png, rows + i * rowStep, nullptr);
+  }
+  return true;
+}
+
+bool JxlPngChunkedInput::fillStripe(size_t ypos, size_t ysize) {
+  const size_t stripeCapacity = stripe.capacity();
+  if (ypos + ysize > height) {
+    return false;
+  }
+
+  if (interlaced) {
+    // Every pass touches all rows, so the image is read once as a whole
+    if (stripeRows == 0) {
+      stripe.resize(rowStride * height);
+      for (uint32_t pass = 0; pass < passes; ++pass) {
+        if (!readRows(stripe.data(), height, rowStride)) {
+          return false;
+        }
+      }
+      stripeRows = height;
+    }
+  } else {
+    if (ypos < stripeTop) {
+      // libpng cannot seek back, the encoder asked for rows it has already moved past
+      return false;
+    }
+    const size_t rowsRead = stripeTop + stripeRows;
+    if (ypos > stripeTop) {
+      // Rows above the request are never asked for again
+      const size_t kept = rowsRead > ypos ? rowsRead - ypos : 0;
+      if (kept > 0) {
+        std::memmove(stripe.data(), stripe.data() + (ypos - stripeTop) * rowStride, kept * rowStride);
+      }
+      stripeRows = kept;
+      if (rowsRead < ypos) {
+        // Rows which are never requested are decoded over the same scratch row
+        if (stripe.size() < rowStride) {
+          stripe.resize(rowStride);
+        }
+        if (!readRows(stripe.data(), ypos - rowsRead, 0)) {
+          return false;
+        }
+      }
+      stripeTop = ypos;
+    }
+    const size_t rowsNeeded = ypos + ysize - stripeTop;
+    if (rowsNeeded > stripeRows) {
+      if (stripe.size() < rowsNeeded * rowStride) {
+        stripe.resize(rowsNeeded * rowStride);
+      }
+      if (!readRows(stripe.data() + stripeRows * rowStride, rowsNeeded - stripeRows, rowStride)) {
+        return false;
+      }
+      stripeRows = rowsNeeded;
+    }
+  }
+
+  JxlInstrumentation *stats = instrumentation.load();
+  if (stats && stripe.capacity() > stripeCapacity) {
+    stats->addAllocated(stripe.capacity() - stripeCapacity);
+  }
+  return true;
+}
+
+const void *JxlPngChunkedInput::convertTile(size_t xpos, size_t ypos, size_t xsize, size_t ysize,
+                                            bool alphaOnly, size_t *rowOffset) {
+  if (alphaOnly && channels != 2 && channels != 4) {
+    failed = true;
+    return nullptr;
+  }
+  JxlStageTimer conversionTimer(instrumentation.load(), STAGE_CONVERSION);
+  std::unique_ptr<Tile> tile = acquireTile();
+  const size_t tileCapacity = tile->rgba.capacity() + tile->channels.capacity();
+
+  const size_t componentSize = bitDepth == 16 ? sizeof(uint16_t) : sizeof(uint8_t);
+  const size_t pixelSize = channels * componentSize;
+  const size_t dataStride = xsize * (alphaOnly ? componentSize : pixelSize);
+  tile->channels.resize(dataStride * ysize);
+
+  {
+    std::lock_guard guard(rowsLock);
+    if (!fillStripe(ypos, ysize)) {
+      failed = true;
+      return nullptr;
+    }
+    for (size_t row = 0; row < ysize; ++row) {
+      const uint8_t *src = stripe.data() + (ypos - stripeTop + row) * rowStride + xpos * pixelSize;
+      uint8_t *dst = tile->channels.data() + row * dataStride;
+      if (!alphaOnly) {
+        std::memcpy(dst, src, xsize * pixelSize);
+        continue;
+      }
+      // Alpha is the last sample of every pixel
+      src += pixelSize - componentSize;
+      for (size_t x = 0; x < xsize; ++x) {
+        std::memcpy(dst + x * componentSize, src + x * pixelSize, componentSize);
+      }
+    }
+  }
+
+  if (JxlInstrumentation *stats = instrumentation.load()) {
+    const size_t grownCapacity = tile->rgba.capacity() + tile->channels.capacity();
+    stats->addAllocated(grownCapacity - tileCapacity);
+  }
+
+  const uint8_t *data = tile->channels.data();
+  *rowOffset = dataStride;
+  return leaseTile(data, std::move(tile));
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLPNGCHUNKEDINPUT_H
+#define JXLCODER_JXLPNGCHUNKEDINPUT_H
+
+#include <mutex>
+#include "JxlChunkedInput.h"
+#include "PngInput.h"
+
+namespace coder {
+
+/**
+ * Decodes PNG rows with libpng while the encoder pulls tiles, only the rows of the requested rectangles are kept.
+ * Gray, gray with alpha and 16 bit samples are handed over as they are stored, palettes and
+ * low bit depth gray are expanded to 8 bits. Interlaced images are read whole before the first tile.
+ */
+class JxlPngChunkedInput : public JxlChunkedInput {
+ public:
+  explicit JxlPngChunkedInput(ByteInput &input);
+  ~JxlPngChunkedInput() override;
+
+  /**
+   * Reads the header and prepares the row transforms, false when the data is not a valid PNG
+   */
+  bool readHeader();
+
+  [[nodiscard]] JxlEncodingPixelDataFormat getDataFormat() const override {
+    return bitDepth == 16 ? BINARY_16 : UNSIGNED_8;
+  }
+
+  [[nodiscard]] uint32_t getWidth() const {
+    return width;
+  }
+
+  [[nodiscard]] uint32_t getHeight() const {
+    return height;
+  }
+
+  [[nodiscard]] JxlColorPixelType getColorspace() const;
+
+  /**
+   * Embedded iCCP profile, empty when the PNG has none
+   */
+  std::vector<uint8_t> &getIccProfile() {
+    return iccProfile;
+  }
+
+ protected:
+  [[nodiscard]] JxlPixelFormat pixelFormat(uint32_t channels) const override;
+  [[nodiscard]] uint32_t colorChannels() const override {
+    return channels;
+  }
+  const void *convertTile(size_t xpos, size_t ypos, size_t xsize, size_t ysize,
+                          bool alphaOnly, size_t *rowOffset) override;
+
+ private:
+  ByteInput &input;
+  png_structp png = nullptr;
+  png_infop info = nullptr;
+
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t channels = 0;
+  uint32_t bitDepth = 8;
+  bool interlaced = false;
+  uint32_t passes = 1;
+  size_t rowStride = 0;
+  std::vector<uint8_t> iccProfile;
+
+  // libpng reads forward only, tiles are requested from several encoder threads
+  std::mutex rowsLock;
+  std::vector<uint8_t> stripe;
+  size_t stripeTop = 0;
+  size_t stripeRows = 0;
+
+  bool fillStripe(size_t ypos, size_t ysize);
+  bool readRows(uint8_t *rows, size_t count, size_t rowStep);
+};
+
+}
+
+#endif //JXLCODER_JXLPNGCHUNKEDINPUT_H
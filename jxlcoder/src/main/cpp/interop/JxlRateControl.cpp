@@ -0,0 +1,405 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlRateControl.h"
+#include "JxlEncoding.h"
+#include "thread_parallel_runner.h"
+#include "thread_parallel_runner_cxx.h"
+#include "decode.h"
+#include "decode_cxx.h"
+#include "concurrency.hpp"
+#include "metrics/Ssimulacra2.h"
+#include <algorithm>
+#include <cmath>
+
+namespace coder {
+
+struct JxlRateProbe {
+  float distance = 0;
+  std::unique_ptr<JxlChunkListSink> output;
+  bool encoded = false;
+  double score = 0;
+};
+
+/**
+ * Decodes the probe into unassociated RGBA 8 bit pixels of the image size
+ */
+static bool DecodeRateProbe(const JxlChunkListSink &probe, size_t workerThreads, std::vector<uint8_t> &pixels) {
+  std::vector<uint8_t> data(probe.getSize());
+  probe.copyTo(data.data());
+  JxlDecoderPtr dec = JxlDecoderMake(nullptr);
+  JxlThreadParallelRunnerPtr runner = JxlThreadParallelRunnerMake(nullptr, workerThreads);
+  if (!dec || !runner
+      || JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FULL_IMAGE)
+      || JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(dec.get(), JxlThreadParallelRunner, runner.get())
+      || JXL_DEC_SUCCESS != JxlDecoderSetInput(dec.get(), data.data(), data.size())) {
+    return false;
+  }
+  JxlDecoderCloseInput(dec.get());
+
+  const JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+  while (true) {
+    JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+    if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+      size_t bufferSize;
+      if (JXL_DEC_SUCCESS != JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize)
+          || bufferSize != pixels.size()
+          || JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec.get(), &format, pixels.data(), pixels.size())) {
+        return false;
+      }
+    } else if (status != JXL_DEC_FULL_IMAGE) {
+      return status == JXL_DEC_SUCCESS;
+    }
+  }
+}
+
+bool EncodeJxlToTargetSize(JxlBitmapChunkedInput &input, uint32_t xsize, uint32_t ysize,
+                           JxlOutputSink &output,
+                           JxlColorPixelType colorspace, std::vector<uint8_t> &iccProfile,
+                           int effort, int decodingSpeed, JxlColorEncoding &colorEncoding,
+                           const JxlRateControlOptions &options, JxlRateControlResult &result) {
+  result = JxlRateControlResult();
+  if (options.targetSize == 0) {
+    return false;
+  }
+
+  input.materialize();
+
+  const int probesCount = std::max(options.parallelProbes, 1);
+  const size_t workerThreads = std::max<size_t>(JxlThreadParallelRunnerDefaultNumWorkerThreads() / probesCount, 1);
+
+  // Search works on logarithms of the distance and of the size
+  const float lowest = std::log(options.minDistance);
+  const float highest = std::log(options.maxDistance);
+  const float targetLog = std::log(static_cast<float>(options.targetSize) * (1.0f - options.tolerance * 0.5f));
+  const auto acceptedSize = static_cast<uint64_t>(static_cast<float>(options.targetSize) * (1.0f - options.tolerance));
+
+  // Lowest distance known to fit and highest one known to be too large
+  bool haveFit = false, haveOver = false;
+  float fitX = 0, fitY = 0, overX = 0, overY = 0;
+  // Size falls about as distance^-0.7, refined by every pair of probes
+  float slope = -0.7f;
+
+  std::unique_ptr<JxlChunkListSink> best;
+  float bestDistance = 0;
+  std::unique_ptr<JxlChunkListSink> smallest;
+  float smallestDistance = 0;
+
+  for (int iteration = 0; iteration < options.maxIterations; ++iteration) {
+    float guess;
+    if (haveFit && haveOver) {
+      const float width = fitX - overX;
+      const float bracketSlope = (fitY - overY) / width;
+      guess = overX + width * 0.5f;
+      if (bracketSlope < 0) {
+        guess = std::clamp(overX + (targetLog - overY) / bracketSlope,
+                           overX + width * 0.1f, fitX - width * 0.1f);
+      }
+    } else if (haveFit) {
+      guess = fitX + (targetLog - fitY) / slope;
+    } else if (haveOver) {
+      guess = overX + (targetLog - overY) / slope;
+    } else {
+      guess = std::log(options.initialDistance);
+    }
+    const float rangeStart = haveOver ? overX : lowest;
+    const float rangeEnd = haveFit ? fitX : highest;
+    guess = std::clamp(guess, rangeStart, rangeEnd);
+
+    // Extra probes split the current bracket evenly
+    std::vector<JxlRateProbe> probes(probesCount);
+    probes[0].distance = std::exp(guess);
+    for (int i = 1; i < probesCount; ++i) {
+      probes[i].distance = std::exp(rangeStart + (rangeEnd - rangeStart) * static_cast<float>(i)
+          / static_cast<float>(probesCount));
+    }
+
+    concurrency::parallel_for(probesCount, probesCount, [&](int index) {
+      JxlRateProbe &probe = probes[index];
+      try {
+        probe.output = std::make_unique<JxlChunkListSink>();
+        probe.encoded = EncodeJxlChunked(input, xsize, ysize, *probe.output, colorspace, lossy,
+                                         iccProfile, effort, probe.distance, decodingSpeed,
+                                         colorEncoding, false, workerThreads);
+      } catch (std::bad_alloc &err) {
+        probe.encoded = false;
+      }
+    });
+
+    result.iterations += 1;
+    result.encodes += probesCount;
+
+    std::sort(probes.begin(), probes.end(), [](const JxlRateProbe &a, const JxlRateProbe &b) {
+      return a.distance < b.distance;
+    });
+
+    bool haveLast = false;
+    float lastX = 0, lastY = 0;
+    for (JxlRateProbe &probe : probes) {
+      if (!probe.encoded) {
+        return false;
+      }
+      const uint64_t size = probe.output->getSize();
+      const float x = std::log(probe.distance);
+      const float y = std::log(static_cast<float>(std::max<uint64_t>(size, 1)));
+      if (haveLast && x - lastX > 1e-3f) {
+        const float measured = (y - lastY) / (x - lastX);
+        if (measured < -0.05f) {
+          slope = measured;
+        }
+      }
+      haveLast = true;
+      lastX = x;
+      lastY = y;
+
+      if (size <= options.targetSize) {
+        if (!haveFit || x < fitX) {
+          if (haveOver && x - overX > 1e-3f) {
+            const float measured = (y - overY) / (x - overX);
+            if (measured < -0.05f) {
+              slope = measured;
+            }
+          }
+          haveFit = true;
+          fitX = x;
+          fitY = y;
+        }
+        if (!best || size > best->getSize()) {
+          best = std::move(probe.output);
+          bestDistance = probe.distance;
+        }
+      } else {
+        if (!haveOver || x > overX) {
+          haveOver = true;
+          overX = x;
+          overY = y;
+        }
+        if (!best && (!smallest || size < smallest->getSize())) {
+          smallest = std::move(probe.output);
+          smallestDistance = probe.distance;
+        }
+      }
+    }
+
+    if (best && best->getSize() >= acceptedSize) {
+      break;
+    }
+    // Bracket is too narrow to change the size noticeably, or sizes are not monotonic anymore
+    if (haveFit && haveOver && fitX - overX < 0.01f) {
+      break;
+    }
+    // Distance cannot be lowered nor raised anymore
+    if ((haveFit && fitX <= lowest + 1e-4f) || (haveOver && overX >= highest - 1e-4f)) {
+      break;
+    }
+  }
+
+  const JxlChunkListSink *chosen = best ? best.get() : smallest.get();
+  if (!chosen) {
+    return false;
+  }
+  result.distance = best ? bestDistance : smallestDistance;
+  result.targetReached = best != nullptr;
+  result.size = chosen->getSize();
+  bool written = true;
+  chosen->forEachChunk([&](const uint8_t *data, size_t length) {
+    written = written && output.write(data, length);
+  });
+  return written;
+}
+
+bool EncodeJxlToTargetScore(JxlBitmapChunkedInput &input, uint32_t xsize, uint32_t ysize,
+                            JxlOutputSink &output,
+                            JxlColorPixelType colorspace, std::vector<uint8_t> &iccProfile,
+                            int effort, int decodingSpeed, JxlColorEncoding &colorEncoding,
+                            const uint8_t *reference, uint32_t referenceStride,
+                            const JxlRateControlOptions &options, JxlRateControlResult &result) {
+  result = JxlRateControlResult();
+  if (options.targetScore <= 0 || options.targetScore > 100) {
+    return false;
+  }
+
+  input.materialize();
+
+  const int probesCount = std::max(options.parallelProbes, 1);
+  const size_t workerThreads = std::max<size_t>(JxlThreadParallelRunnerDefaultNumWorkerThreads() / probesCount, 1);
+
+  // Search works on the logarithm of the distance and on the score itself
+  const float lowest = std::log(options.minDistance);
+  const float highest = std::log(options.maxDistance);
+  const auto targetY = static_cast<float>(options.targetScore + options.scoreTolerance * 0.5);
+  const double acceptedScore = options.targetScore + options.scoreTolerance;
+
+  // Highest distance known to reach the score and lowest one known to miss it
+  bool havePass = false, haveMiss = false;
+  float passX = 0, passY = 0, missX = 0, missY = 0;
+  // Score falls about 15 points when distance grows e times, refined by every pair of probes
+  float slope = -15.0f;
+
+  std::unique_ptr<JxlChunkListSink> best;
+  float bestDistance = 0;
+  double bestScore = 0;
+  std::unique_ptr<JxlChunkListSink> closest;
+  float closestDistance = 0;
+  double closestScore = 0;
+
+  for (int iteration = 0; iteration < options.maxIterations; ++iteration) {
+    float guess;
+    if (havePass && haveMiss) {
+      const float width = missX - passX;
+      const float bracketSlope = (missY - passY) / width;
+      guess = passX + width * 0.5f;
+      if (bracketSlope < 0) {
+        guess = std::clamp(passX + (targetY - passY) / bracketSlope,
+                           passX + width * 0.1f, missX - width * 0.1f);
+      }
+    } else if (havePass) {
+      guess = passX + (targetY - passY) / slope;
+    } else if (haveMiss) {
+      guess = missX + (targetY - missY) / slope;
+    } else {
+      guess = std::log(options.initialDistance);
+    }
+    const float rangeStart = havePass ? passX : lowest;
+    const float rangeEnd = haveMiss ? missX : highest;
+    guess = std::clamp(guess, rangeStart, rangeEnd);
+
+    std::vector<JxlRateProbe> probes(probesCount);
+    probes[0].distance = std::exp(guess);
+    for (int i = 1; i < probesCount; ++i) {
+      probes[i].distance = std::exp(rangeStart + (rangeEnd - rangeStart) * static_cast<float>(i)
+          / static_cast<float>(probesCount));
+    }
+
+    concurrency::parallel_for(probesCount, probesCount, [&](int index) {
+      JxlRateProbe &probe = probes[index];
+      try {
+        probe.output = std::make_unique<JxlChunkListSink>();
+        probe.encoded = EncodeJxlChunked(input, xsize, ysize, *probe.output, colorspace, lossy,
+                                         iccProfile, effort, probe.distance, decodingSpeed,
+                                         colorEncoding, false, workerThreads);
+        if (probe.encoded) {
+          std::vector<uint8_t> decoded(static_cast<size_t>(xsize) * 4 * ysize);
+          probe.encoded = DecodeRateProbe(*probe.output, workerThreads, decoded);
+          if (probe.encoded) {
+            probe.score = Ssimulacra2Rgba8(reference, referenceStride, decoded.data(), xsize * 4,
+                                           xsize, ysize);
+          }
+        }
+      } catch (std::bad_alloc &err) {
+        probe.encoded = false;
+      } catch (std::runtime_error &err) {
+        probe.encoded = false;
+      }
+    });
+
+    result.iterations += 1;
+    result.encodes += probesCount;
+
+    std::sort(probes.begin(), probes.end(), [](const JxlRateProbe &a, const JxlRateProbe &b) {
+      return a.distance < b.distance;
+    });
+
+    bool haveLast = false;
+    float lastX = 0, lastY = 0;
+    for (JxlRateProbe &probe : probes) {
+      if (!probe.encoded) {
+        return false;
+      }
+      const float x = std::log(probe.distance);
+      const auto y = static_cast<float>(probe.score);
+      if (haveLast && x - lastX > 1e-3f) {
+        const float measured = (y - lastY) / (x - lastX);
+        if (measured < -0.5f) {
+          slope = measured;
+        }
+      }
+      haveLast = true;
+      lastX = x;
+      lastY = y;
+
+      if (probe.score >= options.targetScore) {
+        if (!havePass || x > passX) {
+          havePass = true;
+          passX = x;
+          passY = y;
+        }
+        if (!best || probe.distance > bestDistance) {
+          best = std::move(probe.output);
+          bestDistance = probe.distance;
+          bestScore = probe.score;
+        }
+      } else {
+        if (!haveMiss || x < missX) {
+          if (havePass && x - passX > 1e-3f) {
+            const float measured = (y - passY) / (x - passX);
+            if (measured < -0.5f) {
+              slope = measured;
+            }
+          }
+          haveMiss = true;
+          missX = x;
+          missY = y;
+        }
+        if (!best && (!closest || probe.score > closestScore)) {
+          closest = std::move(probe.output);
+          closestDistance = probe.distance;
+          closestScore = probe.score;
+        }
+      }
+    }
+
+    if (best && bestScore <= acceptedScore) {
+      break;
+    }
+    // Bracket is too narrow to change the score noticeably, or scores are not monotonic anymore
+    if (havePass && haveMiss && missX - passX < 0.01f) {
+      break;
+    }
+    // Distance cannot be raised nor lowered anymore
+    if ((havePass && passX >= highest - 1e-4f) || (haveMiss && missX <= lowest + 1e-4f)) {
+      break;
+    }
+  }
+
+  const JxlChunkListSink *chosen = best ? best.get() : closest.get();
+  if (!chosen) {
+    return false;
+  }
+  result.distance = best ? bestDistance : closestDistance;
+  result.score = best ? bestScore : closestScore;
+  result.targetReached = best != nullptr;
+  result.size = chosen->getSize();
+  bool written = true;
+  chosen->forEachChunk([&](const uint8_t *data, size_t length) {
+    written = written && output.write(data, length);
+  });
+  return written;
+}
+
+}
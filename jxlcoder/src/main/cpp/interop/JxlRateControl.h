@@ -0,0 +1,99 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLRATECONTROL_H
+#define JXLCODER_JXLRATECONTROL_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "JxlDefinitions.h"
+#include "JxlChunkedInput.h"
+#include "JxlOutputSink.h"
+#include "encode.h"
+
+namespace coder {
+
+struct JxlRateControlOptions {
+  // Encoded size must not exceed it
+  uint64_t targetSize = 0;
+  // Any size in targetSize * (1 - tolerance) .. targetSize is accepted
+  float tolerance = 0.05f;
+  float initialDistance = 1.0f;
+  float minDistance = 0.05f;
+  float maxDistance = 25.0f;
+  int maxIterations = 8;
+  // Distances encoded at the same time on every iteration, encoder threads are split between them
+  int parallelProbes = 1;
+  // SSIMULACRA2 score the encoding must reach, used only by the score search
+  double targetScore = 0;
+  // Any score in targetScore .. targetScore + scoreTolerance is accepted
+  double scoreTolerance = 1.0;
+};
+
+struct JxlRateControlResult {
+  float distance = 0;
+  uint64_t size = 0;
+  // Search rounds, each one encodes `parallelProbes` distances
+  int iterations = 0;
+  int encodes = 0;
+  bool targetReached = false;
+  // SSIMULACRA2 score of the chosen encoding, only the score search computes it
+  double score = 0;
+};
+
+/**
+ * Lossy encoding which fits into the target size with the lowest found distance.
+ * Pixels are converted once and every probe encodes them with the same configuration.
+ * Encoded size is close to linear of the distance in log-log scale, so the next distance is placed
+ * by secant on it and falls back to bisection of the bracket when the secant is off.
+ * Probes are kept in memory, only the best one is written into the output,
+ * when nothing fits the smallest one is written and target is not reached.
+ */
+bool EncodeJxlToTargetSize(JxlBitmapChunkedInput &input, uint32_t xsize, uint32_t ysize,
+                           JxlOutputSink &output,
+                           JxlColorPixelType colorspace, std::vector<uint8_t> &iccProfile,
+                           int effort, int decodingSpeed, JxlColorEncoding &colorEncoding,
+                           const JxlRateControlOptions &options, JxlRateControlResult &result);
+
+/**
+ * Lossy encoding which reaches the target SSIMULACRA2 score with the highest found distance.
+ * Every probe is decoded and scored against the reference, unassociated RGBA 8 bit pixels of the same size,
+ * score falls about linearly of the logarithm of the distance so the search is the same as for the size.
+ * When no distance reaches the target the best scored probe is written and target is not reached.
+ */
+bool EncodeJxlToTargetScore(JxlBitmapChunkedInput &input, uint32_t xsize, uint32_t ysize,
+                            JxlOutputSink &output,
+                            JxlColorPixelType colorspace, std::vector<uint8_t> &iccProfile,
+                            int effort, int decodingSpeed, JxlColorEncoding &colorEncoding,
+                            const uint8_t *reference, uint32_t referenceStride,
+                            const JxlRateControlOptions &options, JxlRateControlResult &result);
+
+}
+
+#endif //JXLCODER_JXLRATECONTROL_H
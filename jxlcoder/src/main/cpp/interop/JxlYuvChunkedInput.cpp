@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlYuvChunkedInput.h"
+#include <cstring>
+#include <limits>
+
+namespace coder {
+
+template<typename T>
+static void UpsampleChromaRow(const uint8_t *u, const uint8_t *v, uint32_t pixelStride, uint32_t shift,
+                              size_t xpos, size_t xsize, uint16_t *uRow, uint16_t *vRow) {
+  for (size_t i = 0; i < xsize; ++i) {
+    const size_t offset = ((xpos + i) >> 1) * pixelStride;
+    T uSample, vSample;
+    // Semi-planar chroma of 16 bit samples is not aligned for V of NV21 like layouts
+    std::memcpy(&uSample, u + offset, sizeof(T));
+    std::memcpy(&vSample, v + offset, sizeof(T));
+    uRow[i] = static_cast<uint16_t>(uSample >> shift);
+    vRow[i] = static_cast<uint16_t>(vSample >> shift);
+  }
+}
+
+JxlYuvChunkedInput::JxlYuvChunkedInput(const JxlYuvPlanes &planes, JxlYuvSampleFormat sampleFormat,
+                                       YuvMatrix matrix, bool fullRange)
+    : planes(planes), sampleFormat(sampleFormat) {
+  const bool highBitDepth = sampleFormat == YUV_SAMPLES_P010;
+  coefficients = MakeYuvToRgbCoefficients(matrix, fullRange, highBitDepth ? 10 : 8, highBitDepth ? 16 : 8);
+}
+
+JxlPixelFormat JxlYuvChunkedInput::pixelFormat(uint32_t channels) const {
+  return {channels, sampleFormat == YUV_SAMPLES_P010 ? JXL_TYPE_UINT16 : JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+}
+
+const void *JxlYuvChunkedInput::convertTile(size_t xpos, size_t ypos, size_t xsize, size_t ysize,
+                                            bool alphaOnly, size_t *rowOffset) {
+  if (alphaOnly) {
+    // Frame has no alpha, so extra channels are never declared
+    failed = true;
+    return nullptr;
+  }
+  JxlStageTimer conversionTimer(instrumentation.load(), STAGE_CONVERSION);
+  std::unique_ptr<Tile> tile = acquireTile();
+  const size_t tileCapacity = tile->rgba.capacity() + tile->channels.capacity();
+
+  const bool highBitDepth = sampleFormat == YUV_SAMPLES_P010;
+  const size_t componentSize = highBitDepth ? sizeof(uint16_t) : sizeof(uint8_t);
+  const size_t dataStride = xsize * 3 * componentSize;
+  tile->channels.resize(dataStride * ysize);
+  // Chroma of the current row upsampled to one sample per pixel
+  tile->rgba.resize(2 * xsize * sizeof(uint16_t));
+  auto uRow = reinterpret_cast<uint16_t *>(tile->rgba.data());
+  uint16_t *vRow = uRow + xsize;
+
+  size_t chromaRow = std::numeric_limits<size_t>::max();
+  for (size_t row = 0; row < ysize; ++row) {
+    const size_t y = ypos + row;
+    if ((y >> 1) != chromaRow) {
+      // Two luma rows share one chroma row
+      chromaRow = y >> 1;
+      const uint8_t *u = planes.u + chromaRow * planes.uvRowStride;
+      const uint8_t *v = planes.v + chromaRow * planes.uvRowStride;
+      if (highBitDepth) {
+        UpsampleChromaRow<uint16_t>(u, v, planes.uvPixelStride, 6, xpos, xsize, uRow, vRow);
+      } else {
+        UpsampleChromaRow<uint8_t>(u, v, planes.uvPixelStride, 0, xpos, xsize, uRow, vRow);
+      }
+    }
+    const uint8_t *luma = planes.y + y * planes.yRowStride;
+    uint8_t *dst = tile->channels.data() + row * dataStride;
+    if (highBitDepth) {
+      YuvRowToRgb16(reinterpret_cast<const uint16_t *>(luma) + xpos, 6, uRow, vRow,
+                    reinterpret_cast<uint16_t *>(dst), static_cast<uint32_t>(xsize), coefficients);
+    } else {
+      YuvRowToRgb8(luma + xpos, uRow, vRow, dst, static_cast<uint32_t>(xsize), coefficients);
+    }
+  }
+
+  if (JxlInstrumentation *stats = instrumentation.load()) {
+    const size_t grownCapacity = tile->rgba.capacity() + tile->channels.capacity();
+    stats->addAllocated(grownCapacity - tileCapacity);
+  }
+
+  const uint8_t *data = tile->channels.data();
+  *rowOffset = dataStride;
+  return leaseTile(data, std::move(tile));
+}
+
+}
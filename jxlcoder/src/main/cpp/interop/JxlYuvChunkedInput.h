@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLYUVCHUNKEDINPUT_H
+#define JXLCODER_JXLYUVCHUNKEDINPUT_H
+
+#include "JxlChunkedInput.h"
+#include "imagebit/YuvToRgb.h"
+
+namespace coder {
+
+enum JxlYuvSampleFormat {
+  YUV_SAMPLES_8 = 1,
+  // 10 bits in the high bits of 16 bit samples
+  YUV_SAMPLES_P010 = 2
+};
+
+/**
+ * 4:2:0 frame planes, strides are in bytes.
+ * Semi-planar NV12 and NV21 are U and V pointing into the same plane one sample apart with pixel stride of two samples.
+ */
+struct JxlYuvPlanes {
+  const uint8_t *y;
+  uint32_t yRowStride;
+  const uint8_t *u;
+  const uint8_t *v;
+  uint32_t uvRowStride;
+  uint32_t uvPixelStride;
+};
+
+/**
+ * Converts YUV frame rows into RGB tile by tile while the encoder pulls them, a full size RGB(A) copy never exists.
+ * Chroma is upsampled by the nearest sample. P010 frames are encoded with 16 bits per channel.
+ */
+class JxlYuvChunkedInput : public JxlChunkedInput {
+ public:
+  JxlYuvChunkedInput(const JxlYuvPlanes &planes, JxlYuvSampleFormat sampleFormat,
+                     YuvMatrix matrix, bool fullRange);
+
+  [[nodiscard]] JxlEncodingPixelDataFormat getDataFormat() const override {
+    return sampleFormat == YUV_SAMPLES_P010 ? BINARY_16 : UNSIGNED_8;
+  }
+
+ protected:
+  [[nodiscard]] JxlPixelFormat pixelFormat(uint32_t channels) const override;
+  [[nodiscard]] uint32_t colorChannels() const override {
+    return 3;
+  }
+  const void *convertTile(size_t xpos, size_t ypos, size_t xsize, size_t ysize,
+                          bool alphaOnly, size_t *rowOffset) override;
+
+ private:
+  JxlYuvPlanes planes;
+  JxlYuvSampleFormat sampleFormat;
+  YuvToRgbCoefficients coefficients;
+};
+
+}
+
+#endif //JXLCODER_JXLYUVCHUNKEDINPUT_H
@@ -0,0 +1,743 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "Ssimulacra2.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "concurrency.hpp"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "metrics/Ssimulacra2.cpp"
+
+#include "hwy/foreach_target.h"  // IWYU pragma: keep
+#include "hwy/highway.h"
+#include "hwy/contrib/math/math-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace coder::HWY_NAMESPACE {
+
+using namespace hwy::HWY_NAMESPACE;
+
+// Opsin absorbance of the libjxl XYB
+constexpr float kM00 = 0.30f, kM01 = 0.622f, kM02 = 0.078f;
+constexpr float kM10 = 0.23f, kM11 = 0.692f, kM12 = 0.078f;
+constexpr float kM20 = 0.24342268924547819f, kM21 = 0.20476744424496821f, kM22 = 0.55180986650955360f;
+constexpr float kOpsinBias = 0.0037930732552754493f;
+
+constexpr float kSsimC2 = 0.0009f;
+
+static inline float SrgbToLinear(const float v) {
+  if (v <= 0.04045f) {
+    return v / 12.92f;
+  }
+  return std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+template<typename T>
+void LinearizeRow(const T *__restrict__ src, const uint32_t width, const float maxValue,
+                  const float background, const bool premultiplied,
+                  float *__restrict__ r, float *__restrict__ g, float *__restrict__ b) {
+  const ScalableTag<float> df;
+  const Rebind<int32_t, decltype(df)> di32;
+  const Rebind<T, decltype(df)> dt;
+  using VF = Vec<decltype(df)>;
+  using VT = Vec<decltype(dt)>;
+
+  const VF maxValues = Set(df, maxValue);
+  const VF bg = Set(df, background);
+  const VF threshold = Set(df, 0.04045f);
+  const VF lowScale = Set(df, 1.f / 12.92f);
+  const VF highOffset = Set(df, 0.055f);
+  const VF highScale = Set(df, 1.f / 1.055f);
+  const VF gamma = Set(df, 2.4f);
+  const VF minBase = Set(df, 1e-6f);
+
+  const auto toFloat = [&](VT v) -> VF {
+    return Div(ConvertTo(df, PromoteTo(di32, v)), maxValues);
+  };
+
+  // Blending is done on gamma encoded values, as libjxl does
+  const auto toLinear = [&](VF c, VF a) -> VF {
+    const VF blended = premultiplied ? NegMulAdd(a, bg, Add(c, bg)) : MulAdd(a, Sub(c, bg), bg);
+    const VF low = Mul(blended, lowScale);
+    const VF base = Max(Mul(Add(blended, highOffset), highScale), minBase);
+    const VF high = Exp(df, Mul(Log(df, base), gamma));
+    return IfThenElse(Le(blended, threshold), low, high);
+  };
+
+  const uint32_t pixels = Lanes(df);
+  uint32_t x = 0;
+
+  for (; x + pixels <= width; x += pixels) {
+    VT vr, vg, vb, va;
+    LoadInterleaved4(dt, src, vr, vg, vb, va);
+    const VF a = toFloat(va);
+    StoreU(toLinear(toFloat(vr), a), df, r + x);
+    StoreU(toLinear(toFloat(vg), a), df, g + x);
+    StoreU(toLinear(toFloat(vb), a), df, b + x);
+    src += 4 * pixels;
+  }
+
+  for (; x < width; ++x) {
+    const float a = static_cast<float>(src[3]) / maxValue;
+    const auto blend = [&](T c) -> float {
+      const float value = static_cast<float>(c) / maxValue;
+      return premultiplied ? value + background * (1.f - a) : a * (value - background) + background;
+    };
+    r[x] = SrgbToLinear(blend(src[0]));
+    g[x] = SrgbToLinear(blend(src[1]));
+    b[x] = SrgbToLinear(blend(src[2]));
+    src += 4;
+  }
+}
+
+void LinearizeRgba8RowHWY(const uint8_t *src, const uint32_t width, const float background,
+                          const bool premultiplied, float *r, float *g, float *b) {
+  LinearizeRow(src, width, 255.f, background, premultiplied, r, g, b);
+}
+
+void LinearizeRgba16RowHWY(const uint16_t *src, const uint32_t width, const float maxValue,
+                           const float background, const bool premultiplied, float *r, float *g, float *b) {
+  LinearizeRow(src, width, maxValue, background, premultiplied, r, g, b);
+}
+
+/**
+ * Linear RGB into XYB shifted to be positive, in place
+ */
+void LinearToXybRowHWY(float *__restrict__ planeX, float *__restrict__ planeY, float *__restrict__ planeB,
+                       const uint32_t width) {
+  const ScalableTag<float> df;
+  using VF = Vec<decltype(df)>;
+
+  const float negativeBias = -std::cbrt(kOpsinBias);
+  const VF bias = Set(df, kOpsinBias);
+  const VF negBias = Set(df, negativeBias);
+  const VF zeros = Zero(df);
+  const VF third = Set(df, 1.f / 3.f);
+  const VF half = Set(df, 0.5f);
+  const VF minValue = Set(df, 1e-30f);
+
+  const auto cubeRoot = [&](VF v) -> VF {
+    return IfThenZeroElse(Le(v, zeros), Exp(df, Mul(Log(df, Max(v, minValue)), third)));
+  };
+
+  const uint32_t pixels = Lanes(df);
+  uint32_t x = 0;
+
+  for (; x + pixels <= width; x += pixels) {
+    const VF r = LoadU(df, planeX + x);
+    const VF g = LoadU(df, planeY + x);
+    const VF b = LoadU(df, planeB + x);
+    const VF m0 = Add(cubeRoot(MulAdd(r, Set(df, kM00), MulAdd(g, Set(df, kM01), MulAdd(b, Set(df, kM02), bias)))),
+                      negBias);
+    const VF m1 = Add(cubeRoot(MulAdd(r, Set(df, kM10), MulAdd(g, Set(df, kM11), MulAdd(b, Set(df, kM12), bias)))),
+                      negBias);
+    const VF m2 = Add(cubeRoot(MulAdd(r, Set(df, kM20), MulAdd(g, Set(df, kM21), MulAdd(b, Set(df, kM22), bias)))),
+                      negBias);
+    const VF valueX = Mul(half, Sub(m0, m1));
+    const VF valueY = Mul(half, Add(m0, m1));
+    StoreU(MulAdd(valueX, Set(df, 14.f), Set(df, 0.42f)), df, planeX + x);
+    StoreU(Add(valueY, Set(df, 0.01f)), df, planeY + x);
+    StoreU(Add(Sub(m2, valueY), Set(df, 0.55f)), df, planeB + x);
+  }
+
+  for (; x < width; ++x) {
+    const float r = planeX[x], g = planeY[x], b = planeB[x];
+    const float m0 = std::cbrt(std::max(kM00 * r + kM01 * g + kM02 * b + kOpsinBias, 0.f)) + negativeBias;
+    const float m1 = std::cbrt(std::max(kM10 * r + kM11 * g + kM12 * b + kOpsinBias, 0.f)) + negativeBias;
+    const float m2 = std::cbrt(std::max(kM20 * r + kM21 * g + kM22 * b + kOpsinBias, 0.f)) + negativeBias;
+    const float valueX = 0.5f * (m0 - m1);
+    const float valueY = 0.5f * (m0 + m1);
+    planeX[x] = valueX * 14.f + 0.42f;
+    planeY[x] = valueY + 0.01f;
+    planeB[x] = (m2 - valueY) + 0.55f;
+  }
+}
+
+static void BlurSequence(const float *in, const size_t inStep, float *out, const size_t outStep,
+                         const int32_t length, const float *n2, const float *d1, const int32_t radius) {
+  float prev[3] = {0, 0, 0};
+  float prev2[3] = {0, 0, 0};
+  for (int32_t n = -radius + 1; n < length; ++n) {
+    const int32_t left = n - radius - 1;
+    const int32_t right = n + radius - 1;
+    float sum = 0;
+    if (left >= 0) {
+      sum = in[static_cast<size_t>(left) * inStep];
+    }
+    if (right < length) {
+      sum += in[static_cast<size_t>(right) * inStep];
+    }
+    float value = 0;
+    for (int i = 0; i < 3; ++i) {
+      const float current = sum * n2[i] - d1[i] * prev[i] - prev2[i];
+      prev2[i] = prev[i];
+      prev[i] = current;
+      value += current;
+    }
+    if (n >= 0) {
+      out[static_cast<size_t>(n) * outStep] = value;
+    }
+  }
+}
+
+/**
+ * Recursive gaussian along `length` elements `step` apart, every lane runs its own independent sequence
+ */
+template<class D>
+HWY_INLINE void BlurSequenceLanes(D df, const float *in, const size_t inStep, float *out, const size_t outStep,
+                                  const int32_t length, const float *n2, const float *d1, const int32_t radius) {
+  using VF = Vec<D>;
+  const VF n2First = Set(df, n2[0]), n2Second = Set(df, n2[1]), n2Third = Set(df, n2[2]);
+  const VF d1First = Set(df, d1[0]), d1Second = Set(df, d1[1]), d1Third = Set(df, d1[2]);
+
+  VF prevFirst = Zero(df), prevSecond = Zero(df), prevThird = Zero(df);
+  VF prev2First = Zero(df), prev2Second = Zero(df), prev2Third = Zero(df);
+  for (int32_t n = -radius + 1; n < length; ++n) {
+    const int32_t left = n - radius - 1;
+    const int32_t right = n + radius - 1;
+    VF sum = Zero(df);
+    if (left >= 0) {
+      sum = LoadU(df, in + static_cast<size_t>(left) * inStep);
+    }
+    if (right < length) {
+      sum = Add(sum, LoadU(df, in + static_cast<size_t>(right) * inStep));
+    }
+    const VF first = Sub(NegMulAdd(d1First, prevFirst, Mul(sum, n2First)), prev2First);
+    const VF second = Sub(NegMulAdd(d1Second, prevSecond, Mul(sum, n2Second)), prev2Second);
+    const VF third = Sub(NegMulAdd(d1Third, prevThird, Mul(sum, n2Third)), prev2Third);
+    prev2First = prevFirst;
+    prev2Second = prevSecond;
+    prev2Third = prevThird;
+    prevFirst = first;
+    prevSecond = second;
+    prevThird = third;
+    if (n >= 0) {
+      StoreU(Add(Add(first, second), third), df, out + static_cast<size_t>(n) * outStep);
+    }
+  }
+}
+
+/**
+ * Horizontal pass of the recursive gaussian on rows y0..y1, blurs the product of both planes when
+ * the second one is given. Groups of rows are interleaved, so lanes run over neighbouring rows.
+ */
+void BlurRowsHWY(const float *first, const float *second, float *out, const uint32_t xsize,
+                 const uint32_t y0, const uint32_t y1, const float *n2, const float *d1, const int32_t radius) {
+  const ScalableTag<float> df;
+  const uint32_t pixels = Lanes(df);
+  std::vector<float> interleaved(static_cast<size_t>(xsize) * pixels);
+  std::vector<float> blurred(static_cast<size_t>(xsize) * pixels);
+  const auto width = static_cast<int32_t>(xsize);
+
+  uint32_t y = y0;
+  for (; y + pixels <= y1; y += pixels) {
+    for (uint32_t i = 0; i < pixels; ++i) {
+      const size_t offset = static_cast<size_t>(y + i) * xsize;
+      for (uint32_t x = 0; x < xsize; ++x) {
+        interleaved[static_cast<size_t>(x) * pixels + i] =
+            second ? first[offset + x] * second[offset + x] : first[offset + x];
+      }
+    }
+    BlurSequenceLanes(df, interleaved.data(), pixels, blurred.data(), pixels, width, n2, d1, radius);
+    for (uint32_t i = 0; i < pixels; ++i) {
+      float *row = out + static_cast<size_t>(y + i) * xsize;
+      for (uint32_t x = 0; x < xsize; ++x) {
+        row[x] = blurred[static_cast<size_t>(x) * pixels + i];
+      }
+    }
+  }
+
+  for (; y < y1; ++y) {
+    const size_t offset = static_cast<size_t>(y) * xsize;
+    const float *row = first + offset;
+    if (second) {
+      for (uint32_t x = 0; x < xsize; ++x) {
+        interleaved[x] = first[offset + x] * second[offset + x];
+      }
+      row = interleaved.data();
+    }
+    BlurSequence(row, 1, out + offset, 1, width, n2, d1, radius);
+  }
+}
+
+/**
+ * Vertical pass of the recursive gaussian on columns x0..x1, lanes run over neighbouring columns
+ */
+void BlurColumnsHWY(const float *in, float *out, const uint32_t xsize, const uint32_t ysize,
+                    const uint32_t x0, const uint32_t x1, const float *n2, const float *d1, const int32_t radius) {
+  const ScalableTag<float> df;
+  const auto height = static_cast<int32_t>(ysize);
+
+  const uint32_t pixels = Lanes(df);
+  uint32_t x = x0;
+
+  for (; x + pixels <= x1; x += pixels) {
+    BlurSequenceLanes(df, in + x, xsize, out + x, xsize, height, n2, d1, radius);
+  }
+
+  for (; x < x1; ++x) {
+    BlurSequence(in + x, xsize, out + x, xsize, height, n2, d1, radius);
+  }
+}
+
+/**
+ * Accumulates 1 - SSIM and its 4th power, luminance term has no denominator as in SSIMULACRA2
+ */
+void SsimRowHWY(const float *mu1, const float *mu2, const float *sigma11, const float *sigma22,
+                const float *sigma12, const uint32_t width, double *sums) {
+  const ScalableTag<float> df;
+  using VF = Vec<decltype(df)>;
+
+  const VF ones = Set(df, 1.f);
+  const VF twos = Set(df, 2.f);
+  const VF c2 = Set(df, kSsimC2);
+  const VF zeros = Zero(df);
+
+  VF sum = Zero(df);
+  VF sum4 = Zero(df);
+
+  const uint32_t pixels = Lanes(df);
+  uint32_t x = 0;
+
+  for (; x + pixels <= width; x += pixels) {
+    const VF m1 = LoadU(df, mu1 + x);
+    const VF m2 = LoadU(df, mu2 + x);
+    const VF diff = Sub(m1, m2);
+    const VF numM = NegMulAdd(diff, diff, ones);
+    const VF numS = MulAdd(twos, Sub(LoadU(df, sigma12 + x), Mul(m1, m2)), c2);
+    const VF denomS = Add(Add(Sub(LoadU(df, sigma11 + x), Mul(m1, m1)),
+                              Sub(LoadU(df, sigma22 + x), Mul(m2, m2))), c2);
+    const VF d = Max(Sub(ones, Div(Mul(numM, numS), denomS)), zeros);
+    const VF d2 = Mul(d, d);
+    sum = Add(sum, d);
+    sum4 = MulAdd(d2, d2, sum4);
+  }
+
+  double rowSum = ReduceSum(df, sum);
+  double rowSum4 = ReduceSum(df, sum4);
+
+  for (; x < width; ++x) {
+    const float m1 = mu1[x];
+    const float m2 = mu2[x];
+    const float numM = 1.f - (m1 - m2) * (m1 - m2);
+    const float numS = 2.f * (sigma12[x] - m1 * m2) + kSsimC2;
+    const float denomS = (sigma11[x] - m1 * m1) + (sigma22[x] - m2 * m2) + kSsimC2;
+    const double d = std::max(1.0 - static_cast<double>(numM * numS / denomS), 0.0);
+    rowSum += d;
+    rowSum4 += (d * d) * (d * d);
+  }
+
+  sums[0] += rowSum;
+  sums[1] += rowSum4;
+}
+
+/**
+ * Accumulates edges which appeared in the distorted image (artifacts) and edges which were lost (detail loss),
+ * each as mean and sum of 4th powers
+ */
+void EdgeDiffRowHWY(const float *img1, const float *mu1, const float *img2, const float *mu2,
+                    const uint32_t width, double *sums) {
+  const ScalableTag<float> df;
+  using VF = Vec<decltype(df)>;
+
+  const VF ones = Set(df, 1.f);
+  const VF zeros = Zero(df);
+
+  VF artifacts = Zero(df), artifacts4 = Zero(df);
+  VF details = Zero(df), details4 = Zero(df);
+
+  const uint32_t pixels = Lanes(df);
+  uint32_t x = 0;
+
+  for (; x + pixels <= width; x += pixels) {
+    const VF edge1 = Add(ones, Abs(Sub(LoadU(df, img1 + x), LoadU(df, mu1 + x))));
+    const VF edge2 = Add(ones, Abs(Sub(LoadU(df, img2 + x), LoadU(df, mu2 + x))));
+    const VF d = Sub(Div(edge2, edge1), ones);
+    const VF artifact = Max(d, zeros);
+    const VF detail = Max(Neg(d), zeros);
+    const VF artifact2 = Mul(artifact, artifact);
+    const VF detail2 = Mul(detail, detail);
+    artifacts = Add(artifacts, artifact);
+    artifacts4 = MulAdd(artifact2, artifact2, artifacts4);
+    details = Add(details, detail);
+    details4 = MulAdd(detail2, detail2, details4);
+  }
+
+  double rowSums[4] = {ReduceSum(df, artifacts), ReduceSum(df, artifacts4),
+                       ReduceSum(df, details), ReduceSum(df, details4)};
+
+  for (; x < width; ++x) {
+    const double d = (1.0 + std::abs(img2[x] - mu2[x])) / (1.0 + std::abs(img1[x] - mu1[x])) - 1.0;
+    const double artifact = std::max(d, 0.0);
+    const double detail = std::max(-d, 0.0);
+    rowSums[0] += artifact;
+    rowSums[1] += (artifact * artifact) * (artifact * artifact);
+    rowSums[2] += detail;
+    rowSums[3] += (detail * detail) * (detail * detail);
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    sums[i] += rowSums[i];
+  }
+}
+
+}
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace coder {
+HWY_EXPORT(LinearizeRgba8RowHWY);
+HWY_EXPORT(LinearizeRgba16RowHWY);
+HWY_EXPORT(LinearToXybRowHWY);
+HWY_EXPORT(BlurRowsHWY);
+HWY_EXPORT(BlurColumnsHWY);
+HWY_EXPORT(SsimRowHWY);
+HWY_EXPORT(EdgeDiffRowHWY);
+
+static constexpr int kSsimulacra2Scales = 6;
+static constexpr uint32_t kBlurBlock = 64;
+
+struct MetricImage {
+  uint32_t xsize = 0;
+  uint32_t ysize = 0;
+  std::array<std::vector<float>, 3> planes;
+
+  void resize(uint32_t width, uint32_t height) {
+    xsize = width;
+    ysize = height;
+    for (auto &plane : planes) {
+      plane.resize(static_cast<size_t>(width) * height);
+    }
+  }
+
+  float *row(int channel, uint32_t y) {
+    return planes[channel].data() + static_cast<size_t>(y) * xsize;
+  }
+};
+
+struct MetricScale {
+  // Mean and 4th power norm of 1 - SSIM for every XYB channel
+  double ssim[3 * 2];
+  // Mean and 4th power norm of artifacts, then of detail loss for every XYB channel
+  double edgeDiff[3 * 4];
+};
+
+/**
+ * Recursive gaussian of Charalampidis 2016, the same which libjxl uses, so borders are zero extended
+ */
+struct RecursiveGaussian {
+  float n2[3];
+  float d1[3];
+  int32_t radius;
+
+  explicit RecursiveGaussian(double sigma) {
+    const double kernelRadius = std::round(3.2795 * sigma + 0.2546);
+    const double piDiv2r = M_PI / (2.0 * kernelRadius);
+    const double omega[3] = {piDiv2r, 3.0 * piDiv2r, 5.0 * piDiv2r};
+    const double p1 = +1.0 / std::tan(0.5 * omega[0]);
+    const double p3 = -1.0 / std::tan(0.5 * omega[1]);
+    const double p5 = +1.0 / std::tan(0.5 * omega[2]);
+    const double r1 = +p1 * p1 / std::sin(omega[0]);
+    const double r3 = -p3 * p3 / std::sin(omega[1]);
+    const double r5 = +p5 * p5 / std::sin(omega[2]);
+    const double negHalfSigma2 = -0.5 * sigma * sigma;
+    double rho[3];
+    for (int i = 0; i < 3; ++i) {
+      rho[i] = std::exp(negHalfSigma2 * omega[i] * omega[i]) / kernelRadius;
+    }
+    const double d13 = p1 * r3 - r1 * p3;
+    const double d35 = p3 * r5 - r3 * p5;
+    const double d51 = p5 * r1 - r5 * p1;
+    const double zeta15 = d35 / d13;
+    const double zeta35 = d51 / d13;
+
+    // Solves A * beta = gamma
+    const double a[9] = {p1, p3, p5, r1, r3, r5, zeta15, zeta35, 1};
+    const double gamma[3] = {1, kernelRadius * kernelRadius - sigma * sigma,
+                             zeta15 * rho[0] + zeta35 * rho[1] + rho[2]};
+    const double det = a[0] * (a[4] * a[8] - a[5] * a[7]) - a[1] * (a[3] * a[8] - a[5] * a[6])
+        + a[2] * (a[3] * a[7] - a[4] * a[6]);
+    const double inverse[9] = {
+        (a[4] * a[8] - a[5] * a[7]) / det, (a[2] * a[7] - a[1] * a[8]) / det, (a[1] * a[5] - a[2] * a[4]) / det,
+        (a[5] * a[6] - a[3] * a[8]) / det, (a[0] * a[8] - a[2] * a[6]) / det, (a[2] * a[3] - a[0] * a[5]) / det,
+        (a[3] * a[7] - a[4] * a[6]) / det, (a[1] * a[6] - a[0] * a[7]) / det, (a[0] * a[4] - a[1] * a[3]) / det,
+    };
+
+    radius = static_cast<int32_t>(kernelRadius);
+    for (int i = 0; i < 3; ++i) {
+      const double beta = inverse[i * 3] * gamma[0] + inverse[i * 3 + 1] * gamma[1] + inverse[i * 3 + 2] * gamma[2];
+      n2[i] = static_cast<float>(-beta * std::cos(omega[i] * (kernelRadius + 1.0)));
+      d1[i] = static_cast<float>(-2.0 * std::cos(omega[i]));
+    }
+  }
+};
+
+static int MetricThreads(uint32_t iterations) {
+  const int cores = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  return std::clamp(std::min(cores, 6), 1, static_cast<int>(std::max(iterations, 1u)));
+}
+
+/**
+ * Blurs `first`, or the product of `first` and `second` when the second one is given.
+ * Blocks of rows, then blocks of columns are blurred in parallel.
+ */
+static void BlurPlane(const RecursiveGaussian &rg, const float *first, const float *second,
+                      std::vector<float> &temp, std::vector<float> &out, uint32_t xsize, uint32_t ysize) {
+  const size_t planeSize = static_cast<size_t>(xsize) * ysize;
+  temp.resize(planeSize);
+  out.resize(planeSize);
+
+  const uint32_t rowBlocks = (ysize + kBlurBlock - 1) / kBlurBlock;
+  concurrency::parallel_for(MetricThreads(rowBlocks), static_cast<int>(rowBlocks), [&](int block) {
+    const uint32_t y0 = static_cast<uint32_t>(block) * kBlurBlock;
+    const uint32_t y1 = std::min(y0 + kBlurBlock, ysize);
+    HWY_DYNAMIC_DISPATCH(BlurRowsHWY)(first, second, temp.data(), xsize, y0, y1, rg.n2, rg.d1, rg.radius);
+  });
+
+  const uint32_t columnBlocks = (xsize + kBlurBlock - 1) / kBlurBlock;
+  concurrency::parallel_for(MetricThreads(columnBlocks), static_cast<int>(columnBlocks), [&](int block) {
+    const uint32_t x0 = static_cast<uint32_t>(block) * kBlurBlock;
+    const uint32_t x1 = std::min(x0 + kBlurBlock, xsize);
+    HWY_DYNAMIC_DISPATCH(BlurColumnsHWY)(temp.data(), out.data(), xsize, ysize, x0, x1,
+                                         rg.n2, rg.d1, rg.radius);
+  });
+}
+
+/**
+ * 2x2 box downscale with edge pixels repeated for odd sizes
+ */
+static void Downsample(MetricImage &in, MetricImage &out) {
+  out.resize((in.xsize + 1) / 2, (in.ysize + 1) / 2);
+  concurrency::parallel_for(MetricThreads(out.ysize), static_cast<int>(out.ysize), [&](int y) {
+    const uint32_t y0 = static_cast<uint32_t>(y) * 2;
+    const uint32_t y1 = std::min(y0 + 1, in.ysize - 1);
+    for (int c = 0; c < 3; ++c) {
+      const float *row0 = in.row(c, y0);
+      const float *row1 = in.row(c, y1);
+      float *dst = out.row(c, static_cast<uint32_t>(y));
+      for (uint32_t x = 0; x < out.xsize; ++x) {
+        const uint32_t x0 = x * 2;
+        const uint32_t x1 = std::min(x0 + 1, in.xsize - 1);
+        dst[x] = (row0[x0] + row0[x1] + row1[x0] + row1[x1]) * 0.25f;
+      }
+    }
+  });
+}
+
+static double ScoreFromScales(const std::vector<MetricScale> &scales) {
+  static constexpr double kWeights[108] = {
+      0.0, 0.0007376606707406586, 0.0, 0.0, 0.0007793481682867309, 0.0,
+      0.0, 0.0004371155730107379, 0.0, 1.1041726426657346, 0.00066284834129271, 0.00015231632783718752,
+      0.0, 0.0016406437456599754, 0.0, 1.8422455520539298, 11.441172603757666, 0.0,
+      0.0007989109436015163, 0.000176816438078653, 0.0, 1.8787594979546387, 10.94906990605142, 0.0,
+      0.0007289346991508072, 0.9677937080626833, 0.0, 0.00014003424285435884, 0.9981766977854967, 0.00031949755934435053,
+      0.0004550992113792063, 0.0, 0.0, 0.0013648766163243398, 0.0, 0.0,
+      0.0, 0.0, 0.0, 7.466890328078848, 0.0, 17.445833984131262,
+      0.0006235601634041466, 0.0, 0.0, 6.683678146179332, 0.00037724407979611296, 1.027889937768264,
+      225.20515300849274, 0.0, 0.0, 19.213238186143016, 0.0011401524586618361, 0.001237755635509985,
+      176.39317598450694, 0.0, 0.0, 24.43300999870476, 0.28520802612117757, 0.0004485436923833408,
+      0.0, 0.0, 0.0, 34.77906344483772, 44.835625328877896, 0.0,
+      0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0008680556573291698, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0005313191874358747, 0.0, 0.00016533814161379112, 0.0, 0.0,
+      0.0, 0.0, 0.0, 0.0004179171803251336, 0.0017290828234722833, 0.0,
+      0.0020827005846636437, 0.0, 0.0, 8.826982764996862, 23.19243343998926, 0.0,
+      95.1080498811086, 0.9863978034400682, 0.9834382792465353, 0.0012286405048278493, 171.2667255897307, 0.9807858872435379,
+      0.0, 0.0, 0.0, 0.0005130064588990679, 0.0, 0.00010854057858411537,
+  };
+
+  double score = 0.0;
+  size_t i = 0;
+  for (int c = 0; c < 3; ++c) {
+    for (const MetricScale &scale : scales) {
+      for (int n = 0; n < 2; ++n) {
+        score += kWeights[i++] * std::abs(scale.ssim[c * 2 + n]);
+        score += kWeights[i++] * std::abs(scale.edgeDiff[c * 4 + n]);
+        score += kWeights[i++] * std::abs(scale.edgeDiff[c * 4 + n + 2]);
+      }
+    }
+  }
+
+  score *= 0.9562382616834844;
+  score = 2.326765642916932 * score - 0.020884521182843837 * score * score
+      + 6.248496625763138e-05 * score * score * score;
+  if (score > 0) {
+    return 100.0 - 10.0 * std::pow(score, 0.6276336467831387);
+  }
+  return 100.0;
+}
+
+/**
+ * Consumes both linear images, every scale is converted to XYB in place after the next one is made
+ */
+static double ComputeSsimulacra2(MetricImage &linear1, MetricImage &linear2) {
+  const RecursiveGaussian rg(1.5);
+  std::vector<MetricScale> scales;
+  MetricImage next1, next2;
+  std::vector<float> mu1, mu2, sigma11, sigma22, sigma12, temp;
+  std::vector<std::array<double, 6>> rowSums;
+
+  for (int scale = 0; scale < kSsimulacra2Scales; ++scale) {
+    // As libjxl, the size is checked before downsampling, so the last scale may be smaller than 8
+    if (linear1.xsize < 8 || linear1.ysize < 8) {
+      break;
+    }
+    if (scale > 0) {
+      std::swap(linear1, next1);
+      std::swap(linear2, next2);
+    }
+    const uint32_t xsize = linear1.xsize;
+    const uint32_t ysize = linear1.ysize;
+    if (scale + 1 < kSsimulacra2Scales) {
+      Downsample(linear1, next1);
+      Downsample(linear2, next2);
+    }
+
+    concurrency::parallel_for(MetricThreads(ysize), static_cast<int>(ysize), [&](int y) {
+      const auto row = static_cast<uint32_t>(y);
+      HWY_DYNAMIC_DISPATCH(LinearToXybRowHWY)(linear1.row(0, row), linear1.row(1, row), linear1.row(2, row), xsize);
+      HWY_DYNAMIC_DISPATCH(LinearToXybRowHWY)(linear2.row(0, row), linear2.row(1, row), linear2.row(2, row), xsize);
+    });
+
+    MetricScale metricScale = {};
+    const double pixels = static_cast<double>(xsize) * static_cast<double>(ysize);
+    for (int c = 0; c < 3; ++c) {
+      const float *img1 = linear1.planes[c].data();
+      const float *img2 = linear2.planes[c].data();
+      BlurPlane(rg, img1, nullptr, temp, mu1, xsize, ysize);
+      BlurPlane(rg, img2, nullptr, temp, mu2, xsize, ysize);
+      BlurPlane(rg, img1, img1, temp, sigma11, xsize, ysize);
+      BlurPlane(rg, img2, img2, temp, sigma22, xsize, ysize);
+      BlurPlane(rg, img1, img2, temp, sigma12, xsize, ysize);
+
+      rowSums.assign(ysize, {});
+      concurrency::parallel_for(MetricThreads(ysize), static_cast<int>(ysize), [&](int y) {
+        const size_t offset = static_cast<size_t>(y) * xsize;
+        HWY_DYNAMIC_DISPATCH(SsimRowHWY)(mu1.data() + offset, mu2.data() + offset, sigma11.data() + offset,
+                                         sigma22.data() + offset, sigma12.data() + offset, xsize,
+                                         rowSums[y].data());
+        HWY_DYNAMIC_DISPATCH(EdgeDiffRowHWY)(img1 + offset, mu1.data() + offset, img2 + offset,
+                                             mu2.data() + offset, xsize, rowSums[y].data() + 2);
+      });
+
+      // Rows are summed in order, so the score does not depend on threads
+      double sums[6] = {0, 0, 0, 0, 0, 0};
+      for (const auto &row : rowSums) {
+        for (int i = 0; i < 6; ++i) {
+          sums[i] += row[i];
+        }
+      }
+      metricScale.ssim[c * 2] = sums[0] / pixels;
+      metricScale.ssim[c * 2 + 1] = std::sqrt(std::sqrt(sums[1] / pixels));
+      metricScale.edgeDiff[c * 4] = sums[2] / pixels;
+      metricScale.edgeDiff[c * 4 + 1] = std::sqrt(std::sqrt(sums[3] / pixels));
+      metricScale.edgeDiff[c * 4 + 2] = sums[4] / pixels;
+      metricScale.edgeDiff[c * 4 + 3] = std::sqrt(std::sqrt(sums[5] / pixels));
+    }
+    scales.push_back(metricScale);
+  }
+
+  return ScoreFromScales(scales);
+}
+
+template<typename T>
+static bool HasTransparency(const T *pixels, uint32_t stride, uint32_t width, uint32_t height, T opaque) {
+  for (uint32_t y = 0; y < height; ++y) {
+    auto row = reinterpret_cast<const T *>(reinterpret_cast<const uint8_t *>(pixels) + static_cast<size_t>(y) * stride);
+    for (uint32_t x = 0; x < width; ++x) {
+      if (row[x * 4 + 3] != opaque) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+template<typename T, typename Linearize>
+static double Ssimulacra2Rgba(const T *reference, uint32_t referenceStride,
+                              const T *distorted, uint32_t distortedStride,
+                              uint32_t width, uint32_t height, T opaque, Linearize &&linearize) {
+  if (width < 8 || height < 8) {
+    throw std::runtime_error("SSIMULACRA2 needs an image at least 8x8");
+  }
+
+  const auto toLinear = [&](const T *pixels, uint32_t stride, float background, MetricImage &image) {
+    image.resize(width, height);
+    concurrency::parallel_for(MetricThreads(height), static_cast<int>(height), [&](int y) {
+      auto row = reinterpret_cast<const T *>(reinterpret_cast<const uint8_t *>(pixels)
+          + static_cast<size_t>(y) * stride);
+      const auto line = static_cast<uint32_t>(y);
+      linearize(row, background, image.row(0, line), image.row(1, line), image.row(2, line));
+    });
+  };
+
+  const auto score = [&](float background) {
+    MetricImage linear1, linear2;
+    toLinear(reference, referenceStride, background, linear1);
+    toLinear(distorted, distortedStride, background, linear2);
+    return ComputeSsimulacra2(linear1, linear2);
+  };
+
+  if (!HasTransparency(reference, referenceStride, width, height, opaque) &&
+      !HasTransparency(distorted, distortedStride, width, height, opaque)) {
+    // Background makes no difference for opaque pixels
+    return score(0.f);
+  }
+  return std::min(score(0.1f), score(0.9f));
+}
+
+double Ssimulacra2Rgba8(const uint8_t *reference, uint32_t referenceStride,
+                        const uint8_t *distorted, uint32_t distortedStride,
+                        uint32_t width, uint32_t height, bool premultiplied) {
+  return Ssimulacra2Rgba<uint8_t>(reference, referenceStride, distorted, distortedStride, width, height, 255,
+                                  [&](const uint8_t *row, float background, float *r, float *g, float *b) {
+                                    HWY_DYNAMIC_DISPATCH(LinearizeRgba8RowHWY)(row, width, background,
+                                                                                premultiplied, r, g, b);
+                                  });
+}
+
+double Ssimulacra2Rgba16(const uint16_t *reference, uint32_t referenceStride,
+                         const uint16_t *distorted, uint32_t distortedStride,
+                         uint32_t width, uint32_t height, uint32_t bitDepth, bool premultiplied) {
+  const auto maxValue = static_cast<uint16_t>((1u << bitDepth) - 1);
+  return Ssimulacra2Rgba<uint16_t>(reference, referenceStride, distorted, distortedStride, width, height, maxValue,
+                                   [&](const uint16_t *row, float background, float *r, float *g, float *b) {
+                                     HWY_DYNAMIC_DISPATCH(LinearizeRgba16RowHWY)(row, width,
+                                                                                 static_cast<float>(maxValue),
+                                                                                 background, premultiplied,
+                                                                                 r, g, b);
+                                   });
+}
+
+}
+#endif
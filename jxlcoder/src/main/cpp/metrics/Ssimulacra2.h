@@ -0,0 +1,55 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_SSIMULACRA2_H
+#define JXLCODER_SSIMULACRA2_H
+
+#include <cstdint>
+
+namespace coder {
+
+/**
+ * SSIMULACRA2 score of the distorted image against the reference, computed as libjxl tools do:
+ * linear sRGB is downscaled five times, and on every scale positive XYB gets SSIM and edge difference maps.
+ * 100 is identical, about 90 is visually lossless, 70 is high and 50 is medium quality, bad images go negative.
+ *
+ * Pixels are RGBA in sRGB, unassociated unless `premultiplied` is set. If either image has transparent
+ * pixels, both are scored over dark and over light background and the worse score is returned.
+ * Throws std::runtime_error when the image is smaller than 8x8.
+ */
+double Ssimulacra2Rgba8(const uint8_t *reference, uint32_t referenceStride,
+                        const uint8_t *distorted, uint32_t distortedStride,
+                        uint32_t width, uint32_t height, bool premultiplied = false);
+
+double Ssimulacra2Rgba16(const uint16_t *reference, uint32_t referenceStride,
+                         const uint16_t *distorted, uint32_t distortedStride,
+                         uint32_t width, uint32_t height, uint32_t bitDepth, bool premultiplied = false);
+
+}
+
+#endif //JXLCODER_SSIMULACRA2_H
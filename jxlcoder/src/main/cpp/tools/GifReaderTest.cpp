@@ -0,0 +1,223 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "EasyGifReader.h"
+#include "GifFrameReader.h"
+#include "gif_lib.h"
+#include "interop/ByteInput.h"
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct FixtureFrame {
+  int left, top, width, height;
+  int disposal;
+  int transparentIndex;
+  bool interlaced;
+  bool localPalette;
+};
+
+struct Fixture {
+  const char *name;
+  int width, height;
+  std::vector<FixtureFrame> frames;
+};
+
+int appendBytes(GifFileType *gif, const GifByteType *data, int length) {
+  auto output = reinterpret_cast<std::vector<uint8_t> *>(gif->UserData);
+  output->insert(output->end(), data, data + length);
+  return length;
+}
+
+using Palette = std::unique_ptr<ColorMapObject, decltype(&GifFreeMapObject)>;
+
+Palette makePalette(uint32_t seed) {
+  Palette palette(GifMakeMapObject(8, nullptr), &GifFreeMapObject);
+  for (int i = 0; i < palette->ColorCount; ++i) {
+    palette->Colors[i] = GifColorType{static_cast<GifByteType>(seed * 37 + i * 31),
+                                      static_cast<GifByteType>(seed * 11 + i * 67),
+                                      static_cast<GifByteType>(seed * 53 + i * 13)};
+  }
+  return palette;
+}
+
+void throwWriteError(int error) {
+  throw std::runtime_error("GIF cannot be written with error: " + std::string(GifErrorString(error)));
+}
+
+// Indices stay inside the palette, old reader maps an index past it to the transparent one when that is 0
+std::vector<uint8_t> writeGif(const Fixture &fixture) {
+  static constexpr int kInterlacedOffsets[] = {0, 4, 2, 1};
+  static constexpr int kInterlacedJumps[] = {8, 8, 4, 2};
+
+  std::vector<uint8_t> output;
+  int error = E_GIF_SUCCEEDED;
+  GifFileType *gif = EGifOpen(&output, appendBytes, &error);
+  if (!gif) {
+    throwWriteError(error);
+  }
+  std::unique_ptr<GifFileType, void (*)(GifFileType *)> closer(gif, [](GifFileType *file) {
+    EGifCloseFile(file, nullptr);
+  });
+
+  EGifSetGifVersion(gif, true);
+  const Palette globalPalette = makePalette(0);
+  if (EGifPutScreenDesc(gif, fixture.width, fixture.height, 8, 0, globalPalette.get()) != GIF_OK) {
+    throwWriteError(gif->Error);
+  }
+
+  uint32_t state = 0x2545F491u;
+  std::vector<GifByteType> raster;
+  for (size_t i = 0; i < fixture.frames.size(); ++i) {
+    const FixtureFrame &frame = fixture.frames[i];
+    const GraphicsControlBlock gcb = {frame.disposal, false, 4, frame.transparentIndex};
+    GifByteType extension[4];
+    const auto extensionLength = static_cast<int>(EGifGCBToExtension(&gcb, extension));
+    if (EGifPutExtension(gif, GRAPHICS_EXT_FUNC_CODE, extensionLength, extension) != GIF_OK) {
+      throwWriteError(gif->Error);
+    }
+
+    // egif_lib keeps the local map of the previous frame when the next has none and never frees it
+    const Palette localPalette = frame.localPalette ? makePalette(static_cast<uint32_t>(i + 1))
+                                                    : Palette(nullptr, &GifFreeMapObject);
+    if (!localPalette && gif->Image.ColorMap) {
+      GifFreeMapObject(gif->Image.ColorMap);
+      gif->Image.ColorMap = nullptr;
+    }
+    if (EGifPutImageDesc(gif, frame.left, frame.top, frame.width, frame.height, frame.interlaced,
+                         localPalette.get()) != GIF_OK) {
+      throwWriteError(gif->Error);
+    }
+
+    raster.resize(static_cast<size_t>(frame.width) * frame.height);
+    for (GifByteType &index : raster) {
+      state = state * 1664525u + 1013904223u;
+      index = static_cast<GifByteType>(state >> 29);
+    }
+    const int passes = frame.interlaced ? 4 : 1;
+    for (int pass = 0; pass < passes; ++pass) {
+      const int start = frame.interlaced ? kInterlacedOffsets[pass] : 0;
+      const int step = frame.interlaced ? kInterlacedJumps[pass] : 1;
+      for (int row = start; row < frame.height; row += step) {
+        if (EGifPutLine(gif, raster.data() + static_cast<size_t>(row) * frame.width, frame.width) != GIF_OK) {
+          throwWriteError(gif->Error);
+        }
+      }
+    }
+  }
+
+  closer.release();
+  if (EGifCloseFile(gif, &error) != GIF_OK) {
+    throwWriteError(error);
+  }
+  return output;
+}
+
+int compareFrames(const Fixture &fixture) {
+  const std::vector<uint8_t> bytes = writeGif(fixture);
+
+  EasyGifReader easyReader = EasyGifReader::openMemory(bytes.data(), bytes.size());
+  coder::MemoryByteInput input(std::make_shared<coder::ByteSource>(std::vector<uint8_t>(bytes)));
+  GifFrameReader frameReader(input);
+
+  const size_t frameSize = static_cast<size_t>(fixture.width) * fixture.height * 4;
+  int index = 0;
+  int failures = 0;
+  for (const EasyGifReader::Frame &frame : easyReader) {
+    if (!frameReader.nextFrame()) {
+      std::printf("%-20s frame %d is missing\n", fixture.name, index);
+      return failures + 1;
+    }
+    const uint8_t *expected = reinterpret_cast<const uint8_t *>(frame.pixels());
+    const uint8_t *actual = frameReader.getCanvas().data();
+    if (std::memcmp(expected, actual, frameSize) != 0) {
+      size_t offset = 0;
+      while (expected[offset] == actual[offset]) {
+        ++offset;
+      }
+      std::printf("%-20s frame %d differs at x %zu y %zu\n", fixture.name, index,
+                  (offset / 4) % fixture.width, offset / 4 / fixture.width);
+      failures += 1;
+    }
+    ++index;
+  }
+  if (frameReader.nextFrame()) {
+    std::printf("%-20s has an extra frame\n", fixture.name);
+    failures += 1;
+  }
+  std::printf("%-20s %d frames %s\n", fixture.name, index, failures ? "FAILED" : "ok");
+  return failures;
+}
+
+}
+
+int main() {
+  // Frame past the right edge is never disposed, old reader clears such a rect with a negative width
+  const Fixture fixtures[] = {
+      {"disposal", 40, 30, {
+          {0, 0, 40, 30, DISPOSE_DO_NOT, NO_TRANSPARENT_COLOR, false, false},
+          {4, 4, 16, 12, DISPOSE_BACKGROUND, 3, false, false},
+          {10, 8, 20, 10, DISPOSE_PREVIOUS, NO_TRANSPARENT_COLOR, true, true},
+          {32, 25, 12, 9, DISPOSE_DO_NOT, 5, false, false},
+          {50, 2, 6, 5, DISPOSE_DO_NOT, NO_TRANSPARENT_COLOR, false, false},
+          {0, 0, 30, 20, DISPOSE_PREVIOUS, 0, false, true},
+          {2, 20, 8, 8, DISPOSE_BACKGROUND, 1, true, false},
+          {0, 0, 40, 30, DISPOSE_DO_NOT, 2, false, false},
+      }},
+      {"transparent start", 33, 21, {
+          {3, 2, 25, 13, DISPOSE_PREVIOUS, 7, true, false},
+          {20, 10, 20, 17, DISPOSE_BACKGROUND, 0, true, true},
+          {0, 0, 33, 21, DISPOSE_DO_NOT, 4, false, false},
+      }},
+      {"interlaced", 17, 29, {
+          {0, 0, 17, 29, DISPOSE_DO_NOT, NO_TRANSPARENT_COLOR, true, false},
+          {5, 3, 9, 26, DISPOSE_PREVIOUS, 6, true, false},
+          {1, 1, 15, 27, DISPOSE_DO_NOT, NO_TRANSPARENT_COLOR, true, true},
+      }},
+  };
+
+  int failures = 0;
+  try {
+    for (const Fixture &fixture : fixtures) {
+      failures += compareFrames(fixture);
+    }
+  } catch (EasyGifReader::Error error) {
+    std::printf("old reader failed with error %d\n", static_cast<int>(error));
+    return 1;
+  } catch (std::exception &e) {
+    std::printf("%s\n", e.what());
+    return 1;
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "Ssimulacra2Patterns.h"
+#include "metrics/Ssimulacra2.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <png.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace coder;
+
+namespace {
+
+struct RgbaImage {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<uint8_t> pixels;
+};
+
+RgbaImage ReadPng(const char *path) {
+  png_image image = {};
+  image.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_file(&image, path)) {
+    throw std::runtime_error(std::string("Can't read ") + path + ": " + image.message);
+  }
+  image.format = PNG_FORMAT_RGBA;
+  RgbaImage result;
+  result.width = image.width;
+  result.height = image.height;
+  result.pixels.resize(PNG_IMAGE_SIZE(image));
+  if (!png_image_finish_read(&image, nullptr, result.pixels.data(), 0, nullptr)) {
+    png_image_free(&image);
+    throw std::runtime_error(std::string("Can't decode ") + path + ": " + image.message);
+  }
+  return result;
+}
+
+int Usage() {
+  std::fprintf(stderr,
+               "Usage: ssimulacra2 [--repeat N] reference.png distorted.png\n"
+               "       ssimulacra2 [--repeat N] --bench WIDTHxHEIGHT\n"
+               "Prints the score, with --repeat the images are scored N times and the timing is printed too\n");
+  return 2;
+}
+
+}
+
+int main(int argc, char **argv) {
+  int repeat = 0;
+  const char *bench = nullptr;
+  std::vector<const char *> files;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+      bench = argv[++i];
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+
+  try {
+    RgbaImage reference, distorted;
+    if (bench) {
+      unsigned width = 0, height = 0;
+      if (std::sscanf(bench, "%ux%u", &width, &height) != 2) {
+        return Usage();
+      }
+      reference.width = distorted.width = width;
+      reference.height = distorted.height = height;
+      reference.pixels = GradientRgba8(width, height);
+      distorted.pixels = DistortRgba8(reference.pixels, width, height, Distortion::BoxBlur);
+      repeat = std::max(repeat, 1);
+    } else if (files.size() == 2) {
+      reference = ReadPng(files[0]);
+      distorted = ReadPng(files[1]);
+      if (reference.width != distorted.width || reference.height != distorted.height) {
+        std::fprintf(stderr, "Images must have the same size\n");
+        return 1;
+      }
+    } else {
+      return Usage();
+    }
+
+    const uint32_t stride = reference.width * 4;
+    const auto start = std::chrono::steady_clock::now();
+    double score = 0;
+    for (int i = 0; i < std::max(repeat, 1); ++i) {
+      score = Ssimulacra2Rgba8(reference.pixels.data(), stride, distorted.pixels.data(), stride,
+                               reference.width, reference.height);
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("%.8f\n", score);
+    if (repeat > 0) {
+      const double perImage = elapsed.count() / repeat;
+      const double megapixels = static_cast<double>(reference.width) * reference.height / 1e6;
+      std::printf("%ux%u: %.3f ms per image, %.2f MPix/s over %d runs\n", reference.width, reference.height,
+                  perImage, megapixels / (perImage / 1000.0), repeat);
+    }
+  } catch (std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
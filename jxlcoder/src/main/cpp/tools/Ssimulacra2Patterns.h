@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_SSIMULACRA2PATTERNS_H
+#define JXLCODER_SSIMULACRA2PATTERNS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace coder {
+
+/**
+ * RGBA 8 bit pictures and distortions shared by the host tools and androidTest TestImages, the formulas are
+ * integer only so both sides produce the same pixels
+ */
+enum class Distortion {
+  Posterize,
+  RedShift,
+  BoxBlur,
+  XorPattern,
+};
+
+inline std::vector<uint8_t> GradientRgba8(uint32_t width, uint32_t height, bool translucent = false) {
+  std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      uint8_t *pixel = pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+      const uint32_t r = (x * 255 / (width - 1)) & 0xFF;
+      const uint32_t g = (y * 255 / (height - 1)) & 0xFF;
+      const uint32_t b = (x / 16 + y / 16) % 5 == 0 ? 255 - r : (r + g) / 2;
+      pixel[0] = static_cast<uint8_t>(r);
+      pixel[1] = static_cast<uint8_t>(g);
+      pixel[2] = static_cast<uint8_t>(b);
+      pixel[3] = static_cast<uint8_t>(translucent ? 64 + (x + y) % 192 : 255);
+    }
+  }
+  return pixels;
+}
+
+/**
+ * Distorts color channels of the picture, alpha is kept
+ */
+inline std::vector<uint8_t> DistortRgba8(const std::vector<uint8_t> &source, uint32_t width, uint32_t height,
+                                         Distortion distortion) {
+  std::vector<uint8_t> pixels = source;
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      uint8_t *pixel = pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+      for (uint32_t c = 0; c < 3; ++c) {
+        const uint32_t value = source[(static_cast<size_t>(y) * width + x) * 4 + c];
+        switch (distortion) {
+          case Distortion::Posterize:
+            pixel[c] = static_cast<uint8_t>((value & 0xE0) | 0x10);
+            break;
+          case Distortion::RedShift:
+            pixel[c] = static_cast<uint8_t>(c == 0 ? std::min(value + 12, 255u) : value);
+            break;
+          case Distortion::BoxBlur: {
+            uint32_t sum = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+              for (int dx = -1; dx <= 1; ++dx) {
+                const auto sx = static_cast<uint32_t>(std::clamp(static_cast<int>(x) + dx, 0, static_cast<int>(width) - 1));
+                const auto sy = static_cast<uint32_t>(std::clamp(static_cast<int>(y) + dy, 0, static_cast<int>(height) - 1));
+                sum += source[(static_cast<size_t>(sy) * width + sx) * 4 + c];
+              }
+            }
+            pixel[c] = static_cast<uint8_t>((sum + 4) / 9);
+            break;
+          }
+          case Distortion::XorPattern:
+            pixel[c] = static_cast<uint8_t>(value ^ ((x * 7 + y * 13) & 15));
+            break;
+        }
+      }
+    }
+  }
+  return pixels;
+}
+
+}
+
+#endif //JXLCODER_SSIMULACRA2PATTERNS_H
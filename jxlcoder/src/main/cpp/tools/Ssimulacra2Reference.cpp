@@ -0,0 +1,364 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "Ssimulacra2Reference.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace coder {
+
+namespace {
+
+struct Plane {
+  uint32_t xsize = 0;
+  uint32_t ysize = 0;
+  std::vector<float> values;
+
+  Plane(uint32_t width, uint32_t height) : xsize(width), ysize(height), values(static_cast<size_t>(width) * height) {}
+
+  float &at(uint32_t x, uint32_t y) {
+    return values[static_cast<size_t>(y) * xsize + x];
+  }
+
+  [[nodiscard]] float at(uint32_t x, uint32_t y) const {
+    return values[static_cast<size_t>(y) * xsize + x];
+  }
+};
+
+using Image = std::array<Plane, 3>;
+
+Image MakeImage(uint32_t width, uint32_t height) {
+  return {Plane(width, height), Plane(width, height), Plane(width, height)};
+}
+
+double SrgbToLinear(double v) {
+  return v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+}
+
+// Alpha is blended over the background on gamma encoded values, then linearized
+Image ToLinear(const uint8_t *pixels, uint32_t stride, uint32_t width, uint32_t height, double background) {
+  Image image = MakeImage(width, height);
+  for (uint32_t y = 0; y < height; ++y) {
+    const uint8_t *row = pixels + static_cast<size_t>(y) * stride;
+    for (uint32_t x = 0; x < width; ++x) {
+      const double alpha = row[x * 4 + 3] / 255.0;
+      for (int c = 0; c < 3; ++c) {
+        const double value = row[x * 4 + c] / 255.0;
+        image[c].at(x, y) = static_cast<float>(SrgbToLinear(alpha * value + (1.0 - alpha) * background));
+      }
+    }
+  }
+  return image;
+}
+
+Image Downsample(const Image &in) {
+  const uint32_t xsize = (in[0].xsize + 1) / 2;
+  const uint32_t ysize = (in[0].ysize + 1) / 2;
+  Image out = MakeImage(xsize, ysize);
+  for (int c = 0; c < 3; ++c) {
+    for (uint32_t y = 0; y < ysize; ++y) {
+      for (uint32_t x = 0; x < xsize; ++x) {
+        float sum = 0;
+        for (uint32_t iy = 0; iy < 2; ++iy) {
+          for (uint32_t ix = 0; ix < 2; ++ix) {
+            sum += in[c].at(std::min(x * 2 + ix, in[c].xsize - 1), std::min(y * 2 + iy, in[c].ysize - 1));
+          }
+        }
+        out[c].at(x, y) = sum * 0.25f;
+      }
+    }
+  }
+  return out;
+}
+
+// libjxl opsin absorbance followed by MakePositiveXYB
+void ToPositiveXyb(Image &image) {
+  static constexpr float kM[9] = {
+      0.30, 0.622, 0.078,
+      0.23, 0.692, 0.078,
+      0.24342268924547819, 0.20476744424496821, 0.55180986650955360,
+  };
+  static constexpr float kBias = 0.0037930732552754493f;
+  const float negBias = -std::cbrt(kBias);
+  for (uint32_t y = 0; y < image[0].ysize; ++y) {
+    for (uint32_t x = 0; x < image[0].xsize; ++x) {
+      const float r = image[0].at(x, y), g = image[1].at(x, y), b = image[2].at(x, y);
+      float m[3];
+      for (int i = 0; i < 3; ++i) {
+        m[i] = std::cbrt(std::max(kM[i * 3] * r + kM[i * 3 + 1] * g + kM[i * 3 + 2] * b + kBias, 0.f)) + negBias;
+      }
+      const float valueX = 0.5f * (m[0] - m[1]);
+      const float valueY = 0.5f * (m[0] + m[1]);
+      image[0].at(x, y) = valueX * 14.f + 0.42f;
+      image[1].at(x, y) = valueY + 0.01f;
+      image[2].at(x, y) = (m[2] - valueY) + 0.55f;
+    }
+  }
+}
+
+// Recursive gaussian of Charalampidis 2016 as libjxl lib/jxl/gauss_blur.cc builds it
+struct Gaussian {
+  float n2[3];
+  float d1[3];
+  int radius;
+
+  explicit Gaussian(double sigma) {
+    const double kernelRadius = std::round(3.2795 * sigma + 0.2546);
+    const double piDiv2r = M_PI / (2.0 * kernelRadius);
+    const double omega[3] = {piDiv2r, 3.0 * piDiv2r, 5.0 * piDiv2r};
+    const double p1 = +1.0 / std::tan(0.5 * omega[0]);
+    const double p3 = -1.0 / std::tan(0.5 * omega[1]);
+    const double p5 = +1.0 / std::tan(0.5 * omega[2]);
+    const double r1 = +p1 * p1 / std::sin(omega[0]);
+    const double r3 = -p3 * p3 / std::sin(omega[1]);
+    const double r5 = +p5 * p5 / std::sin(omega[2]);
+    double rho[3];
+    for (int i = 0; i < 3; ++i) {
+      rho[i] = std::exp(-0.5 * sigma * sigma * omega[i] * omega[i]) / kernelRadius;
+    }
+    const double d13 = p1 * r3 - r1 * p3;
+    const double d35 = p3 * r5 - r3 * p5;
+    const double d51 = p5 * r1 - r5 * p1;
+    const double zeta15 = d35 / d13;
+    const double zeta35 = d51 / d13;
+
+    // Cramer's rule for A * beta = gamma
+    const double a[3][3] = {{p1, p3, p5}, {r1, r3, r5}, {zeta15, zeta35, 1}};
+    const double gamma[3] = {1, kernelRadius * kernelRadius - sigma * sigma,
+                             zeta15 * rho[0] + zeta35 * rho[1] + rho[2]};
+    const auto det = [](const double m[3][3]) {
+      return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+          + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    };
+    const double denominator = det(a);
+    radius = static_cast<int>(kernelRadius);
+    for (int i = 0; i < 3; ++i) {
+      double replaced[3][3];
+      for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+          replaced[row][column] = column == i ? gamma[row] : a[row][column];
+        }
+      }
+      const double beta = det(replaced) / denominator;
+      n2[i] = static_cast<float>(-beta * std::cos(omega[i] * (kernelRadius + 1.0)));
+      d1[i] = static_cast<float>(-2.0 * std::cos(omega[i]));
+    }
+  }
+
+  // FastGaussian1D, samples out of the line are zero
+  void blur(const std::vector<float> &in, std::vector<float> &out) const {
+    const auto length = static_cast<int>(in.size());
+    float prev[3] = {0, 0, 0}, prev2[3] = {0, 0, 0};
+    for (int n = -radius + 1; n < length; ++n) {
+      const int left = n - radius - 1;
+      const int right = n + radius - 1;
+      const float sum = (left >= 0 ? in[left] : 0.f) + (right < length ? in[right] : 0.f);
+      float value = 0;
+      for (int k = 0; k < 3; ++k) {
+        const float current = n2[k] * sum - d1[k] * prev[k] - prev2[k];
+        prev2[k] = prev[k];
+        prev[k] = current;
+        value += current;
+      }
+      if (n >= 0) {
+        out[n] = value;
+      }
+    }
+  }
+};
+
+Plane Blur(const Gaussian &gaussian, const Plane &in) {
+  Plane horizontal(in.xsize, in.ysize);
+  std::vector<float> line(in.xsize), blurred(in.xsize);
+  for (uint32_t y = 0; y < in.ysize; ++y) {
+    for (uint32_t x = 0; x < in.xsize; ++x) {
+      line[x] = in.at(x, y);
+    }
+    gaussian.blur(line, blurred);
+    for (uint32_t x = 0; x < in.xsize; ++x) {
+      horizontal.at(x, y) = blurred[x];
+    }
+  }
+  Plane out(in.xsize, in.ysize);
+  line.resize(in.ysize);
+  blurred.resize(in.ysize);
+  for (uint32_t x = 0; x < in.xsize; ++x) {
+    for (uint32_t y = 0; y < in.ysize; ++y) {
+      line[y] = horizontal.at(x, y);
+    }
+    gaussian.blur(line, blurred);
+    for (uint32_t y = 0; y < in.ysize; ++y) {
+      out.at(x, y) = blurred[y];
+    }
+  }
+  return out;
+}
+
+Plane Multiply(const Plane &a, const Plane &b) {
+  Plane out(a.xsize, a.ysize);
+  for (size_t i = 0; i < out.values.size(); ++i) {
+    out.values[i] = a.values[i] * b.values[i];
+  }
+  return out;
+}
+
+struct Scale {
+  double ssim[6];
+  double edgeDiff[12];
+};
+
+double Score(const std::vector<Scale> &scales) {
+  static constexpr double kWeights[108] = {
+      0.0, 0.0007376606707406586, 0.0, 0.0, 0.0007793481682867309, 0.0,
+      0.0, 0.0004371155730107379, 0.0, 1.1041726426657346, 0.00066284834129271, 0.00015231632783718752,
+      0.0, 0.0016406437456599754, 0.0, 1.8422455520539298, 11.441172603757666, 0.0,
+      0.0007989109436015163, 0.000176816438078653, 0.0, 1.8787594979546387, 10.94906990605142, 0.0,
+      0.0007289346991508072, 0.9677937080626833, 0.0, 0.00014003424285435884, 0.9981766977854967, 0.00031949755934435053,
+      0.0004550992113792063, 0.0, 0.0, 0.0013648766163243398, 0.0, 0.0,
+      0.0, 0.0, 0.0, 7.466890328078848, 0.0, 17.445833984131262,
+      0.0006235601634041466, 0.0, 0.0, 6.683678146179332, 0.00037724407979611296, 1.027889937768264,
+      225.20515300849274, 0.0, 0.0, 19.213238186143016, 0.0011401524586618361, 0.001237755635509985,
+      176.39317598450694, 0.0, 0.0, 24.43300999870476, 0.28520802612117757, 0.0004485436923833408,
+      0.0, 0.0, 0.0, 34.77906344483772, 44.835625328877896, 0.0,
+      0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0008680556573291698, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0005313191874358747, 0.0, 0.00016533814161379112, 0.0, 0.0,
+      0.0, 0.0, 0.0, 0.0004179171803251336, 0.0017290828234722833, 0.0,
+      0.0020827005846636437, 0.0, 0.0, 8.826982764996862, 23.19243343998926, 0.0,
+      95.1080498811086, 0.9863978034400682, 0.9834382792465353, 0.0012286405048278493, 171.2667255897307, 0.9807858872435379,
+      0.0, 0.0, 0.0, 0.0005130064588990679, 0.0, 0.00010854057858411537,
+  };
+  double score = 0;
+  size_t i = 0;
+  for (int c = 0; c < 3; ++c) {
+    for (const Scale &scale : scales) {
+      for (int n = 0; n < 2; ++n) {
+        score += kWeights[i++] * std::abs(scale.ssim[c * 2 + n]);
+        score += kWeights[i++] * std::abs(scale.edgeDiff[c * 4 + n]);
+        score += kWeights[i++] * std::abs(scale.edgeDiff[c * 4 + n + 2]);
+      }
+    }
+  }
+  score *= 0.9562382616834844;
+  score = 2.326765642916932 * score - 0.020884521182843837 * score * score
+      + 6.248496625763138e-05 * score * score * score;
+  return score > 0 ? 100.0 - 10.0 * std::pow(score, 0.6276336467831387) : 100.0;
+}
+
+double Compute(Image linear1, Image linear2) {
+  static constexpr int kScales = 6;
+  static constexpr double kC2 = 0.0009;
+  const Gaussian gaussian(1.5);
+  std::vector<Scale> scales;
+  for (int scale = 0; scale < kScales; ++scale) {
+    if (linear1[0].xsize < 8 || linear1[0].ysize < 8) {
+      break;
+    }
+    if (scale > 0) {
+      linear1 = Downsample(linear1);
+      linear2 = Downsample(linear2);
+    }
+    Image img1 = linear1, img2 = linear2;
+    ToPositiveXyb(img1);
+    ToPositiveXyb(img2);
+
+    Scale result = {};
+    const double pixels = static_cast<double>(img1[0].values.size());
+    for (int c = 0; c < 3; ++c) {
+      const Plane mu1 = Blur(gaussian, img1[c]);
+      const Plane mu2 = Blur(gaussian, img2[c]);
+      const Plane sigma11 = Blur(gaussian, Multiply(img1[c], img1[c]));
+      const Plane sigma22 = Blur(gaussian, Multiply(img2[c], img2[c]));
+      const Plane sigma12 = Blur(gaussian, Multiply(img1[c], img2[c]));
+
+      double sums[6] = {0, 0, 0, 0, 0, 0};
+      for (size_t i = 0; i < mu1.values.size(); ++i) {
+        const float m1 = mu1.values[i], m2 = mu2.values[i];
+        const float muDiff = m1 - m2;
+        const double numM = 1.0 - muDiff * muDiff;
+        const double numS = 2 * (sigma12.values[i] - m1 * m2) + kC2;
+        const double denomS = (sigma11.values[i] - m1 * m1) + (sigma22.values[i] - m2 * m2) + kC2;
+        const double d = std::max(1.0 - numM * numS / denomS, 0.0);
+        sums[0] += d;
+        sums[1] += d * d * d * d;
+
+        const double edge = (1.0 + std::abs(img2[c].values[i] - m2)) / (1.0 + std::abs(img1[c].values[i] - m1))
+            - 1.0;
+        const double artifact = std::max(edge, 0.0);
+        const double detail = std::max(-edge, 0.0);
+        sums[2] += artifact;
+        sums[3] += artifact * artifact * artifact * artifact;
+        sums[4] += detail;
+        sums[5] += detail * detail * detail * detail;
+      }
+      result.ssim[c * 2] = sums[0] / pixels;
+      result.ssim[c * 2 + 1] = std::sqrt(std::sqrt(sums[1] / pixels));
+      result.edgeDiff[c * 4] = sums[2] / pixels;
+      result.edgeDiff[c * 4 + 1] = std::sqrt(std::sqrt(sums[3] / pixels));
+      result.edgeDiff[c * 4 + 2] = sums[4] / pixels;
+      result.edgeDiff[c * 4 + 3] = std::sqrt(std::sqrt(sums[5] / pixels));
+    }
+    scales.push_back(result);
+  }
+  return Score(scales);
+}
+
+bool HasTransparency(const uint8_t *pixels, uint32_t stride, uint32_t width, uint32_t height) {
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      if (pixels[static_cast<size_t>(y) * stride + x * 4 + 3] != 255) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}
+
+double Ssimulacra2Reference(const uint8_t *reference, uint32_t referenceStride,
+                            const uint8_t *distorted, uint32_t distortedStride,
+                            uint32_t width, uint32_t height) {
+  if (width < 8 || height < 8) {
+    throw std::runtime_error("SSIMULACRA2 needs an image at least 8x8");
+  }
+  const auto score = [&](double background) {
+    return Compute(ToLinear(reference, referenceStride, width, height, background),
+                   ToLinear(distorted, distortedStride, width, height, background));
+  };
+  if (!HasTransparency(reference, referenceStride, width, height) &&
+      !HasTransparency(distorted, distortedStride, width, height)) {
+    return score(0.0);
+  }
+  return std::min(score(0.1), score(0.9));
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_SSIMULACRA2REFERENCE_H
+#define JXLCODER_SSIMULACRA2REFERENCE_H
+
+#include <cstdint>
+
+namespace coder {
+
+/**
+ * Plain scalar transcription of libjxl tools/ssimulacra2.cc with no SIMD, tiling or threads. Precision follows
+ * libjxl: planes and blur in float, SSIM terms and sums in double. Slow, used only to check the library metric.
+ * Pixels are unassociated RGBA 8 bit sRGB.
+ */
+double Ssimulacra2Reference(const uint8_t *reference, uint32_t referenceStride,
+                            const uint8_t *distorted, uint32_t distortedStride,
+                            uint32_t width, uint32_t height);
+
+}
+
+#endif //JXLCODER_SSIMULACRA2REFERENCE_H
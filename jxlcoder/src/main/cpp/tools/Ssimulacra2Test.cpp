@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "Ssimulacra2Patterns.h"
+#include "Ssimulacra2Reference.h"
+#include "metrics/Ssimulacra2.h"
+#include <cmath>
+#include <cstdio>
+#include <exception>
+
+using namespace coder;
+
+namespace {
+
+struct MetricCase {
+  const char *name;
+  Distortion distortion;
+  bool translucent;
+  double tolerance;
+};
+
+constexpr uint32_t kWidth = 96;
+constexpr uint32_t kHeight = 80;
+
+}
+
+int main() {
+  // Summation order and FMA of the SIMD code move scores by a few hundredths. Red shift leaves almost no
+  // structural difference, there SSIM terms are about 1e-3 and float cancellation in sigma - mu * mu moves
+  // them by a tenth, as in libjxl itself, so the case gets a wider tolerance
+  static constexpr MetricCase cases[] = {
+      {"posterize", Distortion::Posterize, false, 0.05},
+      {"red shift", Distortion::RedShift, false, 0.25},
+      {"box blur", Distortion::BoxBlur, false, 0.05},
+      {"xor pattern", Distortion::XorPattern, false, 0.05},
+      {"translucent posterize", Distortion::Posterize, true, 0.05},
+      {"translucent box blur", Distortion::BoxBlur, true, 0.05},
+  };
+
+  int failures = 0;
+  try {
+    for (const MetricCase &metricCase : cases) {
+      const auto reference = GradientRgba8(kWidth, kHeight, metricCase.translucent);
+      const auto distorted = DistortRgba8(reference, kWidth, kHeight, metricCase.distortion);
+      const double expected = Ssimulacra2Reference(reference.data(), kWidth * 4, distorted.data(), kWidth * 4,
+                                                   kWidth, kHeight);
+      const double actual = Ssimulacra2Rgba8(reference.data(), kWidth * 4, distorted.data(), kWidth * 4,
+                                             kWidth, kHeight);
+      const bool passed = std::abs(expected - actual) <= metricCase.tolerance;
+      std::printf("%-24s reference %.4f library %.4f %s\n", metricCase.name, expected, actual,
+                  passed ? "ok" : "FAILED");
+      failures += passed ? 0 : 1;
+    }
+
+    const auto reference = GradientRgba8(kWidth, kHeight);
+    const double identical = Ssimulacra2Rgba8(reference.data(), kWidth * 4, reference.data(), kWidth * 4,
+                                              kWidth, kHeight);
+    if (identical != 100.0) {
+      std::printf("identical images score %.4f\n", identical);
+      failures += 1;
+    }
+
+    bool thrown = false;
+    try {
+      Ssimulacra2Rgba8(reference.data(), kWidth * 4, reference.data(), kWidth * 4, 7, 7);
+    } catch (std::exception &) {
+      thrown = true;
+    }
+    if (!thrown) {
+      std::printf("image smaller than 8x8 was scored\n");
+      failures += 1;
+    }
+  } catch (std::exception &e) {
+    std::printf("%s\n", e.what());
+    return 1;
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -262,7 +262,10 @@ class FrameSequenceDrawable(animatedImage: JxlAnimatedImage, bitmapProvider: Bit
                 mFrontBitmap = tmp
                 mLastSwap = SystemClock.uptimeMillis()
                 var continueLooping = true
-                if (mNextFrameToDecode >= animatedImage.numberOfFrames - 1) {
+                // Only the final count tells the last frame, known frames may grow meanwhile
+                if (animatedImage.isNumberOfFramesFinal &&
+                    mNextFrameToDecode >= animatedImage.knownNumberOfFrames - 1
+                ) {
                     continueLooping = false
                 }
                 if (continueLooping) {
@@ -278,8 +281,9 @@ class FrameSequenceDrawable(animatedImage: JxlAnimatedImage, bitmapProvider: Bit
     private fun scheduleDecodeLocked() {
         mState = STATE_SCHEDULED
         mNextFrameToDecode += 2
-        if (mNextFrameToDecode > animatedImage.numberOfFrames - 1) {
-            mNextFrameToDecode = animatedImage.numberOfFrames - 1
+        val lastKnownFrame = animatedImage.knownNumberOfFrames - 1
+        if (mNextFrameToDecode > lastKnownFrame) {
+            mNextFrameToDecode = lastKnownFrame
         }
         sDecodingThreadHandler!!.post(mDecodeRunnable!!)
     }
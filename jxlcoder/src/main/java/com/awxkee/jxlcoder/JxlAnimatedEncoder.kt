@@ -30,10 +30,15 @@ package com.awxkee.jxlcoder
 
 import android.graphics.Bitmap
 import android.os.Build
+import android.os.ParcelFileDescriptor
 import androidx.annotation.IntRange
 import androidx.annotation.Keep
 import java.io.Closeable
 
+/**
+ * @param output when set, every frame is written into the file as soon as it is encoded
+ * and the animation is completed with [finish]. The descriptor must stay open until then.
+ */
 @Keep
 class JxlAnimatedEncoder @Keep constructor(
     width: Int,
@@ -44,7 +49,8 @@ class JxlAnimatedEncoder @Keep constructor(
     @IntRange(from = 1L, to = 9L) effort: Int = 7,
     @IntRange(from = 0, to = 100) quality: Int = 0,
     decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
-    dataPixelFormat: JxlEncodingDataPixelFormat = JxlEncodingDataPixelFormat.UNSIGNED_8
+    dataPixelFormat: JxlEncodingDataPixelFormat = JxlEncodingDataPixelFormat.UNSIGNED_8,
+    private val output: ParcelFileDescriptor? = null,
 ) : Closeable {
 
     private var coordinator: Long = -1
@@ -63,6 +69,7 @@ class JxlAnimatedEncoder @Keep constructor(
             effort,
             decodingSpeed.value,
             dataPixelFormat.cValue,
+            output?.fd ?: -1,
         )
     }
 
@@ -73,11 +80,24 @@ class JxlAnimatedEncoder @Keep constructor(
 
     fun encode(): ByteArray {
         assertOpen()
+        check(output == null) { "Animation is written into the output, complete it with finish()" }
         val bos = encodeAnimatedImpl(coordinator)
         close()
         return bos
     }
 
+    /**
+     * Completes the animation written into the output
+     * @return size of the whole encoded image
+     */
+    fun finish(): Long {
+        assertOpen()
+        check(output != null) { "Animation has no output, use encode()" }
+        val written = finishAnimatedImpl(coordinator)
+        close()
+        return written
+    }
+
     private external fun createEncodeCoordinator(
         width: Int,
         height: Int,
@@ -89,9 +109,11 @@ class JxlAnimatedEncoder @Keep constructor(
         effort: Int,
         decodingSpeed: Int,
         dataPixelFormat: Int,
+        fd: Int,
     ): Long
 
     private external fun encodeAnimatedImpl(coordinatorPtr: Long): ByteArray
+    private external fun finishAnimatedImpl(coordinatorPtr: Long): Long
     private external fun addFrameImpl(coordinatorPtr: Long, bitmap: Bitmap, duration: Int)
     private external fun closeAndReleaseAnimatedEncoder(coordinatorPtr: Long)
 
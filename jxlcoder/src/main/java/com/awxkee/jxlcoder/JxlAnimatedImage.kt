@@ -29,10 +29,12 @@
 package com.awxkee.jxlcoder
 
 import android.graphics.Bitmap
+import android.graphics.Rect
 import android.graphics.drawable.AnimatedImageDrawable
 import android.graphics.drawable.AnimationDrawable
 import android.graphics.drawable.BitmapDrawable
 import android.os.Build
+import android.os.ParcelFileDescriptor
 import androidx.annotation.Keep
 import androidx.annotation.RequiresApi
 import java.io.Closeable
@@ -59,8 +61,19 @@ class JxlAnimatedImage : Closeable {
         jxlResizeSampler: Int,
         ): Long
 
+    private external fun createCoordinatorFd(
+        fd: Int,
+        preferredColorConfig: Int,
+        scaleMode: Int,
+        jxlResizeSampler: Int,
+    ): Long
+
     val scaleMode: ScaleMode
 
+    /**
+     * @param byteBuffer direct byte buffer, e.g. a [java.nio.MappedByteBuffer], it is referenced and not copied,
+     * so its content must stay unchanged until the image is closed
+     */
     @Keep
     public constructor(
         byteBuffer: ByteBuffer,
@@ -99,6 +112,28 @@ class JxlAnimatedImage : Closeable {
         )
     }
 
+    /**
+     * File is mapped into memory and read in place, [fileDescriptor] may be closed right after construction
+     */
+    @Keep
+    public constructor(
+        fileDescriptor: ParcelFileDescriptor,
+        preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
+        scaleMode: ScaleMode = ScaleMode.FIT,
+        jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.BILINEAR,
+    ) {
+        if (Build.VERSION.SDK_INT >= 21) {
+            System.loadLibrary("jxlcoder")
+        }
+        this.scaleMode = scaleMode
+        coordinator = createCoordinatorFd(
+            fileDescriptor.fd,
+            preferredColorConfig.value,
+            scaleMode.value,
+            jxlResizeFilter.value,
+        )
+    }
+
     val animatedDrawable: AnimationDrawable
         @Keep
         get() {
@@ -118,6 +153,9 @@ class JxlAnimatedImage : Closeable {
             return img
         }
 
+    /**
+     * Waits until all frame headers are scanned, use [knownNumberOfFrames] to start playback earlier
+     */
     public val numberOfFrames: Int
         @Keep
         get() {
@@ -125,6 +163,35 @@ class JxlAnimatedImage : Closeable {
             return getNumberOfFrames(coordinator)
         }
 
+    /**
+     * Frames found so far by the background scan, there are at least this many frames
+     * until [isNumberOfFramesFinal] returns true
+     */
+    public val knownNumberOfFrames: Int
+        @Keep
+        get() {
+            assertOpen()
+            return getKnownNumberOfFrames(coordinator)
+        }
+
+    public val isNumberOfFramesFinal: Boolean
+        @Keep
+        get() {
+            assertOpen()
+            return isNumberOfFramesFinalImpl(coordinator)
+        }
+
+    /**
+     * Waits until all frame headers are scanned, false when the stream breaks off before its last frame,
+     * frames before the broken part are still available
+     */
+    public val isComplete: Boolean
+        @Keep
+        get() {
+            assertOpen()
+            return isStreamCompleteImpl(coordinator)
+        }
+
     public val loopsCount: Int
         @Keep
         get() {
@@ -138,10 +205,36 @@ class JxlAnimatedImage : Closeable {
         return getFrameDurationImpl(coordinator, frame)
     }
 
+    /**
+     * @param reuseBitmap optional mutable bitmap from the previous call, if it matches frame size and config
+     * the frame is written into it and it is returned instead of allocating a new one
+     * @param instrumentation receives stage timings of this frame, allocated bytes count growth of the
+     * frame buffers kept by the image and a new bitmap, so they are zero in steady playback into [reuseBitmap]
+     */
     @Keep
-    public fun getFrame(frame: Int, scaleWidth: Int = 0, scaleHeight: Int = 0): Bitmap {
+    public fun getFrame(
+        frame: Int,
+        scaleWidth: Int = 0,
+        scaleHeight: Int = 0,
+        reuseBitmap: Bitmap? = null,
+        instrumentation: JxlInstrumentation? = null,
+    ): Bitmap {
         assertOpen()
-        return getFrameImpl(coordinator, frame, scaleWidth, scaleHeight)
+        return getFrameImpl(coordinator, frame, scaleWidth, scaleHeight, reuseBitmap, instrumentation)
+    }
+
+    /**
+     * Non-coalesced playback: frames are composited from their own sized layers into a persistent native canvas
+     * and only the changed region is written into [target].
+     * Pass the same [target] for sequential frames, it must be a mutable ARGB_8888 bitmap of the animation size.
+     * Any other target, or not the next frame, is fully redrawn.
+     * @return region of the [target] which was updated, it is stored in [dirtyRect]
+     */
+    @Keep
+    public fun renderFrame(frame: Int, target: Bitmap, dirtyRect: Rect = Rect()): Rect {
+        assertOpen()
+        renderFrameImpl(coordinator, frame, target, dirtyRect)
+        return dirtyRect
     }
 
     @Keep
@@ -170,12 +263,24 @@ class JxlAnimatedImage : Closeable {
         coordinatorPtr: Long,
         frame: Int,
         width: Int,
-        height: Int
+        height: Int,
+        reuseBitmap: Bitmap?,
+        instrumentation: JxlInstrumentation?,
     ): Bitmap
 
+    private external fun renderFrameImpl(
+        coordinatorPtr: Long,
+        frame: Int,
+        target: Bitmap,
+        dirtyRect: Rect,
+    )
+
     private external fun getLoopsCount(coordinatorPtr: Long): Int
     private external fun getFrameDurationImpl(coordinatorPtr: Long, frame: Int): Int
     private external fun getNumberOfFrames(coordinatorPtr: Long): Int
+    private external fun getKnownNumberOfFrames(coordinatorPtr: Long): Int
+    private external fun isNumberOfFramesFinalImpl(coordinatorPtr: Long): Boolean
+    private external fun isStreamCompleteImpl(coordinatorPtr: Long): Boolean
     private external fun closeAndReleaseAnimatedImage(coordinatorPtr: Long)
 
     override fun close() {
@@ -33,8 +33,7 @@ enum class JxlChannelsConfiguration(internal val cValue: Int) {
     RGBA(2),
 
     /**
-     * If mono selected from RGBA channels will be picked only R channel since it's considered that when image is MONO then all the gamut channels are the same,
-     * so it's your responsibility to ensure that image is correctly grayed before sending it is as mono and R channel contains required intensity values
+     * If mono selected RGBA channels are reduced to their Rec. 709 luma, alpha is dropped
      */
     MONOCHROME(3),
 }
\ No newline at end of file
@@ -30,6 +30,7 @@ package com.awxkee.jxlcoder
 
 import android.graphics.Bitmap
 import android.os.Build
+import android.os.ParcelFileDescriptor
 import android.util.Size
 import androidx.annotation.IntRange
 import androidx.annotation.Keep
@@ -45,12 +46,14 @@ object JxlCoder {
     }
 
     /**
+     * @param instrumentation - receives stage timings, allocated bytes and threads of this call
      * @author Radzivon Bartoshyk
      */
     fun decode(
         byteArray: ByteArray,
         preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
         scaleMode: ScaleMode = ScaleMode.FIT,
+        instrumentation: JxlInstrumentation? = null,
     ): Bitmap {
         return decodeSampledImpl(
             byteArray,
@@ -59,6 +62,7 @@ object JxlCoder {
             preferredColorConfig.value,
             scaleMode.value,
             JxlResizeFilter.CATMULL_ROM.value,
+            instrumentation,
         )
     }
 
@@ -72,6 +76,7 @@ object JxlCoder {
         preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
         scaleMode: ScaleMode = ScaleMode.FIT,
         jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.MITCHELL_NETRAVALI,
+        instrumentation: JxlInstrumentation? = null,
     ): Bitmap {
         return decodeSampledImpl(
             byteArray,
@@ -80,6 +85,7 @@ object JxlCoder {
             preferredColorConfig.value,
             scaleMode.value,
             jxlResizeFilter.value,
+            instrumentation,
         )
     }
 
@@ -93,6 +99,7 @@ object JxlCoder {
         preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
         scaleMode: ScaleMode = ScaleMode.FIT,
         jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.MITCHELL_NETRAVALI,
+        instrumentation: JxlInstrumentation? = null,
     ): Bitmap {
         return decodeByteBufferSampledImpl(
             byteArray,
@@ -101,9 +108,21 @@ object JxlCoder {
             preferredColorConfig.value,
             scaleMode.value,
             jxlResizeFilter.value,
+            instrumentation,
         )
     }
 
+    /**
+     * @param chunked - pixels are converted and passed to the encoder tile by tile straight from the bitmap
+     * and encoder processes them group by group, keeps memory bounded for huge bitmaps at a small compression cost.
+     * The bitmap stays locked while encoding.
+     * RGBA_F16 bitmaps are encoded as half floats, so HDR and extended range values are kept
+     * @param qualityMapping - how quality is turned into the distance, see [JxlQualityMapping]
+     * @param autoGrayscale - RGBA_8888 bitmaps which are gray are encoded as a single channel, with alpha if needed
+     * @param grayscaleTolerance - largest difference of R, G, B of opaque pixels still considered gray, 0...8,
+     * used only for lossy encoding, translucent pixels must always be exactly gray
+     * @param instrumentation - receives stage timings, allocated bytes, threads and libjxl encoder stats of this call
+     */
     fun encode(
         bitmap: Bitmap,
         channelsConfiguration: JxlChannelsConfiguration = JxlChannelsConfiguration.RGB,
@@ -111,36 +130,281 @@ object JxlCoder {
         effort: JxlEffort = JxlEffort.SQUIRREL,
         @IntRange(from = 0, to = 100) quality: Int = 0,
         decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+        chunked: Boolean = false,
+        qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+        autoGrayscale: Boolean = false,
+        @IntRange(from = 0, to = 8) grayscaleTolerance: Int = 0,
+        instrumentation: JxlInstrumentation? = null,
     ): ByteArray {
-        var dataSpaceValue: Int = -1
-        var bitmapColorSpace: String? = null
-        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.O) {
-            val colorSpaceValue = bitmap.colorSpace?.name
-            if (colorSpaceValue != null) {
-                bitmapColorSpace = colorSpaceValue
-            }
-
-            if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
-                dataSpaceValue = bitmap.colorSpace?.dataSpace ?: -1
-            }
-        }
-
         return encodeImpl(
             bitmap,
             channelsConfiguration.cValue,
             compressionOption.cValue,
             effort.value,
-            bitmapColorSpace,
-            dataSpaceValue,
+            bitmapColorSpaceName(bitmap),
+            bitmapDataSpace(bitmap),
+            quality,
+            qualityMapping.value,
+            decodingSpeed.value,
+            chunked,
+            autoGrayscale,
+            grayscaleTolerance,
+            instrumentation,
+        )
+    }
+
+    /**
+     * Writes encoded image straight into the file from its current offset
+     * @return number of bytes written
+     */
+    fun encode(
+        bitmap: Bitmap,
+        output: ParcelFileDescriptor,
+        channelsConfiguration: JxlChannelsConfiguration = JxlChannelsConfiguration.RGB,
+        compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSY,
+        effort: JxlEffort = JxlEffort.SQUIRREL,
+        @IntRange(from = 0, to = 100) quality: Int = 0,
+        decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+        chunked: Boolean = false,
+        qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+        autoGrayscale: Boolean = false,
+        @IntRange(from = 0, to = 8) grayscaleTolerance: Int = 0,
+        instrumentation: JxlInstrumentation? = null,
+    ): Long {
+        return encodeToOutputImpl(
+            bitmap,
+            channelsConfiguration.cValue,
+            compressionOption.cValue,
+            effort.value,
+            bitmapColorSpaceName(bitmap),
+            bitmapDataSpace(bitmap),
             quality,
+            qualityMapping.value,
             decodingSpeed.value,
+            chunked,
+            autoGrayscale,
+            grayscaleTolerance,
+            output.fd,
+            null,
+            instrumentation,
         )
     }
 
+    /**
+     * Writes encoded image into the direct buffer from its position, the position is advanced past the image.
+     * Fails if the remaining space is not enough.
+     * @return number of bytes written
+     */
+    fun encode(
+        bitmap: Bitmap,
+        output: ByteBuffer,
+        channelsConfiguration: JxlChannelsConfiguration = JxlChannelsConfiguration.RGB,
+        compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSY,
+        effort: JxlEffort = JxlEffort.SQUIRREL,
+        @IntRange(from = 0, to = 100) quality: Int = 0,
+        decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+        chunked: Boolean = false,
+        qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+        autoGrayscale: Boolean = false,
+        @IntRange(from = 0, to = 8) grayscaleTolerance: Int = 0,
+        instrumentation: JxlInstrumentation? = null,
+    ): Int {
+        val written = encodeToOutputImpl(
+            bitmap,
+            channelsConfiguration.cValue,
+            compressionOption.cValue,
+            effort.value,
+            bitmapColorSpaceName(bitmap),
+            bitmapDataSpace(bitmap),
+            quality,
+            qualityMapping.value,
+            decodingSpeed.value,
+            chunked,
+            autoGrayscale,
+            grayscaleTolerance,
+            -1,
+            output.slice(),
+            instrumentation,
+        ).toInt()
+        output.position(output.position() + written)
+        return written
+    }
+
+    /**
+     * Lossy encoding which is not larger than [targetSize], searches the lowest distance that fits.
+     * Pixels are converted once and reused by every attempt.
+     * @param quality - only the first guess of the search
+     * @param tolerance - any size in targetSize * (1 - tolerance)..targetSize is accepted
+     * @param parallelProbes - distances tried at the same time in each round, encoder threads are split between them
+     */
+    fun encodeToSize(
+        bitmap: Bitmap,
+        targetSize: Long,
+        channelsConfiguration: JxlChannelsConfiguration = JxlChannelsConfiguration.RGB,
+        effort: JxlEffort = JxlEffort.SQUIRREL,
+        @IntRange(from = 0, to = 100) quality: Int = 0,
+        decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+        qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+        autoGrayscale: Boolean = false,
+        @IntRange(from = 0, to = 8) grayscaleTolerance: Int = 0,
+        tolerance: Float = 0.05f,
+        maxIterations: Int = 8,
+        parallelProbes: Int = 1,
+    ): JxlRateControlResult {
+        return encodeToTargetImpl(
+            bitmap,
+            channelsConfiguration.cValue,
+            effort.value,
+            bitmapColorSpaceName(bitmap),
+            bitmapDataSpace(bitmap),
+            quality,
+            qualityMapping.value,
+            decodingSpeed.value,
+            autoGrayscale,
+            grayscaleTolerance,
+            targetSize,
+            tolerance,
+            0.0,
+            0.0,
+            maxIterations,
+            parallelProbes,
+        )
+    }
+
+    /**
+     * Lossy encoding which reaches [targetScore] of SSIMULACRA2, searches the highest distance that reaches it.
+     * Every attempt is decoded and scored against the bitmap, only RGBA_8888 bitmaps of at least 8x8 are supported.
+     * @param targetScore - 0...100, about 90 is visually lossless, 70 is high and 50 is medium quality
+     * @param quality - only the first guess of the search
+     * @param tolerance - any score in targetScore..targetScore + tolerance is accepted
+     * @param parallelProbes - distances tried at the same time in each round, encoder threads are split between them
+     */
+    fun encodeToScore(
+        bitmap: Bitmap,
+        targetScore: Double,
+        channelsConfiguration: JxlChannelsConfiguration = JxlChannelsConfiguration.RGB,
+        effort: JxlEffort = JxlEffort.SQUIRREL,
+        @IntRange(from = 0, to = 100) quality: Int = 0,
+        decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+        qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+        autoGrayscale: Boolean = false,
+        @IntRange(from = 0, to = 8) grayscaleTolerance: Int = 0,
+        tolerance: Double = 1.0,
+        maxIterations: Int = 8,
+        parallelProbes: Int = 1,
+    ): JxlRateControlResult {
+        return encodeToTargetImpl(
+            bitmap,
+            channelsConfiguration.cValue,
+            effort.value,
+            bitmapColorSpaceName(bitmap),
+            bitmapDataSpace(bitmap),
+            quality,
+            qualityMapping.value,
+            decodingSpeed.value,
+            autoGrayscale,
+            grayscaleTolerance,
+            0,
+            0f,
+            targetScore,
+            tolerance,
+            maxIterations,
+            parallelProbes,
+        )
+    }
+
+    /**
+     * Encodes a camera or video frame without going through a bitmap,
+     * rows are converted to RGB tile by tile while the encoder pulls them.
+     * Planes must not be changed until encoding finishes.
+     */
+    fun encodeYuv(
+        image: JxlYuvImage,
+        compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSY,
+        effort: JxlEffort = JxlEffort.SQUIRREL,
+        @IntRange(from = 0, to = 100) quality: Int = 0,
+        decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+        qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+        instrumentation: JxlInstrumentation? = null,
+    ): ByteArray {
+        return encodeYuvImpl(
+            image.y,
+            image.yRowStride,
+            image.u,
+            image.v,
+            image.uvRowStride,
+            image.uvPixelStride,
+            image.width,
+            image.height,
+            image.format.value,
+            image.dataSpace,
+            compressionOption.cValue,
+            effort.value,
+            quality,
+            qualityMapping.value,
+            decodingSpeed.value,
+            instrumentation,
+        )
+    }
+
+    /**
+     * Encodes several renditions of the bitmap in one call: pixels are converted once,
+     * downscales are made from the converted pixels and renditions are encoded concurrently.
+     * @param parallelEncodes - renditions encoded at the same time, encoder threads are split between them
+     */
+    fun encodeRenditions(
+        bitmap: Bitmap,
+        renditions: List<JxlRenditionSpec>,
+        channelsConfiguration: JxlChannelsConfiguration = JxlChannelsConfiguration.RGB,
+        decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+        resizeFilter: JxlResizeFilter = JxlResizeFilter.LANCZOS,
+        parallelEncodes: Int = 2,
+    ): JxlRenditions {
+        return encodeRenditionsImpl(
+            bitmap,
+            channelsConfiguration.cValue,
+            bitmapColorSpaceName(bitmap),
+            bitmapDataSpace(bitmap),
+            renditions.map { it.maxWidth }.toIntArray(),
+            renditions.map { it.maxHeight }.toIntArray(),
+            renditions.map { it.compressionOption.cValue }.toIntArray(),
+            renditions.map { it.distance }.toFloatArray(),
+            renditions.map { it.effort.value }.toIntArray(),
+            decodingSpeed.value,
+            resizeFilter.value,
+            parallelEncodes,
+        )
+    }
+
+    /**
+     * SSIMULACRA2 score of [distorted] against [reference]: 100 is identical, about 90 is visually lossless,
+     * 70 is high and 50 is medium quality. Both bitmaps must be RGBA_8888 or RGBA_F16 of the same size and format,
+     * F16 is scored in 16 bits.
+     */
+    fun ssimulacra2(reference: Bitmap, distorted: Bitmap): Double {
+        return ssimulacra2Impl(reference, distorted)
+    }
+
+    private fun bitmapColorSpaceName(bitmap: Bitmap): String? {
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.O) {
+            return bitmap.colorSpace?.name
+        }
+        return null
+    }
+
+    private fun bitmapDataSpace(bitmap: Bitmap): Int {
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            return bitmap.colorSpace?.dataSpace ?: -1
+        }
+        return -1
+    }
+
     object Convenience {
 
         /**
          * @param gifData - byte array contains the GIF data
+         * @param compressionOption - [JxlCompressionOption.LOSSLESS] keeps pixels exact and encodes
+         * only the regions each GIF frame updates, quality is ignored then
          * @return Byte array contains converted JPEG XL
          */
         fun gif2JXL(
@@ -148,8 +412,40 @@ object JxlCoder {
             @IntRange(from = 0, to = 100) quality: Int = 0,
             effort: JxlEffort = JxlEffort.SQUIRREL,
             decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+            compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSY,
+        ): ByteArray {
+            return gif2JXLImpl(gifData, quality, effort.value, decodingSpeed.value, compressionOption.cValue)
+        }
+
+        /**
+         * @param gifData - direct byte buffer contains the GIF data, it is read in place without copying
+         * @param compressionOption - [JxlCompressionOption.LOSSLESS] keeps pixels exact, quality is ignored then
+         * @return Byte array contains converted JPEG XL
+         */
+        fun gif2JXL(
+            gifData: ByteBuffer,
+            @IntRange(from = 0, to = 100) quality: Int = 0,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+            compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSY,
         ): ByteArray {
-            return gif2JXLImpl(gifData, quality, effort.value, decodingSpeed.value)
+            return gif2JXLBufferImpl(gifData, quality, effort.value, decodingSpeed.value, compressionOption.cValue)
+        }
+
+        /**
+         * @param gifFile - GIF file, regular files are mapped into memory, pipes and sockets are read as a stream.
+         * Frames are decoded one at a time, so memory does not depend on the file size
+         * @param compressionOption - [JxlCompressionOption.LOSSLESS] keeps pixels exact, quality is ignored then
+         * @return Byte array contains converted JPEG XL
+         */
+        fun gif2JXL(
+            gifFile: ParcelFileDescriptor,
+            @IntRange(from = 0, to = 100) quality: Int = 0,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+            compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSY,
+        ): ByteArray {
+            return gif2JXLFdImpl(gifFile.fd, quality, effort.value, decodingSpeed.value, compressionOption.cValue)
         }
 
         /**
@@ -165,13 +461,167 @@ object JxlCoder {
             return apng2JXLImpl(apngData, quality, effort.value, decodingSpeed.value)
         }
 
+        /**
+         * @param apngData - direct byte buffer contains the APNG data, it is read in place without copying
+         * @return Byte array contains converted JPEG XL
+         */
+        fun apng2JXL(
+            apngData: ByteBuffer,
+            @IntRange(from = 0, to = 100) quality: Int = 0,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.FAST,
+        ): ByteArray {
+            return apng2JXLBufferImpl(apngData, quality, effort.value, decodingSpeed.value)
+        }
+
+        /**
+         * @param apngFile - APNG file, regular files are mapped into memory, pipes and sockets are read as a stream
+         * @return Byte array contains converted JPEG XL
+         */
+        fun apng2JXL(
+            apngFile: ParcelFileDescriptor,
+            @IntRange(from = 0, to = 100) quality: Int = 0,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.FAST,
+        ): ByteArray {
+            return apng2JXLFdImpl(apngFile.fd, quality, effort.value, decodingSpeed.value)
+        }
+
+        /**
+         * Encodes a still PNG without decoding it into a bitmap, rows are decoded while the encoder pulls them
+         * so memory stays bounded for large images. 16 bit samples, gray and the embedded ICC profile are kept,
+         * palettes are expanded and reduced again by the lossless encoder.
+         * @param pngData - byte array contains the PNG data
+         * @return Byte array contains converted JPEG XL
+         */
+        fun png2JXL(
+            pngData: ByteArray,
+            compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSLESS,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            @IntRange(from = 0, to = 100) quality: Int = 100,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+            qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+            instrumentation: JxlInstrumentation? = null,
+        ): ByteArray {
+            return png2JXLImpl(
+                pngData,
+                compressionOption.cValue,
+                effort.value,
+                quality,
+                qualityMapping.value,
+                decodingSpeed.value,
+                instrumentation,
+            )
+        }
+
+        /**
+         * @param pngData - direct byte buffer contains the PNG data, it is read in place without copying
+         * @return Byte array contains converted JPEG XL
+         */
+        fun png2JXL(
+            pngData: ByteBuffer,
+            compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSLESS,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            @IntRange(from = 0, to = 100) quality: Int = 100,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+            qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+            instrumentation: JxlInstrumentation? = null,
+        ): ByteArray {
+            return png2JXLBufferImpl(
+                pngData,
+                compressionOption.cValue,
+                effort.value,
+                quality,
+                qualityMapping.value,
+                decodingSpeed.value,
+                instrumentation,
+            )
+        }
+
+        /**
+         * @param pngFile - PNG file, regular files are mapped into memory, pipes and sockets are read as a stream
+         * @return Byte array contains converted JPEG XL
+         */
+        fun png2JXL(
+            pngFile: ParcelFileDescriptor,
+            compressionOption: JxlCompressionOption = JxlCompressionOption.LOSSLESS,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            @IntRange(from = 0, to = 100) quality: Int = 100,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.SLOWEST,
+            qualityMapping: JxlQualityMapping = JxlQualityMapping.CODER,
+            instrumentation: JxlInstrumentation? = null,
+        ): ByteArray {
+            return png2JXLFdImpl(
+                pngFile.fd,
+                compressionOption.cValue,
+                effort.value,
+                quality,
+                qualityMapping.value,
+                decodingSpeed.value,
+                instrumentation,
+            )
+        }
+
         /**
          * @author Radzivon Bartoshyk
          * @param fromJpegData - JPEG data that will be used for JPEG XL lossless construction
          * @return Byte array that contains constructed JPEG XL
+         * @see JxlJpegRecompressor for converting many files
          */
-        fun construct(fromJpegData: ByteArray): ByteArray {
-            return constructImpl(fromJpegData)
+        fun construct(
+            fromJpegData: ByteArray,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.FAST,
+        ): ByteArray {
+            return constructImpl(fromJpegData, effort.value, decodingSpeed.value)
+        }
+
+        /**
+         * Recompresses many JPEG files, whole files are converted in parallel with one encoder thread each,
+         * which uses cores better than threads inside one small image. Blocks until every file is done,
+         * a failed file does not stop the others and its output file is removed.
+         * @param parallelFiles - files converted at the same time, 0 uses every core
+         */
+        fun recompressJpegs(
+            inputPaths: List<String>,
+            outputPaths: List<String>,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.FAST,
+            @IntRange(from = 0) parallelFiles: Int = 0,
+        ): JxlRecompressionReport {
+            require(inputPaths.size == outputPaths.size) { "Every input must have an output" }
+            return recompressBatchImpl(
+                inputPaths.toTypedArray(),
+                outputPaths.toTypedArray(),
+                null,
+                null,
+                effort.value,
+                decodingSpeed.value,
+                parallelFiles,
+            )
+        }
+
+        /**
+         * Same as the paths variant, outputs are written from their current offsets and descriptors are left open
+         */
+        @JvmName("recompressJpegDescriptors")
+        fun recompressJpegs(
+            inputs: List<ParcelFileDescriptor>,
+            outputs: List<ParcelFileDescriptor>,
+            effort: JxlEffort = JxlEffort.SQUIRREL,
+            decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.FAST,
+            @IntRange(from = 0) parallelFiles: Int = 0,
+        ): JxlRecompressionReport {
+            require(inputs.size == outputs.size) { "Every input must have an output" }
+            return recompressBatchImpl(
+                null,
+                null,
+                inputs.map { it.fd }.toIntArray(),
+                outputs.map { it.fd }.toIntArray(),
+                effort.value,
+                decodingSpeed.value,
+                parallelFiles,
+            )
         }
 
         /**
@@ -199,16 +649,91 @@ object JxlCoder {
         decodingSpeed: Int,
     ): ByteArray
 
+    private external fun apng2JXLBufferImpl(
+        apngData: ByteBuffer,
+        quality: Int,
+        effort: Int,
+        decodingSpeed: Int,
+    ): ByteArray
+
+    private external fun apng2JXLFdImpl(
+        fd: Int,
+        quality: Int,
+        effort: Int,
+        decodingSpeed: Int,
+    ): ByteArray
+
+    private external fun png2JXLImpl(
+        pngData: ByteArray,
+        compressionOption: Int,
+        effort: Int,
+        quality: Int,
+        qualityMapping: Int,
+        decodingSpeed: Int,
+        instrumentation: JxlInstrumentation?,
+    ): ByteArray
+
+    private external fun png2JXLBufferImpl(
+        pngData: ByteBuffer,
+        compressionOption: Int,
+        effort: Int,
+        quality: Int,
+        qualityMapping: Int,
+        decodingSpeed: Int,
+        instrumentation: JxlInstrumentation?,
+    ): ByteArray
+
+    private external fun png2JXLFdImpl(
+        fd: Int,
+        compressionOption: Int,
+        effort: Int,
+        quality: Int,
+        qualityMapping: Int,
+        decodingSpeed: Int,
+        instrumentation: JxlInstrumentation?,
+    ): ByteArray
+
     private external fun gif2JXLImpl(
         gifData: ByteArray,
         quality: Int,
         effort: Int,
         decodingSpeed: Int,
+        compressionOption: Int,
+    ): ByteArray
+
+    private external fun gif2JXLBufferImpl(
+        gifData: ByteBuffer,
+        quality: Int,
+        effort: Int,
+        decodingSpeed: Int,
+        compressionOption: Int,
+    ): ByteArray
+
+    private external fun gif2JXLFdImpl(
+        fd: Int,
+        quality: Int,
+        effort: Int,
+        decodingSpeed: Int,
+        compressionOption: Int,
     ): ByteArray
 
     private external fun reconstructImpl(fromJPEGXLData: ByteArray): ByteArray
 
-    private external fun constructImpl(fromJpegData: ByteArray): ByteArray
+    private external fun recompressBatchImpl(
+        inputPaths: Array<String>?,
+        outputPaths: Array<String>?,
+        inputFds: IntArray?,
+        outputFds: IntArray?,
+        effort: Int,
+        decodingSpeed: Int,
+        parallelFiles: Int,
+    ): JxlRecompressionReport
+
+    private external fun constructImpl(
+        fromJpegData: ByteArray,
+        effort: Int,
+        decodingSpeed: Int,
+    ): ByteArray
 
     private external fun getSizeImpl(byteArray: ByteArray): Size?
 
@@ -219,6 +744,7 @@ object JxlCoder {
         preferredColorConfig: Int,
         scaleMode: Int,
         jxlResizeSampler: Int,
+        instrumentation: JxlInstrumentation?,
     ): Bitmap
 
     private external fun decodeByteBufferSampledImpl(
@@ -228,6 +754,7 @@ object JxlCoder {
         preferredColorConfig: Int,
         scaleMode: Int,
         jxlResizeSampler: Int,
+        instrumentation: JxlInstrumentation?,
     ): Bitmap
 
     private external fun encodeImpl(
@@ -238,9 +765,87 @@ object JxlCoder {
         bitmapColorSpace: String?,
         dataSpaceValue: Int,
         quality: Int,
-        decodingSpeed: Int
+        qualityMapping: Int,
+        decodingSpeed: Int,
+        chunked: Boolean,
+        autoGrayscale: Boolean,
+        grayscaleTolerance: Int,
+        instrumentation: JxlInstrumentation?,
     ): ByteArray
 
+    private external fun encodeToOutputImpl(
+        bitmap: Bitmap,
+        colorSpace: Int,
+        compressionOption: Int,
+        loosyLevel: Int,
+        bitmapColorSpace: String?,
+        dataSpaceValue: Int,
+        quality: Int,
+        qualityMapping: Int,
+        decodingSpeed: Int,
+        chunked: Boolean,
+        autoGrayscale: Boolean,
+        grayscaleTolerance: Int,
+        fd: Int,
+        byteBuffer: ByteBuffer?,
+        instrumentation: JxlInstrumentation?,
+    ): Long
+
+    private external fun encodeToTargetImpl(
+        bitmap: Bitmap,
+        colorSpace: Int,
+        loosyLevel: Int,
+        bitmapColorSpace: String?,
+        dataSpaceValue: Int,
+        quality: Int,
+        qualityMapping: Int,
+        decodingSpeed: Int,
+        autoGrayscale: Boolean,
+        grayscaleTolerance: Int,
+        targetSize: Long,
+        tolerance: Float,
+        targetScore: Double,
+        scoreTolerance: Double,
+        maxIterations: Int,
+        parallelProbes: Int,
+    ): JxlRateControlResult
+
+    private external fun encodeRenditionsImpl(
+        bitmap: Bitmap,
+        colorSpace: Int,
+        bitmapColorSpace: String?,
+        dataSpaceValue: Int,
+        maxWidths: IntArray,
+        maxHeights: IntArray,
+        compressionOptions: IntArray,
+        distances: FloatArray,
+        efforts: IntArray,
+        decodingSpeed: Int,
+        resizeFilter: Int,
+        parallelEncodes: Int,
+    ): JxlRenditions
+
+    private external fun encodeYuvImpl(
+        yPlane: ByteBuffer,
+        yRowStride: Int,
+        uPlane: ByteBuffer,
+        vPlane: ByteBuffer,
+        uvRowStride: Int,
+        uvPixelStride: Int,
+        width: Int,
+        height: Int,
+        sampleFormat: Int,
+        dataSpace: Int,
+        compressionOption: Int,
+        effort: Int,
+        quality: Int,
+        qualityMapping: Int,
+        decodingSpeed: Int,
+        instrumentation: JxlInstrumentation?,
+    ): ByteArray
+
+    private external fun ssimulacra2Impl(reference: Bitmap, distorted: Bitmap): Double
+
     private val MAGIC_1 = byteArrayOf(0xFF.toByte(), 0x0A)
     private val MAGIC_2 = byteArrayOf(
         0x0.toByte(),
@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+package com.awxkee.jxlcoder
+
+/**
+ * *JxlEncoderStatsKey* of libjxl, order matches the native side
+ */
+enum class JxlEncoderStat {
+    HEADER_BITS,
+    TOC_BITS,
+    DICTIONARY_BITS,
+    SPLINES_BITS,
+    NOISE_BITS,
+    QUANT_BITS,
+    MODULAR_TREE_BITS,
+    MODULAR_GLOBAL_BITS,
+    DC_BITS,
+    MODULAR_DC_GROUP_BITS,
+    CONTROL_FIELDS_BITS,
+    COEF_ORDER_BITS,
+    AC_HISTOGRAM_BITS,
+    AC_BITS,
+    MODULAR_AC_GROUP_BITS,
+    NUM_SMALL_BLOCKS,
+    NUM_DCT4X8_BLOCKS,
+    NUM_AFV_BLOCKS,
+    NUM_DCT8_BLOCKS,
+    NUM_DCT8X32_BLOCKS,
+    NUM_DCT16_BLOCKS,
+    NUM_DCT16X32_BLOCKS,
+    NUM_DCT32_BLOCKS,
+    NUM_DCT32X64_BLOCKS,
+    NUM_DCT64_BLOCKS,
+    NUM_BUTTERAUGLI_ITERS,
+}
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+package com.awxkee.jxlcoder
+
+import androidx.annotation.Keep
+
+/**
+ * Timings and counters of one encode or decode call, filled when the call succeeds.
+ * Stage timings are monotonic wall clock nanoseconds.
+ * Allocated bytes count pixel and output buffers of the coder, allocations inside libjxl are not seen.
+ * Encoder stats are filled only when libjxl is built with stats enabled, otherwise all of them are zero.
+ */
+class JxlInstrumentation {
+    private var stageNanos = LongArray(JxlPipelineStage.entries.size)
+    private var encoderStats = LongArray(JxlEncoderStat.entries.size)
+
+    var allocatedBytes: Long = 0
+        private set
+
+    /**
+     * Worker threads of the libjxl runner
+     */
+    var threads: Int = 0
+        private set
+
+    /**
+     * True after an encode, decoding has no encoder stats
+     */
+    var hasEncoderStats: Boolean = false
+        private set
+
+    fun stageNanos(stage: JxlPipelineStage): Long = stageNanos[stage.ordinal]
+
+    fun encoderStat(stat: JxlEncoderStat): Long = encoderStats[stat.ordinal]
+
+    @Keep
+    private fun update(stageNanos: LongArray, allocatedBytes: Long, threads: Int, encoderStats: LongArray?) {
+        this.stageNanos = stageNanos
+        this.allocatedBytes = allocatedBytes
+        this.threads = threads
+        hasEncoderStats = encoderStats != null
+        this.encoderStats = encoderStats ?: LongArray(JxlEncoderStat.entries.size)
+    }
+}
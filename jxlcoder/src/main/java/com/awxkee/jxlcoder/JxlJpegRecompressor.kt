@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+import android.os.Build
+import android.os.ParcelFileDescriptor
+import androidx.annotation.IntRange
+import androidx.annotation.Keep
+import java.io.Closeable
+import java.nio.ByteBuffer
+
+/**
+ * Lossless JPEG to JPEG XL recompression which keeps its native encoder and threads between files,
+ * for converting many JPEGs. JPEG in a direct buffer or a file is read in place without copying.
+ * Calls are serialized, use one instance per thread for parallel conversion.
+ * @param workerThreads - encoder threads, 0 picks the default and 1 encodes on the calling thread
+ */
+@Keep
+class JxlJpegRecompressor @Keep constructor(
+    effort: JxlEffort = JxlEffort.SQUIRREL,
+    decodingSpeed: JxlDecodingSpeed = JxlDecodingSpeed.FAST,
+    @IntRange(from = 0) workerThreads: Int = 0,
+) : Closeable {
+
+    private var recompressor: Long = -1
+    private val lock = Any()
+
+    init {
+        if (Build.VERSION.SDK_INT >= 21) {
+            System.loadLibrary("jxlcoder")
+        }
+        recompressor = createRecompressor(effort.value, decodingSpeed.value, workerThreads)
+    }
+
+    fun recompress(jpegData: ByteArray): ByteArray {
+        synchronized(lock) {
+            assertOpen()
+            return recompressImpl(recompressor, jpegData, null, -1)
+        }
+    }
+
+    /**
+     * @param jpegData - direct byte buffer, read in place without copying
+     */
+    fun recompress(jpegData: ByteBuffer): ByteArray {
+        synchronized(lock) {
+            assertOpen()
+            return recompressImpl(recompressor, null, jpegData, -1)
+        }
+    }
+
+    /**
+     * @param jpegFile - regular JPEG file, it is mapped into memory
+     */
+    fun recompress(jpegFile: ParcelFileDescriptor): ByteArray {
+        synchronized(lock) {
+            assertOpen()
+            return recompressImpl(recompressor, null, null, jpegFile.fd)
+        }
+    }
+
+    /**
+     * Writes JPEG XL straight into the file from its current offset
+     * @param jpegFile - regular JPEG file, it is mapped into memory
+     * @return number of bytes written
+     */
+    fun recompress(jpegFile: ParcelFileDescriptor, output: ParcelFileDescriptor): Long {
+        synchronized(lock) {
+            assertOpen()
+            return recompressToOutputImpl(recompressor, null, null, jpegFile.fd, output.fd, null)
+        }
+    }
+
+    /**
+     * Writes JPEG XL into the direct buffer from its position, the position is advanced past the image.
+     * Fails if the remaining space is not enough, JPEG size plus a small margin is always enough in practice.
+     * @param jpegData - direct byte buffer, read in place without copying
+     * @return number of bytes written
+     */
+    fun recompress(jpegData: ByteBuffer, output: ByteBuffer): Int {
+        synchronized(lock) {
+            assertOpen()
+            val written = recompressToOutputImpl(recompressor, null, jpegData, -1, -1, output.slice()).toInt()
+            output.position(output.position() + written)
+            return written
+        }
+    }
+
+    private external fun createRecompressor(effort: Int, decodingSpeed: Int, workerThreads: Int): Long
+    private external fun releaseRecompressor(ptr: Long)
+    private external fun recompressImpl(
+        ptr: Long,
+        jpegData: ByteArray?,
+        jpegBuffer: ByteBuffer?,
+        jpegFd: Int,
+    ): ByteArray
+
+    private external fun recompressToOutputImpl(
+        ptr: Long,
+        jpegData: ByteArray?,
+        jpegBuffer: ByteBuffer?,
+        jpegFd: Int,
+        outputFd: Int,
+        outputBuffer: ByteBuffer?,
+    ): Long
+
+    private fun assertOpen() {
+        if (recompressor == -1L) {
+            throw IllegalStateException("Recompressor is already closed, call to it functions is impossible")
+        }
+    }
+
+    override fun close() {
+        synchronized(lock) {
+            if (recompressor != -1L) {
+                releaseRecompressor(recompressor)
+                recompressor = -1L
+            }
+        }
+    }
+
+    protected fun finalize() {
+        close()
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+
+/**
+ * Outcome of [JxlCoder.Convenience.recompressJpegs], statuses and sizes are in the order of inputs
+ */
+class JxlRecompressionReport(
+    private val statuses: IntArray,
+    private val outputSizes: LongArray,
+    /** Total size of successfully recompressed JPEGs */
+    val inputBytes: Long,
+    val outputBytes: Long,
+    val elapsedNanos: Long,
+) {
+    val count: Int
+        get() = statuses.size
+
+    val failedCount: Int
+        get() = statuses.count { it != JxlRecompressionStatus.OK.value }
+
+    /**
+     * Throughput of the whole batch by the recompressed JPEG bytes
+     */
+    val megabytesPerSecond: Double
+        get() = if (elapsedNanos > 0) inputBytes / 1e6 / (elapsedNanos / 1e9) else 0.0
+
+    fun status(index: Int): JxlRecompressionStatus {
+        return JxlRecompressionStatus.values().first { it.value == statuses[index] }
+    }
+
+    fun outputSize(index: Int): Long = outputSizes[index]
+}
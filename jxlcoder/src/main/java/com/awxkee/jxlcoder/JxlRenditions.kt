@@ -0,0 +1,61 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+import java.nio.ByteBuffer
+
+/**
+ * Images encoded by [JxlCoder.encodeRenditions] in the order of their specs,
+ * all of them are stored one after another in [data]
+ */
+class JxlRenditions(
+    val data: ByteArray,
+    private val offsets: IntArray,
+    private val sizes: IntArray,
+    private val widths: IntArray,
+    private val heights: IntArray,
+) {
+    val count: Int
+        get() = offsets.size
+
+    fun width(index: Int): Int = widths[index]
+
+    fun height(index: Int): Int = heights[index]
+
+    /**
+     * Read only view of the encoded image inside [data], nothing is copied
+     */
+    fun buffer(index: Int): ByteBuffer {
+        return ByteBuffer.wrap(data, offsets[index], sizes[index]).slice().asReadOnlyBuffer()
+    }
+
+    fun toByteArray(index: Int): ByteArray {
+        return data.copyOfRange(offsets[index], offsets[index] + sizes[index])
+    }
+}
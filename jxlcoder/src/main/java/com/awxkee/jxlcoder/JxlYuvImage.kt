@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+package com.awxkee.jxlcoder
+
+import android.graphics.ImageFormat
+import android.media.Image
+import android.os.Build
+import java.nio.ByteBuffer
+
+/**
+ * 4:2:0 frame given to [JxlCoder.encodeYuv], planes must be direct buffers, strides are in bytes.
+ * Semi-planar frames have [u] and [v] one sample apart in the same memory with pixel stride of two samples.
+ * @param dataSpace - *android.hardware.DataSpace* of the frame, selects the matrix, the range and the color encoding.
+ * When unknown, 8 bit frames are treated as full range BT.601 and P010 as limited range BT.601 in sRGB.
+ */
+class JxlYuvImage(
+    val width: Int,
+    val height: Int,
+    val format: JxlYuvFormat,
+    val y: ByteBuffer,
+    val yRowStride: Int,
+    val u: ByteBuffer,
+    val v: ByteBuffer,
+    val uvRowStride: Int,
+    val uvPixelStride: Int,
+    val dataSpace: Int = -1,
+) {
+    companion object {
+        /**
+         * Wraps planes of a *YUV_420_888* or *YCBCR_P010* image, nothing is copied, so the image must stay open while encoding
+         */
+        fun fromImage(image: Image): JxlYuvImage {
+            val format = when (image.format) {
+                ImageFormat.YUV_420_888 -> JxlYuvFormat.YUV_420
+                ImageFormat.YCBCR_P010 -> JxlYuvFormat.P010
+                else -> throw IllegalArgumentException("Only YUV_420_888 and YCBCR_P010 images are supported")
+            }
+            val planes = image.planes
+            return JxlYuvImage(
+                image.width,
+                image.height,
+                format,
+                planes[0].buffer,
+                planes[0].rowStride,
+                planes[1].buffer,
+                planes[2].buffer,
+                planes[1].rowStride,
+                planes[1].pixelStride,
+                if (Build.VERSION.SDK_INT >= 33) image.dataSpace else -1,
+            )
+        }
+
+        /**
+         * NV21 frame of the legacy camera, it is copied into a direct buffer
+         */
+        fun fromNv21(data: ByteArray, width: Int, height: Int, dataSpace: Int = -1): JxlYuvImage {
+            val buffer = ByteBuffer.allocateDirect(data.size)
+            buffer.put(data)
+            val chromaOffset = width * height
+            val vPlane = buffer.duplicate().apply { position(chromaOffset) }
+            val uPlane = buffer.duplicate().apply { position(chromaOffset + 1) }
+            val chromaRowStride = (width + 1) / 2 * 2
+            return JxlYuvImage(
+                width,
+                height,
+                JxlYuvFormat.YUV_420,
+                buffer,
+                width,
+                uPlane.slice(),
+                vPlane.slice(),
+                chromaRowStride,
+                2,
+                dataSpace,
+            )
+        }
+    }
+}
@@ -112,14 +112,14 @@ public class AnimatedDrawable(
         if (firstFrameAsPlaceholder) {
             nextFrameIndex += 1
         }
-        if (nextFrameIndex >= frameStore.framesCount) {
+        if (!frameStore.hasFrame(nextFrameIndex)) {
             nextFrameIndex = 0
         }
 
         repeat(preheatFrames) {
             makeDecodingRunner(nextFrameIndex).run()
             nextFrameIndex += 1
-            if (nextFrameIndex >= frameStore.framesCount) {
+            if (!frameStore.hasFrame(nextFrameIndex)) {
                 nextFrameIndex = 0
             }
         }
@@ -127,7 +127,7 @@ public class AnimatedDrawable(
 
     private val decodingRunnable = Runnable {
         var nextFrameIndex = lastDecodedFrameIndex + 1
-        if (nextFrameIndex >= frameStore.framesCount) {
+        if (!frameStore.hasFrame(nextFrameIndex)) {
             nextFrameIndex = 0
         }
 
@@ -158,7 +158,7 @@ public class AnimatedDrawable(
             nextFrameIndex += 1
         }
 
-        if (nextFrameIndex >= frameStore.framesCount) {
+        if (!frameStore.hasFrame(nextFrameIndex)) {
             nextFrameIndex = 0
         }
 
@@ -167,7 +167,7 @@ public class AnimatedDrawable(
         makeDecodingRunner(nextFrameIndex).run()
         // Since we actually moving with stride *preheatFrames* we have to check if the N + stride frame also exists
         var preheatFrame = nextFrameIndex - 1 + preheatFrames
-        if (preheatFrame >= frameStore.framesCount || preheatFrame < 0) {
+        if (preheatFrame < 0 || !frameStore.hasFrame(preheatFrame)) {
             preheatFrame = 0
         }
         makeDecodingRunner(preheatFrame).run()
@@ -179,7 +179,7 @@ public class AnimatedDrawable(
             // If we decode faster than 1000/24ms then do to frames at the time
             if (averageDecodingTime < minFrameToIncrease.toDouble()) {
                 nextFrameIndex += preheatFrames + 1
-                if (nextFrameIndex >= frameStore.framesCount) {
+                if (!frameStore.hasFrame(nextFrameIndex)) {
                     nextFrameIndex = 0
                 }
                 makeDecodingRunner(nextFrameIndex).run()
@@ -35,5 +35,14 @@ public interface AnimatedFrameStore {
     val height: Int
     fun getFrame(frame: Int): Bitmap
     fun getFrameDuration(frame: Int): Int
+
+    /**
+     * Frames known so far, stores which count frames while playing may report more later
+     */
     val framesCount: Int
+
+    /**
+     * Whether the frame exists, may wait until the store knows it
+     */
+    fun hasFrame(frame: Int): Boolean = frame < framesCount
 }
\ No newline at end of file
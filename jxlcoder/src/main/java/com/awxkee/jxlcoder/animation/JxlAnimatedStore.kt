@@ -75,10 +75,28 @@ public class JxlAnimatedStore(
     private var storedFramesCount: Int = -1
 
     override val framesCount: Int
-        get() = if (storedFramesCount == -1) {
-            storedFramesCount = jxlAnimatedImage.numberOfFrames
-            storedFramesCount
-        } else {
-            storedFramesCount
+        get() {
+            if (storedFramesCount != -1) {
+                return storedFramesCount
+            }
+            // Finality is read first so the count read after it is the final one
+            val isFinal = jxlAnimatedImage.isNumberOfFramesFinal
+            val knownFrames = jxlAnimatedImage.knownNumberOfFrames
+            if (isFinal) {
+                storedFramesCount = knownFrames
+            }
+            return knownFrames
+        }
+
+    override fun hasFrame(frame: Int): Boolean {
+        if (frame < framesCount) {
+            return true
         }
+        if (storedFramesCount != -1) {
+            return false
+        }
+        // Waits for the background scan only as far as this frame
+        jxlAnimatedImage.getFrameDuration(frame)
+        return frame < framesCount
+    }
 }
\ No newline at end of file